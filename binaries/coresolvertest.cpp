@@ -52,6 +52,7 @@
 #include <gui/Window.h>
 #include <imageprocessing/gui/ImageStackView.h>
 #include <neurons/NeuronExtractor.h>
+#include <trace/Tracer.h>
 
 #include <util/Logger.h>
 
@@ -1818,6 +1819,7 @@ int main(int optionc, char** optionv)
 {
 	util::ProgramOptions::init(optionc, optionv);
 	LogManager::init();
+	Tracer::configure();
 	
 	try
 	{
@@ -14,6 +14,7 @@
 #include <imageprocessing/io/ImageStackDirectoryWriter.h>
 #include <pipeline/Process.h>
 #include <pipeline/Value.h>
+#include <sopnet/evaluation/ContingencyTableExtractor.h>
 #include <sopnet/evaluation/TolerantEditDistance.h>
 #include <sopnet/evaluation/VariationOfInformation.h>
 #include <sopnet/evaluation/RandIndex.h>
@@ -75,25 +76,25 @@ int main(int optionc, char** optionv) {
 
 		// setup comparison measures
 
-		pipeline::Process<VariationOfInformation> voi;
-		pipeline::Process<RandIndex>              rand;
+		pipeline::Process<ContingencyTableExtractor> contingencyTable;
+		pipeline::Process<VariationOfInformation>    voi;
+		pipeline::Process<RandIndex>                 rand;
 
 		// connect
 
 		editDistance->setInput("ground truth", groundTruthReader->getOutput());
 		editDistance->setInput("reconstruction", reconstructionReader->getOutput());
 
-		if (optionVoi) {
+		// both measures share the label counts of a single pass over the 
+		// volumes
+		contingencyTable->setInput("stack 1", groundTruthReader->getOutput());
+		contingencyTable->setInput("stack 2", reconstructionReader->getOutput());
 
-			voi->setInput("stack 1", groundTruthReader->getOutput());
-			voi->setInput("stack 2", reconstructionReader->getOutput());
-		}
-
-		if (optionRand) {
+		if (optionVoi)
+			voi->setInput("contingency table", contingencyTable->getOutput());
 
-			rand->setInput("stack 1", groundTruthReader->getOutput());
-			rand->setInput("stack 2", reconstructionReader->getOutput());
-		}
+		if (optionRand)
+			rand->setInput("contingency table", contingencyTable->getOutput());
 
 		if (!optionHeadless) {
 
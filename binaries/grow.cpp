@@ -15,6 +15,7 @@
 #include <imageprocessing/io/ImageStackDirectoryWriter.h>
 #include <pipeline/Process.h>
 #include <pipeline/Value.h>
+#include <sopnet/evaluation/EuclideanDistanceTransform.h>
 #include <util/ProgramOptions.h>
 #include <util/Logger.h>
 
@@ -63,9 +64,21 @@ private:
 		int width  = (*_stack)[0]->width();
 		int height = (*_stack)[0]->height();
 
-		int distanceX = (int)optionDistance/resX;
-		int distanceY = (int)optionDistance/resY;
-		int distanceZ = (int)optionDistance/resZ;
+		// find the closest foreground pixel for each pixel
+
+		vigra::Shape3 shape(width, height, depth);
+
+		EuclideanDistanceTransform::mask_type     foreground(shape);
+		EuclideanDistanceTransform::distance_type distance2;
+		EuclideanDistanceTransform::nearest_type  nearest;
+
+		for (int z = 0; z < depth; z++)
+			for (int y = 0; y < height; y++)
+				for (int x = 0; x < width; x++)
+					foreground(x, y, z) = ((*(*_stack)[z])(x, y) != 0);
+
+		EuclideanDistanceTransform distanceTransform(resX, resY, resZ);
+		distanceTransform(foreground, distance2, nearest);
 
 		_grown->clear();
 		for (int i = 0; i < depth; i++) {
@@ -76,60 +89,21 @@ private:
 			for (int y = 0; y < height; y++)
 				for (int x = 0; x < width; x++) {
 
-					// get the label of the center pixel
-					float k = (*(*_stack)[z])(x, y);
-
-					// forground pixels don't change
-					if (k != 0) {
-
-						(*(*_grown)[z])(x, y) = k;
-						continue;
-					}
-
-					// now we know we process a background pixel
-
-					// find the closest foreground label within grow radius 
-					// sphere
+					// forground pixels don't change, background pixels take 
+					// the label of the closest foreground pixel within grow 
+					// radius sphere
 
 					float closestLabel = 0;
-					float minDistance2 = growRadius*growRadius;
-
-					// for each candidate pixel in the grow radius
-					for (int dz = -distanceZ; dz <= distanceZ; dz++)
-						for (int dy = -distanceY; dy <= distanceY; dy++)
-							for (int dx = -distanceX; dx <= distanceY; dx++) {
-
-								// the squared distance to the background pixel 
-								// in nm
-								float distance2 = resX*resX*dx*dx + resY*resY*dy*dy + resZ*resZ*dz*dz;
-
-								// don't consider pixels outside the grow radius 
-								// sphere
-								if (distance2 > growRadius*growRadius)
-									continue;
 
-								// the pixel coordinates of the candidate pixel
-								int tx = x + dx;
-								int ty = y + dy;
-								int tz = z + dz;
+					if (distance2(x, y, z) <= growRadius*growRadius) {
 
-								// is the candidate still in the volume?
-								if (tx < 0 || tx >= width || ty < 0 || ty >= height || tz < 0 || tz >= depth)
-									continue;
+						unsigned int n  = nearest(x, y, z);
+						unsigned int nx = n%width;
+						unsigned int ny = (n/width)%height;
+						unsigned int nz = n/(width*height);
 
-								// the label of the candidate pixel
-								float label = (*(*_stack)[tz])(tx, ty);
-
-								// we are only interested in foreground labels
-								if (label == 0)
-									continue;
-
-								if (distance2 <= minDistance2) {
-
-									closestLabel = label;
-									minDistance2 = distance2;
-								}
-							}
+						closestLabel = (*(*_stack)[nz])(nx, ny);
+					}
 
 					(*(*_grown)[z])(x, y) = closestLabel;
 				}
@@ -1,25 +1,37 @@
 /**
  * median filter main file. Initializes all objects, views, and visualizers.
+ *
+ * With --inDirectory, filters all images of a directory in parallel and 
+ * writes them to --outDirectory without showing the gui.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
 
 #include <vigra/convolution.hxx>
+#include <vigra/impex.hxx>
 
 #include <gui/ContainerView.h>
 #include <gui/Slider.h>
 #include <gui/VerticalPlacing.h>
 #include <gui/Window.h>
 #include <gui/ZoomView.h>
-#include <imageprocessing/MedianFilter.h>
 #include <imageprocessing/gui/ImageView.h>
 #include <imageprocessing/io/ImageReader.h>
 #include <imageprocessing/io/ImageWriter.h>
 #include <pipeline/Process.h>
 #include <pipeline/Value.h>
+#include <sopnet/filters/ConstantTimeMedianFilter.h>
+#include <sopnet/parallel/WorkerPool.h>
+#include <util/exceptions.h>
 #include <util/ProgramOptions.h>
 #include <util/Logger.h>
 
@@ -40,10 +52,67 @@ util::ProgramOption optionRadius(
 		util::_description_text = "The radius of the median filter to smooth the image.",
 		util::_default_value    = 2);
 
+util::ProgramOption optionInDirectory(
+		util::_long_name        = "inDirectory",
+		util::_description_text = "A directory of membrane images to process in batch mode. Implies --headless.");
+
+util::ProgramOption optionOutDirectory(
+		util::_long_name        = "outDirectory",
+		util::_description_text = "The directory to write the filtered images of the batch mode to.",
+		util::_default_value    = "membranes_filtered");
+
 util::ProgramOption optionHeadless(
 		util::_long_name        = "headless",
 		util::_description_text = "Create the filtered image and leave without gui");
 
+void filterImage(const boost::filesystem::path& inFile, const boost::filesystem::path& outFile, int radius) {
+
+	vigra::ImageImportInfo info(inFile.string().c_str());
+
+	vigra::MultiArray<2, vigra::UInt8> image(vigra::Shape2(info.width(), info.height()));
+	vigra::MultiArray<2, vigra::UInt8> filtered(vigra::Shape2(info.width(), info.height()));
+
+	vigra::importImage(info, destImage(image));
+
+	// the images are processed in parallel already
+	ConstantTimeMedianFilter::filter(image, filtered, radius, 1);
+
+	vigra::exportImage(srcImageRange(filtered), vigra::ImageExportInfo(outFile.string().c_str()));
+}
+
+void filterDirectory(const std::string& inDirectory, const std::string& outDirectory, int radius) {
+
+	boost::filesystem::path inPath(inDirectory);
+	boost::filesystem::path outPath(outDirectory);
+
+	if (!boost::filesystem::is_directory(inPath))
+		BOOST_THROW_EXCEPTION(IOError() << error_message(std::string("\"") + inDirectory + "\" is not a directory") << STACK_TRACE);
+
+	if (!boost::filesystem::exists(outPath))
+		boost::filesystem::create_directory(outPath);
+
+	std::vector<boost::filesystem::path> files;
+	std::copy(boost::filesystem::directory_iterator(inPath), boost::filesystem::directory_iterator(), std::back_inserter(files));
+	std::sort(files.begin(), files.end());
+
+	WorkerPool workers;
+
+	unsigned int numImages = 0;
+
+	for (unsigned int i = 0; i < files.size(); i++) {
+
+		if (!boost::filesystem::is_regular_file(files[i]))
+			continue;
+
+		workers.schedule(boost::bind(&filterImage, files[i], outPath/files[i].filename(), radius));
+		numImages++;
+	}
+
+	LOG_USER(out) << "[main] filtering " << numImages << " images with " << workers.size() << " threads" << std::endl;
+
+	workers.wait();
+}
+
 int main(int optionc, char** optionv) {
 
 	try {
@@ -60,6 +129,16 @@ int main(int optionc, char** optionv) {
 
 		LOG_USER(out) << "[main] starting..." << std::endl;
 
+		if (optionInDirectory) {
+
+			filterDirectory(
+					optionInDirectory.as<std::string>(),
+					optionOutDirectory.as<std::string>(),
+					optionRadius.as<int>());
+
+			return 0;
+		}
+
 		/*********
 		 * SETUP *
 		 *********/
@@ -74,7 +153,7 @@ int main(int optionc, char** optionv) {
 
 		// setup median filter
 
-		pipeline::Process<MedianFilter> medianFilter;
+		pipeline::Process<ConstantTimeMedianFilter> medianFilter;
 
 		medianFilter->setInput("radius", radiusSlider->getOutput("value"));
 		medianFilter->setInput("image", membraneReader->getOutput());
@@ -5,7 +5,6 @@
  */
 
 #include <iostream>
-#include <vigra/multi_distance.hxx>
 #include <gui/ContainerView.h>
 #include <gui/HorizontalPlacing.h>
 #include <gui/NamedView.h>
@@ -16,6 +15,7 @@
 #include <imageprocessing/io/ImageStackDirectoryWriter.h>
 #include <pipeline/Process.h>
 #include <pipeline/Value.h>
+#include <sopnet/evaluation/EuclideanDistanceTransform.h>
 #include <util/ProgramOptions.h>
 #include <util/Logger.h>
 
@@ -70,27 +70,17 @@ private:
 		int width  = (*_stack)[0]->width();
 		int height = (*_stack)[0]->height();
 
-		vigra::MultiArray<3, float> boundaryDistance2(vigra::Shape3(width, height, depth));
-		boundaryDistance2 = 0;
+		EuclideanDistanceTransform::mask_type     boundary(vigra::Shape3(width, height, depth));
+		EuclideanDistanceTransform::distance_type boundaryDistance2;
 
 		for (int z = 0; z < depth; z++)
 			for (int y = 0; y < height; y++)
 				for (int x = 0; x < width; x++)
-					if ((*(*_stack)[z])(x, y) == 0)
-						boundaryDistance2(x, y, z) = 1.0;
-
-
-		float pitch[3];
-		pitch[0] = resX;
-		pitch[1] = resY;
-		pitch[2] = resZ;
+					boundary(x, y, z) = ((*(*_stack)[z])(x, y) == 0);
 
 		// compute l2 distance for each pixel to boundary
-		vigra::separableMultiDistSquared(
-				boundaryDistance2,
-				boundaryDistance2,
-				true /* background */,
-				pitch);
+		EuclideanDistanceTransform distanceTransform(resX, resY, resZ);
+		distanceTransform(boundary, boundaryDistance2);
 
 		// for each region, get maximal boundary distance
 		std::map<float, float> maxDistances2;
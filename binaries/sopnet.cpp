@@ -37,7 +37,10 @@
 #include <sopnet/io/IdMapCreator.h>
 #include <sopnet/io/NeuronsImageWriter.h>
 #include <sopnet/inference/GridSearch.h>
+#include <sopnet/inference/GridSearchSolver.h>
+#include <sopnet/inference/Reconstructor.h>
 #include <sopnet/neurons/NeuronExtractor.h>
+#include <trace/Tracer.h>
 #include <util/ProgramOptions.h>
 #include <util/SignalHandler.h>
 
@@ -186,6 +189,9 @@ int main(int optionc, char** optionv) {
 		// init logger
 		LogManager::init();
 
+		// init tracing of the processing stages
+		Tracer::configure();
+
 		// init signal handler
 		//util::SignalHandler::init();
 
@@ -626,24 +632,58 @@ int main(int optionc, char** optionv) {
 				sopnet->setInput("prior cost parameters", gridSearch->getOutput("prior cost parameters"));
 				sopnet->setInput("segmentation cost parameters", gridSearch->getOutput("segmentation cost parameters"));
 
-				while (true) {
+				// segments, features, and constraints are extracted only once, 
+				// for each grid point only the objective is updated
+				pipeline::Value<LinearConstraints> linearConstraints = sopnet->getOutput("linear constraints");
+
+				GridSearchSolver gridSearchSolver(
+						boost::make_shared<LinearConstraints>(*linearConstraints),
+						LinearSolverParameters(Binary));
+
+				// reconstruct the solutions of the grid search
+				boost::shared_ptr<Reconstructor> gridReconstructor = boost::make_shared<Reconstructor>();
+				gridReconstructor->setInput("segments", sopnet->getOutput("segments"));
+				neuronExtractor->setInput("segments", gridReconstructor->getOutput());
+
+				bool done = false;
+
+				while (!done) {
+
+					std::vector<std::string>                       parameterStrings;
+					std::vector<boost::shared_ptr<LinearObjective> > objectives;
+
+					// collect the objectives of the next grid points
+					while (objectives.size() < gridSearchSolver.getBatchSize()) {
+
+						parameterStrings.push_back(gridSearch->currentParameters());
+
+						pipeline::Value<LinearObjective> objective = sopnet->getOutput("objective");
+						objectives.push_back(boost::make_shared<LinearObjective>(*objective));
+
+						if (!gridSearch->next()) {
+
+							done = true;
+							break;
+						}
+					}
+
+					LOG_USER(out) << "[main] solving " << objectives.size() << " grid points" << std::endl;
 
-					std::string parameterString = gridSearch->currentParameters();
+					std::vector<boost::shared_ptr<Solution> > solutions = gridSearchSolver.solve(objectives);
 
-					LOG_USER(out) << "[main] performing grid search with " << parameterString << std::endl;
+					for (unsigned int i = 0; i < solutions.size(); i++) {
 
-					boost::shared_ptr<IdMapCreator>       gridResultIdMapCreator = boost::make_shared<IdMapCreator>();
-					boost::shared_ptr<NeuronsImageWriter> gridResultWriter       = boost::make_shared<NeuronsImageWriter>(optionSaveResultDirectory.as<std::string>() + "/" + parameterString, optionSaveResultBasename);
+						LOG_USER(out) << "[main] writing grid search result for " << parameterStrings[i] << std::endl;
 
-					gridResultIdMapCreator->setInput("neurons", neuronExtractor->getOutput());
-					gridResultIdMapCreator->setInput("reference", rawSectionsReader->getOutput());
+						gridReconstructor->setInput("solution", solutions[i]);
 
-					gridResultWriter->setInput("id map", gridResultIdMapCreator->getOutput("id map"));
-					gridResultWriter->setInput("annotation", variationOfInformation->getOutput());
-					gridResultWriter->write();
+						boost::shared_ptr<NeuronsImageWriter> gridResultWriter = boost::make_shared<NeuronsImageWriter>(optionSaveResultDirectory.as<std::string>() + "/" + parameterStrings[i], optionSaveResultBasename);
 
-					if (!gridSearch->next())
-						break;
+						gridResultWriter->setInput("neurons", neuronExtractor->getOutput());
+						gridResultWriter->setInput("reference", rawSectionsReader->getOutput());
+						gridResultWriter->setInput("annotation", variationOfInformation->getOutput());
+						gridResultWriter->write();
+					}
 				}
 
 				LOG_USER(out) << "[main] grid search done." << std::endl;
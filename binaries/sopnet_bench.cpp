@@ -0,0 +1,599 @@
+/**
+ * sopnet_bench
+ *
+ * End-to-end benchmark of the blockwise pipeline on a synthetic volume. A
+ * membrane, raw, and label stack of configurable size and neurite density is
+ * generated in a work directory, and the pipeline stages are run on local
+ * stores one after another:
+ *
+ *   slices    - slice extraction for all blocks (SliceGuarantor)
+ *   segments  - segment extraction for all blocks (SegmentGuarantor)
+ *   features  - segment feature extraction on the raw stack
+ *   costs     - linear cost evaluation and objective generation
+ *   assembly  - consistency constraints (SolutionGuarantor's assembler) and
+ *               problem assembly
+ *   solve     - solving all cores (SolutionGuarantor)
+ *
+ * For each stage, the wall time, the number of processed items, the
+ * throughput, and the peak resident set size of the process are written as
+ * JSON. No network connection is needed. Without a linear solver backend, the
+ * solve stage is reported as skipped.
+ */
+
+#include <config.h>
+
+#include <sys/resource.h>
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <vigra/impex.hxx>
+#include <vigra/multi_array.hxx>
+
+#include <catmaid/SegmentGuarantor.h>
+#include <catmaid/SliceGuarantor.h>
+#include <catmaid/SolutionGuarantor.h>
+#include <catmaid/persistence/LocalSegmentStore.h>
+#include <catmaid/persistence/LocalSliceStore.h>
+#include <catmaid/persistence/LocalStackStore.h>
+#include <catmaid/persistence/SegmentReader.h>
+#include <catmaid/persistence/SliceReader.h>
+#include <imageprocessing/io/ImageStackDirectoryReader.h>
+#include <inference/LinearConstraint.h>
+#include <inference/LinearConstraints.h>
+#include <inference/LinearObjective.h>
+#include <pipeline/Value.h>
+#include <pipeline/all.h>
+#include <sopnet/block/Blocks.h>
+#include <sopnet/block/Box.h>
+#include <sopnet/block/Cores.h>
+#include <sopnet/block/LocalBlockManager.h>
+#include <sopnet/features/Features.h>
+#include <sopnet/features/SegmentFeaturesExtractor.h>
+#include <sopnet/inference/LinearCostFunction.h>
+#include <sopnet/inference/LinearCostFunctionParameters.h>
+#include <sopnet/inference/ObjectiveGenerator.h>
+#include <sopnet/inference/PriorCostFunctionParameters.h>
+#include <sopnet/inference/ProblemAssembler.h>
+#include <sopnet/segments/Segments.h>
+#include <sopnet/slices/ConflictSets.h>
+#include <sopnet/slices/Slices.h>
+#include <trace/Tracer.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
+#include <util/foreach.h>
+#include <util/point3.hpp>
+
+using util::point3;
+using namespace logger;
+
+logger::LogChannel benchlog("benchlog", "[sopnet_bench] ");
+
+util::ProgramOption optionBenchWidth(
+		util::_module           = "bench",
+		util::_long_name        = "width",
+		util::_description_text = "The width of the synthetic volume in pixels.",
+		util::_default_value    = 512);
+
+util::ProgramOption optionBenchHeight(
+		util::_module           = "bench",
+		util::_long_name        = "height",
+		util::_description_text = "The height of the synthetic volume in pixels.",
+		util::_default_value    = 512);
+
+util::ProgramOption optionBenchDepth(
+		util::_module           = "bench",
+		util::_long_name        = "depth",
+		util::_description_text = "The number of sections of the synthetic volume.",
+		util::_default_value    = 10);
+
+util::ProgramOption optionBenchNeuriteDensity(
+		util::_module           = "bench",
+		util::_long_name        = "neuriteDensity",
+		util::_description_text = "The number of neurites per 100x100 pixels of a section.",
+		util::_default_value    = 2.0);
+
+util::ProgramOption optionBenchMinRadius(
+		util::_module           = "bench",
+		util::_long_name        = "minRadius",
+		util::_description_text = "The minimal radius of a neurite in pixels.",
+		util::_default_value    = 5);
+
+util::ProgramOption optionBenchMaxRadius(
+		util::_module           = "bench",
+		util::_long_name        = "maxRadius",
+		util::_description_text = "The maximal radius of a neurite in pixels.",
+		util::_default_value    = 15);
+
+util::ProgramOption optionBenchNoise(
+		util::_module           = "bench",
+		util::_long_name        = "noise",
+		util::_description_text = "The standard deviation of the noise added to the membrane and raw images, in gray values.",
+		util::_default_value    = 10.0);
+
+util::ProgramOption optionBenchSeed(
+		util::_module           = "bench",
+		util::_long_name        = "seed",
+		util::_description_text = "The seed of the random number generator used to create the volume.",
+		util::_default_value    = 42);
+
+util::ProgramOption optionBenchBlockSize(
+		util::_module           = "bench",
+		util::_long_name        = "blockSize",
+		util::_description_text = "The size of a block as 'x,y,z'.",
+		util::_default_value    = "256,256,5");
+
+util::ProgramOption optionBenchCoreSize(
+		util::_module           = "bench",
+		util::_long_name        = "coreSize",
+		util::_description_text = "The size of a core in blocks as 'x,y,z'.",
+		util::_default_value    = "2,2,1");
+
+util::ProgramOption optionBenchBuffer(
+		util::_module           = "bench",
+		util::_long_name        = "buffer",
+		util::_description_text = "The number of blocks to buffer each core with for solving.",
+		util::_default_value    = 1);
+
+util::ProgramOption optionBenchWorkDirectory(
+		util::_module           = "bench",
+		util::_long_name        = "workDirectory",
+		util::_description_text = "The directory to write the synthetic volume to.",
+		util::_default_value    = "./sopnet_bench_volume");
+
+util::ProgramOption optionBenchOutput(
+		util::_module           = "bench",
+		util::_long_name        = "output",
+		util::_description_text = "The file to write the JSON report to. Leave empty to write it to stdout.",
+		util::_default_value    = "");
+
+/**
+ * The measurements of a single benchmark stage.
+ */
+struct StageResult {
+
+	StageResult() : seconds(0), items(0), peakRss(0), skipped(false) {}
+
+	std::string name;
+
+	double seconds;
+
+	// the number of items (slices, segments, constraints, ...) produced
+	unsigned int items;
+
+	// the peak resident set size of the process after the stage in kB
+	long peakRss;
+
+	bool skipped;
+};
+
+/**
+ * Measures the wall time between its creation and a call to stop().
+ */
+class StageTimer {
+
+public:
+
+	StageTimer(const std::string& name) :
+		_start(boost::posix_time::microsec_clock::universal_time()) {
+
+		_result.name = name;
+
+		LOG_USER(benchlog) << "running stage " << name << std::endl;
+	}
+
+	StageResult stop(unsigned int items) {
+
+		boost::posix_time::time_duration elapsed =
+				boost::posix_time::microsec_clock::universal_time() - _start;
+
+		_result.seconds = elapsed.total_microseconds()*1e-6;
+		_result.items   = items;
+		_result.peakRss = peakRss();
+
+		LOG_USER(benchlog)
+				<< "stage " << _result.name << " processed " << items << " items in "
+				<< _result.seconds << "s" << std::endl;
+
+		return _result;
+	}
+
+	/**
+	 * The peak resident set size of this process in kB.
+	 */
+	static long peakRss() {
+
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+			return 0;
+
+		return usage.ru_maxrss;
+	}
+
+private:
+
+	boost::posix_time::ptime _start;
+
+	StageResult _result;
+};
+
+point3<unsigned int> parsePoint(const std::string& s) {
+
+	point3<unsigned int> p;
+	char sep1, sep2;
+
+	std::istringstream in(s);
+	in >> p.x >> sep1 >> p.y >> sep2 >> p.z;
+
+	if (!in || sep1 != ',' || sep2 != ',')
+		BOOST_THROW_EXCEPTION(
+				UsageError()
+						<< error_message(std::string("can not parse '") + s + "', expected 'x,y,z'")
+						<< STACK_TRACE);
+
+	return p;
+}
+
+std::string sectionFilename(const boost::filesystem::path& directory, unsigned int section) {
+
+	std::ostringstream filename;
+	filename << "section_";
+	filename.width(5);
+	filename.fill('0');
+	filename << section << ".png";
+
+	return (directory/filename.str()).string();
+}
+
+/**
+ * Generate a synthetic volume: neurites are tubes with a random radius that
+ * drift randomly from section to section. The membrane images show the
+ * neurite interiors bright on dark membranes and background (as expected by
+ * the slice extraction), the raw images show dark membranes on a bright
+ * background. The ground-truth labels are stored as 16-bit images.
+ *
+ * @return The number of neurites.
+ */
+unsigned int createVolume(
+		const point3<unsigned int>& size,
+		const boost::filesystem::path& membranesDirectory,
+		const boost::filesystem::path& rawDirectory,
+		const boost::filesystem::path& labelsDirectory) {
+
+	boost::mt19937 rng(optionBenchSeed.as<unsigned int>());
+
+	const double minRadius = optionBenchMinRadius.as<double>();
+	const double maxRadius = std::max(minRadius, optionBenchMaxRadius.as<double>());
+	const double noise     = optionBenchNoise.as<double>();
+
+	unsigned int numNeurites = std::max(1u, (unsigned int)(
+			optionBenchNeuriteDensity.as<double>()*size.x*size.y/10000.0));
+
+	boost::random::uniform_real_distribution<double> uniformX(0, size.x);
+	boost::random::uniform_real_distribution<double> uniformY(0, size.y);
+	boost::random::uniform_real_distribution<double> uniformRadius(minRadius, maxRadius);
+	boost::random::normal_distribution<double>       drift(0, 0.25*minRadius);
+	boost::random::normal_distribution<double>       pixelNoise(0, noise);
+
+	std::vector<double> x(numNeurites), y(numNeurites), r(numNeurites);
+	for (unsigned int i = 0; i < numNeurites; i++) {
+
+		x[i] = uniformX(rng);
+		y[i] = uniformY(rng);
+		r[i] = uniformRadius(rng);
+	}
+
+	vigra::MultiArray<2, vigra::UInt16> labels(vigra::Shape2(size.x, size.y));
+	vigra::MultiArray<2, vigra::UInt8>  membrane(vigra::Shape2(size.x, size.y));
+	vigra::MultiArray<2, vigra::UInt8>  raw(vigra::Shape2(size.x, size.y));
+
+	for (unsigned int z = 0; z < size.z; z++) {
+
+		labels.init(0);
+
+		// later neurites occlude earlier ones
+		for (unsigned int i = 0; i < numNeurites; i++) {
+
+			int minX = std::max(0, (int)(x[i] - r[i]));
+			int maxX = std::min((int)size.x - 1, (int)(x[i] + r[i]));
+			int minY = std::max(0, (int)(y[i] - r[i]));
+			int maxY = std::min((int)size.y - 1, (int)(y[i] + r[i]));
+
+			for (int py = minY; py <= maxY; py++)
+				for (int px = minX; px <= maxX; px++)
+					if ((px - x[i])*(px - x[i]) + (py - y[i])*(py - y[i]) <= r[i]*r[i])
+						labels(px, py) = i + 1;
+		}
+
+		for (unsigned int py = 0; py < size.y; py++)
+			for (unsigned int px = 0; px < size.x; px++) {
+
+				vigra::UInt16 label = labels(px, py);
+
+				bool boundary =
+						label == 0 ||
+						(px > 0          && labels(px - 1, py) != label) ||
+						(px < size.x - 1 && labels(px + 1, py) != label) ||
+						(py > 0          && labels(px, py - 1) != label) ||
+						(py < size.y - 1 && labels(px, py + 1) != label);
+
+				double membraneValue = (boundary ? 20.0  : 230.0) + pixelNoise(rng);
+				double rawValue      = (boundary ? 60.0  : 190.0) + pixelNoise(rng);
+
+				membrane(px, py) = (vigra::UInt8)std::min(255.0, std::max(0.0, membraneValue));
+				raw(px, py)      = (vigra::UInt8)std::min(255.0, std::max(0.0, rawValue));
+			}
+
+		vigra::exportImage(srcImageRange(membrane), vigra::ImageExportInfo(sectionFilename(membranesDirectory, z).c_str()));
+		vigra::exportImage(srcImageRange(raw),      vigra::ImageExportInfo(sectionFilename(rawDirectory, z).c_str()));
+		vigra::exportImage(srcImageRange(labels),   vigra::ImageExportInfo(sectionFilename(labelsDirectory, z).c_str()));
+
+		// move the neurites to the next section
+		for (unsigned int i = 0; i < numNeurites; i++) {
+
+			x[i] = std::min((double)size.x - 1, std::max(0.0, x[i] + drift(rng)));
+			y[i] = std::min((double)size.y - 1, std::max(0.0, y[i] + drift(rng)));
+		}
+	}
+
+	return numNeurites;
+}
+
+void writeReport(
+		std::ostream& out,
+		const point3<unsigned int>& size,
+		unsigned int numNeurites,
+		const std::vector<StageResult>& results) {
+
+	out << "{" << std::endl;
+	out << "  \"volume\": { \"width\": " << size.x << ", \"height\": " << size.y
+	    << ", \"depth\": " << size.z << ", \"neurites\": " << numNeurites << " }," << std::endl;
+	out << "  \"stages\": [" << std::endl;
+
+	for (unsigned int i = 0; i < results.size(); i++) {
+
+		const StageResult& result = results[i];
+
+		out << "    { \"name\": \"" << result.name << "\"";
+
+		if (result.skipped) {
+
+			out << ", \"skipped\": true }";
+
+		} else {
+
+			double itemsPerSecond = (result.seconds > 0 ? result.items/result.seconds : 0);
+
+			out << ", \"seconds\": " << result.seconds
+			    << ", \"items\": " << result.items
+			    << ", \"itemsPerSecond\": " << itemsPerSecond
+			    << ", \"peakRssKb\": " << result.peakRss << " }";
+		}
+
+		out << (i + 1 < results.size() ? "," : "") << std::endl;
+	}
+
+	out << "  ]," << std::endl;
+	out << "  \"peakRssKb\": " << StageTimer::peakRss() << std::endl;
+	out << "}" << std::endl;
+}
+
+int main(int optionc, char** optionv) {
+
+	try {
+
+		util::ProgramOptions::init(optionc, optionv);
+		LogManager::init();
+		Tracer::configure();
+
+		point3<unsigned int> stackSize(
+				optionBenchWidth.as<unsigned int>(),
+				optionBenchHeight.as<unsigned int>(),
+				optionBenchDepth.as<unsigned int>());
+		point3<unsigned int> blockSize = parsePoint(optionBenchBlockSize.as<std::string>());
+		point3<unsigned int> coreSize  = parsePoint(optionBenchCoreSize.as<std::string>());
+
+		boost::filesystem::path workDirectory(optionBenchWorkDirectory.as<std::string>());
+		boost::filesystem::path membranesDirectory = workDirectory/"membranes";
+		boost::filesystem::path rawDirectory       = workDirectory/"raw";
+		boost::filesystem::path labelsDirectory    = workDirectory/"labels";
+
+		boost::filesystem::remove_all(workDirectory);
+		boost::filesystem::create_directories(membranesDirectory);
+		boost::filesystem::create_directories(rawDirectory);
+		boost::filesystem::create_directories(labelsDirectory);
+
+		std::vector<StageResult> results;
+
+		StageTimer volumeTimer("volume");
+		unsigned int numNeurites = createVolume(stackSize, membranesDirectory, rawDirectory, labelsDirectory);
+		results.push_back(volumeTimer.stop(stackSize.z));
+
+		boost::shared_ptr<BlockManager> blockManager =
+				boost::make_shared<LocalBlockManager>(stackSize, blockSize, coreSize);
+		boost::shared_ptr<StackStore>   membraneStackStore = boost::make_shared<LocalStackStore>(membranesDirectory.string());
+		boost::shared_ptr<StackStore>   rawStackStore      = boost::make_shared<LocalStackStore>(rawDirectory.string());
+		boost::shared_ptr<SliceStore>   sliceStore         = boost::make_shared<LocalSliceStore>();
+		boost::shared_ptr<SegmentStore> segmentStore       = boost::make_shared<LocalSegmentStore>();
+
+		boost::shared_ptr<Blocks> blocks = blockManager->blocksInBox(
+				boost::make_shared<Box<> >(point3<unsigned int>(0, 0, 0), stackSize));
+
+		/*
+		 * slices
+		 */
+
+		StageTimer slicesTimer("slices");
+
+		boost::shared_ptr<SliceGuarantor> sliceGuarantor = boost::make_shared<SliceGuarantor>();
+		sliceGuarantor->setInput("blocks", blocks);
+		sliceGuarantor->setInput("slice store", sliceStore);
+		sliceGuarantor->setInput("stack store", membraneStackStore);
+		sliceGuarantor->guaranteeSlices();
+
+		boost::shared_ptr<SliceReader> sliceReader = boost::make_shared<SliceReader>();
+		sliceReader->setInput("blocks", blocks);
+		sliceReader->setInput("store", sliceStore);
+		pipeline::Value<Slices>       slices       = sliceReader->getOutput("slices");
+		pipeline::Value<ConflictSets> conflictSets = sliceReader->getOutput("conflict sets");
+
+		results.push_back(slicesTimer.stop(slices->size()));
+
+		/*
+		 * segments
+		 */
+
+		StageTimer segmentsTimer("segments");
+
+		boost::shared_ptr<SegmentGuarantor> segmentGuarantor = boost::make_shared<SegmentGuarantor>();
+		segmentGuarantor->setInput("blocks", blocks);
+		segmentGuarantor->setInput("segment store", segmentStore);
+		segmentGuarantor->setInput("slice store", sliceStore);
+		segmentGuarantor->setInput("stack store", rawStackStore);
+		pipeline::Value<Blocks> needBlocks = segmentGuarantor->guaranteeSegments();
+
+		if (!needBlocks->empty())
+			BOOST_THROW_EXCEPTION(
+					UsageError()
+							<< error_message("segment extraction is missing slices for some blocks")
+							<< STACK_TRACE);
+
+		boost::shared_ptr<SegmentReader> segmentReader = boost::make_shared<SegmentReader>();
+		segmentReader->setInput("blocks", blocks);
+		segmentReader->setInput("store", segmentStore);
+		pipeline::Value<Segments> segments = segmentReader->getOutput("segments");
+
+		results.push_back(segmentsTimer.stop(segments->size()));
+
+		/*
+		 * features
+		 */
+
+		StageTimer featuresTimer("features");
+
+		boost::shared_ptr<ImageStackDirectoryReader> rawReader =
+				boost::make_shared<ImageStackDirectoryReader>(rawDirectory.string());
+		boost::shared_ptr<SegmentFeaturesExtractor> featuresExtractor =
+				boost::make_shared<SegmentFeaturesExtractor>();
+		featuresExtractor->setInput("segments", segments);
+		featuresExtractor->setInput("raw sections", rawReader->getOutput());
+		pipeline::Value<Features> features = featuresExtractor->getOutput("all features");
+
+		results.push_back(featuresTimer.stop(features->size()));
+
+		/*
+		 * costs
+		 */
+
+		StageTimer costsTimer("costs");
+
+		// the same weight for every feature, the actual values don't matter
+		// for the timing
+		pipeline::Value<LinearCostFunctionParameters> parameters;
+		parameters->setWeights(std::vector<double>(features->numFeatures(), 1.0));
+
+		boost::shared_ptr<LinearCostFunction> costFunction = boost::make_shared<LinearCostFunction>();
+		costFunction->setInput("features", features);
+		costFunction->setInput("parameters", parameters);
+
+		boost::shared_ptr<ObjectiveGenerator> objectiveGenerator = boost::make_shared<ObjectiveGenerator>();
+		objectiveGenerator->setInput("segments", segments);
+		objectiveGenerator->addInput("cost functions", costFunction->getOutput("cost function"));
+		pipeline::Value<LinearObjective> objective = objectiveGenerator->getOutput("objective");
+
+		results.push_back(costsTimer.stop(segments->size()));
+
+		/*
+		 * assembly
+		 */
+
+		StageTimer assemblyTimer("assembly");
+
+		boost::shared_ptr<SolutionGuarantor::ConstraintAssembler> constraintAssembler =
+				boost::make_shared<SolutionGuarantor::ConstraintAssembler>();
+		constraintAssembler->setInput("segments", segments);
+		constraintAssembler->setInput("conflict sets", conflictSets);
+		constraintAssembler->setInput("force explanation", pipeline::Value<bool>(false));
+
+		boost::shared_ptr<ProblemAssembler> problemAssembler = boost::make_shared<ProblemAssembler>();
+		problemAssembler->addInput("neuron segments", segments);
+		problemAssembler->addInput("neuron linear constraints", constraintAssembler->getOutput("linear constraints"));
+		pipeline::Value<LinearConstraints> constraints = problemAssembler->getOutput("linear constraints");
+
+		results.push_back(assemblyTimer.stop(constraints->size()));
+
+		/*
+		 * solve
+		 */
+
+#if defined(HAVE_GUROBI) || defined(HAVE_CPLEX)
+
+		StageTimer solveTimer("solve");
+
+		boost::shared_ptr<Cores> cores = blockManager->coresInBox(
+				boost::make_shared<Box<> >(point3<unsigned int>(0, 0, 0), stackSize));
+
+		boost::shared_ptr<SolutionGuarantor> solutionGuarantor = boost::make_shared<SolutionGuarantor>();
+		solutionGuarantor->setInput("cores", cores);
+		solutionGuarantor->setInput("slice store", sliceStore);
+		solutionGuarantor->setInput("segment store", segmentStore);
+		solutionGuarantor->setInput("raw stack store", rawStackStore);
+		solutionGuarantor->setInput("membrane stack store", membraneStackStore);
+		solutionGuarantor->setInput("buffer", pipeline::Value<unsigned int>(optionBenchBuffer.as<unsigned int>()));
+		solutionGuarantor->setInput("force explanation", pipeline::Value<bool>(false));
+		solutionGuarantor->setInput("prior cost parameters", pipeline::Value<PriorCostFunctionParameters>());
+		solutionGuarantor->guaranteeSolution();
+
+		results.push_back(solveTimer.stop(cores->length()));
+
+#else
+
+		LOG_USER(benchlog) << "no linear solver backend available, skipping stage solve" << std::endl;
+
+		StageResult solveResult;
+		solveResult.name    = "solve";
+		solveResult.skipped = true;
+		results.push_back(solveResult);
+
+#endif
+
+		std::string outputFile = optionBenchOutput.as<std::string>();
+
+		if (outputFile.empty()) {
+
+			writeReport(std::cout, stackSize, numNeurites, results);
+
+		} else {
+
+			std::ofstream out(outputFile.c_str());
+
+			if (!out)
+				BOOST_THROW_EXCEPTION(
+						IOError()
+								<< error_message(std::string("can not open ") + outputFile + " for writing")
+								<< STACK_TRACE);
+
+			writeReport(out, stackSize, numNeurites, results);
+		}
+
+	} catch (Exception& e) {
+
+		handleException(e, std::cerr);
+		return 1;
+	}
+
+	return 0;
+}
@@ -22,7 +22,6 @@
 #include <sopnet/evaluation/GroundTruthExtractor.h>
 #include <sopnet/gui/NeuronsStackView.h>
 #include <sopnet/gui/NeuronsView.h>
-#include <sopnet/io/IdMapCreator.h>
 #include <sopnet/io/NeuronsImageWriter.h>
 #include <sopnet/neurons/NeuronExtractor.h>
 #include <sopnet/segments/SplitMerge.h>
@@ -108,14 +107,10 @@ int main(int optionc, char** optionv) {
 		pipeline::Process<NeuronExtractor> neuronsExtractor;
 		neuronsExtractor->setInput(splitMerge->getOutput("segments"));
 
-		// create a neuron id creator
-		pipeline::Process<IdMapCreator> resultIdMapCreator;
-		resultIdMapCreator->setInput("neurons", neuronsExtractor->getOutput());
-		resultIdMapCreator->setInput("reference", rawReader->getOutput());
-
 		// create a neuron id writer
 		pipeline::Process<NeuronsImageWriter> resultWriter(optionSaveResultDirectory.as<std::string>(), optionSaveResultBasename.as<std::string>());
-		resultWriter->setInput(resultIdMapCreator->getOutput("id map"));
+		resultWriter->setInput("neurons", neuronsExtractor->getOutput());
+		resultWriter->setInput("reference", rawReader->getOutput());
 
 		// create basic views
 		pipeline::Process<NeuronsStackView>  groundTruthView;
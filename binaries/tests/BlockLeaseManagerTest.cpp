@@ -0,0 +1,135 @@
+#include "BlockLeaseManagerTest.h"
+#include <boost/thread.hpp>
+#include <util/Logger.h>
+#include <block/Core.h>
+#include <block/Cores.h>
+#include <block/Block.h>
+#include <block/Blocks.h>
+
+namespace catsoptest
+{
+
+logger::LogChannel blockleasemanagertestlog("blockleasemanagertestlog", "[BlockLeaseManagerTest] ");
+
+BlockLeaseManagerTest::BlockLeaseManagerTest(
+	const boost::shared_ptr<BlockManagerFactory> blockManagerFactory,
+	const boost::shared_ptr<BlockLeaseManagerFactory> leaseManagerFactory) :
+	_blockManagerFactory(blockManagerFactory),
+	_leaseManagerFactory(leaseManagerFactory)
+{
+
+}
+
+bool
+BlockLeaseManagerTest::expect(BlockLeaseManager::ClaimResult result,
+							  BlockLeaseManager::ClaimResult expected,
+							  const std::string& what)
+{
+	if (result != expected)
+	{
+		LOG_DEBUG(blockleasemanagertestlog) << what << ": got claim result " << result <<
+			", expected " << expected << std::endl;
+		_reason << what << ": got claim result " << result << ", expected " << expected <<
+			std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool
+BlockLeaseManagerTest::run(boost::shared_ptr<BlockManagerTestParam> arg)
+{
+	const unsigned int leaseDuration = 2;
+
+	_leaseManagerFactory->clear();
+
+	boost::shared_ptr<BlockManager> blockManager =
+		_blockManagerFactory->createBlockManager(arg->blockSize, arg->coreSizeInBlocks);
+	boost::shared_ptr<BlockLeaseManager> a =
+		_leaseManagerFactory->createBlockLeaseManager(blockManager, "a", leaseDuration);
+	boost::shared_ptr<BlockLeaseManager> b =
+		_leaseManagerFactory->createBlockLeaseManager(blockManager, "b", leaseDuration);
+
+	util::point3<unsigned int> stackSize = blockManager->stackSize();
+	boost::shared_ptr<Blocks> allBlocks = blockManager->blocksInBox(
+		boost::make_shared<Box<> >(util::point3<unsigned int>(0,0,0), stackSize));
+	boost::shared_ptr<Block> block0 =
+		blockManager->blockAtLocation(util::point3<unsigned int>(0,0,0));
+	boost::shared_ptr<Core> core0 =
+		blockManager->coreAtLocation(util::point3<unsigned int>(0,0,0));
+
+	bool ok = true;
+
+	// only one worker gets the lease
+	ok &= expect(a->claim(block0, BlockLeaseManager::SlicesTask), BlockLeaseManager::Claimed,
+				 "first claim of block 0");
+	ok &= expect(b->claim(block0, BlockLeaseManager::SlicesTask), BlockLeaseManager::InProgress,
+				 "claim of block 0 leased by another worker");
+	ok &= expect(a->claim(block0, BlockLeaseManager::SlicesTask), BlockLeaseManager::Claimed,
+				 "repeated claim of block 0 by the lease holder");
+
+	// a released lease can be claimed by another worker
+	a->release(block0, BlockLeaseManager::SlicesTask);
+	ok &= expect(b->claim(block0, BlockLeaseManager::SlicesTask), BlockLeaseManager::Claimed,
+				 "claim of released block 0");
+
+	// finished work is not claimed again
+	b->finish(block0, BlockLeaseManager::SlicesTask);
+	ok &= expect(a->claim(block0, BlockLeaseManager::SlicesTask), BlockLeaseManager::Done,
+				 "claim of finished block 0");
+
+	if (!block0->getSlicesFlag())
+	{
+		LOG_DEBUG(blockleasemanagertestlog) << "slices flag of finished block 0 is false" <<
+			std::endl;
+		_reason << "slices flag of finished block 0 is false" << std::endl;
+		ok = false;
+	}
+
+	// the queue hands out different blocks to different workers
+	boost::shared_ptr<Block> nextA = a->claimNext(allBlocks, BlockLeaseManager::SegmentsTask);
+	boost::shared_ptr<Block> nextB = b->claimNext(allBlocks, BlockLeaseManager::SegmentsTask);
+
+	if (!nextA || (allBlocks->length() > 1 && (!nextB || *nextA == *nextB)))
+	{
+		LOG_DEBUG(blockleasemanagertestlog) << "claimNext did not return two different blocks" <<
+			std::endl;
+		_reason << "claimNext did not return two different blocks" << std::endl;
+		ok = false;
+	}
+
+	// the heartbeat keeps held leases alive beyond their duration
+	if (nextA)
+	{
+		boost::this_thread::sleep(boost::posix_time::seconds(leaseDuration + 1));
+
+		ok &= expect(b->claim(nextA, BlockLeaseManager::SegmentsTask),
+					 BlockLeaseManager::InProgress, "claim of block renewed by the heartbeat");
+	}
+
+	// cores are leased for solving
+	ok &= expect(a->claim(core0), BlockLeaseManager::Claimed, "first claim of core 0");
+	ok &= expect(b->claim(core0), BlockLeaseManager::InProgress,
+				 "claim of core 0 leased by another worker");
+	a->finish(core0);
+	ok &= expect(b->claim(core0), BlockLeaseManager::Done, "claim of finished core 0");
+
+	return ok;
+}
+
+std::string
+BlockLeaseManagerTest::name()
+{
+	return "BlockLeaseManager test";
+}
+
+std::string
+BlockLeaseManagerTest::reason()
+{
+	std::string reason = _reason.str();
+	_reason.clear();
+	return reason;
+}
+
+};
@@ -0,0 +1,59 @@
+#ifndef TEST_BLOCK_LEASE_MANAGER_H__
+#define TEST_BLOCK_LEASE_MANAGER_H__
+#include "CatsopTest.h"
+#include "BlockManagerTest.h"
+#include <sopnet/block/BlockLeaseManager.h>
+#include <sopnet/block/BlockManager.h>
+#include <boost/shared_ptr.hpp>
+#include <iostream>
+
+namespace catsoptest
+{
+
+class BlockLeaseManagerFactory
+{
+public:
+	/**
+	 * Remove all leases from the lease storage.
+	 */
+	virtual void clear() = 0;
+
+	/**
+	 * Create a lease manager for the given worker. All lease managers created by this
+	 * factory share the same lease storage.
+	 */
+	virtual boost::shared_ptr<BlockLeaseManager> createBlockLeaseManager(
+		const boost::shared_ptr<BlockManager> blockManager,
+		const std::string& worker,
+		unsigned int leaseDuration) = 0;
+};
+
+/**
+ * Tests claiming, releasing, finishing and renewing leases with two workers.
+ */
+class BlockLeaseManagerTest : public catsoptest::Test<BlockManagerTestParam>
+{
+public:
+
+	BlockLeaseManagerTest(const boost::shared_ptr<BlockManagerFactory> blockManagerFactory,
+						  const boost::shared_ptr<BlockLeaseManagerFactory> leaseManagerFactory);
+
+	bool run(boost::shared_ptr<BlockManagerTestParam> arg);
+
+	std::string name();
+
+	std::string reason();
+
+private:
+	bool expect(BlockLeaseManager::ClaimResult result,
+				BlockLeaseManager::ClaimResult expected,
+				const std::string& what);
+
+	const boost::shared_ptr<BlockManagerFactory> _blockManagerFactory;
+	const boost::shared_ptr<BlockLeaseManagerFactory> _leaseManagerFactory;
+	std::ostringstream _reason;
+};
+
+};
+
+#endif //TEST_BLOCK_LEASE_MANAGER_H__
@@ -0,0 +1,135 @@
+#include "BoundaryLengthTest.h"
+
+#include <cstdlib>
+
+#include <boost/make_shared.hpp>
+
+#include <imageprocessing/ConnectedComponent.h>
+#include <sopnet/features/BoundaryLength.h>
+#include <util/Logger.h>
+
+namespace catsoptest
+{
+
+logger::LogChannel boundarylengthtestlog("boundarylengthtestlog", "[BoundaryLengthTest] ");
+
+namespace
+{
+
+// the number of 4-neighbors of each pixel that are not part of the shape
+unsigned int
+bruteForceBoundaryLength(const std::vector<bool>& pixels, unsigned int width, unsigned int height)
+{
+	unsigned int boundaryLength = 0;
+
+	for (unsigned int y = 0; y < height; y++)
+		for (unsigned int x = 0; x < width; x++)
+		{
+			if (!pixels[x + y*width])
+				continue;
+
+			if (x == 0 || !pixels[(x - 1) + y*width])
+				boundaryLength++;
+			if (x == width - 1 || !pixels[(x + 1) + y*width])
+				boundaryLength++;
+			if (y == 0 || !pixels[x + (y - 1)*width])
+				boundaryLength++;
+			if (y == height - 1 || !pixels[x + (y + 1)*width])
+				boundaryLength++;
+		}
+
+	return boundaryLength;
+}
+
+}
+
+bool
+BoundaryLengthTest::run(boost::shared_ptr<BoundaryLengthTestParam> arg)
+{
+	// not at the origin, to test the offset of the bounding box
+	const unsigned int offsetX = 13;
+	const unsigned int offsetY = 7;
+
+	std::vector<bool> pixels(arg->width*arg->height, false);
+
+	boost::shared_ptr<ConnectedComponent::pixel_list_type> pixelList =
+		boost::make_shared<ConnectedComponent::pixel_list_type>();
+
+	std::srand(arg->seed);
+
+	for (unsigned int y = 0; y < arg->height; y++)
+		for (unsigned int x = 0; x < arg->width; x++)
+		{
+			// the corners are always set, such that the bounding box has the
+			// requested size
+			bool corner = (x == 0 && y == 0) || (x == arg->width - 1 && y == arg->height - 1);
+
+			if (corner || std::rand() < arg->density*RAND_MAX)
+			{
+				pixels[x + y*arg->width] = true;
+				pixelList->push_back(util::point<unsigned int>(offsetX + x, offsetY + y));
+			}
+		}
+
+	ConnectedComponent component(boost::shared_ptr<Image>(), 1.0, pixelList, 0, pixelList->size());
+
+	unsigned int expected = bruteForceBoundaryLength(pixels, arg->width, arg->height);
+	unsigned int boundaryLength = BoundaryLength()(component);
+
+	// a second call reuses the bitmap of the first
+	unsigned int second = BoundaryLength()(component);
+
+	if (boundaryLength != expected || second != expected)
+	{
+		LOG_DEBUG(boundarylengthtestlog) << "got " << boundaryLength << " and " << second <<
+			", expected " << expected << std::endl;
+		_reason << "boundary length of " << pixelList->size() << " pixels: got " <<
+			boundaryLength << " and " << second << ", expected " << expected << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+std::string
+BoundaryLengthTest::name()
+{
+	return "BoundaryLength test";
+}
+
+std::string
+BoundaryLengthTest::reason()
+{
+	std::string reason = _reason.str();
+	_reason.clear();
+	return reason;
+}
+
+std::vector<boost::shared_ptr<BoundaryLengthTestParam> >
+BoundaryLengthTest::generateTestParameters()
+{
+	std::vector<boost::shared_ptr<BoundaryLengthTestParam> > params;
+
+	// single pixel and full rectangles
+	params.push_back(boost::make_shared<BoundaryLengthTestParam>(1, 1, 1.0, 1));
+	params.push_back(boost::make_shared<BoundaryLengthTestParam>(64, 3, 1.0, 2));
+	params.push_back(boost::make_shared<BoundaryLengthTestParam>(65, 10, 1.0, 3));
+
+	// random shapes within one word and across word borders
+	params.push_back(boost::make_shared<BoundaryLengthTestParam>(20, 20, 0.5, 4));
+	params.push_back(boost::make_shared<BoundaryLengthTestParam>(63, 17, 0.3, 5));
+	params.push_back(boost::make_shared<BoundaryLengthTestParam>(128, 40, 0.7, 6));
+	params.push_back(boost::make_shared<BoundaryLengthTestParam>(200, 50, 0.1, 7));
+	params.push_back(boost::make_shared<BoundaryLengthTestParam>(1000, 5, 0.9, 8));
+
+	return params;
+}
+
+};
+
+std::ostream& operator<<(std::ostream& os, const catsoptest::BoundaryLengthTestParam& param)
+{
+	os << "size: " << param.width << "x" << param.height << ", density: " << param.density <<
+		", seed: " << param.seed;
+	return os;
+}
@@ -0,0 +1,48 @@
+#ifndef TEST_BOUNDARY_LENGTH_H__
+#define TEST_BOUNDARY_LENGTH_H__
+#include "CatsopTest.h"
+#include <boost/shared_ptr.hpp>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace catsoptest
+{
+
+class BoundaryLengthTestParam
+{
+public:
+	BoundaryLengthTestParam(unsigned int w, unsigned int h, double d, unsigned int s) :
+		width(w), height(h), density(d), seed(s) {}
+
+	unsigned int width;
+	unsigned int height;
+	double density;
+	unsigned int seed;
+};
+
+/**
+ * Compares the word-level BoundaryLength to a per-pixel test of the four
+ * neighbors, on random shapes.
+ */
+class BoundaryLengthTest : public catsoptest::Test<BoundaryLengthTestParam>
+{
+public:
+
+	bool run(boost::shared_ptr<BoundaryLengthTestParam> arg);
+
+	std::string name();
+
+	std::string reason();
+
+	static std::vector<boost::shared_ptr<BoundaryLengthTestParam> > generateTestParameters();
+
+private:
+	std::ostringstream _reason;
+};
+
+};
+
+std::ostream& operator<<(std::ostream& os, const catsoptest::BoundaryLengthTestParam& param);
+
+#endif //TEST_BOUNDARY_LENGTH_H__
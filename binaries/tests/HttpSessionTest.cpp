@@ -0,0 +1,406 @@
+#include "HttpSessionTest.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+#include <curl/curl.h>
+
+#include <catmaid/django/HttpSession.h>
+#include <util/exceptions.h>
+#include <util/Logger.h>
+
+namespace catsoptest
+{
+
+logger::LogChannel httpsessiontestlog("httpsessiontestlog", "[HttpSessionTest] ");
+
+/**
+ * A stand-in for the Django server on an ephemeral localhost port. It answers
+ *
+ *   GET  /ok/<n>    with {"n": "<n>"}
+ *   GET  /slow/<n>  with {"n": "<n>"}, after 100ms
+ *   POST /echo      with the request body
+ *   anything else   with status 404
+ *
+ * and keeps connections open between requests. It counts the accepted connections
+ * and the maximal number of connections open at the same time.
+ */
+class StandInServer
+{
+public:
+
+	StandInServer() :
+		_socket(-1),
+		_port(0),
+		_stopped(false),
+		_numConnections(0),
+		_numOpen(0),
+		_maxOpen(0)
+	{
+		_socket = socket(AF_INET, SOCK_STREAM, 0);
+
+		sockaddr_in address;
+		std::memset(&address, 0, sizeof(address));
+		address.sin_family      = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port        = 0;
+
+		socklen_t length = sizeof(address);
+
+		if (_socket < 0 ||
+			bind(_socket, (sockaddr*)&address, sizeof(address)) != 0 ||
+			listen(_socket, 64) != 0 ||
+			getsockname(_socket, (sockaddr*)&address, &length) != 0)
+		{
+			BOOST_THROW_EXCEPTION(IOError() << error_message("can not start the stand-in server"));
+		}
+
+		_port = ntohs(address.sin_port);
+
+		_acceptThread = boost::thread(boost::bind(&StandInServer::acceptLoop, this));
+	}
+
+	~StandInServer()
+	{
+		_stopped = true;
+		_acceptThread.join();
+		_connectionThreads.join_all();
+		close(_socket);
+	}
+
+	std::string url() const
+	{
+		return "http://127.0.0.1:" + boost::lexical_cast<std::string>(_port);
+	}
+
+	unsigned int numConnections()
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		return _numConnections;
+	}
+
+	unsigned int maxOpenConnections()
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		return _maxOpen;
+	}
+
+	void resetMaxOpenConnections()
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_maxOpen = _numOpen;
+	}
+
+private:
+
+	void acceptLoop()
+	{
+		while (!_stopped)
+		{
+			pollfd request;
+			request.fd     = _socket;
+			request.events = POLLIN;
+
+			if (poll(&request, 1, 100) <= 0)
+				continue;
+
+			int connection = accept(_socket, 0, 0);
+
+			if (connection < 0)
+				continue;
+
+			{
+				boost::mutex::scoped_lock lock(_mutex);
+				_numConnections++;
+				_numOpen++;
+				_maxOpen = std::max(_maxOpen, _numOpen);
+			}
+
+			_connectionThreads.create_thread(boost::bind(&StandInServer::serve, this, connection));
+		}
+	}
+
+	void serve(int connection)
+	{
+		std::string buffer;
+		std::string method, path, body;
+
+		while (readRequest(connection, buffer, method, path, body))
+		{
+			std::string status = "200 OK";
+			std::string response;
+
+			if (method == "GET" && path.compare(0, 4, "/ok/") == 0)
+			{
+				response = "{\"n\": \"" + path.substr(4) + "\"}";
+			}
+			else if (method == "GET" && path.compare(0, 6, "/slow/") == 0)
+			{
+				boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+				response = "{\"n\": \"" + path.substr(6) + "\"}";
+			}
+			else if (method == "POST" && path == "/echo")
+			{
+				response = body;
+			}
+			else
+			{
+				status   = "404 Not Found";
+				response = "{\"error\": \"not found\"}";
+			}
+
+			std::ostringstream os;
+			os << "HTTP/1.1 " << status << "\r\n"
+				<< "Content-Type: application/json\r\n"
+				<< "Content-Length: " << response.size() << "\r\n"
+				<< "\r\n"
+				<< response;
+
+			std::string message = os.str();
+
+			if (send(connection, message.data(), message.size(), MSG_NOSIGNAL) != (ssize_t)message.size())
+				break;
+		}
+
+		close(connection);
+
+		boost::mutex::scoped_lock lock(_mutex);
+		_numOpen--;
+	}
+
+	// read the next request from the connection, false if the connection was closed
+	bool readRequest(int connection, std::string& buffer, std::string& method, std::string& path,
+					 std::string& body)
+	{
+		size_t headerEnd;
+
+		while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos)
+			if (!receive(connection, buffer))
+				return false;
+
+		std::istringstream header(buffer.substr(0, headerEnd));
+		header >> method >> path;
+
+		size_t contentLength = 0;
+		std::string line;
+		while (std::getline(header, line))
+		{
+			std::string lower = line;
+			std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+			if (lower.compare(0, 15, "content-length:") == 0)
+				std::istringstream(line.substr(15)) >> contentLength;
+		}
+
+		while (buffer.size() < headerEnd + 4 + contentLength)
+			if (!receive(connection, buffer))
+				return false;
+
+		body = buffer.substr(headerEnd + 4, contentLength);
+		buffer.erase(0, headerEnd + 4 + contentLength);
+
+		return true;
+	}
+
+	bool receive(int connection, std::string& buffer)
+	{
+		while (!_stopped)
+		{
+			pollfd request;
+			request.fd     = connection;
+			request.events = POLLIN;
+
+			if (poll(&request, 1, 100) <= 0)
+				continue;
+
+			char data[4096];
+			ssize_t received = recv(connection, data, sizeof(data), 0);
+
+			if (received <= 0)
+				return false;
+
+			buffer.append(data, received);
+			return true;
+		}
+
+		return false;
+	}
+
+	int _socket;
+	unsigned short _port;
+	volatile bool _stopped;
+
+	boost::thread _acceptThread;
+	boost::thread_group _connectionThreads;
+
+	boost::mutex _mutex;
+	unsigned int _numConnections;
+	unsigned int _numOpen;
+	unsigned int _maxOpen;
+};
+
+namespace
+{
+
+std::string
+expectedBody(unsigned int n)
+{
+	return "{\"n\": \"" + boost::lexical_cast<std::string>(n) + "\"}";
+}
+
+void
+performSlowRequests(HttpSession& session, const std::string& url, unsigned int numRequests,
+					std::vector<std::string>& responses, bool& failed)
+{
+	std::vector<HttpSession::Request> requests;
+	for (unsigned int i = 0; i < numRequests; ++i)
+		requests.push_back(HttpSession::Request(url + "/slow/" + boost::lexical_cast<std::string>(i)));
+
+	try
+	{
+		responses = session.performAll(requests);
+	}
+	catch (boost::exception& e)
+	{
+		failed = true;
+	}
+}
+
+bool
+expectBodies(const std::vector<std::string>& responses, unsigned int numRequests)
+{
+	if (responses.size() != numRequests)
+		return false;
+
+	for (unsigned int i = 0; i < numRequests; ++i)
+		if (responses[i] != expectedBody(i))
+			return false;
+
+	return true;
+}
+
+}
+
+bool
+HttpSessionTest::expect(bool condition, const std::string& what)
+{
+	if (!condition)
+	{
+		LOG_DEBUG(httpsessiontestlog) << what << " failed" << std::endl;
+		_reason << what << " failed" << std::endl;
+	}
+
+	return condition;
+}
+
+bool
+HttpSessionTest::run(boost::shared_ptr<HttpSessionTestParam> arg)
+{
+	bool ok = true;
+
+	curl_global_init(CURL_GLOBAL_ALL);
+
+	{
+		StandInServer server;
+		HttpSession session(arg->maxConnections);
+
+		// sequential requests reuse one keep-alive connection
+		bool sequentialOk = true;
+		for (unsigned int i = 0; i < arg->numRequests; ++i)
+			sequentialOk &= (session.get(server.url() + "/ok/" + boost::lexical_cast<std::string>(i)) ==
+							 expectedBody(i));
+
+		ok &= expect(sequentialOk, "sequential GET responses");
+		ok &= expect(server.numConnections() == 1, "reuse of a keep-alive connection");
+
+		// POST bodies arrive unchanged
+		ok &= expect(session.post(server.url() + "/echo", "a=1&b=2") == "a=1&b=2", "POST form data");
+		ok &= expect(session.post(server.url() + "/echo", "{}", "application/json") == "{}",
+					 "POST with content type");
+
+		// error status codes are not returned as data
+		bool thrown = false;
+		try
+		{
+			session.get(server.url() + "/missing");
+		}
+		catch (IOError& e)
+		{
+			thrown = true;
+		}
+		ok &= expect(thrown, "IOError for status 404");
+
+		// concurrent requests stay within the connection limit
+		server.resetMaxOpenConnections();
+
+		std::vector<std::string> responses;
+		bool failed = false;
+		performSlowRequests(session, server.url(), arg->numRequests, responses, failed);
+
+		ok &= expect(!failed && expectBodies(responses, arg->numRequests), "performAll responses");
+		ok &= expect(server.maxOpenConnections() <= arg->maxConnections, "connection limit");
+
+		// concurrent callers get their own connections
+		std::vector<std::string> responsesA, responsesB;
+		bool failedA = false, failedB = false;
+
+		boost::thread threadA(boost::bind(&performSlowRequests, boost::ref(session), server.url(),
+										  arg->numRequests, boost::ref(responsesA), boost::ref(failedA)));
+		boost::thread threadB(boost::bind(&performSlowRequests, boost::ref(session), server.url(),
+										  arg->numRequests, boost::ref(responsesB), boost::ref(failedB)));
+		threadA.join();
+		threadB.join();
+
+		ok &= expect(!failedA && expectBodies(responsesA, arg->numRequests) &&
+					 !failedB && expectBodies(responsesB, arg->numRequests),
+					 "concurrent performAll responses");
+	}
+
+	curl_global_cleanup();
+
+	return ok;
+}
+
+std::string
+HttpSessionTest::name()
+{
+	return "HttpSession test";
+}
+
+std::string
+HttpSessionTest::reason()
+{
+	std::string reason = _reason.str();
+	_reason.clear();
+	return reason;
+}
+
+std::vector<boost::shared_ptr<HttpSessionTestParam> >
+HttpSessionTest::generateTestParameters()
+{
+	std::vector<boost::shared_ptr<HttpSessionTestParam> > params;
+
+	params.push_back(boost::make_shared<HttpSessionTestParam>(1, 4));
+	params.push_back(boost::make_shared<HttpSessionTestParam>(2, 8));
+	params.push_back(boost::make_shared<HttpSessionTestParam>(4, 16));
+
+	return params;
+}
+
+};
+
+std::ostream& operator<<(std::ostream& os, const catsoptest::HttpSessionTestParam& param)
+{
+	os << "max connections: " << param.maxConnections << ", requests: " << param.numRequests;
+	return os;
+}
@@ -0,0 +1,49 @@
+#ifndef TEST_HTTP_SESSION_H__
+#define TEST_HTTP_SESSION_H__
+#include "CatsopTest.h"
+#include <boost/shared_ptr.hpp>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace catsoptest
+{
+
+class HttpSessionTestParam
+{
+public:
+	HttpSessionTestParam(unsigned int mc, unsigned int nr) :
+		maxConnections(mc), numRequests(nr) {}
+
+	unsigned int maxConnections;
+	unsigned int numRequests;
+};
+
+/**
+ * Tests the HttpSession against a minimal HTTP/1.1 server on localhost: keep-alive
+ * reuse, POST bodies, error status codes, the connection limit of performAll(), and
+ * concurrent callers.
+ */
+class HttpSessionTest : public catsoptest::Test<HttpSessionTestParam>
+{
+public:
+
+	bool run(boost::shared_ptr<HttpSessionTestParam> arg);
+
+	std::string name();
+
+	std::string reason();
+
+	static std::vector<boost::shared_ptr<HttpSessionTestParam> > generateTestParameters();
+
+private:
+	bool expect(bool condition, const std::string& what);
+
+	std::ostringstream _reason;
+};
+
+};
+
+std::ostream& operator<<(std::ostream& os, const catsoptest::HttpSessionTestParam& param);
+
+#endif //TEST_HTTP_SESSION_H__
@@ -1,4 +1,6 @@
 #include "LocalTestSuite.h"
+#include <boost/filesystem.hpp>
+#include <sopnet/block/LocalBlockLeaseManager.h>
 #include <sopnet/block/LocalBlockManager.h>
 #include <catmaid/persistence/LocalSliceStore.h>
 #include <catmaid/persistence/LocalSegmentStore.h>
@@ -22,6 +24,12 @@ util::ProgramOption optionLocalTestRawImagesPath(
 	util::_description_text = 	"Path to raw image stack",
 	util::_default_value =		"./raw");
 
+util::ProgramOption optionLocalTestLeasesPath(
+	util::_module = 			"core",
+	util::_long_name = 			"localTestLeases",
+	util::_description_text = 	"Path to a directory for block leases, will be cleared by the tests",
+	util::_default_value =		"./test_leases");
+
 LocalBlockManagerFactory::LocalBlockManagerFactory(const util::point3<unsigned int> stackSize) :
 	_stackSize(stackSize)
 {
@@ -36,14 +44,41 @@ LocalBlockManagerFactory::createBlockManager(const util::point3<unsigned int> bl
 	return manager;
 }
 
+LocalBlockLeaseManagerFactory::LocalBlockLeaseManagerFactory(const std::string& directory) :
+	_directory(directory)
+{
+}
+
+void
+LocalBlockLeaseManagerFactory::clear()
+{
+	boost::filesystem::remove_all(_directory);
+}
+
+boost::shared_ptr<BlockLeaseManager>
+LocalBlockLeaseManagerFactory::createBlockLeaseManager(
+	const boost::shared_ptr<BlockManager> /*blockManager*/,
+	const std::string& worker,
+	unsigned int leaseDuration)
+{
+	boost::shared_ptr<BlockLeaseManager> manager =
+		boost::make_shared<LocalBlockLeaseManager>(_directory, worker, leaseDuration);
+	return manager;
+}
+
 boost::shared_ptr<TestSuite>
 LocalTestSuite::localTestSuite(const util::point3<unsigned int> stackSize)
 {
 	boost::shared_ptr<TestSuite> suite = boost::make_shared<TestSuite>("Local");
 	
 	addBlockManagerTest(suite, stackSize);
+	addBlockLeaseManagerTest(suite, stackSize);
 	addSliceStoreTest(suite, stackSize);
 	addSegmentStoreTest(suite, stackSize);
+	addHttpSessionTest(suite);
+	addMedianFilterTest(suite);
+	addBoundaryLengthTest(suite);
+	addSliceIndexTest(suite);
 
 	return suite;
 }
@@ -67,6 +102,45 @@ void LocalTestSuite::addBlockManagerTest(const boost::shared_ptr<TestSuite> suit
 		BlockManagerTest::generateTestParameters(stackSize));
 }
 
+void LocalTestSuite::addBlockLeaseManagerTest(const boost::shared_ptr<TestSuite> suite,
+	const util::point3<unsigned int>& stackSize)
+{
+	boost::shared_ptr<BlockManagerFactory> blockManagerFactory =
+		boost::make_shared<LocalBlockManagerFactory>(stackSize);
+	boost::shared_ptr<BlockLeaseManagerFactory> leaseManagerFactory =
+		boost::make_shared<LocalBlockLeaseManagerFactory>(
+			optionLocalTestLeasesPath.as<std::string>());
+	
+	boost::shared_ptr<Test<BlockManagerTestParam> > test =
+		boost::make_shared<BlockLeaseManagerTest>(blockManagerFactory, leaseManagerFactory);
+	suite->addTest<BlockManagerTestParam>(test,
+		BlockManagerTest::generateTestParameters(stackSize));
+}
+
+void LocalTestSuite::addHttpSessionTest(const boost::shared_ptr<TestSuite> suite)
+{
+	boost::shared_ptr<Test<HttpSessionTestParam> > test = boost::make_shared<HttpSessionTest>();
+	suite->addTest<HttpSessionTestParam>(test, HttpSessionTest::generateTestParameters());
+}
+
+void LocalTestSuite::addMedianFilterTest(const boost::shared_ptr<TestSuite> suite)
+{
+	boost::shared_ptr<Test<MedianFilterTestParam> > test = boost::make_shared<MedianFilterTest>();
+	suite->addTest<MedianFilterTestParam>(test, MedianFilterTest::generateTestParameters());
+}
+
+void LocalTestSuite::addBoundaryLengthTest(const boost::shared_ptr<TestSuite> suite)
+{
+	boost::shared_ptr<Test<BoundaryLengthTestParam> > test = boost::make_shared<BoundaryLengthTest>();
+	suite->addTest<BoundaryLengthTestParam>(test, BoundaryLengthTest::generateTestParameters());
+}
+
+void LocalTestSuite::addSliceIndexTest(const boost::shared_ptr<TestSuite> suite)
+{
+	boost::shared_ptr<Test<SliceIndexTestParam> > test = boost::make_shared<SliceIndexTest>();
+	suite->addTest<SliceIndexTestParam>(test, SliceIndexTest::generateTestParameters());
+}
+
 void LocalTestSuite::addSegmentStoreTest(const boost::shared_ptr<TestSuite> suite,
 										 const util::point3<unsigned int>& stackSize)
 {
@@ -1,6 +1,11 @@
 #ifndef TEST_LOCAL_SUITE_H__
 #define TEST_LOCAL_SUITE_H__
+#include "BlockLeaseManagerTest.h"
 #include "BlockManagerTest.h"
+#include "BoundaryLengthTest.h"
+#include "HttpSessionTest.h"
+#include "MedianFilterTest.h"
+#include "SliceIndexTest.h"
 #include "SliceStoreTest.h"
 #include "SegmentStoreTest.h"
 #include <sopnet/block/BlockManager.h>
@@ -36,6 +41,22 @@ private:
 	const util::point3<unsigned int> _stackSize;
 };
 	
+class LocalBlockLeaseManagerFactory : public BlockLeaseManagerFactory
+{
+public:
+	LocalBlockLeaseManagerFactory(const std::string& directory);
+
+	void clear();
+
+	boost::shared_ptr<BlockLeaseManager> createBlockLeaseManager(
+		const boost::shared_ptr<BlockManager> blockManager,
+		const std::string& worker,
+		unsigned int leaseDuration);
+
+private:
+	const std::string _directory;
+};
+	
 class LocalTestSuite
 {
 public:
@@ -43,10 +64,16 @@ public:
 private:
 	static void addBlockManagerTest(const boost::shared_ptr<TestSuite> suite,
 		const util::point3<unsigned int>& stackSize);
+	static void addBlockLeaseManagerTest(const boost::shared_ptr<TestSuite> suite,
+		const util::point3<unsigned int>& stackSize);
 	static void addSliceStoreTest(const boost::shared_ptr<TestSuite> suite,
 		const util::point3<unsigned int>& stackSize);
 	static void addSegmentStoreTest(const boost::shared_ptr<TestSuite> suite,
 		const util::point3<unsigned int>& stackSize);
+	static void addHttpSessionTest(const boost::shared_ptr<TestSuite> suite);
+	static void addMedianFilterTest(const boost::shared_ptr<TestSuite> suite);
+	static void addBoundaryLengthTest(const boost::shared_ptr<TestSuite> suite);
+	static void addSliceIndexTest(const boost::shared_ptr<TestSuite> suite);
 };
 
 };
@@ -0,0 +1,128 @@
+#include "MedianFilterTest.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <boost/make_shared.hpp>
+
+#include <sopnet/filters/ConstantTimeMedianFilter.h>
+#include <util/Logger.h>
+
+namespace catsoptest
+{
+
+logger::LogChannel medianfiltertestlog("medianfiltertestlog", "[MedianFilterTest] ");
+
+namespace
+{
+
+// the median of the window around (x, y), with pixels outside the image
+// replaced by the closest pixel inside
+vigra::UInt8
+bruteForceMedian(const vigra::MultiArray<2, vigra::UInt8>& image, int x, int y, int radius)
+{
+	const int width  = image.shape(0);
+	const int height = image.shape(1);
+
+	std::vector<vigra::UInt8> window;
+
+	for (int dy = -radius; dy <= radius; dy++)
+		for (int dx = -radius; dx <= radius; dx++)
+			window.push_back(image(
+					std::min(std::max(x + dx, 0), width - 1),
+					std::min(std::max(y + dy, 0), height - 1)));
+
+	std::nth_element(window.begin(), window.begin() + window.size()/2, window.end());
+
+	return window[window.size()/2];
+}
+
+}
+
+bool
+MedianFilterTest::run(boost::shared_ptr<MedianFilterTestParam> arg)
+{
+	vigra::MultiArray<2, vigra::UInt8> in(vigra::Shape2(arg->width, arg->height));
+	vigra::MultiArray<2, vigra::UInt8> out(vigra::Shape2(arg->width, arg->height));
+
+	std::srand(arg->seed);
+
+	// few distinct values, such that ties are frequent
+	for (unsigned int y = 0; y < arg->height; y++)
+		for (unsigned int x = 0; x < arg->width; x++)
+			in(x, y) = (std::rand()%2 ? std::rand()%256 : 16*(std::rand()%4));
+
+	ConstantTimeMedianFilter::filter(in, out, arg->radius, arg->numThreads);
+
+	unsigned int numWrong = 0;
+
+	for (unsigned int y = 0; y < arg->height; y++)
+		for (unsigned int x = 0; x < arg->width; x++)
+		{
+			vigra::UInt8 expected = bruteForceMedian(in, x, y, arg->radius);
+
+			if (out(x, y) != expected)
+			{
+				if (numWrong == 0)
+				{
+					_reason << "first wrong median at (" << x << ", " << y << "): got " <<
+						(int)out(x, y) << ", expected " << (int)expected << std::endl;
+				}
+
+				numWrong++;
+			}
+		}
+
+	if (numWrong > 0)
+	{
+		LOG_DEBUG(medianfiltertestlog) << numWrong << " wrong medians" << std::endl;
+		_reason << numWrong << " of " << arg->width*arg->height << " medians are wrong" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+std::string
+MedianFilterTest::name()
+{
+	return "ConstantTimeMedianFilter test";
+}
+
+std::string
+MedianFilterTest::reason()
+{
+	std::string reason = _reason.str();
+	_reason.clear();
+	return reason;
+}
+
+std::vector<boost::shared_ptr<MedianFilterTestParam> >
+MedianFilterTest::generateTestParameters()
+{
+	std::vector<boost::shared_ptr<MedianFilterTestParam> > params;
+
+	// single pixel, and radius larger than the image
+	params.push_back(boost::make_shared<MedianFilterTestParam>(1, 1, 0, 1, 1));
+	params.push_back(boost::make_shared<MedianFilterTestParam>(5, 4, 7, 2, 2));
+
+	// one tile
+	params.push_back(boost::make_shared<MedianFilterTestParam>(17, 9, 1, 1, 3));
+	params.push_back(boost::make_shared<MedianFilterTestParam>(64, 48, 3, 1, 4));
+
+	// several tiles, with tile borders inside the window
+	params.push_back(boost::make_shared<MedianFilterTestParam>(200, 31, 5, 4, 5));
+	params.push_back(boost::make_shared<MedianFilterTestParam>(120, 37, 8, 3, 6));
+	params.push_back(boost::make_shared<MedianFilterTestParam>(300, 20, 2, 0, 7));
+
+	return params;
+}
+
+};
+
+std::ostream& operator<<(std::ostream& os, const catsoptest::MedianFilterTestParam& param)
+{
+	os << "size: " << param.width << "x" << param.height << ", radius: " << param.radius <<
+		", threads: " << param.numThreads << ", seed: " << param.seed;
+	return os;
+}
@@ -0,0 +1,49 @@
+#ifndef TEST_MEDIAN_FILTER_H__
+#define TEST_MEDIAN_FILTER_H__
+#include "CatsopTest.h"
+#include <boost/shared_ptr.hpp>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace catsoptest
+{
+
+class MedianFilterTestParam
+{
+public:
+	MedianFilterTestParam(unsigned int w, unsigned int h, int r, unsigned int nt, unsigned int s) :
+		width(w), height(h), radius(r), numThreads(nt), seed(s) {}
+
+	unsigned int width;
+	unsigned int height;
+	int radius;
+	unsigned int numThreads;
+	unsigned int seed;
+};
+
+/**
+ * Compares the ConstantTimeMedianFilter to a brute-force median over the
+ * window of each pixel, on random images.
+ */
+class MedianFilterTest : public catsoptest::Test<MedianFilterTestParam>
+{
+public:
+
+	bool run(boost::shared_ptr<MedianFilterTestParam> arg);
+
+	std::string name();
+
+	std::string reason();
+
+	static std::vector<boost::shared_ptr<MedianFilterTestParam> > generateTestParameters();
+
+private:
+	std::ostringstream _reason;
+};
+
+};
+
+std::ostream& operator<<(std::ostream& os, const catsoptest::MedianFilterTestParam& param);
+
+#endif //TEST_MEDIAN_FILTER_H__
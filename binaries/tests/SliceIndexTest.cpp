@@ -0,0 +1,188 @@
+#include "SliceIndexTest.h"
+
+#include <cstdlib>
+
+#include <boost/make_shared.hpp>
+
+#include <imageprocessing/ConnectedComponent.h>
+#include <sopnet/slices/Slice.h>
+#include <util/Logger.h>
+
+namespace catsoptest
+{
+
+logger::LogChannel sliceindextestlog("sliceindextestlog", "[SliceIndexTest] ");
+
+namespace
+{
+
+// the side length of the area the slices are placed in
+const int AreaSize = 1000;
+
+int
+randomInt(int min, int max)
+{
+	return min + std::rand()%(max - min + 1);
+}
+
+// a slice with the given bounding box, made of the two corner pixels
+boost::shared_ptr<Slice>
+createSlice(unsigned int id, unsigned int minX, unsigned int minY, unsigned int maxX, unsigned int maxY)
+{
+	boost::shared_ptr<ConnectedComponent::pixel_list_type> pixelList =
+		boost::make_shared<ConnectedComponent::pixel_list_type>();
+
+	pixelList->push_back(util::point<unsigned int>(minX, minY));
+	pixelList->push_back(util::point<unsigned int>(maxX, maxY));
+
+	boost::shared_ptr<ConnectedComponent> component = boost::make_shared<ConnectedComponent>(
+		boost::shared_ptr<Image>(), 1.0, pixelList, 0, pixelList->size());
+
+	return boost::make_shared<Slice>(id, 0, component);
+}
+
+boost::shared_ptr<Slice>
+randomSlice(unsigned int id, unsigned int maxSize)
+{
+	unsigned int minX = randomInt(0, AreaSize - 1);
+	unsigned int minY = randomInt(0, AreaSize - 1);
+
+	return createSlice(
+			id,
+			minX,
+			minY,
+			minX + randomInt(0, maxSize - 1),
+			minY + randomInt(0, maxSize - 1));
+}
+
+// a box that may be partly or completely outside of the area of the slices
+util::rect<int>
+randomBox(unsigned int maxSize)
+{
+	int minX = randomInt(-AreaSize/2, 2*AreaSize);
+	int minY = randomInt(-AreaSize/2, 2*AreaSize);
+
+	return util::rect<int>(
+			minX,
+			minY,
+			minX + randomInt(0, maxSize - 1),
+			minY + randomInt(0, maxSize - 1));
+}
+
+bool
+intersects(const util::rect<int>& a, const util::rect<int>& b)
+{
+	return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+}
+
+}
+
+bool
+SliceIndexTest::compare(SliceIndex& index, const util::rect<int>& box)
+{
+	std::vector<unsigned int> expected;
+
+	for (unsigned int i = 0; i < index.size(); i++)
+		if (intersects(box, index[i]->getComponent()->getBoundingBox()))
+			expected.push_back(i);
+
+	std::vector<unsigned int> found = index.find(box);
+
+	if (found != expected)
+	{
+		LOG_DEBUG(sliceindextestlog) << "query " << box << " found " << found.size() <<
+			" slices, expected " << expected.size() << std::endl;
+		_reason << "query " << box << " in " << index.size() << " slices: found " <<
+			found.size() << " slices, expected " << expected.size() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool
+SliceIndexTest::run(boost::shared_ptr<SliceIndexTestParam> arg)
+{
+	const unsigned int numQueries = 200;
+
+	SliceIndex index;
+	std::vector<boost::shared_ptr<Slice> > slices;
+
+	std::srand(arg->seed);
+
+	if (arg->hugeSlice)
+		slices.push_back(createSlice(0, 0, 0, 10*AreaSize, 10*AreaSize));
+
+	while (slices.size() < arg->numSlices)
+		slices.push_back(randomSlice(slices.size(), arg->maxSize));
+
+	// add the slices in two halves, to query a rebuilt index as well
+	for (unsigned int half = 0; half < 2; half++)
+	{
+		unsigned int end = (half == 0 ? slices.size()/2 : slices.size());
+
+		for (unsigned int i = index.size(); i < end; i++)
+			index.add(slices[i]);
+
+		for (unsigned int i = 0; i < numQueries; i++)
+			if (!compare(index, randomBox(2*arg->maxSize)))
+				return false;
+
+		// completely outside of the area
+		if (!compare(index, util::rect<int>(-2*AreaSize, -2*AreaSize, -AreaSize, -AreaSize)) ||
+			!compare(index, util::rect<int>(20*AreaSize, 0, 21*AreaSize, AreaSize)))
+			return false;
+
+		// the bounding boxes of the slices themselves, with touching borders
+		for (unsigned int i = 0; i < index.size(); i++)
+			if (!compare(index, index[i]->getComponent()->getBoundingBox()))
+				return false;
+	}
+
+	return true;
+}
+
+std::string
+SliceIndexTest::name()
+{
+	return "SliceIndex test";
+}
+
+std::string
+SliceIndexTest::reason()
+{
+	std::string reason = _reason.str();
+	_reason.clear();
+	return reason;
+}
+
+std::vector<boost::shared_ptr<SliceIndexTestParam> >
+SliceIndexTest::generateTestParameters()
+{
+	std::vector<boost::shared_ptr<SliceIndexTestParam> > params;
+
+	// single slices
+	params.push_back(boost::make_shared<SliceIndexTestParam>(1, 1, false, 1));
+	params.push_back(boost::make_shared<SliceIndexTestParam>(1, 1, true, 2));
+
+	// few and many slices, of similar and very different sizes
+	params.push_back(boost::make_shared<SliceIndexTestParam>(10, 50, false, 3));
+	params.push_back(boost::make_shared<SliceIndexTestParam>(500, 20, false, 4));
+	params.push_back(boost::make_shared<SliceIndexTestParam>(500, 500, false, 5));
+	params.push_back(boost::make_shared<SliceIndexTestParam>(2000, 10, false, 6));
+
+	// one huge slice, that makes the mean size large
+	params.push_back(boost::make_shared<SliceIndexTestParam>(100, 10, true, 7));
+	params.push_back(boost::make_shared<SliceIndexTestParam>(2000, 30, true, 8));
+
+	return params;
+}
+
+};
+
+std::ostream& operator<<(std::ostream& os, const catsoptest::SliceIndexTestParam& param)
+{
+	os << "slices: " << param.numSlices << ", max size: " << param.maxSize <<
+		", huge slice: " << param.hugeSlice << ", seed: " << param.seed;
+	return os;
+}
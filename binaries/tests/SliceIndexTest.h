@@ -0,0 +1,52 @@
+#ifndef TEST_SLICE_INDEX_H__
+#define TEST_SLICE_INDEX_H__
+#include "CatsopTest.h"
+#include <boost/shared_ptr.hpp>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <sopnet/slices/SliceIndex.h>
+
+namespace catsoptest
+{
+
+class SliceIndexTestParam
+{
+public:
+	SliceIndexTestParam(unsigned int n, unsigned int m, bool h, unsigned int s) :
+		numSlices(n), maxSize(m), hugeSlice(h), seed(s) {}
+
+	unsigned int numSlices;
+	unsigned int maxSize;
+	bool hugeSlice;
+	unsigned int seed;
+};
+
+/**
+ * Compares the slices found by a SliceIndex to a test of all bounding boxes,
+ * for random slices and random query boxes inside and outside of the slices.
+ */
+class SliceIndexTest : public catsoptest::Test<SliceIndexTestParam>
+{
+public:
+
+	bool run(boost::shared_ptr<SliceIndexTestParam> arg);
+
+	std::string name();
+
+	std::string reason();
+
+	static std::vector<boost::shared_ptr<SliceIndexTestParam> > generateTestParameters();
+
+private:
+
+	bool compare(SliceIndex& index, const util::rect<int>& box);
+
+	std::ostringstream _reason;
+};
+
+};
+
+std::ostream& operator<<(std::ostream& os, const catsoptest::SliceIndexTestParam& param);
+
+#endif //TEST_SLICE_INDEX_H__
@@ -1,4 +1,5 @@
 #include <sopnet/block/LocalBlockManager.h>
+#include <catmaid/django/DjangoBlockLeaseManager.h>
 #include <catmaid/django/DjangoSegmentStore.h>
 #include <catmaid/django/CatmaidStackStore.h>
 #include <catmaid/persistence/LocalStackStore.h>
@@ -139,4 +140,30 @@ BackendClient::createSolutionStore(const ProjectConfiguration& configuration) {
 	UTIL_THROW_EXCEPTION(UsageError, "unknown backend type " << configuration.getBackendType());
 }
 
+boost::shared_ptr<BlockLeaseManager>
+BackendClient::createBlockLeaseManager(const ProjectConfiguration& configuration) {
+
+	if (configuration.getBackendType() == ProjectConfiguration::Local) {
+
+		// local stores live only as long as a single request
+		return boost::shared_ptr<BlockLeaseManager>();
+	}
+
+	if (configuration.getBackendType() == ProjectConfiguration::Django) {
+
+		// the lease requests are not available on all servers
+		if (!configuration.getUseBlockLeases())
+			return boost::shared_ptr<BlockLeaseManager>();
+
+		LOG_USER(pylog) << "[BackendClient] create django block lease manager" << std::endl;
+
+		if (!_djangoBlockManager)
+			createBlockManager(configuration);
+
+		return boost::make_shared<DjangoBlockLeaseManager>(_djangoBlockManager);
+	}
+
+	UTIL_THROW_EXCEPTION(UsageError, "unknown backend type " << configuration.getBackendType());
+}
+
 } // namespace python
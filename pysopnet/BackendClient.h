@@ -1,6 +1,7 @@
 #ifndef SOPNET_PYTHON_BACKEND_CLIENT_H__
 #define SOPNET_PYTHON_BACKEND_CLIENT_H__
 
+#include <sopnet/block/BlockLeaseManager.h>
 #include <sopnet/block/BlockManager.h>
 #include <catmaid/django/DjangoBlockManager.h>
 #include <catmaid/django/DjangoSliceStore.h>
@@ -39,6 +40,14 @@ protected:
 
 	boost::shared_ptr<SolutionStore> createSolutionStore(const ProjectConfiguration& configuration);
 
+	/**
+	 * Create a lease manager that prevents several workers from processing the 
+	 * same block. Returns an empty pointer for the local backend, whose stores 
+	 * are not shared between workers, and for the Django backend unless block 
+	 * leases are enabled in the configuration.
+	 */
+	boost::shared_ptr<BlockLeaseManager> createBlockLeaseManager(const ProjectConfiguration& configuration);
+
 private:
 
 	boost::shared_ptr<DjangoBlockManager> _djangoBlockManager;
@@ -2,6 +2,9 @@
 
 namespace python {
 
+ProjectConfiguration::ProjectConfiguration() :
+	_useBlockLeases(false) {}
+
 void
 ProjectConfiguration::setBackendType(BackendType type) {
 
@@ -98,5 +101,17 @@ ProjectConfiguration::getCoreSize() const
 	return _coreSizeInBlocks;
 }
 
+void
+ProjectConfiguration::setUseBlockLeases(bool useBlockLeases) {
+
+	_useBlockLeases = useBlockLeases;
+}
+
+bool
+ProjectConfiguration::getUseBlockLeases() const {
+
+	return _useBlockLeases;
+}
+
 
 } // namespace python
@@ -30,6 +30,8 @@ public:
 		Django
 	};
 
+	ProjectConfiguration();
+
 	/**
 	 * Set the backend type (Local or Django).
 	 */
@@ -115,6 +117,19 @@ public:
 	 */
 	const util::point3<unsigned int>& getCoreSize() const;
 
+	/**
+	 * Enable or disable block leases in the Django backend. With leases, 
+	 * workers don't extract slices or segments of a block at the same time. 
+	 * This requires the lease requests (acquire_lease, renew_lease, 
+	 * release_lease) on the server. Disabled by default.
+	 */
+	void setUseBlockLeases(bool useBlockLeases);
+
+	/**
+	 * Check whether block leases are used in the Django backend.
+	 */
+	bool getUseBlockLeases() const;
+
 private:
 
 	BackendType _backendType;
@@ -129,6 +144,8 @@ private:
 	util::point3<unsigned int> _coreSize;
 	util::point3<unsigned int> _volumeSize;
 	util::point3<unsigned int> _coreSizeInBlocks;
+
+	bool _useBlockLeases;
 };
 
 } // namespace python
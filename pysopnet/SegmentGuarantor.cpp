@@ -1,3 +1,4 @@
+#include <boost/exception/diagnostic_information.hpp>
 #include <pipeline/Value.h>
 #include <pipeline/Process.h>
 #include <catmaid/SegmentGuarantor.h>
@@ -19,6 +20,7 @@ SegmentGuarantor::fill(
 	boost::shared_ptr<BlockManager> blockManager = createBlockManager(configuration);
 	boost::shared_ptr<SliceStore>   sliceStore   = createSliceStore(configuration);
 	boost::shared_ptr<SegmentStore> segmentStore = createSegmentStore(configuration);
+	boost::shared_ptr<BlockLeaseManager> leases  = createBlockLeaseManager(configuration);
 
 	// create a valid request block
 	boost::shared_ptr<Block> requestBlock = blockManager->blockAtCoordinates(request);
@@ -27,6 +29,13 @@ SegmentGuarantor::fill(
 	boost::shared_ptr<Blocks> blocks = boost::make_shared<Blocks>();
 	blocks->add(requestBlock);
 
+	// make sure no other worker extracts segments in this block at the same time
+	if (leases && leases->waitAndClaim(requestBlock, BlockLeaseManager::SegmentsTask) == BlockLeaseManager::Done) {
+
+		LOG_DEBUG(pylog) << "[SegmentGuarantor] segments were extracted by another worker" << std::endl;
+		return Locations();
+	}
+
 	// create the SegmentGuarantor process node
 	pipeline::Process< ::SegmentGuarantor> segmentGuarantor;
 
@@ -36,7 +45,41 @@ SegmentGuarantor::fill(
 	segmentGuarantor->setInput("stack store", rawStackStore);
 
 	// let it do what it was build for
-	pipeline::Value<Blocks> missingBlocks = segmentGuarantor->guaranteeSegments();
+	pipeline::Value<Blocks> missingBlocks;
+	try {
+
+		missingBlocks = segmentGuarantor->guaranteeSegments();
+
+	} catch (...) {
+
+		// a failing release must not replace the original error
+		if (leases) {
+
+			try {
+
+				leases->release(requestBlock, BlockLeaseManager::SegmentsTask);
+
+			} catch (boost::exception& e) {
+
+				LOG_ERROR(pylog) << "[SegmentGuarantor] could not release the segments lease on " << request << ": "
+				                 << boost::diagnostic_information(e) << std::endl;
+
+			} catch (std::exception& e) {
+
+				LOG_ERROR(pylog) << "[SegmentGuarantor] could not release the segments lease on " << request << ": "
+				                 << e.what() << std::endl;
+			}
+		}
+		throw;
+	}
+
+	if (leases) {
+
+		if (missingBlocks->length() > 0)
+			leases->release(requestBlock, BlockLeaseManager::SegmentsTask);
+		else
+			leases->finish(requestBlock, BlockLeaseManager::SegmentsTask);
+	}
 
 	// collect missing block locations
 	Locations missing;
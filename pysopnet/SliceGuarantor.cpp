@@ -1,3 +1,4 @@
+#include <boost/exception/diagnostic_information.hpp>
 #include <pipeline/Value.h>
 #include <pipeline/Process.h>
 #include <catmaid/SliceGuarantor.h>
@@ -20,6 +21,7 @@ SliceGuarantor::fill(
 	boost::shared_ptr<BlockManager> blockManager       = createBlockManager(configuration);
 	boost::shared_ptr<StackStore>   membraneStackStore = createStackStore(configuration, Membrane);
 	boost::shared_ptr<SliceStore>   sliceStore         = createSliceStore(configuration);
+	boost::shared_ptr<BlockLeaseManager> leases        = createBlockLeaseManager(configuration);
 
 	// create a valid request block
 	boost::shared_ptr<Block> requestBlock = blockManager->blockAtCoordinates(request);
@@ -28,6 +30,13 @@ SliceGuarantor::fill(
 	boost::shared_ptr<Blocks> blocks = boost::make_shared<Blocks>();
 	blocks->add(requestBlock);
 
+	// make sure no other worker extracts slices in this block at the same time
+	if (leases && leases->waitAndClaim(requestBlock, BlockLeaseManager::SlicesTask) == BlockLeaseManager::Done) {
+
+		LOG_DEBUG(pylog) << "[SliceGuarantor] slices were extracted by another worker" << std::endl;
+		return;
+	}
+
 	// slice extraction parameters
 	pipeline::Value<MserParameters> mserParameters;
 	mserParameters->darkToBright =  parameters.membraneIsBright();
@@ -49,10 +58,44 @@ SliceGuarantor::fill(
 	LOG_DEBUG(pylog) << "[SliceGuarantor] asking for slices..." << std::endl;
 
 	// let it do what it was build for
-	pipeline::Value<Blocks> missing = sliceGuarantor->guaranteeSlices();
+	pipeline::Value<Blocks> missing;
+	try {
+
+		missing = sliceGuarantor->guaranteeSlices();
+
+	} catch (...) {
+
+		// a failing release must not replace the original error
+		if (leases) {
+
+			try {
+
+				leases->release(requestBlock, BlockLeaseManager::SlicesTask);
+
+			} catch (boost::exception& e) {
+
+				LOG_ERROR(pylog) << "[SliceGuarantor] could not release the slices lease on " << request << ": "
+				                 << boost::diagnostic_information(e) << std::endl;
+
+			} catch (std::exception& e) {
+
+				LOG_ERROR(pylog) << "[SliceGuarantor] could not release the slices lease on " << request << ": "
+				                 << e.what() << std::endl;
+			}
+		}
+		throw;
+	}
 
 	LOG_DEBUG(pylog) << "[SliceGuarantor] " << missing->length() << " blocks missing" << std::endl;
 
+	if (leases) {
+
+		if (missing->length() > 0)
+			leases->release(requestBlock, BlockLeaseManager::SlicesTask);
+		else
+			leases->finish(requestBlock, BlockLeaseManager::SlicesTask);
+	}
+
 	if (missing->length() > 0)
 		UTIL_THROW_EXCEPTION(
 				MissingSliceData,
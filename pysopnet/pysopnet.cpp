@@ -5,6 +5,7 @@
 #include <util/exceptions.h>
 #include <util/point3.hpp>
 #include <sopnet/block/Block.h>
+#include <trace/Tracer.h>
 #include "ProjectConfiguration.h"
 #include "SliceGuarantor.h"
 #include "SegmentGuarantor.h"
@@ -54,6 +55,10 @@ BOOST_PYTHON_MODULE(libpysopnet) {
 	// setLogLevel
 	boost::python::def("setLogLevel", setLogLevel);
 
+	// enableTracing(traceFile, summary), writeTrace()
+	boost::python::def("enableTracing", &Tracer::enable);
+	boost::python::def("writeTrace", &Tracer::write);
+
 	// point3<unsigned int>
 	boost::python::class_<util::point3<unsigned int> >("point3", boost::python::init<unsigned int, unsigned int, unsigned int>())
 			.def_readwrite("x", &util::point3<unsigned int>::x)
@@ -93,7 +98,9 @@ BOOST_PYTHON_MODULE(libpysopnet) {
 			.def("setCoreSize", &ProjectConfiguration::setCoreSize)
 			.def("getCoreSize", &ProjectConfiguration::getCoreSize, boost::python::return_internal_reference<>())
 			.def("setVolumeSize", &ProjectConfiguration::setVolumeSize)
-			.def("getVolumeSize", &ProjectConfiguration::getVolumeSize, boost::python::return_internal_reference<>());
+			.def("getVolumeSize", &ProjectConfiguration::getVolumeSize, boost::python::return_internal_reference<>())
+			.def("setUseBlockLeases", &ProjectConfiguration::setUseBlockLeases)
+			.def("getUseBlockLeases", &ProjectConfiguration::getUseBlockLeases);
 
 	// BackendType
 	boost::python::enum_<ProjectConfiguration::BackendType>("BackendType")
@@ -14,15 +14,15 @@
 #include <inference/PriorCostFunctionParameters.h>
 #include <inference/Reconstructor.h>
 #include <inference/SegmentationCostFunction.h>
-#include <io/FileContentProvider.h>
 #include <neurons/NeuronExtractor.h>
 #include <pipeline/Value.h>
 #include <sopnet/segments/SegmentSet.h>
+#include <trace/Tracer.h>
 #include <util/foreach.h>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 
-#include <inference/io/LinearCostFunctionParametersReader.h>
+#include <inference/io/ModelCache.h>
 
 
 #include "CoreSolver.h"
@@ -109,6 +109,8 @@ CoreSolver::ConstraintAssembler::assembleConstraint(const ConflictSet& conflictS
 
 void CoreSolver::ConstraintAssembler::updateOutputs()
 {
+	TRACE_SCOPE("CoreSolver::assembleConstraints");
+
 	map<unsigned int, vector<unsigned int> > sliceSegmentMap;
 	boost::shared_ptr<LinearConstraints> constraints = boost::make_shared<LinearConstraints>();
 	
@@ -136,6 +138,8 @@ void CoreSolver::ConstraintAssembler::updateOutputs()
 	}
 	
 	*_constraints = *constraints;
+
+	TRACE_COUNT("constraints assembled", constraints->size());
 }
 
 CoreSolver::EndExtractor::EndExtractor()
@@ -207,6 +211,8 @@ void CoreSolver::EndExtractor::updateOutputs()
 void
 CoreSolver::updateOutputs()
 {
+	TRACE_SCOPE("CoreSolver::solve");
+
 	// A whole mess of pipeline variables
 	boost::shared_ptr<SliceReader> sliceReader = boost::make_shared<SliceReader>();
 	boost::shared_ptr<SegmentReader> segmentReader = boost::make_shared<SegmentReader>();
@@ -221,11 +227,9 @@ CoreSolver::updateOutputs()
 	boost::shared_ptr<ConstraintAssembler> constraintAssembler =
 		boost::make_shared<ConstraintAssembler>();
 	boost::shared_ptr<LinearCostFunction> linearCostFunction = boost::make_shared<LinearCostFunction>();;
-	boost::shared_ptr<FileContentProvider> contentProvider
-				= boost::make_shared<FileContentProvider>(
-					optionLinearCostFunctionParametersFileBlock.as<std::string>());
-	boost::shared_ptr<LinearCostFunctionParametersReader> reader
-				= boost::make_shared<LinearCostFunctionParametersReader>();
+	boost::shared_ptr<LinearCostFunctionParameters> costFunctionParameters =
+		ModelCache::getLinearCostFunctionParameters(
+			optionLinearCostFunctionParametersFileBlock.as<std::string>());
 	boost::shared_ptr<SegmentFeatureReader> segmentFeatureReader =
 		boost::make_shared<SegmentFeatureReader>();
 	
@@ -262,10 +266,8 @@ CoreSolver::updateOutputs()
 	
 	objectiveGenerator->setInput("segments", problemAssembler->getOutput("segments"));
 	
-	reader->setInput(contentProvider->getOutput());
-	
 	linearCostFunction->setInput("features", segmentFeatureReader->getOutput("features"));
-	linearCostFunction->setInput("parameters", reader->getOutput());
+	linearCostFunction->setInput("parameters", costFunctionParameters);
 
 	objectiveGenerator->addInput("cost functions", linearCostFunction->getOutput("cost function"));
 	
@@ -1,9 +1,12 @@
 #include "SegmentGuarantor.h"
+#include <boost/bind.hpp>
 #include <util/Logger.h>
+#include <sopnet/parallel/WorkerPool.h>
 #include <sopnet/segments/SegmentExtractor.h>
 #include <features/SegmentFeaturesExtractor.h>
 #include <pipeline/Value.h>
 #include <catmaid/EndExtractor.h>
+#include <trace/Tracer.h>
 
 logger::LogChannel segmentguarantorlog("segmentguarantorlog", "[SegmentGuarantor] ");
 
@@ -20,6 +23,8 @@ SegmentGuarantor::SegmentGuarantor()
 
 pipeline::Value<Blocks> SegmentGuarantor::guaranteeSegments()
 {
+	TRACE_SCOPE("SegmentGuarantor::guaranteeSegments");
+
 	updateInputs();
 	
 	pipeline::Value<Blocks> needBlocks;
@@ -74,7 +79,12 @@ pipeline::Value<Blocks> SegmentGuarantor::guaranteeSegments()
 	
 	sliceReader->setInput("blocks", sliceBlocks);
 	sliceReader->setInput("store", _sliceStore);
-	slices = sliceReader->getOutput("slices");
+
+	{
+		TRACE_SCOPE("SegmentGuarantor::readSlices");
+
+		slices = sliceReader->getOutput("slices");
+	}
 	
 	LOG_DEBUG(segmentguarantorlog) << "Read " << slices->size() <<
 		" slices from blocks " << *sliceBlocks << ". Expanding blocks to fit." << std::endl;
@@ -93,8 +103,14 @@ pipeline::Value<Blocks> SegmentGuarantor::guaranteeSegments()
 		return needBlocks;
 	}
 
-	sliceReader->setInput("blocks", sliceBlocks);
-	slices = sliceReader->getOutput("slices");
+	{
+		TRACE_SCOPE("SegmentGuarantor::readSlices");
+
+		sliceReader->setInput("blocks", sliceBlocks);
+		slices = sliceReader->getOutput("slices");
+	}
+
+	TRACE_COUNT("slices read", slices->size());
 
 	LOG_DEBUG(segmentguarantorlog) << "Altogether, I have " << slices->size() << " slices" << std::endl;
 
@@ -102,13 +118,15 @@ pipeline::Value<Blocks> SegmentGuarantor::guaranteeSegments()
 	foreach (boost::shared_ptr<Slice> slice, *slices)
 		LOG_ALL(segmentguarantorlog) << "\t" << slice->getComponent()->getCenter() << ", " << slice->getSection() << std::endl;
 	
+	// Set up one extractor for each inter-section interval. The intervals don't
+	// depend on each other, so the extraction is done in parallel.
+	std::vector<boost::shared_ptr<SegmentExtractor> > extractors;
+	
 	for (unsigned int z = zBegin; z < zEnd; ++z)
 	{
 		// If sections z and z + 1 exist in our whitelist
 		if (_blocks->getManager()->isValidZ(z) && _blocks->getManager()->isValidZ(z + 1))
 		{
-			pipeline::Value<Segments> extractedSegments;
-			
 			boost::shared_ptr<SegmentExtractor> extractor = boost::make_shared<SegmentExtractor>();
 			// Collect slices for sections z and z + 1
 			boost::shared_ptr<Slices> prevSlices = collectSlicesByZ(slices, z);
@@ -118,15 +136,59 @@ pipeline::Value<Blocks> SegmentGuarantor::guaranteeSegments()
 			extractor->setInput("previous slices", prevSlices);
 			extractor->setInput("next slices", nextSlices);
 			
-			// and grab the segments.
-			extractedSegments = extractor->getOutput("segments");
-			
-			LOG_DEBUG(segmentguarantorlog) << "Got " << extractedSegments->size() << " segments"
-				<< std::endl;
-			
-			segments->addAll(extractedSegments);
+			extractors.push_back(extractor);
 		}
 	}
+	
+	// Slices are shared between neighboring intervals, and their bitmaps are
+	// created lazily on first use. Create them here, such that the workers
+	// only read from the slices.
+	foreach (boost::shared_ptr<Slice> slice, *slices)
+	{
+		slice->getComponent()->getBitmap();
+	}
+	
+	std::vector<boost::shared_ptr<Segments> > intervalSegments(extractors.size());
+	std::vector<pipeline::Value<Features> > intervalFeatures;
+	FinishedIntervals finished;
+	WorkerPool workers;
+	
+	LOG_DEBUG(segmentguarantorlog) << "Extracting segments for " << extractors.size() <<
+		" intervals using " << workers.size() << " threads" << std::endl;
+	
+	for (unsigned int i = 0; i < extractors.size(); ++i)
+	{
+		workers.schedule(boost::bind(&SegmentGuarantor::extractInterval,
+									 extractors[i],
+									 boost::ref(intervalSegments[i]),
+									 boost::ref(finished),
+									 i));
+	}
+	
+	// Collect the segments as they are extracted, and extract their features
+	// while the remaining intervals are still being processed.
+	for (unsigned int n = 0; n < extractors.size(); ++n)
+	{
+		unsigned int i = finished.pop();
+		
+		// the extraction failed, the exception is rethrown by wait() below
+		if (!intervalSegments[i])
+		{
+			continue;
+		}
+		
+		LOG_DEBUG(segmentguarantorlog) << "Got " << intervalSegments[i]->size() << " segments"
+			<< std::endl;
+		
+		segments->addAll(intervalSegments[i]);
+		
+		if (_rawImageStore.isSet() && intervalSegments[i]->size() > 0)
+		{
+			intervalFeatures.push_back(guaranteeFeatures(intervalSegments[i]));
+		}
+	}
+	
+	workers.wait();
 
 	// In the case that the guarantee block shares its upper bound with the whole stack, extracte
 	// EndSegments there and write them to the store.
@@ -146,12 +208,20 @@ pipeline::Value<Blocks> SegmentGuarantor::guaranteeSegments()
 	segmentWriter->setInput("blocks", _blocks);
 	segmentWriter->setInput("store", _segmentStore);
 	
-	if (_rawImageStore.isSet())
 	{
-		segmentWriter->setInput("features", guaranteeFeatures(segments));
+		TRACE_SCOPE("SegmentGuarantor::writeSegments");
+
+		segmentWriter->writeSegments();
+		
+		// Features can only be stored for segments that are already associated
+		// with a block.
+		foreach (pipeline::Value<Features> features, intervalFeatures)
+		{
+			_segmentStore->storeFeatures(features);
+		}
 	}
-	
-	segmentWriter->writeSegments();
+
+	TRACE_COUNT("segments written", segments->size());
 	
 	foreach (boost::shared_ptr<Block> block, *_blocks)
 	{
@@ -163,6 +233,56 @@ pipeline::Value<Blocks> SegmentGuarantor::guaranteeSegments()
 }
 
 
+void
+SegmentGuarantor::extractInterval(boost::shared_ptr<SegmentExtractor> extractor,
+								  boost::shared_ptr<Segments>& segments,
+								  FinishedIntervals& finished,
+								  unsigned int interval)
+{
+	TRACE_SCOPE("SegmentGuarantor::extractInterval");
+
+	try
+	{
+		pipeline::Value<Segments> extractedSegments = extractor->getOutput("segments");
+		segments = extractedSegments;
+	}
+	catch (...)
+	{
+		// let the waiting thread know that there is nothing to collect
+		finished.push(interval);
+		throw;
+	}
+	
+	finished.push(interval);
+}
+
+void
+SegmentGuarantor::FinishedIntervals::push(unsigned int interval)
+{
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_finished.push_back(interval);
+	}
+	
+	_available.notify_one();
+}
+
+unsigned int
+SegmentGuarantor::FinishedIntervals::pop()
+{
+	boost::mutex::scoped_lock lock(_mutex);
+	
+	while (_finished.empty())
+	{
+		_available.wait(lock);
+	}
+	
+	unsigned int interval = _finished.front();
+	_finished.pop_front();
+	
+	return interval;
+}
+
 void SegmentGuarantor::updateOutputs()
 {
 	_needBlocks = new Blocks();
@@ -244,6 +364,8 @@ SegmentGuarantor::checkBlockSlices(const boost::shared_ptr<Blocks> sliceBlocks,
 pipeline::Value<Features>
 SegmentGuarantor::guaranteeFeatures(const boost::shared_ptr<Segments> segments)
 {
+	TRACE_SCOPE("SegmentGuarantor::guaranteeFeatures");
+
 	boost::shared_ptr<Box<> > box = segments->boundingBox();
 	boost::shared_ptr<Blocks> blocks = _blocks->getManager()->blocksInBox(box);
 	pipeline::Value<util::point3<unsigned int> > offset(blocks->location());
@@ -1,6 +1,10 @@
 #ifndef SEGMENT_GUARANTOR_H__
 #define SEGMENT_GUARANTOR_H__
 
+#include <deque>
+
+#include <boost/thread.hpp>
+
 #include <pipeline/all.h>
 #include <catmaid/SliceGuarantor.h>
 #include <catmaid/persistence/SegmentStore.h>
@@ -10,6 +14,9 @@
 #include <catmaid/persistence/StackStore.h>
 #include <sopnet/features/Features.h>
 
+// forward declaration
+class SegmentExtractor;
+
 class SegmentGuarantor : public pipeline::SimpleProcessNode<>
 {
 public:
@@ -23,6 +30,9 @@ public:
 	 * 
 	 * If "stack store" is set, this SegmentGuarantor will extract Features from the guaranteed
 	 * Segments, and store them in the SegmentStore.
+	 * 
+	 * Segments are extracted for all inter-section intervals in parallel. Features are extracted
+	 * for each interval as soon as its segments are available.
 	 *  
 	 * Outputs:
 	 *   Blocks "slices blocks" - blocks for which Slices must be guaranteed as a prerequisite
@@ -34,8 +44,38 @@ public:
 	pipeline::Value<Blocks> guaranteeSegments();
 	
 private:
+
+	/**
+	 * A queue of inter-section intervals, for which the extraction of segments
+	 * is done.
+	 */
+	class FinishedIntervals
+	{
+	public:
+		void push(unsigned int interval);
+		
+		/**
+		 * Get the next finished interval. Blocks until one is available.
+		 */
+		unsigned int pop();
+		
+	private:
+		std::deque<unsigned int> _finished;
+		boost::mutex _mutex;
+		boost::condition_variable _available;
+	};
+	
 	void updateOutputs();
 
+	/**
+	 * Extract the segments of one inter-section interval. Called from the
+	 * worker threads.
+	 */
+	static void extractInterval(boost::shared_ptr<SegmentExtractor> extractor,
+								boost::shared_ptr<Segments>& segments,
+								FinishedIntervals& finished,
+								unsigned int interval);
+
 	boost::shared_ptr<Slices> collectSlicesByZ(const boost::shared_ptr<Slices> slices,
 											   unsigned int z) const;
 
@@ -9,6 +9,7 @@
 #include <util/Logger.h>
 #include <util/foreach.h>
 #include <pipeline/Value.h>
+#include <trace/Tracer.h>
 
 logger::LogChannel sliceguarantorlog("sliceguarantorlog", "[SliceGuarantor] ");
 
@@ -72,6 +73,8 @@ SliceGuarantor::sizeOk(util::point3<unsigned int> size)
 pipeline::Value<Blocks>
 SliceGuarantor::guaranteeSlices()
 {
+	TRACE_SCOPE("SliceGuarantor::guaranteeSlices");
+
 	pipeline::Value<Blocks> extractBlocks = pipeline::Value<Blocks>();
 	pipeline::Value<Slices> slices = pipeline::Value<Slices>();
 	pipeline::Value<ConflictSets> conflictSets = pipeline::Value<ConflictSets>();
@@ -140,7 +143,13 @@ SliceGuarantor::guaranteeSlices()
 	sliceWriter->setInput("conflict sets", conflictSets);
 	sliceWriter->setInput("store", _sliceStore);
 	
-	sliceWriter->writeSlices();
+	{
+		TRACE_SCOPE("SliceGuarantor::writeSlices");
+
+		sliceWriter->writeSlices();
+	}
+
+	TRACE_COUNT("slices written", slices->size());
 	
 	foreach (boost::shared_ptr<Block> block, *_blocks)
 	{
@@ -158,6 +167,8 @@ SliceGuarantor::extractSlices(const unsigned int z,
 							  const shared_ptr<ConflictSets> conflictSets,
 							  const shared_ptr<Blocks> extractBlocks)
 {
+	TRACE_SCOPE("SliceGuarantor::extractSlices");
+
 	LOG_ALL(sliceguarantorlog) << "Setting up mini pipeline for section " << z << std::endl;
 	shared_ptr<Blocks> nbdBlocks;
 	util::rect<unsigned int> blocksRect = *_blocks;
@@ -179,7 +190,13 @@ SliceGuarantor::extractSlices(const unsigned int z,
 		util::rect<unsigned int> bound = *extractBlocks;
 		util::point<int> translate(extractBlocks->location().x, extractBlocks->location().y);
 		Box<> box(bound, z, 1);
-		shared_ptr<Image> image = (*_stackStore->getImageStack(box))[0];
+		shared_ptr<Image> image;
+
+		{
+			TRACE_SCOPE("SliceGuarantor::readImage");
+
+			image = (*_stackStore->getImageStack(box))[0];
+		}
 		
 		LOG_ALL(sliceguarantorlog) << "Processing over " << bound << std::endl;
 		
@@ -197,16 +214,25 @@ SliceGuarantor::extractSlices(const unsigned int z,
 			sliceExtractor->setInput("mser parameters", _mserParameters);
 		}
 			
-		slicesValue = sliceExtractor->getOutput("slices");
-		conflictValue = sliceExtractor->getOutput("conflict sets");
+		{
+			TRACE_SCOPE("SliceGuarantor::extractComponents");
+
+			slicesValue = sliceExtractor->getOutput("slices");
+			conflictValue = sliceExtractor->getOutput("conflict sets");
+		}
+
+		TRACE_COUNT("slices extracted", slicesValue->size());
 		
 		LOG_DEBUG(sliceguarantorlog) << "Extracted " << slicesValue->size() << " slices" << std::endl;
 		
 		// Slices are extracted in [0 0 w h]. Translate them to Box coordinates.
+		// This is done for all slices at once, such that nested slices keep
+		// sharing their pixels.
 		LOG_ALL(sliceguarantorlog) << "Translating slices to request coordinates" << std::endl;
+		slicesValue->translate(translate);
+		
 		foreach(boost::shared_ptr<Slice> slice, *slicesValue)
 		{
-			slice->translate(translate);
 			if (blocksRect.intersects(
 				static_cast<util::rect<unsigned int> >(slice->getComponent()->getBoundingBox())))
 			{
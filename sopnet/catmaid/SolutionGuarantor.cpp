@@ -1,3 +1,8 @@
+#include <config.h>
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
 #include <boost/make_shared.hpp>
 
 #include <catmaid/EndExtractor.h>
@@ -18,15 +23,16 @@
 #include <inference/PriorCostFunctionParameters.h>
 #include <inference/Reconstructor.h>
 #include <inference/SegmentationCostFunction.h>
-#include <io/FileContentProvider.h>
 #include <neurons/NeuronExtractor.h>
 #include <pipeline/Value.h>
+#include <sopnet/parallel/WorkerPool.h>
 #include <sopnet/segments/SegmentSet.h>
+#include <trace/Tracer.h>
 #include <util/foreach.h>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 
-#include <inference/io/LinearCostFunctionParametersReader.h>
+#include <inference/io/ModelCache.h>
 
 
 #include "SolutionGuarantor.h"
@@ -48,6 +54,16 @@ util::ProgramOption optionRandomForestFileSolutionGuarantor(
 		util::_description_text = "Path to an HDF5 file containing the segment random forest.",
 		util::_default_value    = "segment_rf.hdf");
 
+util::ProgramOption optionNumParallelCores(
+		util::_module           = "solutionGuarantor",
+		util::_long_name        = "numParallelCores",
+		util::_description_text = "The number of cores to solve concurrently. The default (0) divides the available CPUs by the number of threads per solver.",
+		util::_default_value    = 0);
+
+#ifdef HAVE_GUROBI
+extern util::ProgramOption optionGurobiNumThreads;
+#endif
+
 SolutionGuarantor::SolutionGuarantor()
 {
 	registerInput(_priorCostFunctionParameters, "prior cost parameters");
@@ -113,6 +129,8 @@ SolutionGuarantor::ConstraintAssembler::assembleConstraint(const ConflictSet& co
 
 void SolutionGuarantor::ConstraintAssembler::updateOutputs()
 {
+	TRACE_SCOPE("SolutionGuarantor::assembleConstraints");
+
 	map<unsigned int, vector<unsigned int> > sliceSegmentMap;
 	_constraints = new LinearConstraints();
 	
@@ -138,6 +156,8 @@ void SolutionGuarantor::ConstraintAssembler::updateOutputs()
 	{
 		_constraints->add(*assembleConstraint(conflictSet, sliceSegmentMap));
 	}
+
+	TRACE_COUNT("constraints assembled", _constraints->size());
 }
 
 SolutionGuarantor::LinearObjectiveAssembler::LinearObjectiveAssembler()
@@ -154,6 +174,7 @@ SolutionGuarantor::LinearObjectiveAssembler::LinearObjectiveAssembler()
 void
 SolutionGuarantor::LinearObjectiveAssembler::updateOutputs()
 {
+	TRACE_SCOPE("SolutionGuarantor::assembleObjective");
 	
 	pipeline::Value<Segments> noCostSegments;
 	pipeline::Value<LinearObjective> objective;
@@ -176,13 +197,14 @@ SolutionGuarantor::LinearObjectiveAssembler::updateOutputs()
 	
 	if (noCostSegments->size() > 0)
 	{
+		TRACE_SCOPE("SolutionGuarantor::computeCosts");
+		TRACE_COUNT("segments without costs", noCostSegments->size());
+
 		// When noCostSegments is non-empty, there are Segments for which
 		// no cost was retrieved.
 		std::string filename =
 			optionLinearCostFunctionParametersFileSolutionGuarantor.as<std::string>();
 			
-		boost::shared_ptr<LinearCostFunctionParametersReader> reader
-				= boost::make_shared<LinearCostFunctionParametersReader>(filename);
 		boost::shared_ptr<SegmentFeatureReader> segmentFeatureReader =
 			boost::make_shared<SegmentFeatureReader>();
 		boost::shared_ptr<LinearCostFunction> linearCostFunction =
@@ -192,15 +214,15 @@ SolutionGuarantor::LinearObjectiveAssembler::updateOutputs()
 		boost::shared_ptr<CostWriter> costWriter = boost::make_shared<CostWriter>();
 		boost::unordered_map<boost::shared_ptr<Segment>, double,
 							 SegmentPointerHash, SegmentPointerEquals> segmentCostMap;
-		std::vector<boost::shared_ptr<Segment> > segmentVector = noCostSegments->getSegments();
+		const std::vector<boost::shared_ptr<Segment> >& segmentVector = noCostSegments->getSegments();
 		std::vector<double> coefficientVector;
 		unsigned int i = 0;
 		pipeline::Value<LinearObjective> computedObjective;
 		pipeline::Value<Features> features;
-		pipeline::Value<LinearCostFunctionParameters> costFunctionParams = reader->getOutput();
+		boost::shared_ptr<LinearCostFunctionParameters> costFunctionParams =
+			ModelCache::getLinearCostFunctionParameters(filename);
 		
 		// Compute the objective for the costless segments.
-		//reader->setInput(paramFileStream);
 		
 		segmentFeatureReader->setInput("segments", noCostSegments);
 		segmentFeatureReader->setInput("store", _store);
@@ -252,94 +274,220 @@ SolutionGuarantor::LinearObjectiveAssembler::updateOutputs()
 
 
 void
-SolutionGuarantor::solve()
+SolutionGuarantor::solveCores()
 {
-	// A whole mess of pipeline variables
-	boost::shared_ptr<SliceReader> sliceReader = boost::make_shared<SliceReader>();
-	boost::shared_ptr<SegmentReader> segmentReader = boost::make_shared<SegmentReader>();
-	boost::shared_ptr<ProblemAssembler> problemAssembler = boost::make_shared<ProblemAssembler>();
-	boost::shared_ptr<ObjectiveGenerator> objectiveGenerator =
-		boost::make_shared<ObjectiveGenerator>();
-	boost::shared_ptr<SegmentationCostFunction> segmentationCostFunction =
-		boost::make_shared<SegmentationCostFunction>();
-	boost::shared_ptr<LinearSolver> linearSolver = boost::make_shared<LinearSolver>();
-	boost::shared_ptr<Reconstructor> reconstructor = boost::make_shared<Reconstructor>();
-	boost::shared_ptr<NeuronExtractor> neuronExtractor = boost::make_shared<NeuronExtractor>();
+	std::vector<boost::shared_ptr<Core> > cores(_inCores->begin(), _inCores->end());
+
+	if (cores.size() == 1)
+	{
+		solve(cores[0], _bufferedBlocks);
+		return;
+	}
+
+	// the buffered blocks of each core
+	std::vector<boost::shared_ptr<Blocks> > bufferedBlocks;
+	foreach (boost::shared_ptr<Core> core, cores)
+		bufferedBlocks.push_back(bufferCore(core, *_buffer));
+
+	std::vector<unsigned int> colours = colourCores(bufferedBlocks);
+	unsigned int numColours = 0;
+	foreach (unsigned int colour, colours)
+		numColours = std::max(numColours, colour + 1);
+
+	WorkerPool workers(getNumParallelCores());
+
+	LOG_USER(solutionguarantorlog) << "solving " << cores.size() << " cores in " << numColours
+		<< " rounds with up to " << workers.size() << " concurrent cores" << std::endl;
+
+	// Cores of the same colour do not share any buffered block and can be 
+	// solved concurrently. The colours are processed one after another.
+	for (unsigned int colour = 0; colour < numColours; ++colour)
+	{
+		for (unsigned int i = 0; i < cores.size(); ++i)
+		{
+			if (colours[i] == colour)
+			{
+				workers.schedule(boost::bind(&SolutionGuarantor::solve, this,
+											 cores[i], bufferedBlocks[i]));
+			}
+		}
+
+		workers.wait();
+	}
+}
+
+std::vector<unsigned int>
+SolutionGuarantor::colourCores(const std::vector<boost::shared_ptr<Blocks> >& bufferedBlocks)
+{
+	const unsigned int numCores = bufferedBlocks.size();
+	std::vector<std::vector<unsigned int> > neighbors(numCores);
+
+	// two cores are adjacent, if their buffered blocks overlap
+	for (unsigned int i = 0; i < numCores; ++i)
+	{
+		for (unsigned int j = i + 1; j < numCores; ++j)
+		{
+			foreach (boost::shared_ptr<Block> block, *bufferedBlocks[i])
+			{
+				if (bufferedBlocks[j]->contains(block))
+				{
+					neighbors[i].push_back(j);
+					neighbors[j].push_back(i);
+					break;
+				}
+			}
+		}
+	}
+
+	// greedy colouring, visiting the cores with the most neighbors first
+	std::vector<std::pair<unsigned int, unsigned int> > degrees;
+	for (unsigned int i = 0; i < numCores; ++i)
+		degrees.push_back(std::make_pair(neighbors[i].size(), i));
+	std::sort(degrees.rbegin(), degrees.rend());
+
+	const unsigned int uncoloured = numCores;
+	std::vector<unsigned int> colours(numCores, uncoloured);
+
+	for (unsigned int k = 0; k < numCores; ++k)
+	{
+		unsigned int i = degrees[k].second;
+		std::vector<bool> used(numCores, false);
+
+		foreach (unsigned int j, neighbors[i])
+			if (colours[j] != uncoloured)
+				used[colours[j]] = true;
+
+		unsigned int colour = 0;
+		while (used[colour])
+			++colour;
+
+		colours[i] = colour;
+	}
+
+	return colours;
+}
+
+unsigned int
+SolutionGuarantor::getNumParallelCores()
+{
+	unsigned int numParallelCores = optionNumParallelCores.as<unsigned int>();
+
+	if (numParallelCores > 0)
+		return numParallelCores;
+
+	// Don't oversubscribe the CPUs: each solver uses its own threads.
+	unsigned int numSolverThreads = 0;
+#ifdef HAVE_GUROBI
+	numSolverThreads = optionGurobiNumThreads.as<unsigned int>();
+#endif
+
+	// a solver without explicit thread count uses all CPUs
+	if (numSolverThreads == 0)
+		return 1;
+
+	return std::max(WorkerPool::getDefaultNumThreads()/numSolverThreads, 1u);
+}
+
+void
+SolutionGuarantor::solve(boost::shared_ptr<Core> core, boost::shared_ptr<Blocks> bufferedBlocks)
+{
+	TRACE_SCOPE("SolutionGuarantor::solve");
+
+	pipeline::Value<Cores> cores;
+	pipeline::Value<Segments> segments;
+	pipeline::Value<ConflictSets> conflictSets;
+	pipeline::Value<LinearObjective> objective;
+	pipeline::Value<bool> forceExplanation;
+
+	cores->add(core);
+
+	LOG_DEBUG(solutionguarantorlog) << "solving core " << core->getCoordinates() << std::endl;
+
+	// Read the problem and its objective. The stores are not thread-safe, 
+	// and so aren't the signal connections to them. All process nodes that 
+	// are connected to a store live only inside a locked scope.
+	{
+		boost::mutex::scoped_lock lock(_storeMutex);
+
+		TRACE_SCOPE("SolutionGuarantor::readProblem");
+
+		boost::shared_ptr<SliceReader> sliceReader = boost::make_shared<SliceReader>();
+		boost::shared_ptr<SegmentReader> segmentReader = boost::make_shared<SegmentReader>();
+		boost::shared_ptr<EndExtractor> endExtractor = boost::make_shared<EndExtractor>();
+		boost::shared_ptr<LinearObjectiveAssembler> objectiveAssembler =
+			boost::make_shared<LinearObjectiveAssembler>();
+
+		segmentReader->setInput("blocks", bufferedBlocks);
+		sliceReader->setInput("blocks", bufferedBlocks);
+
+		segmentReader->setInput("store", _segmentStore);
+		sliceReader->setInput("store", _sliceStore);
+
+		endExtractor->setInput("segments", segmentReader->getOutput("segments"));
+		endExtractor->setInput("slices", sliceReader->getOutput("slices"));
+
+		objectiveAssembler->setInput("segment store", _segmentStore);
+		objectiveAssembler->setInput("segments", endExtractor->getOutput("segments"));
+		objectiveAssembler->setInput("blocks", bufferedBlocks);
+		objectiveAssembler->setInput("stack store", _rawImageStore);
+
+		segments = endExtractor->getOutput("segments");
+		conflictSets = sliceReader->getOutput("conflict sets");
+		objective = objectiveAssembler->getOutput();
+
+		*forceExplanation = *_forceExplanation;
+
+		LOG_DEBUG(solutionguarantorlog) << "read " << segments->size() << " segments, "
+			<< objective->size() << " objective coefficients" << std::endl;
+	}
+
+	// Assemble and solve the problem. This does not touch any store.
 	boost::shared_ptr<ConstraintAssembler> constraintAssembler =
 		boost::make_shared<ConstraintAssembler>();
-	boost::shared_ptr<LinearCostFunction> linearCostFunction = boost::make_shared<LinearCostFunction>();
-	boost::shared_ptr<FileContentProvider> contentProvider
-				= boost::make_shared<FileContentProvider>(
-					optionLinearCostFunctionParametersFileSolutionGuarantor.as<std::string>());
-	boost::shared_ptr<LinearCostFunctionParametersReader> reader
-				= boost::make_shared<LinearCostFunctionParametersReader>();
-	boost::shared_ptr<SegmentFeatureReader> segmentFeatureReader =
-		boost::make_shared<SegmentFeatureReader>();
-	
-	boost::shared_ptr<EndExtractor> endExtractor = boost::make_shared<EndExtractor>();
-	
-	boost::shared_ptr<SegmentSolutionWriter> solutionWriter = boost::make_shared<SegmentSolutionWriter>();
-	
-	boost::shared_ptr<LinearObjectiveAssembler> objectiveAssembler =
-		boost::make_shared<LinearObjectiveAssembler>();
-	
-	// inputs and outputs
+	boost::shared_ptr<ProblemAssembler> problemAssembler = boost::make_shared<ProblemAssembler>();
+	boost::shared_ptr<LinearSolver> linearSolver = boost::make_shared<LinearSolver>();
 	boost::shared_ptr<LinearSolverParameters> binarySolverParameters = 
 		boost::make_shared<LinearSolverParameters>(Binary);
-	pipeline::Value<SegmentTrees> neurons;
-	pipeline::Value<Segments> segments;
-	boost::shared_ptr<Blocks> needBlocks = boost::make_shared<Blocks>();
+	pipeline::Value<Segments> problemSegments;
+	pipeline::Value<Solution> solution;
 
-	LOG_DEBUG(solutionguarantorlog) << "Variables instantiated, setting up pipeline" << std::endl;
-	
-	segmentReader->setInput("blocks", _bufferedBlocks);
-	sliceReader->setInput("blocks", _bufferedBlocks);
-	
-	segmentReader->setInput("store", _segmentStore);
-	sliceReader->setInput("store", _sliceStore);
-	
-	endExtractor->setInput("segments", segmentReader->getOutput("segments"));
-	endExtractor->setInput("slices", sliceReader->getOutput("slices"));
-	
-	constraintAssembler->setInput("segments", endExtractor->getOutput("segments"));
-	constraintAssembler->setInput("conflict sets", sliceReader->getOutput("conflict sets"));
-	constraintAssembler->setInput("force explanation", _forceExplanation);
-	
-	problemAssembler->addInput("neuron segments", endExtractor->getOutput("segments"));
-	problemAssembler->addInput("neuron linear constraints", constraintAssembler->getOutput("linear constraints"));
-
-	objectiveAssembler->setInput("segment store", _segmentStore);
-	objectiveAssembler->setInput("segments", endExtractor->getOutput("segments"));
-	objectiveAssembler->setInput("blocks", _bufferedBlocks);
-	objectiveAssembler->setInput("stack store", _rawImageStore);
+	constraintAssembler->setInput("segments", segments);
+	constraintAssembler->setInput("conflict sets", conflictSets);
+	constraintAssembler->setInput("force explanation", forceExplanation);
 
-// 	segmentFeatureReader->setInput("segments", endExtractor->getOutput("segments"));
-// 	segmentFeatureReader->setInput("store", _segmentStore);
-// 	segmentFeatureReader->setInput("block manager", _bufferedBlocks->getManager());
-// 	segmentFeatureReader->setInput("raw stack store", _rawImageStore);
-	
-// 	objectiveGenerator->setInput("segments", problemAssembler->getOutput("segments"));
-	
-// 	reader->setInput(contentProvider->getOutput());
-	
-// 	linearCostFunction->setInput("features", segmentFeatureReader->getOutput("features"));
-// 	linearCostFunction->setInput("parameters", reader->getOutput());
+	problemAssembler->addInput("neuron segments", segments);
+	problemAssembler->addInput("neuron linear constraints", constraintAssembler->getOutput("linear constraints"));
 
-// 	objectiveGenerator->addInput("cost functions", linearCostFunction->getOutput("cost function"));
-	
-	
-	linearSolver->setInput("objective", objectiveAssembler->getOutput());
+	linearSolver->setInput("objective", objective);
 	linearSolver->setInput("linear constraints", problemAssembler->getOutput("linear constraints"));
 	linearSolver->setInput("parameters", binarySolverParameters);
-	
-	solutionWriter->setInput("segments", problemAssembler->getOutput("segments"));
-	solutionWriter->setInput("cores", _inCores);
-	solutionWriter->setInput("solution", linearSolver->getOutput());
-	solutionWriter->setInput("store", _segmentStore);
-	
-	LOG_DEBUG(solutionguarantorlog) << "Pipeline is setup, extracting neurons" << std::endl;
 
-	solutionWriter->writeSolution();
+	{
+		TRACE_SCOPE("SolutionGuarantor::assembleAndSolve");
+
+		problemSegments = problemAssembler->getOutput("segments");
+		solution = linearSolver->getOutput();
+	}
+
+	LOG_DEBUG(solutionguarantorlog) << "solved core " << core->getCoordinates()
+		<< ", writing solution" << std::endl;
+
+	// Write the solution.
+	{
+		boost::mutex::scoped_lock lock(_storeMutex);
+
+		TRACE_SCOPE("SolutionGuarantor::writeSolution");
+
+		boost::shared_ptr<SegmentSolutionWriter> solutionWriter =
+			boost::make_shared<SegmentSolutionWriter>();
+
+		solutionWriter->setInput("segments", problemSegments);
+		solutionWriter->setInput("cores", cores);
+		solutionWriter->setInput("solution", solution);
+		solutionWriter->setInput("store", _segmentStore);
+
+		solutionWriter->writeSolution();
+	}
 }
 
 void
@@ -369,6 +517,8 @@ SolutionGuarantor::checkBlocks()
 
 pipeline::Value<Blocks> SolutionGuarantor::guaranteeSolution()
 {
+	TRACE_SCOPE("SolutionGuarantor::guaranteeSolution");
+
 	pipeline::Value<Blocks> needBlocks;
 	
 	updateInputs();
@@ -391,7 +541,7 @@ pipeline::Value<Blocks> SolutionGuarantor::guaranteeSolution()
 	
 	if (needBlocks->empty())
 	{
-		solve();
+		solveCores();
 	}
 	
 	return needBlocks;
@@ -1,7 +1,10 @@
 #ifndef SOLUTION_GUARANTOR_H__
 #define SOLUTION_GUARANTOR_H__
 
+#include <vector>
+
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <pipeline/all.h>
 
@@ -36,6 +39,12 @@ public:
 	 * This process node takes the Slices and Segments from their given stores and Blocks, and
 	 * computes a Sopnet segmentation solution over them, given the various other inputs. The
 	 * solution is written to a SegmentStore view a SolutionWriter.
+	 *
+	 * Each core is solved separately over its buffered blocks. Cores whose buffered blocks
+	 * overlap are never solved at the same time: the cores are coloured such that adjacent
+	 * cores have different colours, and all cores of one colour are solved concurrently.
+	 * The number of concurrent cores is set by the program option
+	 * solutionGuarantor.numParallelCores.
 	 */
 	SolutionGuarantor();
 	
@@ -46,9 +55,10 @@ public:
 	
 	static boost::shared_ptr<Blocks> bufferCores(boost::shared_ptr<Cores> cores,
 											   const unsigned int buffer);
-private:
+	
 	/**
 	 * Assembles segment-wise linear constraints from slices-wise conflict sets.
+	 * Public to be benchmarked on its own.
 	 */
 	class ConstraintAssembler : public pipeline::SimpleProcessNode<>
 	{
@@ -68,6 +78,7 @@ private:
 		pipeline::Output<LinearConstraints> _constraints;
 	};
 	
+private:
 	class LinearObjectiveAssembler : public pipeline::SimpleProcessNode<>
 	{
 	public:
@@ -83,7 +94,27 @@ private:
 		pipeline::Output<LinearObjective> _objective;
 	};
 	
-	void solve();
+	/**
+	 * Solve all input cores, concurrently where possible.
+	 */
+	void solveCores();
+	
+	/**
+	 * Read, solve and write the solution of a single core.
+	 */
+	void solve(boost::shared_ptr<Core> core, boost::shared_ptr<Blocks> bufferedBlocks);
+	
+	/**
+	 * Assign a colour to each core, such that no two cores with overlapping buffered blocks 
+	 * have the same colour. Colours are numbered from 0.
+	 */
+	static std::vector<unsigned int> colourCores(
+			const std::vector<boost::shared_ptr<Blocks> >& bufferedBlocks);
+	
+	/**
+	 * Get the number of cores to solve concurrently.
+	 */
+	static unsigned int getNumParallelCores();
 	
 	pipeline::Value<Blocks> checkBlocks();
 	
@@ -102,6 +133,9 @@ private:
 	pipeline::Output<Blocks> _needBlocks;
 	
 	boost::shared_ptr<Blocks> _bufferedBlocks;
+	
+	// guards the stores while cores are solved concurrently
+	boost::mutex _storeMutex;
 };
 
 #endif //SOLUTION_GUARANTOR_H__
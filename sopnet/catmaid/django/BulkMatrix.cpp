@@ -0,0 +1,267 @@
+#include "BulkMatrix.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/lexical_cast.hpp>
+
+#include <util/exceptions.h>
+
+const char* BulkMatrix::FormatName  = "sopnet-bulk-matrix-1";
+const char* BulkMatrix::ContentType = "application/octet-stream";
+
+namespace {
+
+const char Magic[4] = { 'S', 'P', 'B', 'M' };
+
+const boost::uint32_t Version = 1;
+
+void putUint32(std::string& out, boost::uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+		out += static_cast<char>((value >> (8*i)) & 0xff);
+}
+
+void putUint64(std::string& out, boost::uint64_t value)
+{
+	for (int i = 0; i < 8; i++)
+		out += static_cast<char>((value >> (8*i)) & 0xff);
+}
+
+boost::uint32_t getUint32(const char* in)
+{
+	boost::uint32_t value = 0;
+	for (int i = 0; i < 4; i++)
+		value |= static_cast<boost::uint32_t>(static_cast<unsigned char>(in[i])) << (8*i);
+	return value;
+}
+
+boost::uint64_t getUint64(const char* in)
+{
+	boost::uint64_t value = 0;
+	for (int i = 0; i < 8; i++)
+		value |= static_cast<boost::uint64_t>(static_cast<unsigned char>(in[i])) << (8*i);
+	return value;
+}
+
+void putValue(std::string& out, double value, unsigned int valueSize)
+{
+	if (valueSize == 4)
+	{
+		float f = static_cast<float>(value);
+		boost::uint32_t bits;
+		std::memcpy(&bits, &f, 4);
+		putUint32(out, bits);
+	}
+	else
+	{
+		boost::uint64_t bits;
+		std::memcpy(&bits, &value, 8);
+		putUint64(out, bits);
+	}
+}
+
+double getValue(const char* in, unsigned int valueSize)
+{
+	if (valueSize == 4)
+	{
+		boost::uint32_t bits = getUint32(in);
+		float f;
+		std::memcpy(&f, &bits, 4);
+		return f;
+	}
+	else
+	{
+		boost::uint64_t bits = getUint64(in);
+		double d;
+		std::memcpy(&d, &bits, 8);
+		return d;
+	}
+}
+
+} // anonymous namespace
+
+BulkMatrix::BulkMatrix(unsigned int valueSize) :
+	_valueSize(valueSize),
+	_columns(0),
+	_columnsSet(false)
+{
+	if (valueSize != 4 && valueSize != 8)
+		BOOST_THROW_EXCEPTION(
+				UsageError()
+				<< error_message("values of bulk matrices have to be 4 or 8 bytes")
+				<< STACK_TRACE);
+}
+
+void
+BulkMatrix::addRow(const std::string& hash)
+{
+	setColumns(0);
+	addHash(hash);
+}
+
+void
+BulkMatrix::addRow(const std::string& hash, double value)
+{
+	setColumns(1);
+	addHash(hash);
+	_values.push_back(value);
+}
+
+void
+BulkMatrix::addRow(const std::string& hash, const std::vector<double>& values)
+{
+	setColumns(values.size());
+	addHash(hash);
+	_values.insert(_values.end(), values.begin(), values.end());
+}
+
+std::string
+BulkMatrix::hash(unsigned int row) const
+{
+	return boost::lexical_cast<std::string>(_hashes[row]);
+}
+
+std::vector<double>
+BulkMatrix::row(unsigned int row) const
+{
+	return std::vector<double>(
+			_values.begin() + row*_columns,
+			_values.begin() + (row + 1)*_columns);
+}
+
+std::string
+BulkMatrix::encode(unsigned int begin, unsigned int end) const
+{
+	std::string out;
+	out.reserve(HeaderSize + (end - begin)*(8 + _columns*_valueSize));
+
+	out.append(Magic, 4);
+	putUint32(out, Version);
+	putUint32(out, end - begin);
+	putUint32(out, _columns);
+	putUint32(out, _valueSize);
+
+	for (unsigned int i = begin; i < end; i++)
+		putUint64(out, _hashes[i]);
+
+	for (size_t i = begin*_columns; i < end*_columns; i++)
+		putValue(out, _values[i], _valueSize);
+
+	return out;
+}
+
+std::vector<std::string>
+BulkMatrix::encodeChunks(size_t maxBytes) const
+{
+	size_t rowSize = 8 + _columns*_valueSize;
+	size_t rowsPerChunk = (maxBytes > HeaderSize ? (maxBytes - HeaderSize)/rowSize : 0);
+
+	if (rowsPerChunk == 0)
+		rowsPerChunk = 1;
+
+	std::vector<std::string> chunks;
+
+	for (unsigned int begin = 0; begin < rows(); begin += rowsPerChunk)
+		chunks.push_back(encode(begin, std::min<size_t>(begin + rowsPerChunk, rows())));
+
+	return chunks;
+}
+
+bool
+BulkMatrix::isEncoded(const std::string& data)
+{
+	return data.size() >= HeaderSize && std::memcmp(data.c_str(), Magic, 4) == 0;
+}
+
+BulkMatrix
+BulkMatrix::decode(const std::string& data)
+{
+	if (!isEncoded(data))
+		BOOST_THROW_EXCEPTION(IOError() << error_message("not a bulk matrix") << STACK_TRACE);
+
+	const char* in = data.c_str();
+
+	boost::uint32_t version   = getUint32(in + 4);
+	boost::uint32_t rows      = getUint32(in + 8);
+	boost::uint32_t columns   = getUint32(in + 12);
+	boost::uint32_t valueSize = getUint32(in + 16);
+
+	if (version != Version)
+		BOOST_THROW_EXCEPTION(
+				IOError()
+				<< error_message("unsupported bulk matrix version " + boost::lexical_cast<std::string>(version))
+				<< STACK_TRACE);
+
+	// a list of hashes might not specify a value size
+	if (columns == 0 && valueSize == 0)
+		valueSize = 8;
+
+	if (valueSize != 4 && valueSize != 8)
+		BOOST_THROW_EXCEPTION(
+				IOError()
+				<< error_message("invalid value size in bulk matrix")
+				<< STACK_TRACE);
+
+	boost::uint64_t expectedSize =
+			HeaderSize +
+			static_cast<boost::uint64_t>(rows)*8 +
+			static_cast<boost::uint64_t>(rows)*columns*valueSize;
+
+	if (data.size() != expectedSize)
+		BOOST_THROW_EXCEPTION(
+				IOError()
+				<< error_message(
+						"bulk matrix has " + boost::lexical_cast<std::string>(data.size()) +
+						" bytes, expected " + boost::lexical_cast<std::string>(expectedSize))
+				<< STACK_TRACE);
+
+	BulkMatrix matrix(valueSize);
+	matrix.setColumns(columns);
+
+	in += HeaderSize;
+
+	matrix._hashes.resize(rows);
+	for (unsigned int i = 0; i < rows; i++, in += 8)
+		matrix._hashes[i] = getUint64(in);
+
+	matrix._values.resize(static_cast<size_t>(rows)*columns);
+	for (size_t i = 0; i < matrix._values.size(); i++, in += valueSize)
+		matrix._values[i] = getValue(in, valueSize);
+
+	return matrix;
+}
+
+void
+BulkMatrix::addHash(const std::string& hash)
+{
+	// hashes are the decimal representation of Segment::hashValue()
+	const char* begin = hash.c_str();
+	char* end;
+
+	errno = 0;
+	unsigned long long value = std::strtoull(begin, &end, 10);
+
+	if (hash.empty() || *end != 0 || errno == ERANGE)
+		BOOST_THROW_EXCEPTION(
+				UsageError()
+				<< error_message("segment hash '" + hash + "' is not a 64-bit number")
+				<< STACK_TRACE);
+
+	_hashes.push_back(value);
+}
+
+void
+BulkMatrix::setColumns(unsigned int columns)
+{
+	if (_columnsSet && columns != _columns)
+		BOOST_THROW_EXCEPTION(
+				UsageError()
+				<< error_message("all rows of a bulk matrix need to have the same number of values")
+				<< STACK_TRACE);
+
+	_columns    = columns;
+	_columnsSet = true;
+}
@@ -0,0 +1,120 @@
+#ifndef BULK_MATRIX_H__
+#define BULK_MATRIX_H__
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+/**
+ * A table of values per segment hash in the binary, columnar format used for
+ * bulk transfers of features and costs to and from the Django backend.
+ *
+ * The encoding is (all numbers little-endian):
+ *
+ *   char[4]               magic "SPBM"
+ *   uint32                format version (1)
+ *   uint32                number of rows n
+ *   uint32                number of columns m
+ *   uint32                bytes per value (4 for float32, 8 for float64)
+ *   uint64[n]             the segment hashes
+ *   float32/float64[n*m]  the values, row by row
+ *
+ * A table without columns is used to send a list of hashes.
+ */
+class BulkMatrix
+{
+public:
+
+	/**
+	 * The name of this format in the server's list of supported formats.
+	 */
+	static const char* FormatName;
+
+	/**
+	 * The MIME type of encoded tables.
+	 */
+	static const char* ContentType;
+
+	/**
+	 * Create an empty table.
+	 *
+	 * @param valueSize
+	 *              The number of bytes per value in the encoding, 4 or 8.
+	 */
+	BulkMatrix(unsigned int valueSize = 8);
+
+	/**
+	 * Add a row without values.
+	 */
+	void addRow(const std::string& hash);
+
+	/**
+	 * Add a row with a single value.
+	 */
+	void addRow(const std::string& hash, double value);
+
+	/**
+	 * Add a row. All rows need to have the same number of values.
+	 */
+	void addRow(const std::string& hash, const std::vector<double>& values);
+
+	unsigned int rows() const { return _hashes.size(); }
+
+	unsigned int columns() const { return _columns; }
+
+	std::string hash(unsigned int row) const;
+
+	double value(unsigned int row, unsigned int column) const
+	{
+		return _values[row*_columns + column];
+	}
+
+	/**
+	 * Get the values of a row.
+	 */
+	std::vector<double> row(unsigned int row) const;
+
+	/**
+	 * Encode the rows [begin, end).
+	 */
+	std::string encode(unsigned int begin, unsigned int end) const;
+
+	/**
+	 * Encode the whole table.
+	 */
+	std::string encode() const { return encode(0, rows()); }
+
+	/**
+	 * Encode the table in chunks of at most maxBytes (but at least one row
+	 * each).
+	 */
+	std::vector<std::string> encodeChunks(size_t maxBytes) const;
+
+	/**
+	 * Test whether the given data is an encoded table.
+	 */
+	static bool isEncoded(const std::string& data);
+
+	/**
+	 * Decode a table. Raises an IOError, if the data is malformed.
+	 */
+	static BulkMatrix decode(const std::string& data);
+
+private:
+
+	static const unsigned int HeaderSize = 20;
+
+	void addHash(const std::string& hash);
+
+	void setColumns(unsigned int columns);
+
+	unsigned int _valueSize;
+	unsigned int _columns;
+	bool         _columnsSet;
+
+	std::vector<boost::uint64_t> _hashes;
+	std::vector<double>          _values;
+};
+
+#endif // BULK_MATRIX_H__
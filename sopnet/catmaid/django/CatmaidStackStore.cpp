@@ -1,8 +1,13 @@
 #include "CatmaidStackStore.h"
-#include <imageprocessing/io/ImageHttpReader.h>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <imageprocessing/io/ImageFileReader.h>
 #include <util/httpclient.h>
+#include <util/exceptions.h>
 #include <catmaid/django/DjangoUtils.h>
+#include <catmaid/django/HttpSession.h>
 #include <util/Logger.h>
+#include <trace/Tracer.h>
 
 logger::LogChannel catmaidstackstorelog("catmaidstackstorelog", "[CatmaidStackStore] ");
 
@@ -17,7 +22,7 @@ CatmaidStackStore::CatmaidStackStore(const std::string& url,
 	DjangoUtils::appendProjectAndStack(os, _serverUrl, _project, _stack);
 	os << "/stack_info";
 	
-	pt = HttpClient::getPropertyTree(os.str());
+	pt = DjangoUtils::getPropertyTree(os.str());
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -58,6 +63,8 @@ boost::shared_ptr<Image>
 CatmaidStackStore::getImage(const util::rect<unsigned int> bound,
 							const unsigned int section)
 {
+	TRACE_SCOPE("CatmaidStackStore::getImage");
+
 	/*
 	Step 1) Calculate which tiles we need to fetch. This is done by dividing the bounds by the
 	        tile width and height.
@@ -76,26 +83,76 @@ CatmaidStackStore::getImage(const util::rect<unsigned int> bound,
 	tileCMax = (bound.maxX + _tileWidth - 1) / _tileWidth;
 	tileRMax = (bound.maxY + _tileHeight -1) / _tileHeight;
 	
+	// fetch all tiles at once, over the pooled connections of the HttpSession
+	std::vector<HttpSession::Request> requests;
 	for (unsigned int r = tileRMin; r < tileRMax; ++r)
 	{
-		std::vector<boost::shared_ptr<Image> > imageVector;
 		for (unsigned int c = tileCMin; c < tileCMax; ++c)
 		{
-			boost::shared_ptr<ImageHttpReader> reader =
-				boost::make_shared<ImageHttpReader>(tileURL(c, r, section));
-			pipeline::Value<Image> image = reader->getOutput();
-
+			requests.push_back(HttpSession::Request(tileURL(c, r, section)));
+		}
+	}
+	
+	std::vector<std::string> tiles = HttpSession::getInstance().performAll(requests);
+	
+	TRACE_COUNT("image tiles", tiles.size());
+	
+	unsigned int i = 0;
+	for (unsigned int r = tileRMin; r < tileRMax; ++r)
+	{
+		for (unsigned int c = tileCMin; c < tileCMax; ++c, ++i)
+		{
+			boost::shared_ptr<Image> image = decodeTile(tiles[i]);
+			
 			unsigned int tileWXmin = c * _tileWidth; // Upper left of the tile in world coords.
 			unsigned int tileWYmin = r * _tileHeight;
 
 			copyImageInto(*image, *imageOut, tileWXmin, tileWYmin, bound);
 		}
+	}
+	
+	
+	return imageOut;
+}
+
+boost::shared_ptr<Image>
+CatmaidStackStore::decodeTile(const std::string& data)
+{
+	// vigra reads images from files only
+	boost::filesystem::path file = boost::filesystem::temp_directory_path() /
+		boost::filesystem::unique_path("catmaid-tile-%%%%-%%%%-%%%%-%%%%." + _extension);
+	
+	{
+		std::ofstream out(file.string().c_str(), std::ios::binary);
+		out.write(data.data(), data.size());
 		
+		if (!out)
+		{
+			UTIL_THROW_EXCEPTION(IOError, "can not write the tile to " << file);
+		}
+	}
+	
+	pipeline::Value<Image> image;
+	
+	try
+	{
+		boost::shared_ptr<ImageFileReader> reader =
+			boost::make_shared<ImageFileReader>(file.string());
+		image = reader->getOutput("image");
 		
+		// read the file now, before it is removed
+		LOG_ALL(catmaidstackstorelog) << "decoded tile of size " << image->width() << "x" <<
+			image->height() << " from " << data.size() << " bytes" << std::endl;
+	}
+	catch (...)
+	{
+		boost::filesystem::remove(file);
+		throw;
 	}
 	
+	boost::filesystem::remove(file);
 	
-	return imageOut;
+	return image;
 }
 
 void
@@ -45,6 +45,12 @@ private:
 	std::string tileURL(const unsigned int column, const unsigned int row,
 						const unsigned int section);
 	
+	/**
+	 * Decodes a tile from the body of its HTTP response, using the same image reader as
+	 * for local stacks.
+	 */
+	boost::shared_ptr<Image> decodeTile(const std::string& data);
+	
 	/**
 	 * Copies the tile image into the output image.
 	 * @param tile - the Image returned for the given CATMAID tile
@@ -0,0 +1,139 @@
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/optional.hpp>
+
+#include <util/exceptions.h>
+#include <util/httpclient.h>
+#include <util/Logger.h>
+#include <catmaid/django/DjangoUtils.h>
+#include "DjangoBlockLeaseManager.h"
+
+logger::LogChannel djangoblockleaselog("djangoblockleaselog", "[DjangoBlockLeaseManager] ");
+
+DjangoBlockLeaseManager::DjangoBlockLeaseManager(
+		boost::shared_ptr<DjangoBlockManager> blockManager,
+		const std::string& worker,
+		unsigned int leaseDuration) :
+	BlockLeaseManager(worker, leaseDuration),
+	_blockManager(blockManager)
+{
+
+}
+
+DjangoBlockLeaseManager::~DjangoBlockLeaseManager()
+{
+	stopHeartbeat();
+}
+
+void
+DjangoBlockLeaseManager::appendLeaseRequest(std::ostringstream& os, const std::string& request,
+											const Lease& lease)
+{
+	DjangoUtils::appendProjectAndStack(os, _blockManager->getServer(),
+									   _blockManager->getProject(), _blockManager->getStack());
+
+	os << "/" << request << "?"
+		<< (lease.task == SolutionTask ? "core_id" : "block_id") << "=" << lease.id
+		<< "&task=" << taskName(lease.task)
+		<< "&worker=" << getWorker();
+}
+
+BlockLeaseManager::ClaimResult
+DjangoBlockLeaseManager::acquireLease(const Lease& lease, std::time_t expiry)
+{
+	std::ostringstream os;
+
+	appendLeaseRequest(os, "acquire_lease", lease);
+	os << "&expiry=" << expiry;
+
+	boost::shared_ptr<ptree> pt;
+
+	try
+	{
+		pt = DjangoUtils::getPropertyTree(os.str());
+	}
+	catch (IOError& e)
+	{
+		LOG_ERROR(djangoblockleaselog) << "acquire_lease for " << taskName(lease.task)
+			<< " on " << lease.id << " failed: " << boost::diagnostic_information(e) << std::endl;
+
+		return Failed;
+	}
+
+	boost::optional<std::string> status;
+
+	if (!HttpClient::checkDjangoError(pt))
+		status = pt->get_optional<std::string>("status");
+
+	if (!status)
+	{
+		LOG_ERROR(djangoblockleaselog) << "Django error in acquire_lease for "
+			<< taskName(lease.task) << " on " << lease.id << std::endl;
+
+		// don't let the worker start working without a lease
+		return Failed;
+	}
+
+	if (status->compare("claimed") == 0)
+		return Claimed;
+
+	if (status->compare("done") == 0)
+		return Done;
+
+	return InProgress;
+}
+
+bool
+DjangoBlockLeaseManager::renewLease(const Lease& lease, std::time_t expiry)
+{
+	std::ostringstream os;
+
+	appendLeaseRequest(os, "renew_lease", lease);
+	os << "&expiry=" << expiry;
+
+	boost::shared_ptr<ptree> pt = DjangoUtils::getPropertyTree(os.str());
+
+	boost::optional<std::string> ok;
+
+	if (!HttpClient::checkDjangoError(pt))
+		ok = pt->get_optional<std::string>("ok");
+
+	if (!ok)
+	{
+		LOG_ERROR(djangoblockleaselog) << "Django error in renew_lease for "
+			<< taskName(lease.task) << " on " << lease.id << std::endl;
+
+		// keep the lease for now, the next heartbeat will try again
+		return true;
+	}
+
+	return ok->compare("true") == 0;
+}
+
+void
+DjangoBlockLeaseManager::releaseLease(const Lease& lease, bool done)
+{
+	std::ostringstream os;
+
+	appendLeaseRequest(os, "release_lease", lease);
+	os << "&done=" << (done ? 1 : 0);
+
+	boost::shared_ptr<ptree> pt = DjangoUtils::getPropertyTree(os.str());
+
+	boost::optional<std::string> ok;
+
+	if (!HttpClient::checkDjangoError(pt))
+		ok = pt->get_optional<std::string>("ok");
+
+	if (!ok)
+	{
+		LOG_ERROR(djangoblockleaselog) << "Django error in release_lease for "
+			<< taskName(lease.task) << " on " << lease.id << std::endl;
+		return;
+	}
+
+	if (ok->compare("true") != 0)
+	{
+		LOG_ERROR(djangoblockleaselog) << "Got not-ok when releasing " << taskName(lease.task)
+			<< " lease on " << lease.id << std::endl;
+	}
+}
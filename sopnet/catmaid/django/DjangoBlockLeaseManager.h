@@ -0,0 +1,57 @@
+#ifndef DJANGO_BLOCK_LEASE_MANAGER_H__
+#define DJANGO_BLOCK_LEASE_MANAGER_H__
+
+#include <sstream>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include <catmaid/django/DjangoBlockManager.h>
+#include <sopnet/block/BlockLeaseManager.h>
+
+/**
+ * A BlockLeaseManager that keeps its leases in the CATMAID database, to be shared by workers
+ * on a cluster. Leases are identified by the database ids of the blocks and cores of the
+ * given DjangoBlockManager.
+ *
+ * The server checks and takes a lease in one request, such that two workers never get the
+ * same lease.
+ */
+class DjangoBlockLeaseManager : public BlockLeaseManager
+{
+public:
+
+	/**
+	 * Create a Django lease manager.
+	 *
+	 * @param blockManager the DjangoBlockManager whose blocks and cores are leased
+	 * @param worker the name of this worker, see BlockLeaseManager.
+	 * @param leaseDuration the lease duration in seconds, see BlockLeaseManager.
+	 */
+	DjangoBlockLeaseManager(
+			boost::shared_ptr<DjangoBlockManager> blockManager,
+			const std::string& worker = "",
+			unsigned int leaseDuration = 0);
+
+	~DjangoBlockLeaseManager();
+
+protected:
+
+	ClaimResult acquireLease(const Lease& lease, std::time_t expiry);
+
+	bool renewLease(const Lease& lease, std::time_t expiry);
+
+	void releaseLease(const Lease& lease, bool done);
+
+private:
+
+	/**
+	 * Append the url of a lease request, up to and including the lease parameters.
+	 */
+	void appendLeaseRequest(std::ostringstream& os, const std::string& request,
+							const Lease& lease);
+
+	boost::shared_ptr<DjangoBlockManager> _blockManager;
+};
+
+#endif //DJANGO_BLOCK_LEASE_MANAGER_H__
@@ -31,7 +31,7 @@ DjangoBlockManager::getBlockManager(const std::string& server,
 	
 	os << "/block";
 	
-	boost::shared_ptr<ptree> pt = HttpClient::getPropertyTree(os.str());
+	boost::shared_ptr<ptree> pt = DjangoUtils::getPropertyTree(os.str());
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -120,7 +120,7 @@ DjangoBlockManager::blockAtLocation(const util::point3<unsigned int>& location)
 			appendProjectAndStack(os);
 			os << "/block_at_location?x=" << loc.x << "&y=" << loc.y << "&z=" <<loc.z;
 
-			pt = HttpClient::getPropertyTree(os.str());
+			pt = DjangoUtils::getPropertyTree(os.str());
 
 			if (!HttpClient::checkDjangoError(pt))
 			{
@@ -158,21 +158,33 @@ DjangoBlockManager::blockAtCoordinates(const util::point3<unsigned int>& coordin
 boost::shared_ptr<Blocks>
 DjangoBlockManager::blocksInBox(const boost::shared_ptr<Box<> >& box)
 {
-    boost::shared_ptr<Blocks> blocks = boost::make_shared<Blocks>();
-	boost::shared_ptr<ptree> pt;
+	boost::shared_ptr<ptree> pt = DjangoUtils::getPropertyTree(blocksInBoxUrl(*box));
+	
+	return parseBlocks(pt, *box);
+}
+
+std::string
+DjangoBlockManager::blocksInBoxUrl(const Box<>& box)
+{
 	std::ostringstream os;
 	
 	appendProjectAndStack(os);
 	
-	os << "/blocks_in_box?xmin=" << box->location().x << "&ymin=" << box->location().y << "&zmin=" <<
-		box->location().z << "&width=" << box->size().x << "&height=" << box->size().y <<
-		"&depth=" << box->size().z;
+	os << "/blocks_in_box?xmin=" << box.location().x << "&ymin=" << box.location().y << "&zmin=" <<
+		box.location().z << "&width=" << box.size().x << "&height=" << box.size().y <<
+		"&depth=" << box.size().z;
 	
-	pt = HttpClient::getPropertyTree(os.str());
+	return os.str();
+}
+
+boost::shared_ptr<Blocks>
+DjangoBlockManager::parseBlocks(const boost::shared_ptr<ptree> pt, const Box<>& box)
+{
+	boost::shared_ptr<Blocks> blocks = boost::make_shared<Blocks>();
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
-		LOG_ERROR(djangoblockmanagerlog) << "Django error in blocksInBox: " << *box << std::endl;
+		LOG_ERROR(djangoblockmanagerlog) << "Django error in blocksInBox: " << box << std::endl;
 	}
 	else
 	{
@@ -192,44 +204,91 @@ DjangoBlockManager::blocksInBox(const boost::shared_ptr<Box<> >& box)
 	return blocks;
 }
 
+boost::shared_ptr<Box<> >
+DjangoBlockManager::parseCoreBox(const ptree& pt, unsigned int& id)
+{
+	int signedId = pt.get_child("id").get_value<int>();
+
+	if (signedId < 0)
+	{
+		return boost::shared_ptr<Box<> >();
+	}
+	
+	std::vector<unsigned int> vGeometry;
+	unsigned int geometryCount;
+
+	id = pt.get_child("id").get_value<unsigned int>();
+	geometryCount = HttpClient::ptreeVector<unsigned int>(pt.get_child("box"),
+															vGeometry);
+	
+	if (geometryCount < 6)
+	{
+		LOG_ERROR(djangoblockmanagerlog) << "JSON: core " << id << " box field had " <<
+			geometryCount << " entries, need 6" << std::endl;
+		return boost::shared_ptr<Box<> >();
+	}
+
+	util::point3<unsigned int> loc = util::point3<unsigned int>(vGeometry);
+	util::point3<unsigned int> size = util::point3<unsigned int>(
+		vGeometry[3], vGeometry[4], vGeometry[5]) - loc;
+
+	return boost::make_shared<Box<> >(loc, size);
+}
+
 boost::shared_ptr<Core>
 DjangoBlockManager::parseCore(const ptree& pt)
 {
-	int signedId = pt.get_child("id").get_value<int>();
-	boost::shared_ptr<Core> core;
+	unsigned int id;
+	boost::shared_ptr<Box<> > box = parseCoreBox(pt, id);
 
-	if (signedId >= 0)
+	if (!box)
 	{
-		
-		std::vector<unsigned int> vGeometry;
-		unsigned int id, geometryCount;
+		return boost::shared_ptr<Core>();
+	}
 
-		id = pt.get_child("id").get_value<unsigned int>();
-		geometryCount = HttpClient::ptreeVector<unsigned int>(pt.get_child("box"),
-																vGeometry);
-		
-		if (geometryCount < 6)
+	return boost::make_shared<Core>(id, blocksInBox(box));
+}
+
+std::vector<boost::shared_ptr<Core> >
+DjangoBlockManager::parseCores(const ptree& pt)
+{
+	std::vector<boost::shared_ptr<Core> > cores;
+	std::vector<unsigned int> ids;
+	std::vector<boost::shared_ptr<Box<> > > boxes;
+	std::vector<HttpSession::Request> requests;
+
+	foreach (const ptree::value_type& v, pt)
+	{
+		unsigned int id = 0;
+		boost::shared_ptr<Box<> > box = parseCoreBox(v.second, id);
+
+		ids.push_back(id);
+		boxes.push_back(box);
+
+		if (box)
 		{
-			LOG_ERROR(djangoblockmanagerlog) << "JSON: core " << id << " box field had " <<
-				geometryCount << " entries, need 6" << std::endl;
-			core = boost::shared_ptr<Core>();
+			requests.push_back(HttpSession::Request(blocksInBoxUrl(*box)));
+		}
+	}
+
+	// The blocks of the cores don't depend on each other, get them all at once.
+	std::vector<boost::shared_ptr<ptree> > blockPts = DjangoUtils::getPropertyTrees(requests);
+	unsigned int next = 0;
+
+	for (unsigned int i = 0; i < boxes.size(); ++i)
+	{
+		if (boxes[i])
+		{
+			cores.push_back(boost::make_shared<Core>(ids[i],
+													 parseBlocks(blockPts[next++], *boxes[i])));
 		}
 		else
 		{
-			util::point3<unsigned int> loc = util::point3<unsigned int>(vGeometry);
-			util::point3<unsigned int> size = util::point3<unsigned int>(
-				vGeometry[3], vGeometry[4], vGeometry[5]) - loc;
-			boost::shared_ptr<Box<> > box = boost::make_shared<Box<> >(loc, size);
-			boost::shared_ptr<Blocks> blocks = blocksInBox(box);
-			core = boost::make_shared<Core>(id, blocks);
+			cores.push_back(boost::shared_ptr<Core>());
 		}
 	}
-	else
-	{
-		core = boost::shared_ptr<Core>();
-	}
 
-	return core;
+	return cores;
 }
 
 boost::shared_ptr<Core>
@@ -254,7 +313,7 @@ DjangoBlockManager::coreAtLocation(const util::point3<unsigned int>& location)
 			appendProjectAndStack(os);
 			os << "/core_at_location?x=" << loc.x << "&y=" << loc.y << "&z=" <<loc.z;
 
-			pt = HttpClient::getPropertyTree(os.str());
+			pt = DjangoUtils::getPropertyTree(os.str());
 			if (HttpClient::checkDjangoError(pt))
 			{
 				LOG_ERROR(djangoblockmanagerlog) << "Django error in coreAtLocation" << std::endl;
@@ -300,7 +359,7 @@ DjangoBlockManager::coresInBox(const boost::shared_ptr<Box<> > box)
 		box->location().z << "&width=" << box->size().x << "&height=" << box->size().y <<
 		"&depth=" << box->size().z;
 
-	pt = HttpClient::getPropertyTree(os.str());
+	pt = DjangoUtils::getPropertyTree(os.str());
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -308,10 +367,8 @@ DjangoBlockManager::coresInBox(const boost::shared_ptr<Box<> > box)
 	}
 	else
 	{
-		foreach (ptree::value_type v, pt->get_child("cores"))
+		foreach (boost::shared_ptr<Core> core, parseCores(pt->get_child("cores")))
 		{
-			boost::shared_ptr<Core> core = parseCore(v.second);
-
 			if (core && !_locationCoreMap.count(core->location()))
 			{
 				insertCore(core);
@@ -334,7 +391,7 @@ bool DjangoBlockManager::getFlag(const unsigned int id, const std::string& flagN
 	appendProjectAndStack(os);
 	os << "/get_" << flagName << "?" << idVar << "=" << id;
 
-	pt = HttpClient::getPropertyTree(os.str());
+	pt = DjangoUtils::getPropertyTree(os.str());
 
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -357,7 +414,7 @@ void DjangoBlockManager::setFlag(const unsigned int id, const std::string& flagN
 	appendProjectAndStack(os);
 	os << "/set_" << flagName << "?" << idVar << "=" << id << "&flag=" << iFlag;
 	
-	pt = HttpClient::getPropertyTree(os.str());
+	pt = DjangoUtils::getPropertyTree(os.str());
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -477,7 +534,7 @@ DjangoBlockManager::blocksById(std::vector<unsigned int>& ids)
 	
 	if (needRequest)
 	{
-		boost::shared_ptr<ptree> pt = HttpClient::postPropertyTree(url.str(), post.str());
+		boost::shared_ptr<ptree> pt = DjangoUtils::postPropertyTree(url.str(), post.str());
 		
 		if (HttpClient::checkDjangoError(pt))
 		{
@@ -528,7 +585,7 @@ DjangoBlockManager::coresById(std::vector<unsigned int>& ids)
 	
 	if (needRequest)
 	{
-		boost::shared_ptr<ptree> pt = HttpClient::postPropertyTree(url.str(), post.str());
+		boost::shared_ptr<ptree> pt = DjangoUtils::postPropertyTree(url.str(), post.str());
 		
 		if (HttpClient::checkDjangoError(pt))
 		{
@@ -536,10 +593,8 @@ DjangoBlockManager::coresById(std::vector<unsigned int>& ids)
 		}
 		else
 		{
-			foreach (ptree::value_type v, pt->get_child("cores"))
+			foreach (boost::shared_ptr<Core> core, parseCores(pt->get_child("cores")))
 			{
-				boost::shared_ptr<Core> core = parseCore(v.second);
-
 				insertCore(core);
 				
 				cores->add(core);
@@ -93,8 +93,19 @@ private:
 	
 	boost::shared_ptr<Block> parseBlock(const ptree& pt);
 	
+	std::string blocksInBoxUrl(const Box<>& box);
+	
+	boost::shared_ptr<Blocks> parseBlocks(const boost::shared_ptr<ptree> pt, const Box<>& box);
+	
+	boost::shared_ptr<Box<> > parseCoreBox(const ptree& pt, unsigned int& id);
+	
 	boost::shared_ptr<Core> parseCore(const ptree& pt);
 	
+	/**
+	 * Parse a list of cores. The blocks of all cores are requested at once.
+	 */
+	std::vector<boost::shared_ptr<Core> > parseCores(const ptree& pt);
+	
 	bool getFlag(const unsigned int id, const std::string& flagName,
 				 const std::string& idVar);
 	void setFlag(const unsigned int id, const std::string& flagName, bool flag,
@@ -2,16 +2,37 @@
 #include <util/httpclient.h>
 #include <util/Logger.h>
 #include <catmaid/django/DjangoUtils.h>
+#include <catmaid/django/BulkMatrix.h>
 #include <boost/algorithm/string/replace.hpp>
+#include <trace/Tracer.h>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
 
 logger::LogChannel djangosegmentstorelog("djangosegmentstorelog", "[DjangoSegmentStore] ");
 
+util::ProgramOption optionDjangoTextTransfer(
+		util::_module           = "djangoHttp",
+		util::_long_name        = "textTransfer",
+		util::_description_text = "Transfer segment features and costs as text, even if the server supports binary bulk transfers.");
+
+util::ProgramOption optionDjangoMaxRequestSize(
+		util::_module           = "djangoHttp",
+		util::_long_name        = "maxRequestSize",
+		util::_description_text = "The maximal size in bytes of a single binary bulk transfer. Larger transfers are split.",
+		util::_default_value    = 8*1024*1024);
+
+util::ProgramOption optionDjangoSinglePrecisionFeatures(
+		util::_module           = "djangoHttp",
+		util::_long_name        = "singlePrecisionFeatures",
+		util::_description_text = "Send segment features as 32-bit floats in binary bulk transfers.");
+
 DjangoSegmentStore::DjangoSegmentStore(boost::shared_ptr<DjangoSliceStore> sliceStore):
 	_sliceStore(sliceStore),
 	_server(_sliceStore->getDjangoBlockManager()->getServer()),
 	_project(_sliceStore->getDjangoBlockManager()->getProject()),
 	_stack(_sliceStore->getDjangoBlockManager()->getStack()),
-	_featureNamesFlag(false)
+	_featureNamesFlag(false),
+	_transferFormat(UnknownTransfer)
 {
 
 }
@@ -20,6 +41,8 @@ void
 DjangoSegmentStore::associate(pipeline::Value<Segments> segments,
 							  pipeline::Value<Block> block)
 {
+	TRACE_SCOPE("DjangoSegmentStore::associate");
+
 	if (segments->size() == 0)
 		return;
 
@@ -69,7 +92,7 @@ DjangoSegmentStore::associate(pipeline::Value<Segments> segments,
 			++i;
 		}
 		
-		insertPt = HttpClient::postPropertyTree(insertUrl.str(), insertPostData.str());
+		insertPt = DjangoUtils::postPropertyTree(insertUrl.str(), insertPostData.str());
 		
 		if (HttpClient::checkDjangoError(insertPt))
 		{
@@ -98,7 +121,7 @@ DjangoSegmentStore::associate(pipeline::Value<Segments> segments,
 		
 		assocPost << "&block=" << block->getId();
 		
-		assocPt = HttpClient::postPropertyTree(assocUrl.str(), assocPost.str());
+		assocPt = DjangoUtils::postPropertyTree(assocUrl.str(), assocPost.str());
 		
 		if (HttpClient::checkDjangoError(assocPt))
 		{
@@ -113,10 +136,11 @@ DjangoSegmentStore::associate(pipeline::Value<Segments> segments,
 pipeline::Value<Segments>
 DjangoSegmentStore::retrieveSegments(pipeline::Value<Blocks> blocks)
 {
+	TRACE_SCOPE("DjangoSegmentStore::retrieveSegments");
+
 	std::ostringstream url;
 	std::ostringstream post;
 	std::string delim = "";
-	boost::shared_ptr<ptree> pt;
 	pipeline::Value<Segments> segments = pipeline::Value<Segments>();
 	
 	appendProjectAndStack(url);
@@ -133,24 +157,49 @@ DjangoSegmentStore::retrieveSegments(pipeline::Value<Blocks> blocks)
 			<< "requesting segments from " << url.str()
 			<< ", " << post.str() << std::endl;
 	
-	pt = HttpClient::postPropertyTree(url.str(), post.str());
-	
-	if (!HttpClient::checkDjangoError(pt) &&
-		pt->get_child("ok").get_value<std::string>().compare("true") == 0)
+	std::string json = DjangoUtils::post(url.str(), post.str());
+	std::string key, ok;
+	std::vector<SegmentDescription> descriptions;
+
 	{
-		ptree segmentsTree = pt->get_child("segments");
+		TRACE_SCOPE("DjangoSegmentStore::readSegments");
 
+		JsonReader reader(json);
+		reader.beginObject();
+		while (reader.nextMember(key))
+		{
+			if (key == "ok")
+			{
+				ok = reader.readString();
+			}
+			else if (key == "segments")
+			{
+				reader.beginArray();
+				while (reader.nextElement())
+				{
+					descriptions.push_back(readSegmentDescription(reader));
+				}
+			}
+			else
+			{
+				reader.skipValue();
+			}
+		}
+	}
+	
+	if (ok == "true")
+	{
 		LOG_DEBUG(djangosegmentstorelog)
 			<< "requesting all slices in the same blocks" << std::endl;
 		
 		// Force the slice store to cache the necessary slices.
 		_sliceStore->retrieveSlices(blocks);
 
-		LOG_DEBUG(djangosegmentstorelog) << "create segments from ptree" << std::endl;
+		LOG_DEBUG(djangosegmentstorelog) << "create segments from descriptions" << std::endl;
 		
-		foreach (ptree::value_type segmentV, segmentsTree)
+		foreach (const SegmentDescription& description, descriptions)
 		{
-			boost::shared_ptr<Segment> segment = ptreeToSegment(segmentV.second);
+			boost::shared_ptr<Segment> segment = descriptionToSegment(description);
 			segments->add(segment);
 			if (!_idSegmentMap.count(segment->getId()))
 			{
@@ -160,6 +209,11 @@ DjangoSegmentStore::retrieveSegments(pipeline::Value<Blocks> blocks)
 
 		LOG_DEBUG(djangosegmentstorelog) << "done" << std::endl;
 	}
+	else
+	{
+		HttpClient::checkDjangoError(DjangoUtils::parseJson(json, url.str()));
+		LOG_ERROR(djangosegmentstorelog) << "Error retrieving segments" << std::endl;
+	}
 	
 	return segments;
 }
@@ -177,7 +231,7 @@ DjangoSegmentStore::getAssociatedBlocks(pipeline::Value<Segment> segment)
 	
 	appendProjectAndStack(url);
 	url << "/blocks_by_segment?hash=" << hash;
-	pt = HttpClient::getPropertyTree(url.str());
+	pt = DjangoUtils::getPropertyTree(url.str());
 	
 	// Check for problems.
 	if (HttpClient::checkDjangoError(pt) ||
@@ -200,6 +254,11 @@ DjangoSegmentStore::getAssociatedBlocks(pipeline::Value<Segment> segment)
 
 int DjangoSegmentStore::storeFeatures(pipeline::Value<Features> features)
 {
+	TRACE_SCOPE("DjangoSegmentStore::storeFeatures");
+
+	if (useBinaryTransfer())
+		return storeFeaturesBinary(features);
+
 	unsigned int i = 0;
 	std::map<unsigned int, unsigned int> idMap = features->getSegmentsIdsMap();
 	std::map<unsigned int, unsigned int>::const_iterator it;
@@ -235,7 +294,7 @@ int DjangoSegmentStore::storeFeatures(pipeline::Value<Features> features)
 	
 	data << "n=" << i;
 	
-	pt = HttpClient::postPropertyTree(url.str(), data.str());
+	pt = DjangoUtils::postPropertyTree(url.str(), data.str());
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -261,6 +320,11 @@ int DjangoSegmentStore::storeFeatures(pipeline::Value<Features> features)
 pipeline::Value<SegmentStore::SegmentFeaturesMap>
 DjangoSegmentStore::retrieveFeatures(pipeline::Value<Segments> segments)
 {
+	TRACE_SCOPE("DjangoSegmentStore::retrieveFeatures");
+
+	if (useBinaryTransfer())
+		return retrieveFeaturesBinary(segments);
+
 	pipeline::Value<SegmentStore::SegmentFeaturesMap> featureMap = 
 		pipeline::Value<SegmentStore::SegmentFeaturesMap>();
 	boost::shared_ptr<ptree> pt;
@@ -280,7 +344,7 @@ DjangoSegmentStore::retrieveFeatures(pipeline::Value<Segments> segments)
 		delim = ",";
 	}
 	
-	pt = HttpClient::postPropertyTree(url.str(), post.str());
+	pt = DjangoUtils::postPropertyTree(url.str(), post.str());
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -319,7 +383,7 @@ DjangoSegmentStore::getFeatureNames()
 	
 	url << "/feature_names";
 	
-	pt = HttpClient::getPropertyTree(url.str());
+	pt = DjangoUtils::getPropertyTree(url.str());
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -340,6 +404,11 @@ unsigned int
 DjangoSegmentStore::storeCost(pipeline::Value<Segments> segments,
 							  pipeline::Value<LinearObjective> objective)
 {
+	TRACE_SCOPE("DjangoSegmentStore::storeCost");
+
+	if (useBinaryTransfer())
+		return storeCostBinary(segments, objective);
+
 	unsigned int i = 0;
 	const std::vector<double> coefs = objective->getCoefficients();
 	std::ostringstream url;
@@ -363,7 +432,7 @@ DjangoSegmentStore::storeCost(pipeline::Value<Segments> segments,
 		}
 	}
 	
-	pt = HttpClient::postPropertyTree(url.str(), post.str());
+	pt = DjangoUtils::postPropertyTree(url.str(), post.str());
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -388,12 +457,49 @@ pipeline::Value<LinearObjective>
 DjangoSegmentStore::retrieveCost(pipeline::Value<Segments> segments,
 								 double defaultCost, pipeline::Value<Segments> segmentsNF)
 {
+	TRACE_SCOPE("DjangoSegmentStore::retrieveCost");
+
 	pipeline::Value<LinearObjective> objective = pipeline::Value<LinearObjective>();
+	std::map<std::string, double> hashCostMap;
+	
+	bool ok = (useBinaryTransfer() ?
+			retrieveCostBinary(segments, hashCostMap) :
+			retrieveCostText(segments, hashCostMap));
+	
+	if (ok)
+	{
+		unsigned int i = 0;
+		
+		objective->resize(segments->size());
+		
+		// Iterate through the segments, pushing their cost to the objective, if it exists
+		foreach (boost::shared_ptr<Segment> segment, segments->getSegments())
+		{
+			std::string hash = getHash(segment);
+			if (hashCostMap.count(hash))
+			{
+				objective->setCoefficient(i, hashCostMap[hash]);
+			}
+			else
+			{
+				objective->setCoefficient(i, defaultCost);
+				segmentsNF->add(segment);
+			}
+			++i;
+		}
+	}
+	
+	return objective;
+}
+
+bool
+DjangoSegmentStore::retrieveCostText(pipeline::Value<Segments> segments,
+									 std::map<std::string, double>& hashCostMap)
+{
 	std::ostringstream url;
 	std::ostringstream post;
 	boost::shared_ptr<ptree> pt;
 	std::string delim = "";
-	std::map<std::string, double> hashCostMap;
 	
 	appendProjectAndStack(url);
 	url << "/costs_by_segments";
@@ -408,16 +514,13 @@ DjangoSegmentStore::retrieveCost(pipeline::Value<Segments> segments,
 		delim = ",";
 	}
 	
-	pt = HttpClient::postPropertyTree(url.str(), post.str());
+	pt = DjangoUtils::postPropertyTree(url.str(), post.str());
 	
 	if (!HttpClient::checkDjangoError(pt) &&
 		pt->get_child("ok").get_value<std::string>().compare("true") == 0)
 	{
-		unsigned int i = 0;
 		ptree costTree = pt->get_child("costs");
 		
-		objective->resize(segments->size());
-		
 		// Populate the hash->cost map from the result
 		foreach (ptree::value_type costNode, costTree)
 		{
@@ -427,30 +530,15 @@ DjangoSegmentStore::retrieveCost(pipeline::Value<Segments> segments,
 			hashCostMap[hash] = cost;
 		}
 		
-		// Iterate through the segments, pushing their cost to the objective, if it exists
-		foreach (boost::shared_ptr<Segment> segment, segments->getSegments())
-		{
-			std::string hash = getHash(segment);
-			if (hashCostMap.count(hash))
-			{
-				objective->setCoefficient(i, hashCostMap[hash]);
-			}
-			else
-			{
-				objective->setCoefficient(i, defaultCost);
-				segmentsNF->add(segment);
-			}
-			++i;
-		}
-		
+		return true;
 	}
 	else
 	{
 		LOG_ERROR(djangosegmentstorelog) << "Error while retrieving segment costs from url " <<
 			url.str() << std::endl;
+		
+		return false;
 	}
-	
-	return objective;
 }
 
 unsigned int
@@ -459,6 +547,8 @@ DjangoSegmentStore::storeSolution(pipeline::Value<Segments> segments,
 								  pipeline::Value<Solution> solution,
 								  std::vector<unsigned int> indices)
 {
+	TRACE_SCOPE("DjangoSegmentStore::storeSolution");
+
 	unsigned int count = 0, i = 0;
 	std::ostringstream url;
 	std::ostringstream post;
@@ -485,7 +575,7 @@ DjangoSegmentStore::storeSolution(pipeline::Value<Segments> segments,
 		++i;
 	}
 	
-	pt = HttpClient::postPropertyTree(url.str(), post.str());
+	pt = DjangoUtils::postPropertyTree(url.str(), post.str());
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -511,6 +601,8 @@ pipeline::Value<Solution>
 DjangoSegmentStore::retrieveSolution(pipeline::Value<Segments> segments,
 									 pipeline::Value<Core> core)
 {
+	TRACE_SCOPE("DjangoSegmentStore::retrieveSolution");
+
 	std::ostringstream url;
 	std::ostringstream post;
 	boost::shared_ptr<ptree> pt;
@@ -527,7 +619,7 @@ DjangoSegmentStore::retrieveSolution(pipeline::Value<Segments> segments,
 		delim = ",";
 	}
 	
-	pt = HttpClient::postPropertyTree(url.str(), post.str());
+	pt = DjangoUtils::postPropertyTree(url.str(), post.str());
 	
 	if (!HttpClient::checkDjangoError(pt))
 	{
@@ -569,6 +661,224 @@ DjangoSegmentStore::retrieveSolution(pipeline::Value<Segments> segments,
 }
 
 
+bool
+DjangoSegmentStore::useBinaryTransfer()
+{
+	if (_transferFormat == UnknownTransfer)
+	{
+		_transferFormat = TextTransfer;
+		
+		if (!optionDjangoTextTransfer)
+		{
+			std::ostringstream url;
+			
+			appendProjectAndStack(url);
+			url << "/bulk_transfer_formats";
+			
+			try
+			{
+				boost::shared_ptr<ptree> pt = DjangoUtils::getPropertyTree(url.str());
+				
+				if (!HttpClient::checkDjangoError(pt) && HttpClient::ptreeHasChild(pt, "formats"))
+				{
+					foreach (ptree::value_type formatNode, pt->get_child("formats"))
+					{
+						if (formatNode.second.get_value<std::string>() == BulkMatrix::FormatName)
+						{
+							_transferFormat = BinaryTransfer;
+						}
+					}
+				}
+			}
+			catch (IOError&)
+			{
+				// Servers that don't support bulk transfers don't know this url, either.
+				LOG_DEBUG(djangosegmentstorelog) << "server does not list bulk transfer formats" << std::endl;
+			}
+		}
+		
+		LOG_DEBUG(djangosegmentstorelog)
+				<< "transferring features and costs as "
+				<< (_transferFormat == BinaryTransfer ? "binary" : "text") << std::endl;
+	}
+	
+	return _transferFormat == BinaryTransfer;
+}
+
+int
+DjangoSegmentStore::storeFeaturesBinary(pipeline::Value<Features> features)
+{
+	std::map<unsigned int, unsigned int> idMap = features->getSegmentsIdsMap();
+	std::map<unsigned int, unsigned int>::const_iterator it;
+	BulkMatrix matrix(optionDjangoSinglePrecisionFeatures ? 4 : 8);
+	
+	setFeatureNames(features->getNames());
+	
+	for (it = idMap.begin(); it != idMap.end(); ++it)
+	{
+		if (_idSegmentMap.count(it->first))
+		{
+			matrix.addRow(getHash(_idSegmentMap[it->first]), (*features)[it->second]);
+		}
+	}
+	
+	return postBulkMatrix("store_segment_features_binary", matrix);
+}
+
+pipeline::Value<SegmentStore::SegmentFeaturesMap>
+DjangoSegmentStore::retrieveFeaturesBinary(pipeline::Value<Segments> segments)
+{
+	pipeline::Value<SegmentStore::SegmentFeaturesMap> featureMap = 
+		pipeline::Value<SegmentStore::SegmentFeaturesMap>();
+	std::vector<BulkMatrix> answers;
+	
+	if (!retrieveBulkMatrices("features_by_segments_binary", segments, answers))
+	{
+		LOG_ERROR(djangosegmentstorelog) << "Error while retrieving features" << std::endl;
+		return featureMap;
+	}
+	
+	foreach (const BulkMatrix& answer, answers)
+	{
+		for (unsigned int i = 0; i < answer.rows(); ++i)
+		{
+			std::string hash = answer.hash(i);
+			
+			if (_hashSegmentMap.count(hash))
+			{
+				(*featureMap)[_hashSegmentMap[hash]] = answer.row(i);
+			}
+		}
+	}
+	
+	return featureMap;
+}
+
+unsigned int
+DjangoSegmentStore::storeCostBinary(pipeline::Value<Segments> segments,
+									pipeline::Value<LinearObjective> objective)
+{
+	const std::vector<double> coefs = objective->getCoefficients();
+	BulkMatrix matrix;
+	unsigned int i = 0;
+	
+	foreach (boost::shared_ptr<Segment> segment, segments->getSegments())
+	{
+		if (i >= coefs.size())
+		{
+			break;
+		}
+		
+		matrix.addRow(getHash(segment), coefs[i]);
+		++i;
+	}
+	
+	return postBulkMatrix("store_segment_costs_binary", matrix);
+}
+
+bool
+DjangoSegmentStore::retrieveCostBinary(pipeline::Value<Segments> segments,
+									   std::map<std::string, double>& hashCostMap)
+{
+	std::vector<BulkMatrix> answers;
+	
+	if (!retrieveBulkMatrices("costs_by_segments_binary", segments, answers))
+	{
+		LOG_ERROR(djangosegmentstorelog) << "Error while retrieving segment costs" << std::endl;
+		return false;
+	}
+	
+	foreach (const BulkMatrix& answer, answers)
+	{
+		if (answer.rows() > 0 && answer.columns() != 1)
+		{
+			LOG_ERROR(djangosegmentstorelog) << "Expected one cost per segment, got " <<
+				answer.columns() << std::endl;
+			return false;
+		}
+		
+		for (unsigned int i = 0; i < answer.rows(); ++i)
+		{
+			hashCostMap[answer.hash(i)] = answer.value(i, 0);
+		}
+	}
+	
+	return true;
+}
+
+int
+DjangoSegmentStore::postBulkMatrix(const std::string& request, const BulkMatrix& matrix)
+{
+	std::ostringstream url;
+	std::vector<HttpSession::Request> requests;
+	int count = 0;
+	
+	appendProjectAndStack(url);
+	url << "/" << request;
+	
+	foreach (const std::string& chunk, matrix.encodeChunks(optionDjangoMaxRequestSize.as<size_t>()))
+	{
+		requests.push_back(HttpSession::Request(url.str(), chunk, BulkMatrix::ContentType));
+	}
+	
+	LOG_DEBUG(djangosegmentstorelog) << "sending " << matrix.rows() << " rows in " <<
+		requests.size() << " requests to " << url.str() << std::endl;
+	
+	foreach (boost::shared_ptr<ptree> pt, DjangoUtils::getPropertyTrees(requests))
+	{
+		if (HttpClient::checkDjangoError(pt))
+		{
+			LOG_ERROR(djangosegmentstorelog) << "Error in bulk transfer" << std::endl;
+			LOG_ERROR(djangosegmentstorelog) << "\tURL was " << url.str() << std::endl;
+		}
+		
+		if (HttpClient::ptreeHasChild(pt, "count"))
+		{
+			count += pt->get_child("count").get_value<int>();
+		}
+	}
+	
+	return count;
+}
+
+bool
+DjangoSegmentStore::retrieveBulkMatrices(const std::string& request,
+										 pipeline::Value<Segments> segments,
+										 std::vector<BulkMatrix>& answers)
+{
+	std::ostringstream url;
+	std::vector<HttpSession::Request> requests;
+	BulkMatrix hashes;
+	
+	appendProjectAndStack(url);
+	url << "/" << request;
+	
+	foreach (boost::shared_ptr<Segment> segment, segments->getSegments())
+	{
+		hashes.addRow(getHash(segment));
+	}
+	
+	foreach (const std::string& chunk, hashes.encodeChunks(optionDjangoMaxRequestSize.as<size_t>()))
+	{
+		requests.push_back(HttpSession::Request(url.str(), chunk, BulkMatrix::ContentType));
+	}
+	
+	foreach (const std::string& response, DjangoUtils::performAll(requests))
+	{
+		if (!BulkMatrix::isEncoded(response))
+		{
+			// errors are reported as JSON
+			HttpClient::checkDjangoError(DjangoUtils::parseJson(response, url.str()));
+			LOG_ERROR(djangosegmentstorelog) << "\tURL was " << url.str() << std::endl;
+			return false;
+		}
+		
+		answers.push_back(BulkMatrix::decode(response));
+	}
+	
+	return true;
+}
+
 void DjangoSegmentStore::dumpStore()
 {
 
@@ -641,7 +951,7 @@ DjangoSegmentStore::setFeatureNames(const std::vector<std::string>& featureNames
 		
 		LOG_DEBUG(djangosegmentstorelog) << "Setting feature names via url: " << url.str() << ", post: " << post.str() << std::endl;
 		
-		pt = HttpClient::postPropertyTree(url.str(), post.str());
+		pt = DjangoUtils::postPropertyTree(url.str(), post.str());
 		
 		if (HttpClient::checkDjangoError(pt) ||
 			pt->get_child("ok").get_value<std::string>().compare("true") != 0)
@@ -656,9 +966,37 @@ DjangoSegmentStore::setFeatureNames(const std::vector<std::string>& featureNames
 	}
 }
 
-boost::shared_ptr<Segment> DjangoSegmentStore::ptreeToSegment(const ptree& pt)
+DjangoSegmentStore::SegmentDescription
+DjangoSegmentStore::readSegmentDescription(JsonReader& reader)
+{
+	SegmentDescription description;
+	std::string key;
+
+	reader.beginObject();
+	while (reader.nextMember(key))
+	{
+		if (key == "hash")
+			description.hash = reader.readString();
+		else if (key == "direction")
+			description.direction = reader.readInt();
+		else if (key == "type")
+			description.type = reader.readInt();
+		else if (key == "slice_a")
+			description.sliceA = reader.readString();
+		else if (key == "slice_b")
+			description.sliceB = reader.readString();
+		else if (key == "slice_c")
+			description.sliceC = reader.readString();
+		else
+			reader.skipValue();
+	}
+
+	return description;
+}
+
+boost::shared_ptr<Segment> DjangoSegmentStore::descriptionToSegment(const SegmentDescription& description)
 {
-	std::string hash = pt.get_child("hash").get_value<std::string>();
+	const std::string& hash = description.hash;
 	if (_hashSegmentMap.count(hash))
 	{
 		return _hashSegmentMap[hash];
@@ -667,8 +1005,8 @@ boost::shared_ptr<Segment> DjangoSegmentStore::ptreeToSegment(const ptree& pt)
 	{
 		boost::shared_ptr<Slice> sliceA, sliceB, sliceC;
 		boost::shared_ptr<Segment> segment;
-		int iDir = pt.get_child("direction").get_value<int>();
-		int type = pt.get_child("type").get_value<int>();
+		int iDir = description.direction;
+		int type = description.type;
 		Direction direction = iDir == 0 ? Left : Right;
 		unsigned int id = Segment::getNextSegmentId();
 
@@ -677,14 +1015,11 @@ boost::shared_ptr<Segment> DjangoSegmentStore::ptreeToSegment(const ptree& pt)
 		switch(type)
 		{
 			case 2:
-				sliceC = _sliceStore->sliceByHash(
-					pt.get_child("slice_c").get_value<std::string>());
+				sliceC = _sliceStore->sliceByHash(description.sliceC);
 			case 1:
-				sliceB = _sliceStore->sliceByHash(
-					pt.get_child("slice_b").get_value<std::string>());
+				sliceB = _sliceStore->sliceByHash(description.sliceB);
 			case 0:
-				sliceA = _sliceStore->sliceByHash(
-					pt.get_child("slice_a").get_value<std::string>());
+				sliceA = _sliceStore->sliceByHash(description.sliceA);
 		}
 		
 		switch(type)
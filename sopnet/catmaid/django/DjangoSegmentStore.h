@@ -5,6 +5,8 @@
 #include <catmaid/persistence/SegmentPointerHash.h>
 #include <catmaid/persistence/SegmentStore.h>
 #include "DjangoSliceStore.h"
+#include "BulkMatrix.h"
+#include "JsonReader.h"
 
 /**
  * DjangoSegmentStore is a CATMAID/Django-backed segment store. Segments, Features,
@@ -85,9 +87,63 @@ private:
 	static unsigned int getSectionInfimum(const boost::shared_ptr<Segment> segment);
 	
 	/**
-	 * Converts a ptree into a Segment.
+	 * Find out whether features and costs can be transferred in binary bulk
+	 * transfers, i.e., whether the server supports them and they are not
+	 * disabled. The answer of the server is cached.
 	 */
-	boost::shared_ptr<Segment> ptreeToSegment(const boost::property_tree::ptree& pt);
+	bool useBinaryTransfer();
+	
+	int storeFeaturesBinary(pipeline::Value<Features> features);
+	
+	pipeline::Value<SegmentFeaturesMap> retrieveFeaturesBinary(pipeline::Value<Segments> segments);
+	
+	unsigned int storeCostBinary(pipeline::Value<Segments> segments,
+								 pipeline::Value<LinearObjective> objective);
+	
+	bool retrieveCostText(pipeline::Value<Segments> segments,
+						  std::map<std::string, double>& hashCostMap);
+	
+	bool retrieveCostBinary(pipeline::Value<Segments> segments,
+							std::map<std::string, double>& hashCostMap);
+	
+	/**
+	 * Send a table to the given request of the server, split into chunks of
+	 * bounded size. Returns the sum of the counts of the answers.
+	 */
+	int postBulkMatrix(const std::string& request, const BulkMatrix& matrix);
+	
+	/**
+	 * Send the hashes of the given segments to the given request of the
+	 * server, split into chunks of bounded size, and collect the tables of
+	 * the answers. Returns false, if the server reported an error.
+	 */
+	bool retrieveBulkMatrices(const std::string& request,
+							  pipeline::Value<Segments> segments,
+							  std::vector<BulkMatrix>& answers);
+	
+	/**
+	 * The description of a Segment in a django answer. The Slices it refers to
+	 * are requested after all descriptions have been read.
+	 */
+	struct SegmentDescription
+	{
+		SegmentDescription() : direction(0), type(-1) {}
+
+		std::string hash;
+		int direction;
+		int type;
+		std::string sliceA, sliceB, sliceC;
+	};
+
+	/**
+	 * Reads the description of a Segment from the next object of the given reader.
+	 */
+	SegmentDescription readSegmentDescription(JsonReader& reader);
+
+	/**
+	 * Converts a description into a Segment.
+	 */
+	boost::shared_ptr<Segment> descriptionToSegment(const SegmentDescription& description);
 	
 	const boost::shared_ptr<DjangoSliceStore> _sliceStore;
 	const std::string _server;
@@ -111,6 +167,16 @@ private:
 	
 	// Set to true if feature names have already been set.
 	bool _featureNamesFlag;
+	
+	// How features and costs are transferred, found out on first use.
+	enum TransferFormat
+	{
+		UnknownTransfer,
+		TextTransfer,
+		BinaryTransfer
+	};
+	
+	TransferFormat _transferFormat;
 };
 
 
@@ -1,11 +1,13 @@
 #include "DjangoSliceStore.h"
 #include "DjangoUtils.h"
+#include "JsonReader.h"
 #include <util/httpclient.h>
 #include <sopnet/slices/ComponentTreeConverter.h>
 #include <imageprocessing/ConnectedComponent.h>
 #include <imageprocessing/Image.h>
 #include <util/point.hpp>
 #include <util/ProgramOptions.h>
+#include <trace/Tracer.h>
 
 logger::LogChannel djangoslicestorelog("djangoslicestorelog", "[DjangoSliceStore] ");
 
@@ -27,6 +29,8 @@ DjangoSliceStore::DjangoSliceStore(const boost::shared_ptr<DjangoBlockManager> b
 void
 DjangoSliceStore::associate(pipeline::Value<Slices> slices, pipeline::Value<Block> block)
 {
+	TRACE_SCOPE("DjangoSliceStore::associate");
+
 	if (slices->size() == 0)
 		return;
 
@@ -72,7 +76,7 @@ DjangoSliceStore::associate(pipeline::Value<Slices> slices, pipeline::Value<Bloc
 			++i;
 		}
 		
-		insertPt = HttpClient::postPropertyTree(insertUrl.str(), insertPostData.str());
+		insertPt = DjangoUtils::postPropertyTree(insertUrl.str(), insertPostData.str());
 
 		if (HttpClient::checkDjangoError(insertPt))
 		{
@@ -101,7 +105,7 @@ DjangoSliceStore::associate(pipeline::Value<Slices> slices, pipeline::Value<Bloc
 		
 		assocPostData << "&block=" << block->getId();
 		
-		assocPt = HttpClient::postPropertyTree(assocUrl.str(), assocPostData.str());
+		assocPt = DjangoUtils::postPropertyTree(assocUrl.str(), assocPostData.str());
 
 		if (HttpClient::checkDjangoError(assocPt))
 		{
@@ -118,10 +122,11 @@ DjangoSliceStore::associate(pipeline::Value<Slices> slices, pipeline::Value<Bloc
 pipeline::Value<Slices>
 DjangoSliceStore::retrieveSlices(pipeline::Value<Blocks> blocks)
 {
+	TRACE_SCOPE("DjangoSliceStore::retrieveSlices");
+
 	std::ostringstream url;
 	std::ostringstream post;
 	std::string delim = "";
-	boost::shared_ptr<ptree> pt;
 	pipeline::Value<Slices> slices = pipeline::Value<Slices>();
 	
 	appendProjectAndStack(url);
@@ -134,15 +139,42 @@ DjangoSliceStore::retrieveSlices(pipeline::Value<Blocks> blocks)
 		delim = ",";
 	}
 	
-	pt = HttpClient::postPropertyTree(url.str(), post.str());
+	std::string json = DjangoUtils::post(url.str(), post.str());
+	std::string key, ok;
+	std::vector<boost::shared_ptr<Slice> > retrieved;
+	
+	// Decode the slices directly from the response. A property tree would hold
+	// a node for each pixel of each slice.
+	{
+		TRACE_SCOPE("DjangoSliceStore::readSlices");
+
+		JsonReader reader(json);
+		reader.beginObject();
+		while (reader.nextMember(key))
+		{
+			if (key == "ok")
+			{
+				ok = reader.readString();
+			}
+			else if (key == "slices")
+			{
+				reader.beginArray();
+				while (reader.nextElement())
+				{
+					retrieved.push_back(readSlice(reader));
+				}
+			}
+			else
+			{
+				reader.skipValue();
+			}
+		}
+	}
 	
-	if (!HttpClient::checkDjangoError(pt) &&
-		pt->get_child("ok").get_value<std::string>().compare("true") == 0)
+	if (ok == "true")
 	{
-		ptree slicesTree = pt->get_child("slices");
-		foreach (ptree::value_type sliceV, slicesTree)
+		foreach (boost::shared_ptr<Slice> slice, retrieved)
 		{
-			boost::shared_ptr<Slice> slice = ptreeToSlice(sliceV.second);
 			slices->add(slice);
 			// Make sure that the slice is in the id slice map
 			if (!_idSliceMap.count(slice->getId()))
@@ -154,6 +186,7 @@ DjangoSliceStore::retrieveSlices(pipeline::Value<Blocks> blocks)
 	}
 	else
 	{
+		HttpClient::checkDjangoError(DjangoUtils::parseJson(json, url.str()));
 		LOG_ERROR(djangoslicestorelog) << "Error retrieving slices" << std::endl;
 	}
 	
@@ -177,7 +210,7 @@ DjangoSliceStore::getAssociatedBlocks(pipeline::Value<Slice> slice)
 	
 	appendProjectAndStack(url);
 	url << "/blocks_by_slice?hash=" << hash;
-	pt = HttpClient::getPropertyTree(url.str());
+	pt = DjangoUtils::getPropertyTree(url.str());
 	
 	// Check for problems.
 	if (HttpClient::checkDjangoError(pt) ||
@@ -201,6 +234,8 @@ DjangoSliceStore::getAssociatedBlocks(pipeline::Value<Slice> slice)
 void
 DjangoSliceStore::storeConflict(pipeline::Value<ConflictSets> conflictSets)
 {
+	TRACE_SCOPE("DjangoSliceStore::storeConflict");
+
 	std::ostringstream url;
 	std::ostringstream post;
 
@@ -239,7 +274,7 @@ DjangoSliceStore::storeConflict(pipeline::Value<ConflictSets> conflictSets)
 			setdelim = "|";
 	}
 
-	boost::shared_ptr<ptree> pt = HttpClient::postPropertyTree(url.str(), post.str());
+	boost::shared_ptr<ptree> pt = DjangoUtils::postPropertyTree(url.str(), post.str());
 	if (HttpClient::checkDjangoError(pt)
 		|| pt->get_child("ok").get_value<std::string>().compare("true") != 0)
 	{
@@ -251,6 +286,8 @@ DjangoSliceStore::storeConflict(pipeline::Value<ConflictSets> conflictSets)
 pipeline::Value<ConflictSets>
 DjangoSliceStore::retrieveConflictSets(pipeline::Value<Slices> slices)
 {
+	TRACE_SCOPE("DjangoSliceStore::retrieveConflictSets");
+
 	boost::unordered_set<ConflictSet> conflictSetSet;
 	pipeline::Value<ConflictSets> conflictSets = pipeline::Value<ConflictSets>();
 
@@ -280,7 +317,7 @@ DjangoSliceStore::retrieveConflictSets(pipeline::Value<Slices> slices)
 	post << hash;
 	putSlice(*(slices->end() - 1), hash);
 
-	pt = HttpClient::postPropertyTree(url.str(), post.str());
+	pt = DjangoUtils::postPropertyTree(url.str(), post.str());
 
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -382,14 +419,58 @@ DjangoSliceStore::appendGeometry(const boost::shared_ptr<ConnectedComponent> com
 }
 
 boost::shared_ptr<Slice>
-DjangoSliceStore::ptreeToSlice(const ptree& pt)
+DjangoSliceStore::readSlice(JsonReader& reader)
 {
-	std::string hash = pt.get_child("hash").get_value<std::string>();
+	std::string key, hash;
+	unsigned int section = 0;
+	double value = 0;
+	std::vector<unsigned int> pixelListX, pixelListY;
+	boost::shared_ptr<Slice> cached;
 	
-	// If we have the hash in the map already, just return the already-instantiated slice.
-	if (_hashSliceMap.count(hash) && !optionDjangoSliceStoreNoCache)
+	reader.beginObject();
+	while (reader.nextMember(key))
 	{
-		return _hashSliceMap[hash];
+		if (key == "hash")
+		{
+			hash = reader.readString();
+			
+			// If we have the hash in the map already, the already-instantiated slice is used.
+			if (_hashSliceMap.count(hash) && !optionDjangoSliceStoreNoCache)
+			{
+				cached = _hashSliceMap[hash];
+			}
+		}
+		else if (key == "section")
+		{
+			section = reader.readUnsigned();
+		}
+		else if (key == "value")
+		{
+			value = reader.readDouble();
+		}
+		// Don't decode the pixels of cached slices (if the hash came first).
+		else if (key == "x" && !cached)
+		{
+			reader.readNumbers(pixelListX);
+		}
+		else if (key == "y" && !cached)
+		{
+			reader.readNumbers(pixelListY);
+		}
+		else
+		{
+			reader.skipValue();
+		}
+	}
+	
+	if (hash.empty())
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"slice in django answer has no hash");
+	
+	if (cached)
+	{
+		return cached;
 	}
 	else
 	{
@@ -399,16 +480,8 @@ DjangoSliceStore::ptreeToSlice(const ptree& pt)
 		boost::shared_ptr<ConnectedComponent::pixel_list_type> pixelList = 
 			boost::make_shared<ConnectedComponent::pixel_list_type>();
 		
-		unsigned int section = pt.get_child("section").get_value<unsigned int>();
-		double value = pt.get_child("value").get_value<double>();
 		unsigned int id = ComponentTreeConverter::getNextSliceId();
 		
-		std::vector<unsigned int> pixelListX, pixelListY;
-		
-		// Parse variables from the ptree
-		HttpClient::ptreeVector<unsigned int>(pt.get_child("x"), pixelListX);
-		HttpClient::ptreeVector<unsigned int>(pt.get_child("y"), pixelListY);
-
 		if (pixelListX.size() != pixelListY.size())
 			UTIL_THROW_EXCEPTION(
 					IOError,
@@ -3,6 +3,7 @@
 
 #include <catmaid/persistence/SliceStore.h>
 #include <catmaid/django/DjangoBlockManager.h>
+#include <catmaid/django/JsonReader.h>
 #include <pipeline/all.h>
 #include <sopnet/slices/Slices.h>
 #include <sopnet/block/Blocks.h>
@@ -58,7 +59,10 @@ private:
 	void appendGeometry(const boost::shared_ptr<ConnectedComponent> component,
 						std::ostringstream& osX, std::ostringstream& osY);
 	
-	boost::shared_ptr<Slice> ptreeToSlice(const boost::property_tree::ptree& pt);
+	/**
+	 * Read a Slice from the next object of the given reader.
+	 */
+	boost::shared_ptr<Slice> readSlice(JsonReader& reader);
 	boost::shared_ptr<ConflictSet> ptreeToConflictSet(const boost::property_tree::ptree& pt);
 	
 	std::string generateSliceHash(const Slice& slice);
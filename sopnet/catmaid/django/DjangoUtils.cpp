@@ -2,6 +2,10 @@
 #include <util/httpclient.h>
 #include <sopnet/slices/Slice.h>
 #include <imageprocessing/ConnectedComponent.h>
+#include <boost/make_shared.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <trace/Tracer.h>
+#include <util/exceptions.h>
 
 void
 DjangoUtils::appendProjectAndStack(std::ostringstream& os, const std::string& server,
@@ -20,7 +24,7 @@ DjangoUtils::getStackSize(const std::string& server, const unsigned int project,
 	appendProjectAndStack(url, server, project, stack);
 	url << "/stack_info";
 	
-	pt = HttpClient::getPropertyTree(url.str());
+	pt = getPropertyTree(url.str());
 	
 	if (HttpClient::checkDjangoError(pt))
 	{
@@ -46,6 +50,71 @@ DjangoUtils::getStackSize(const std::string& server, const unsigned int project,
 	return stackSize;
 }
 
+boost::shared_ptr<ptree>
+DjangoUtils::getPropertyTree(const std::string& url)
+{
+	TRACE_SCOPE("HTTP GET");
+
+	return parseJson(HttpSession::getInstance().get(url), url);
+}
+
+boost::shared_ptr<ptree>
+DjangoUtils::postPropertyTree(const std::string& url, const std::string& data)
+{
+	TRACE_SCOPE("HTTP POST");
+
+	return parseJson(HttpSession::getInstance().post(url, data), url);
+}
+
+std::string
+DjangoUtils::post(const std::string& url, const std::string& data)
+{
+	TRACE_SCOPE("HTTP POST");
+
+	return HttpSession::getInstance().post(url, data);
+}
+
+std::vector<std::string>
+DjangoUtils::performAll(const std::vector<HttpSession::Request>& requests)
+{
+	TRACE_SCOPE("HTTP requests");
+
+	return HttpSession::getInstance().performAll(requests);
+}
+
+std::vector<boost::shared_ptr<ptree> >
+DjangoUtils::getPropertyTrees(const std::vector<HttpSession::Request>& requests)
+{
+	std::vector<std::string> responses = performAll(requests);
+	std::vector<boost::shared_ptr<ptree> > pts;
+
+	for (unsigned int i = 0; i < responses.size(); ++i)
+	{
+		pts.push_back(parseJson(responses[i], requests[i].url));
+	}
+
+	return pts;
+}
+
+boost::shared_ptr<ptree>
+DjangoUtils::parseJson(const std::string& json, const std::string& url)
+{
+	boost::shared_ptr<ptree> pt = boost::make_shared<ptree>();
+	std::istringstream in(json);
+
+	try
+	{
+		boost::property_tree::read_json(in, *pt);
+	}
+	catch (boost::property_tree::json_parser_error&)
+	{
+		BOOST_THROW_EXCEPTION(IOError() << error_message(
+			"invalid JSON response from " + url + ": " + json.substr(0, 200)));
+	}
+
+	return pt;
+}
+
 util::rect<int>
 DjangoUtils::segmentBound(const boost::shared_ptr<Segment> segment)
 {
@@ -4,7 +4,10 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
+#include <catmaid/django/HttpSession.h>
+#include <util/httpclient.h>
 #include <util/point3.hpp>
 #include <util/rect.hpp>
 #include <sopnet/segments/Segment.h>
@@ -35,6 +38,45 @@ public:
 																	const unsigned int project,
 																	const unsigned int stack);
 	
+	/**
+	 * Send a GET request to the given url and parse the JSON response. All
+	 * requests to the Django backend go through these functions, which use
+	 * the keep-alive connections of the shared HttpSession.
+	 */
+	static boost::shared_ptr<ptree> getPropertyTree(const std::string& url);
+
+	/**
+	 * Send a POST request with the given data to the given url and parse the
+	 * JSON response.
+	 */
+	static boost::shared_ptr<ptree> postPropertyTree(const std::string& url,
+													 const std::string& data);
+
+	/**
+	 * Send a POST request with the given data to the given url and return the
+	 * unparsed response. Used for large responses, which are decoded with a
+	 * JsonReader instead.
+	 */
+	static std::string post(const std::string& url, const std::string& data);
+
+	/**
+	 * Send independent requests concurrently and return their unparsed
+	 * responses, in the order of the requests.
+	 */
+	static std::vector<std::string> performAll(const std::vector<HttpSession::Request>& requests);
+
+	/**
+	 * Parse a JSON response from the given url into a property tree.
+	 */
+	static boost::shared_ptr<ptree> parseJson(const std::string& json, const std::string& url);
+
+	/**
+	 * Send independent requests concurrently and parse their JSON responses,
+	 * which are returned in the order of the requests.
+	 */
+	static std::vector<boost::shared_ptr<ptree> > getPropertyTrees(
+			const std::vector<HttpSession::Request>& requests);
+	
 	/**
 	 * A helper function to return a rect that bounds the given segment in 2D
 	 */
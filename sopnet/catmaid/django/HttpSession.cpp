@@ -0,0 +1,394 @@
+#include "HttpSession.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
+#include <util/foreach.h>
+#include <trace/Tracer.h>
+
+logger::LogChannel httpsessionlog("httpsessionlog", "[HttpSession] ");
+
+util::ProgramOption optionHttpMaxConnections(
+		util::_module           = "djangoHttp",
+		util::_long_name        = "maxConnections",
+		util::_description_text = "The maximal number of keep-alive connections to the Django server.",
+		util::_default_value    = 8);
+
+util::ProgramOption optionHttpCompressRequests(
+		util::_module           = "djangoHttp",
+		util::_long_name        = "compressRequests",
+		util::_description_text = "Send large request bodies gzip-compressed. The server has to accept 'Content-Encoding: gzip'.");
+
+util::ProgramOption optionHttpCompressThreshold(
+		util::_module           = "djangoHttp",
+		util::_long_name        = "compressThreshold",
+		util::_description_text = "The minimal size in bytes of a request body to be compressed.",
+		util::_default_value    = 4096);
+
+util::ProgramOption optionHttpTimeout(
+		util::_module           = "djangoHttp",
+		util::_long_name        = "timeout",
+		util::_description_text = "The timeout of a single request in seconds (0 for none).",
+		util::_default_value    = 0);
+
+HttpSession&
+HttpSession::getInstance()
+{
+	static struct GlobalInit
+	{
+		GlobalInit() { curl_global_init(CURL_GLOBAL_ALL); }
+	} globalInit;
+
+	static HttpSession session(optionHttpMaxConnections.as<unsigned int>());
+
+	return session;
+}
+
+HttpSession::HttpSession(unsigned int maxConnections) :
+	_maxConnections(std::max(maxConnections, 1u)),
+	_share(curl_share_init())
+{
+	curl_share_setopt(_share, CURLSHOPT_LOCKFUNC, &HttpSession::lockShare);
+	curl_share_setopt(_share, CURLSHOPT_UNLOCKFUNC, &HttpSession::unlockShare);
+	curl_share_setopt(_share, CURLSHOPT_USERDATA, this);
+	curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+HttpSession::~HttpSession()
+{
+	foreach (CURLM* multi, _idleMultis)
+	{
+		curl_multi_cleanup(multi);
+	}
+
+	foreach (CURL* handle, _idleHandles)
+	{
+		curl_easy_cleanup(handle);
+	}
+
+	curl_share_cleanup(_share);
+}
+
+std::string
+HttpSession::get(const std::string& url)
+{
+	return performAll(std::vector<Request>(1, Request(url)))[0];
+}
+
+std::string
+HttpSession::post(const std::string& url, const std::string& data, const std::string& contentType)
+{
+	return performAll(std::vector<Request>(1, Request(url, data, contentType)))[0];
+}
+
+std::vector<std::string>
+HttpSession::performAll(const std::vector<Request>& requests)
+{
+	TRACE_SCOPE("HttpSession::performAll");
+
+	std::vector<Transfer> transfers(requests.size());
+	std::vector<std::string> responses(requests.size());
+
+	CURLM* multi = acquireMulti();
+
+	std::string error;
+
+	try
+	{
+		for (unsigned int i = 0; i < requests.size(); ++i)
+		{
+			prepare(requests[i], transfers[i]);
+			curl_multi_add_handle(multi, transfers[i].handle);
+		}
+
+		int running = 0;
+
+		do
+		{
+			CURLMcode code = curl_multi_perform(multi, &running);
+
+			if (code == CURLM_OK && running > 0)
+			{
+				code = curl_multi_wait(multi, 0, 0, 1000, 0);
+			}
+
+			if (code != CURLM_OK)
+			{
+				error = curl_multi_strerror(code);
+				break;
+			}
+
+			int remaining;
+			while (CURLMsg* message = curl_multi_info_read(multi, &remaining))
+			{
+				if (message->msg != CURLMSG_DONE || !error.empty())
+				{
+					continue;
+				}
+
+				char* url;
+				curl_easy_getinfo(message->easy_handle, CURLINFO_EFFECTIVE_URL, &url);
+
+				if (message->data.result != CURLE_OK)
+				{
+					error = std::string(curl_easy_strerror(message->data.result)) + " for " + url;
+					continue;
+				}
+
+				long status = 0;
+				curl_easy_getinfo(message->easy_handle, CURLINFO_RESPONSE_CODE, &status);
+
+				if (status >= 400)
+				{
+					std::string body;
+					for (unsigned int i = 0; i < transfers.size(); ++i)
+					{
+						if (transfers[i].handle == message->easy_handle)
+						{
+							body = transfers[i].response.substr(0, 200);
+						}
+					}
+
+					std::ostringstream os;
+					os << "HTTP status " << status << " for " << url << ": " << body;
+					error = os.str();
+				}
+			}
+		}
+		while (running > 0);
+	}
+	catch (...)
+	{
+		// e.g., a request could not be prepared -- don't leak the handles
+		finishAll(multi, transfers);
+		throw;
+	}
+
+	for (unsigned int i = 0; i < transfers.size(); ++i)
+	{
+		responses[i].swap(transfers[i].response);
+	}
+
+	finishAll(multi, transfers);
+
+	if (!error.empty())
+	{
+		LOG_ERROR(httpsessionlog) << "request failed: " << error << std::endl;
+		BOOST_THROW_EXCEPTION(IOError() << error_message("HTTP request failed: " + error));
+	}
+
+	return responses;
+}
+
+void
+HttpSession::prepare(const Request& request, Transfer& transfer)
+{
+	transfer.handle = acquireHandle();
+
+	CURL* handle = transfer.handle;
+
+	curl_easy_setopt(handle, CURLOPT_URL, request.url.c_str());
+	curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, &HttpSession::onData);
+	curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer.response);
+
+	// don't wait for a "100 Continue" before sending large bodies
+	transfer.headers = curl_slist_append(transfer.headers, "Expect:");
+
+	if (request.post)
+	{
+		if (optionHttpCompressRequests &&
+			request.data.size() >= optionHttpCompressThreshold.as<size_t>())
+		{
+			transfer.body = gzip(request.data);
+			transfer.headers = curl_slist_append(transfer.headers, "Content-Encoding: gzip");
+
+			LOG_ALL(httpsessionlog) << "compressed request body from " << request.data.size()
+				<< " to " << transfer.body.size() << " bytes" << std::endl;
+		}
+		else
+		{
+			transfer.body = request.data;
+		}
+
+		// curl sends form data by default
+		if (!request.contentType.empty())
+		{
+			transfer.headers = curl_slist_append(transfer.headers,
+				("Content-Type: " + request.contentType).c_str());
+		}
+
+		curl_easy_setopt(handle, CURLOPT_POST, 1L);
+		curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, (long)transfer.body.size());
+		curl_easy_setopt(handle, CURLOPT_POSTFIELDS, transfer.body.c_str());
+	}
+	else
+	{
+		curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+	}
+
+	curl_easy_setopt(handle, CURLOPT_HTTPHEADER, transfer.headers);
+
+	TRACE_COUNT("http requests", 1);
+	TRACE_COUNT("http bytes sent", request.url.size() + transfer.body.size());
+}
+
+void
+HttpSession::finish(Transfer& transfer)
+{
+	double received = 0;
+	curl_easy_getinfo(transfer.handle, CURLINFO_SIZE_DOWNLOAD, &received);
+	TRACE_COUNT("http bytes received", received);
+
+	curl_easy_setopt(transfer.handle, CURLOPT_HTTPHEADER, 0);
+	curl_slist_free_all(transfer.headers);
+	transfer.headers = 0;
+
+	releaseHandle(transfer.handle);
+	transfer.handle = 0;
+}
+
+void
+HttpSession::finishAll(CURLM* multi, std::vector<Transfer>& transfers)
+{
+	foreach (Transfer& transfer, transfers)
+	{
+		// not prepared
+		if (!transfer.handle)
+		{
+			continue;
+		}
+
+		curl_multi_remove_handle(multi, transfer.handle);
+		finish(transfer);
+	}
+
+	releaseMulti(multi);
+}
+
+CURL*
+HttpSession::acquireHandle()
+{
+	{
+		boost::mutex::scoped_lock lock(_handlesMutex);
+
+		if (!_idleHandles.empty())
+		{
+			CURL* handle = _idleHandles.back();
+			_idleHandles.pop_back();
+			return handle;
+		}
+	}
+
+	CURL* handle = curl_easy_init();
+
+	if (!handle)
+	{
+		BOOST_THROW_EXCEPTION(IOError() << error_message("can not create a curl handle"));
+	}
+
+	curl_easy_setopt(handle, CURLOPT_SHARE, _share);
+	curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+	// an empty string accepts all encodings curl can decode, i.e., gzip and deflate
+	curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
+	curl_easy_setopt(handle, CURLOPT_TIMEOUT, optionHttpTimeout.as<long>());
+
+	return handle;
+}
+
+void
+HttpSession::releaseHandle(CURL* handle)
+{
+	boost::mutex::scoped_lock lock(_handlesMutex);
+
+	// The open connections live in the connection caches of the multi
+	// handles, reusing the handle only saves setting it up again. Surplus handles from large
+	// performAll() calls are dropped.
+	if (_idleHandles.size() < _maxConnections)
+	{
+		_idleHandles.push_back(handle);
+	}
+	else
+	{
+		curl_easy_cleanup(handle);
+	}
+}
+
+CURLM*
+HttpSession::acquireMulti()
+{
+	{
+		boost::mutex::scoped_lock lock(_handlesMutex);
+
+		if (!_idleMultis.empty())
+		{
+			CURLM* multi = _idleMultis.back();
+			_idleMultis.pop_back();
+			return multi;
+		}
+	}
+
+	CURLM* multi = curl_multi_init();
+
+	if (!multi)
+	{
+		BOOST_THROW_EXCEPTION(IOError() << error_message("can not create a curl multi handle"));
+	}
+
+	curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)_maxConnections);
+	curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, (long)_maxConnections);
+
+	return multi;
+}
+
+void
+HttpSession::releaseMulti(CURLM* multi)
+{
+	boost::mutex::scoped_lock lock(_handlesMutex);
+
+	// keep the multi handle with its open connections for the next caller
+	_idleMultis.push_back(multi);
+}
+
+std::string
+HttpSession::gzip(const std::string& data)
+{
+	std::istringstream in(data);
+	std::ostringstream out;
+
+	boost::iostreams::filtering_ostream compressor;
+	compressor.push(boost::iostreams::gzip_compressor());
+	compressor.push(out);
+
+	boost::iostreams::copy(in, compressor);
+
+	return out.str();
+}
+
+size_t
+HttpSession::onData(char* data, size_t size, size_t count, void* response)
+{
+	static_cast<std::string*>(response)->append(data, size*count);
+
+	return size*count;
+}
+
+void
+HttpSession::lockShare(CURL*, curl_lock_data data, curl_lock_access, void* session)
+{
+	static_cast<HttpSession*>(session)->_shareMutexes[data].lock();
+}
+
+void
+HttpSession::unlockShare(CURL*, curl_lock_data data, void* session)
+{
+	static_cast<HttpSession*>(session)->_shareMutexes[data].unlock();
+}
@@ -0,0 +1,144 @@
+#ifndef HTTP_SESSION_H__
+#define HTTP_SESSION_H__
+
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <curl/curl.h>
+
+/**
+ * A pool of keep-alive HTTP connections, shared by all Django stores, block
+ * managers, and the CatmaidStackStore.
+ *
+ * Connections are kept open between requests and reused for the next request
+ * to the same host, such that the chatty guarantor workflows don't pay for a
+ * new TCP connection with every call. Compressed (gzip) responses are
+ * requested and decompressed transparently. Large request bodies can be sent
+ * gzip-compressed, if the server supports it (program option
+ * djangoHttp.compressRequests).
+ *
+ * Independent requests can be sent at once with performAll(), which runs them
+ * concurrently over up to djangoHttp.maxConnections connections.
+ *
+ * Responses with an HTTP status of 400 or above raise an IOError.
+ *
+ * All methods are thread-safe. libcurl can't share open connections between
+ * transfers that run at the same time, so each concurrent caller uses its own
+ * connection cache from a pool. Only the DNS and SSL session caches are
+ * shared between all of them.
+ */
+class HttpSession
+{
+public:
+	/**
+	 * A GET or POST request.
+	 */
+	struct Request
+	{
+		/**
+		 * Create a GET request.
+		 */
+		Request(const std::string& url_) : url(url_), post(false) {}
+
+		/**
+		 * Create a POST request. The data is URL-encoded form data, unless
+		 * another content type is given.
+		 */
+		Request(const std::string& url_, const std::string& data_, const std::string& contentType_ = "") :
+			url(url_), data(data_), contentType(contentType_), post(true) {}
+
+		std::string url;
+		std::string data;
+		std::string contentType;
+		bool post;
+	};
+
+	/**
+	 * Get the session shared by all users in this process.
+	 */
+	static HttpSession& getInstance();
+
+	/**
+	 * Create a new session.
+	 *
+	 * @param maxConnections
+	 *              The maximal number of connections per host and concurrent
+	 *              caller.
+	 */
+	HttpSession(unsigned int maxConnections);
+
+	~HttpSession();
+
+	/**
+	 * Send a GET request and return the body of the response.
+	 */
+	std::string get(const std::string& url);
+
+	/**
+	 * Send a POST request with the given data (form data, unless another
+	 * content type is given) and return the body of the response.
+	 */
+	std::string post(const std::string& url, const std::string& data, const std::string& contentType = "");
+
+	/**
+	 * Send independent requests concurrently and return the bodies of their
+	 * responses, in the order of the requests.
+	 */
+	std::vector<std::string> performAll(const std::vector<Request>& requests);
+
+private:
+
+	// the state of a single request in flight
+	struct Transfer
+	{
+		Transfer() : handle(0), headers(0) {}
+
+		CURL* handle;
+		curl_slist* headers;
+		std::string body;
+		std::string response;
+	};
+
+	CURL* acquireHandle();
+
+	void releaseHandle(CURL* handle);
+
+	CURLM* acquireMulti();
+
+	void releaseMulti(CURLM* multi);
+
+	void prepare(const Request& request, Transfer& transfer);
+
+	void finish(Transfer& transfer);
+
+	// remove the prepared transfers from the multi handle and return all handles to the pools
+	void finishAll(CURLM* multi, std::vector<Transfer>& transfers);
+
+	static std::string gzip(const std::string& data);
+
+	static size_t onData(char* data, size_t size, size_t count, void* response);
+
+	static void lockShare(CURL*, curl_lock_data data, curl_lock_access, void* session);
+
+	static void unlockShare(CURL*, curl_lock_data data, void* session);
+
+	unsigned int _maxConnections;
+
+	// DNS and SSL session caches, shared between all handles
+	CURLSH* _share;
+
+	// handles that are not used at the moment
+	std::vector<CURL*> _idleHandles;
+
+	// multi handles that are not used at the moment, each with its own cache
+	// of open connections
+	std::vector<CURLM*> _idleMultis;
+
+	boost::mutex _handlesMutex;
+
+	// one mutex for each kind of shared data
+	boost::mutex _shareMutexes[CURL_LOCK_DATA_LAST];
+};
+
+#endif // HTTP_SESSION_H__
@@ -0,0 +1,359 @@
+#include "JsonReader.h"
+
+#include <cstdlib>
+#include <sstream>
+
+#include <util/exceptions.h>
+
+namespace {
+
+bool isWhitespace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool isDelimiter(char c)
+{
+	return c == ',' || c == ']' || c == '}' || c == ':' || c == '"' || isWhitespace(c);
+}
+
+} // anonymous namespace
+
+JsonReader::JsonReader(const std::string& json) :
+	_begin(json.c_str()),
+	_pos(json.c_str()),
+	_end(json.c_str() + json.size())
+{
+}
+
+JsonReader::ValueType
+JsonReader::peek()
+{
+	skipWhitespace();
+
+	if (_pos == _end)
+		error("unexpected end of input");
+
+	switch (*_pos)
+	{
+		case '{':
+			return ObjectValue;
+		case '[':
+			return ArrayValue;
+		case '"':
+			return StringValue;
+		case 't':
+		case 'f':
+		case 'n':
+			return LiteralValue;
+		default:
+			return NumberValue;
+	}
+}
+
+void
+JsonReader::beginObject()
+{
+	expect('{');
+	_first.push_back(true);
+}
+
+bool
+JsonReader::nextMember(std::string& key)
+{
+	skipWhitespace();
+
+	if (_pos != _end && *_pos == '}')
+	{
+		++_pos;
+		_first.pop_back();
+		return false;
+	}
+
+	skipSeparator();
+
+	skipWhitespace();
+	if (_pos == _end || *_pos != '"')
+		error("expected a member name");
+
+	key.clear();
+	readQuoted(key);
+	expect(':');
+
+	return true;
+}
+
+void
+JsonReader::beginArray()
+{
+	expect('[');
+	_first.push_back(true);
+}
+
+bool
+JsonReader::nextElement()
+{
+	skipWhitespace();
+
+	if (_pos != _end && *_pos == ']')
+	{
+		++_pos;
+		_first.pop_back();
+		return false;
+	}
+
+	skipSeparator();
+
+	return true;
+}
+
+std::string
+JsonReader::readString()
+{
+	ValueType type = peek();
+
+	if (type == ObjectValue || type == ArrayValue)
+		error("expected a scalar");
+
+	if (type != StringValue)
+		return readToken();
+
+	std::string value;
+	readQuoted(value);
+
+	return value;
+}
+
+unsigned int
+JsonReader::readUnsigned()
+{
+	skipWhitespace();
+
+	const char* start = _pos;
+	bool quoted = (_pos != _end && *_pos == '"');
+
+	if (quoted)
+		++_pos;
+
+	if (_pos == _end || *_pos < '0' || *_pos > '9')
+		error("expected a non-negative integer");
+
+	unsigned int value = 0;
+	while (_pos != _end && *_pos >= '0' && *_pos <= '9')
+		value = value*10 + (*_pos++ - '0');
+
+	// fractions and exponents take the slow path
+	if (_pos != _end && (*_pos == '.' || *_pos == 'e' || *_pos == 'E'))
+	{
+		_pos = start;
+		return static_cast<unsigned int>(readDouble());
+	}
+
+	if (quoted)
+		expect('"');
+
+	return value;
+}
+
+int
+JsonReader::readInt()
+{
+	return static_cast<int>(readDouble());
+}
+
+double
+JsonReader::readDouble()
+{
+	skipWhitespace();
+
+	bool quoted = (_pos != _end && *_pos == '"');
+
+	if (quoted)
+		++_pos;
+
+	// the text of a std::string is null-terminated, strtod stops there at the latest
+	char* end;
+	double value = std::strtod(_pos, &end);
+
+	if (end == _pos)
+		error("expected a number");
+
+	_pos = end;
+
+	if (quoted)
+		expect('"');
+
+	return value;
+}
+
+void
+JsonReader::readNumbers(std::vector<unsigned int>& values)
+{
+	beginArray();
+
+	while (nextElement())
+		values.push_back(readUnsigned());
+}
+
+void
+JsonReader::skipValue()
+{
+	switch (peek())
+	{
+		case ObjectValue:
+		{
+			std::string key;
+			beginObject();
+			while (nextMember(key))
+				skipValue();
+			break;
+		}
+
+		case ArrayValue:
+			beginArray();
+			while (nextElement())
+				skipValue();
+			break;
+
+		case StringValue:
+			for (++_pos; _pos != _end && *_pos != '"'; ++_pos)
+				if (*_pos == '\\' && _pos + 1 != _end)
+					++_pos;
+			expect('"');
+			break;
+
+		default:
+			while (_pos != _end && !isDelimiter(*_pos))
+				++_pos;
+	}
+}
+
+void
+JsonReader::skipWhitespace()
+{
+	while (_pos != _end && isWhitespace(*_pos))
+		++_pos;
+}
+
+void
+JsonReader::skipSeparator()
+{
+	if (_first.empty())
+		error("not inside an object or array");
+
+	if (_first.back())
+		_first.back() = false;
+	else
+		expect(',');
+}
+
+void
+JsonReader::expect(char c)
+{
+	skipWhitespace();
+
+	if (_pos == _end || *_pos != c)
+		error(std::string("expected '") + c + "'");
+
+	++_pos;
+}
+
+void
+JsonReader::readQuoted(std::string& value)
+{
+	expect('"');
+
+	while (_pos != _end && *_pos != '"')
+	{
+		// copy runs of plain characters at once
+		const char* run = _pos;
+		while (_pos != _end && *_pos != '"' && *_pos != '\\')
+			++_pos;
+		value.append(run, _pos);
+
+		if (_pos == _end || *_pos == '"')
+			break;
+
+		// an escape sequence
+		if (++_pos == _end)
+			break;
+
+		switch (*_pos++)
+		{
+			case '"':  value += '"';  break;
+			case '\\': value += '\\'; break;
+			case '/':  value += '/';  break;
+			case 'b':  value += '\b'; break;
+			case 'f':  value += '\f'; break;
+			case 'n':  value += '\n'; break;
+			case 'r':  value += '\r'; break;
+			case 't':  value += '\t'; break;
+			case 'u':
+			{
+				if (_end - _pos < 4)
+					error("incomplete unicode escape");
+
+				char hex[5] = { _pos[0], _pos[1], _pos[2], _pos[3], 0 };
+				char* end;
+				unsigned int codePoint = std::strtoul(hex, &end, 16);
+
+				if (end != hex + 4)
+					error("invalid unicode escape");
+
+				_pos += 4;
+				appendCodePoint(codePoint, value);
+				break;
+			}
+			default:
+				error("invalid escape sequence");
+		}
+	}
+
+	expect('"');
+}
+
+void
+JsonReader::appendCodePoint(unsigned int codePoint, std::string& value)
+{
+	// surrogate pairs are not combined, the Django backend sends only ASCII
+	if (codePoint < 0x80)
+	{
+		value += static_cast<char>(codePoint);
+	}
+	else if (codePoint < 0x800)
+	{
+		value += static_cast<char>(0xc0 | (codePoint >> 6));
+		value += static_cast<char>(0x80 | (codePoint & 0x3f));
+	}
+	else
+	{
+		value += static_cast<char>(0xe0 | (codePoint >> 12));
+		value += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+		value += static_cast<char>(0x80 | (codePoint & 0x3f));
+	}
+}
+
+std::string
+JsonReader::readToken()
+{
+	skipWhitespace();
+
+	const char* start = _pos;
+
+	while (_pos != _end && !isDelimiter(*_pos))
+		++_pos;
+
+	if (_pos == start)
+		error("expected a value");
+
+	return std::string(start, _pos);
+}
+
+void
+JsonReader::error(const std::string& what)
+{
+	std::ostringstream message;
+	message << "invalid JSON at offset " << (_pos - _begin) << ": " << what;
+
+	BOOST_THROW_EXCEPTION(IOError() << error_message(message.str()));
+}
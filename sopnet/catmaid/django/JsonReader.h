@@ -0,0 +1,131 @@
+#ifndef JSON_READER_H__
+#define JSON_READER_H__
+
+#include <string>
+#include <vector>
+
+/**
+ * A pull parser for JSON documents. Values are read one by one directly from
+ * the text, without building a property tree. This is used for the large
+ * responses of the Django backend, where a property tree would create one
+ * node (with a string value) for each pixel of each slice.
+ *
+ * Objects and arrays are traversed with beginObject()/nextMember() and
+ * beginArray()/nextElement():
+ *
+ *   reader.beginObject();
+ *   while (reader.nextMember(key))
+ *   {
+ *     if (key == "x")
+ *       reader.readNumbers(xs);
+ *     else
+ *       reader.skipValue();
+ *   }
+ *
+ * Scalars can be read as numbers, even if they are quoted, and as strings,
+ * even if they are numbers or literals, in the same way as a property tree
+ * would return them. Malformed input raises an IOError.
+ */
+class JsonReader
+{
+public:
+	enum ValueType
+	{
+		ObjectValue,
+		ArrayValue,
+		StringValue,
+		NumberValue,
+		LiteralValue
+	};
+
+	/**
+	 * Create a reader for the given JSON text, which has to outlive the reader.
+	 */
+	JsonReader(const std::string& json);
+
+	/**
+	 * Get the type of the next value, without reading it.
+	 */
+	ValueType peek();
+
+	/**
+	 * Start reading an object.
+	 */
+	void beginObject();
+
+	/**
+	 * Read the key of the next member of the current object. Returns false,
+	 * if the end of the object was reached.
+	 */
+	bool nextMember(std::string& key);
+
+	/**
+	 * Start reading an array.
+	 */
+	void beginArray();
+
+	/**
+	 * Advance to the next element of the current array. Returns false, if the
+	 * end of the array was reached.
+	 */
+	bool nextElement();
+
+	/**
+	 * Read a scalar as a string. Numbers and literals are returned as they
+	 * appear in the text.
+	 */
+	std::string readString();
+
+	/**
+	 * Read a scalar as a non-negative integer.
+	 */
+	unsigned int readUnsigned();
+
+	/**
+	 * Read a scalar as an integer.
+	 */
+	int readInt();
+
+	/**
+	 * Read a scalar as a floating point number.
+	 */
+	double readDouble();
+
+	/**
+	 * Read an array of non-negative integers and append them to the given
+	 * vector.
+	 */
+	void readNumbers(std::vector<unsigned int>& values);
+
+	/**
+	 * Skip the next value, including all nested objects and arrays.
+	 */
+	void skipValue();
+
+private:
+
+	void skipWhitespace();
+
+	// skip the separator between two members or elements
+	void skipSeparator();
+
+	void expect(char c);
+
+	void readQuoted(std::string& value);
+
+	void appendCodePoint(unsigned int codePoint, std::string& value);
+
+	// get the text of an unquoted number or literal
+	std::string readToken();
+
+	void error(const std::string& what);
+
+	const char* _begin;
+	const char* _pos;
+	const char* _end;
+
+	// for each open object or array, whether no member or element was read, yet
+	std::vector<bool> _first;
+};
+
+#endif // JSON_READER_H__
@@ -3,6 +3,7 @@
 #include <vector>
 #include <util/Logger.h>
 #include <util/foreach.h>
+#include <trace/Tracer.h>
 logger::LogChannel localsegmentstorelog("localsegmentstorelog", "[LocalSegmentStore] ");
 
 LocalSegmentStore::LocalSegmentStore()
@@ -14,6 +15,8 @@ void
 LocalSegmentStore::associate(pipeline::Value<Segments> segmentsIn,
 							 pipeline::Value<Block> block)
 {
+	TRACE_SCOPE("LocalSegmentStore::associate");
+
 	foreach (boost::shared_ptr<Segment> segmentIn, segmentsIn->getSegments())
 	{
 		boost::shared_ptr<Segment> segment = equivalentSegment(segmentIn);
@@ -41,6 +44,8 @@ LocalSegmentStore::getAssociatedBlocks(pipeline::Value<Segment> segment)
 pipeline::Value<Segments>
 LocalSegmentStore::retrieveSegments(pipeline::Value<Blocks> blocks)
 {
+	TRACE_SCOPE("LocalSegmentStore::retrieveSegments");
+
 	pipeline::Value<Segments> segments;
 	std::vector<boost::shared_ptr<Segment> > segmentVector;
 	SegmentSetType segmentSet;
@@ -201,6 +206,8 @@ void LocalSegmentStore::dumpStore()
 int
 LocalSegmentStore::storeFeatures(pipeline::Value<Features> features)
 {
+	TRACE_SCOPE("LocalSegmentStore::storeFeatures");
+
 	std::map<unsigned int, unsigned int>::const_iterator it;
 	std::map<unsigned int, unsigned int> idMap = features->getSegmentsIdsMap();
 	int count = 0;
@@ -234,6 +241,8 @@ LocalSegmentStore::storeFeatures(pipeline::Value<Features> features)
 pipeline::Value<SegmentStore::SegmentFeaturesMap>
 LocalSegmentStore::retrieveFeatures(pipeline::Value<Segments> segments)
 {
+	TRACE_SCOPE("LocalSegmentStore::retrieveFeatures");
+
 	pipeline::Value<SegmentStore::SegmentFeaturesMap> featureMap;
 	
 	foreach (boost::shared_ptr<Segment> segment, segments->getSegments())
@@ -252,6 +261,8 @@ unsigned int
 LocalSegmentStore::storeCost(pipeline::Value<Segments> segments,
 							 pipeline::Value<LinearObjective> objective)
 {
+	TRACE_SCOPE("LocalSegmentStore::storeCost");
+
 	unsigned int count = 0, i = 0;
 	const std::vector<double> coefs = objective->getCoefficients();
 	
@@ -279,6 +290,8 @@ LocalSegmentStore::retrieveCost(pipeline::Value<Segments> segments,
 								double defaultCost,
 								pipeline::Value<Segments> segmentsNF)
 {
+	TRACE_SCOPE("LocalSegmentStore::retrieveCost");
+
 	pipeline::Value<LinearObjective> objective;
 	unsigned int i = 0;
 	
@@ -308,6 +321,8 @@ LocalSegmentStore::storeSolution(pipeline::Value<Segments> segments,
 								 pipeline::Value<Solution> solution,
 								 std::vector<unsigned int> indices)
 {
+	TRACE_SCOPE("LocalSegmentStore::storeSolution");
+
 	unsigned int count = 0, i = 0;
 
 	if (solution->size() == 0 || indices.empty())
@@ -339,6 +354,8 @@ pipeline::Value<Solution>
 LocalSegmentStore::retrieveSolution(pipeline::Value<Segments> segments,
 									pipeline::Value<Core> core)
 {
+	TRACE_SCOPE("LocalSegmentStore::retrieveSolution");
+
 	pipeline::Value<Solution> solution;
 	unsigned int i = 0;
 	
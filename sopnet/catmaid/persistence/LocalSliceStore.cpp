@@ -7,6 +7,7 @@
 #include <sopnet/slices/ConflictSets.h>
 
 #include <util/Logger.h>
+#include <trace/Tracer.h>
 logger::LogChannel localslicestorelog("localslicestorelog", "[LocalSliceStore] ");
 
 LocalSliceStore::LocalSliceStore()
@@ -30,6 +31,8 @@ LocalSliceStore::getAssociatedBlocks(pipeline::Value<Slice> slice)
 pipeline::Value<Slices>
 LocalSliceStore::retrieveSlices(pipeline::Value<Blocks> blocks)
 {
+	TRACE_SCOPE("LocalSliceStore::retrieveSlices");
+
 	pipeline::Value<Slices> slices = pipeline::Value<Slices>();
 	// Use a set to ensure that we don't accidentally push the same Slice multiple times into to
 	// the returned Slices.
@@ -134,6 +137,8 @@ void
 LocalSliceStore::associate(pipeline::Value<Slices> slicesIn,
 							pipeline::Value<Block> block)
 {
+	TRACE_SCOPE("LocalSliceStore::associate");
+
 	foreach (boost::shared_ptr<Slice> slice, *slicesIn)
 	{
 		// Check to see if we've already stored this Slice, in the sense that we stored a different
@@ -178,7 +183,7 @@ LocalSliceStore::equivalentSlice(const boost::shared_ptr<Slice> slice)
 void
 LocalSliceStore::storeConflict(pipeline::Value<ConflictSets> conflictSets)
 {
-	
+	TRACE_SCOPE("LocalSliceStore::storeConflict");
 	
 	foreach (const ConflictSet conflict, *conflictSets)
 	{
@@ -212,6 +217,8 @@ LocalSliceStore::storeConflict(pipeline::Value<ConflictSets> conflictSets)
 pipeline::Value<ConflictSets>
 LocalSliceStore::retrieveConflictSets(pipeline::Value<Slices> slices)
 {
+	TRACE_SCOPE("LocalSliceStore::retrieveConflictSets");
+
 	pipeline::Value<ConflictSets> allConflictSets;
 	boost::unordered_set<ConflictSet> conflictSetUSet;
 	
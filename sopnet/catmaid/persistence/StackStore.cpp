@@ -1,8 +1,11 @@
 #include "StackStore.h"
+#include <trace/Tracer.h>
 
 pipeline::Value<ImageStack>
 StackStore::getImageStack(const Box<>& box)
 {
+	TRACE_SCOPE("StackStore::getImageStack");
+
 	pipeline::Value<ImageStack> stack = pipeline::Value<ImageStack>();
 	
 	for (unsigned int i = 0; i < box.size().z; ++i)
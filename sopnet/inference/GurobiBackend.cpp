@@ -2,6 +2,7 @@
 
 #ifdef HAVE_GUROBI
 
+#include <algorithm>
 #include <sstream>
 
 #include <util/Logger.h>
@@ -237,6 +238,26 @@ GurobiBackend::setConstraints(const LinearConstraints& constraints) {
 	}
 }
 
+void
+GurobiBackend::setInitialSolution(const Solution& solution) {
+
+	try {
+
+		LOG_DEBUG(gurobilog) << "setting initial solution" << std::endl;
+
+		unsigned int numValues = std::min(_numVariables, solution.size());
+
+		for (unsigned int i = 0; i < numValues; i++)
+			_variables[i].set(GRB_DoubleAttr_Start, solution[i]);
+
+		_model.update();
+
+	} catch (GRBException e) {
+
+		LOG_ERROR(gurobilog) << "error: " << e.getMessage() << endl;
+	}
+}
+
 bool
 GurobiBackend::solve(Solution& x, double& value, std::string& msg) {
 
@@ -56,6 +56,10 @@ public:
 
 	void setConstraints(const LinearConstraints& constraints);
 
+	void setInitialSolution(const Solution& solution);
+
+	void setNumThreads(unsigned int numThreads);
+
 	bool solve(Solution& solution, double& value, std::string& message);
 
 private:
@@ -73,9 +77,6 @@ private:
 	// set the mpi focus
 	void setMIPFocus(unsigned int focus);
 
-	// set the number of threads to use
-	void setNumThreads(unsigned int numThreads);
-
 	/**
 	 * Enable solver output.
 	 */
@@ -1,6 +1,7 @@
 #include <util/Logger.h>
 #include <util/foreach.h>
 #include <util/helpers.hpp>
+#include <trace/Tracer.h>
 #include "LinearSolver.h"
 
 static logger::LogChannel linearsolverlog("linearsolverlog", "[LinearSolver] ");
@@ -59,16 +60,23 @@ LinearSolver::updateOutputs() {
 void
 LinearSolver::updateLinearProgram() {
 
+	TRACE_SCOPE("LinearSolver::updateLinearProgram");
+
 	if (_parametersDirty) {
 
 		LOG_DEBUG(linearsolverlog) << "initializing solver" << std::endl;
 
-		if (_parameters.isSet())
+		if (_parameters.isSet()) {
+
 			_solver->initialize(
 					getNumVariables(),
 					_parameters->getDefaultVariableType(),
 					_parameters->getSpecialVariableTypes());
-		else
+
+			if (_parameters->getNumThreads() > 0)
+				_solver->setNumThreads(_parameters->getNumThreads());
+
+		} else
 			_solver->initialize(
 					getNumVariables(),
 					Continuous);
@@ -91,6 +99,8 @@ LinearSolver::updateLinearProgram() {
 
 		_solver->setConstraints(*_linearConstraints);
 
+		TRACE_COUNT("linear constraints", _linearConstraints->size());
+
 		_linearConstraintsDirty = false;
 	}
 }
@@ -98,6 +108,8 @@ LinearSolver::updateLinearProgram() {
 void
 LinearSolver::solve() {
 
+	TRACE_SCOPE("LinearSolver::solve");
+
 	double value;
 
 	std::string message;
@@ -56,6 +56,23 @@ public:
 	 */
 	virtual void setConstraints(const LinearConstraints& constraints) = 0;
 
+	/**
+	 * Set a start point for the next call to solve(). Solvers that do not 
+	 * support warm starts ignore it.
+	 *
+	 * @param solution An assignment of all variables, usually the solution of 
+	 *                 a similar problem.
+	 */
+	virtual void setInitialSolution(const Solution& /*solution*/) {}
+
+	/**
+	 * Limit the number of threads of the next call to solve(). Solvers that 
+	 * are not multi-threaded ignore it.
+	 *
+	 * @param numThreads The number of threads, 0 for the solver's default.
+	 */
+	virtual void setNumThreads(unsigned int /*numThreads*/) {}
+
 	/**
 	 * Solve the problem.
 	 *
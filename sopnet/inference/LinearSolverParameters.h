@@ -10,10 +10,12 @@ struct LinearSolverParameters : pipeline::Data {
 public:
 
 	LinearSolverParameters() :
-		_variableType(Continuous) {};
+		_variableType(Continuous),
+		_numThreads(0) {};
 
 	LinearSolverParameters(const VariableType& variableType) :
-		_variableType(variableType) {}
+		_variableType(variableType),
+		_numThreads(0) {}
 
 	/**
 	 * Set the default variable type for all variables.
@@ -46,6 +48,20 @@ public:
 		return _variableTypes;
 	}
 
+	/**
+	 * Set the number of threads the solver is allowed to use. If 0, the 
+	 * solver's own default is used.
+	 */
+	void setNumThreads(unsigned int numThreads) {
+
+		_numThreads = numThreads;
+	}
+
+	unsigned int getNumThreads() const {
+
+		return _numThreads;
+	}
+
 private:
 
 	// the default variable type
@@ -53,6 +69,9 @@ private:
 
 	// individual variable types
 	std::map<unsigned int, VariableType> _variableTypes;
+
+	// the number of solver threads, 0 for the solver's default
+	unsigned int _numThreads;
 };
 
 #endif // INFERENCE_LINEAR_SOLVER_PARAMETERS_H__
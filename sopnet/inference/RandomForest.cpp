@@ -1,6 +1,68 @@
+#include <algorithm>
+#include <ctime>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/thread.hpp>
+
+#include <vigra/random.hxx>
 #include <vigra/random_forest_hdf5_impex.hxx>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
 #include "RandomForest.h"
 
+static logger::LogChannel randomforestlog("randomforestlog", "[RandomForest] ");
+
+util::ProgramOption optionRandomForestNumThreads(
+		util::_module           = "inference.randomForest",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to train random forests with. The default (0) uses all available CPUs.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionRandomForestSamplesPerTree(
+		util::_module           = "inference.randomForest",
+		util::_long_name        = "samplesPerTree",
+		util::_description_text = "The size of the bootstrap sample of each tree, as a fraction of all training samples.",
+		util::_default_value    = 1.0);
+
+util::ProgramOption optionRandomForestMaxSamplesInMemory(
+		util::_module           = "inference.randomForest",
+		util::_long_name        = "maxSamplesInMemory",
+		util::_description_text = "The maximal size in MB of training samples to keep in memory. Larger sample sets are "
+		                          "stored in a memory-mapped temporary file.",
+		util::_default_value    = 1024);
+
+/**
+ * A temporary file of samples, mapped into memory. The samples are stored
+ * row by row, i.e., the features of one sample are consecutive.
+ */
+struct RandomForest::MappedSamples {
+
+	MappedSamples(size_t size) :
+		path(boost::filesystem::temp_directory_path()/boost::filesystem::unique_path("sopnet-rf-samples-%%%%-%%%%-%%%%")) {
+
+		boost::iostreams::mapped_file_params params(path.string());
+		params.new_file_size = size;
+		params.mode          = std::ios_base::in | std::ios_base::out;
+
+		file.open(params);
+	}
+
+	~MappedSamples() {
+
+		file.close();
+		boost::filesystem::remove(path);
+	}
+
+	FeatureType* data() { return reinterpret_cast<FeatureType*>(file.data()); }
+
+	boost::filesystem::path      path;
+	boost::iostreams::mapped_file file;
+};
+
 RandomForest::RandomForest() :
 	_outOfBagError(0),
 	_variableImportance(0) {
@@ -11,7 +73,24 @@ RandomForest::RandomForest() :
 void
 RandomForest::prepareTraining(int numSamples, int numFeatures) {
 
-	_samples = SamplesType(SamplesSize(numSamples, numFeatures));
+	size_t samplesSize = (size_t)numSamples*numFeatures*sizeof(FeatureType);
+
+	_mappedSamples.reset();
+
+	if (samplesSize > optionRandomForestMaxSamplesInMemory.as<size_t>()*1024*1024) {
+
+		_mappedSamples = boost::shared_ptr<MappedSamples>(new MappedSamples(samplesSize));
+		_samples = SamplesType();
+
+		LOG_DEBUG(randomforestlog)
+				<< "storing " << numSamples << " samples in "
+				<< _mappedSamples->path << std::endl;
+
+	} else {
+
+		_samples = SamplesType(SamplesSize(numSamples, numFeatures));
+	}
+
 	_labels  = LabelsType(LabelsSize(numSamples, 1));
 
 	_nextSample = 0;
@@ -25,8 +104,11 @@ RandomForest::prepareTraining(int numSamples, int numFeatures) {
 void
 RandomForest::addSample(const std::vector<FeatureType>& sample, LabelType label) {
 
-	for (unsigned int i = 0; i < _numFeatures; i++)
-		_samples(_nextSample, i) = sample[i];
+	if (_mappedSamples)
+		std::copy(sample.begin(), sample.begin() + _numFeatures, _mappedSamples->data() + (size_t)_nextSample*_numFeatures);
+	else
+		for (unsigned int i = 0; i < _numFeatures; i++)
+			_samples(_nextSample, i) = sample[i];
 
 	_labels(_nextSample) = label;
 
@@ -43,8 +125,6 @@ RandomForest::train(int numTrees, int numFeatures) {
 		return;
 	}
 
-	// create new random forest instance
-
 	vigra::RandomForestOptions options;
 
 	if (numTrees > 0)
@@ -52,26 +132,166 @@ RandomForest::train(int numTrees, int numFeatures) {
 	if (numFeatures > 0)
 		options.features_per_node(numFeatures);
 
-	_rf = RandomForestType(options);
+	options.samples_per_tree(optionRandomForestSamplesPerTree.as<double>());
 
-	// create visitors
+	// split the trees into groups to train in parallel
 
-	vigra::rf::visitors::VariableImportanceVisitor variableVisitor;
-	vigra::rf::visitors::OOB_Error                 errorVisitor;
+	unsigned int totalTrees = options.tree_count_;
+	unsigned int numThreads = optionRandomForestNumThreads.as<unsigned int>();
 
-	_rf.learn(
-			_samples,
-			_labels,
-			vigra::rf::visitors::create_visitor(variableVisitor, errorVisitor));
+	if (numThreads == 0)
+		numThreads = boost::thread::hardware_concurrency();
 
-	_outOfBagError = errorVisitor.oob_breiman;
+	numThreads = std::max(1u, std::min(numThreads, totalTrees));
 
-	for (unsigned int i = 0; i < _numFeatures; i++)
-		_variableImportance[i] = variableVisitor.variable_importance_(i);
+	LOG_DEBUG(randomforestlog)
+			<< "training " << totalTrees << " trees in "
+			<< numThreads << " threads" << std::endl;
+
+	std::vector<TrainingResult> results(numThreads);
+
+	unsigned int seed = std::time(0);
+
+	boost::thread_group threads;
+
+	for (unsigned int i = 0; i < numThreads; i++) {
+
+		vigra::RandomForestOptions groupOptions = options;
+		groupOptions.tree_count(totalTrees/numThreads + (i < totalTrees%numThreads ? 1 : 0));
+
+		threads.create_thread(
+				boost::bind(
+						&RandomForest::trainTrees,
+						this,
+						groupOptions,
+						seed + i,
+						boost::ref(results[i])));
+	}
+
+	threads.join_all();
+
+	foreach (const TrainingResult& result, results)
+		if (result.exception)
+			boost::rethrow_exception(result.exception);
+
+	// merge the trees of all groups
+
+	_rf = results[0].rf;
+
+	std::fill(_variableImportance.begin(), _variableImportance.end(), 0.0);
+
+	vigra::MultiArray<2, double> oobVotes = results[0].oobVotes;
+	vigra::MultiArray<2, double> oobCount = results[0].oobCount;
+
+	for (unsigned int i = 0; i < numThreads; i++) {
+
+		if (i > 0) {
+
+			_rf.trees_.insert(_rf.trees_.end(), results[i].rf.trees_.begin(), results[i].rf.trees_.end());
+
+			oobVotes += results[i].oobVotes;
+			oobCount += results[i].oobCount;
+		}
+
+		// the importance is a mean over trees, therefore the weighted mean
+		// over groups is the importance of the merged forest
+		double weight = (double)results[i].rf.tree_count()/totalTrees;
+
+		for (unsigned int f = 0; f < _numFeatures; f++)
+			_variableImportance[f] += weight*results[i].variableImportance[f];
+	}
+
+	_outOfBagError = computeOutOfBagError(oobVotes, oobCount);
+
+	_rf.options_.tree_count_ = _rf.trees_.size();
 
 	_numClasses = _rf.class_count();
 }
 
+void
+RandomForest::trainTrees(
+		const vigra::RandomForestOptions& options,
+		unsigned int                      seed,
+		TrainingResult&                   result) {
+
+	try {
+
+		result.rf = RandomForestType(options);
+
+		vigra::rf::visitors::VariableImportanceVisitor variableVisitor;
+		vigra::rf::visitors::OOB_Error                 errorVisitor;
+
+		vigra::RandomNumberGenerator<> random(seed);
+
+		result.rf.learn(
+				getSamples(),
+				_labels,
+				vigra::rf::visitors::create_visitor(variableVisitor, errorVisitor),
+				vigra::rf_default(),
+				vigra::rf_default(),
+				random);
+
+		// keep the out-of-bag votes, the error is computed on the merged
+		// forest
+		result.oobVotes = errorVisitor.prob_oob;
+		result.oobCount = errorVisitor.oobCount;
+
+		result.variableImportance.resize(_numFeatures);
+		for (unsigned int i = 0; i < _numFeatures; i++)
+			result.variableImportance[i] = variableVisitor.variable_importance_(i);
+
+	} catch (...) {
+
+		result.exception = boost::current_exception();
+	}
+}
+
+double
+RandomForest::computeOutOfBagError(
+		const vigra::MultiArray<2, double>& oobVotes,
+		const vigra::MultiArray<2, double>& oobCount) {
+
+	unsigned int numOutOfBag = 0;
+	unsigned int numWrong    = 0;
+
+	for (unsigned int i = 0; i < _numSamples; i++) {
+
+		// samples that were in the bootstrap sample of all trees
+		if (oobCount(i, 0) == 0)
+			continue;
+
+		int bestClass = 0;
+		for (int c = 1; c < oobVotes.shape(1); c++)
+			if (oobVotes(i, c) > oobVotes(i, bestClass))
+				bestClass = c;
+
+		LabelType label;
+		_rf.ext_param_.to_classlabel(bestClass, label);
+
+		if (label != _labels(i))
+			numWrong++;
+
+		numOutOfBag++;
+	}
+
+	if (numOutOfBag == 0)
+		return 0;
+
+	return (double)numWrong/numOutOfBag;
+}
+
+RandomForest::SamplesViewType
+RandomForest::getSamples() {
+
+	if (_mappedSamples)
+		return SamplesViewType(
+				SamplesSize(_numSamples, _numFeatures),
+				SamplesSize(_numFeatures, 1),
+				_mappedSamples->data());
+
+	return SamplesViewType(_samples.shape(), _samples.stride(), _samples.data());
+}
+
 double
 RandomForest::getOutOfBagError() {
 
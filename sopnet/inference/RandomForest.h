@@ -3,6 +3,9 @@
 
 #include <vector>
 
+#include <boost/exception_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
 #include <vigra/multi_array.hxx>
 #include <vigra/random_forest.hxx>
 
@@ -16,6 +19,7 @@ public:
 	typedef double       FeatureType;
 
 	typedef vigra::MultiArray<2, FeatureType> SamplesType;
+	typedef vigra::MultiArrayView<2, FeatureType, vigra::StridedArrayTag> SamplesViewType;
 	typedef vigra::MultiArray<2, LabelType>   LabelsType;
 	typedef vigra::MultiArray<2, double>      ProbsType;
 
@@ -28,7 +32,10 @@ public:
 	RandomForest();
 
 	/**
-	 * Allocate memory to hold the given number of samples.
+	 * Allocate memory to hold the given number of samples. If the samples
+	 * exceed the size given by the program option
+	 * inference.randomForest.maxSamplesInMemory, they are written to a
+	 * memory-mapped temporary file instead.
 	 */
 	void prepareTraining(int numSamples, int numFeatures);
 
@@ -39,12 +46,16 @@ public:
 
 	/**
 	 * Train the classifier with the given number of trees under consideration
-	 * of numFeatures features.
+	 * of numFeatures features. The trees are split into groups that are
+	 * trained in parallel (see program option
+	 * inference.randomForest.numThreads).
 	 */
 	void train(int numTrees = 0, int numFeatures = 0);
 
 	/**
-	 * Returns the out-of-bag error after training.
+	 * Returns the out-of-bag error after training. Each sample is classified
+	 * by the trees of all groups that did not see it, i.e., this is the error
+	 * of the merged forest.
 	 */
 	double getOutOfBagError();
 
@@ -76,6 +87,45 @@ public:
 
 private:
 
+	// a temporary file holding the samples
+	struct MappedSamples;
+
+	// the result of training a part of the trees
+	struct TrainingResult {
+
+		RandomForestType    rf;
+		std::vector<double> variableImportance;
+
+		// the summed votes of the trees for each sample that was not in
+		// their bootstrap sample, and the number of these trees
+		vigra::MultiArray<2, double> oobVotes;
+		vigra::MultiArray<2, double> oobCount;
+
+		// set, if the training failed
+		boost::exception_ptr exception;
+	};
+
+	/**
+	 * Get the out-of-bag error of the merged forest from the votes of all
+	 * groups.
+	 */
+	double computeOutOfBagError(
+			const vigra::MultiArray<2, double>& oobVotes,
+			const vigra::MultiArray<2, double>& oobCount);
+
+	/**
+	 * Get a view on the training samples, wherever they are stored.
+	 */
+	SamplesViewType getSamples();
+
+	/**
+	 * Train a random forest with the given options on the samples.
+	 */
+	void trainTrees(
+			const vigra::RandomForestOptions& options,
+			unsigned int                      seed,
+			TrainingResult&                   result);
+
 	// random forest implementation
 
 	RandomForestType _rf;
@@ -85,6 +135,9 @@ private:
 	SamplesType _samples;
 	LabelsType  _labels;
 
+	// if set, the samples are stored in this file instead of _samples
+	boost::shared_ptr<MappedSamples> _mappedSamples;
+
 	unsigned int _numSamples;
 	unsigned int _numFeatures;
 	unsigned int _numClasses;
@@ -2,7 +2,6 @@
 #include <boost/filesystem.hpp>
 
 #include <imageprocessing/ImageStack.h>
-#include <inference/io/RandomForestHdf5Reader.h>
 #include <inference/LinearSolver.h>
 #include <pipeline/Process.h>
 #include <util/foreach.h>
@@ -16,6 +15,7 @@
 #include <sopnet/inference/SubproblemsSolver.h>
 #include <sopnet/inference/LinearCostFunction.h>
 #include <sopnet/inference/io/LinearCostFunctionParametersReader.h>
+#include <sopnet/inference/io/ModelCache.h>
 #include <sopnet/inference/RandomForestCostFunction.h>
 #include <sopnet/inference/SegmentationCostFunction.h>
 #include <sopnet/inference/PriorCostFunction.h>
@@ -70,7 +70,6 @@ Sopnet::Sopnet(
 		boost::shared_ptr<ProcessNode> problemWriter) :
 	_problemAssembler(boost::make_shared<ProblemAssembler>()),
 	_segmentFeaturesExtractor(boost::make_shared<SegmentFeaturesExtractor>()),
-	_randomForestReader(boost::make_shared<RandomForestHdf5Reader>(optionRandomForestFile.as<std::string>())),
 	_priorCostFunction(boost::make_shared<PriorCostFunction>()),
 	_objectiveGenerator(boost::make_shared<ObjectiveGenerator>()),
 	_linearSolver(boost::make_shared<LinearSolver>()),
@@ -102,6 +101,7 @@ Sopnet::Sopnet(
 	registerOutput(_reconstructor->getOutput(), "solution");
 	registerOutput(_problemAssembler->getOutput("segments"), "segments");
 	registerOutput(_problemAssembler->getOutput("problem configuration"), "problem configuration");
+	registerOutput(_problemAssembler->getOutput("linear constraints"), "linear constraints");
 	registerOutput(_objectiveGenerator->getOutput("objective"), "objective");
 	registerOutput(_groundTruthExtractor->getOutput("ground truth segments"), "ground truth segments");
 	registerOutput(_goldStandardExtractor->getOutput("gold standard"), "gold standard");
@@ -244,7 +244,8 @@ Sopnet::createInferencePipeline() {
 
 		rfCostFunction = boost::make_shared<RandomForestCostFunction>();
 		rfCostFunction->setInput("features", _segmentFeaturesExtractor->getOutput("all features"));
-		rfCostFunction->setInput("random forest", _randomForestReader->getOutput("random forest"));
+		// the forest is shared with all other users of the same file
+		rfCostFunction->setInput("random forest", ModelCache::getRandomForest(optionRandomForestFile.as<std::string>()));
 	}
 
 	if (optionSegmentationCostFunction) {
@@ -18,7 +18,6 @@ class ObjectiveGenerator;
 class PriorCostFunction;
 class ProblemAssembler;
 class RandomForestCostFunction;
-class RandomForestHdf5Reader;
 class Reconstructor;
 class SectionSelector;
 class SegmentEvaluator;
@@ -126,9 +125,6 @@ private:
 	// a feature extractor computing features for each segment
 	boost::shared_ptr<SegmentFeaturesExtractor>       	_segmentFeaturesExtractor;
 
-	// a random forest file reader
-	boost::shared_ptr<RandomForestHdf5Reader>         	_randomForestReader;
-
 	// a segment evaluator that provides a cost function for segment types
 	boost::shared_ptr<PriorCostFunction>              	_priorCostFunction;
 
@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <util/exceptions.h>
+#include <util/foreach.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include "BlockLeaseManager.h"
+
+logger::LogChannel blockleaselog("blockleaselog", "[BlockLeaseManager] ");
+
+util::ProgramOption optionBlockLeaseDuration(
+		util::_module           = "blockLeases",
+		util::_long_name        = "leaseDuration",
+		util::_description_text = "The number of seconds a block lease is valid without being renewed by its worker.",
+		util::_default_value    = 300);
+
+util::ProgramOption optionBlockLeasePollInterval(
+		util::_module           = "blockLeases",
+		util::_long_name        = "pollInterval",
+		util::_description_text = "The number of seconds to wait between attempts to claim a block that is in progress.",
+		util::_default_value    = 5);
+
+util::ProgramOption optionBlockLeaseMaxRetries(
+		util::_module           = "blockLeases",
+		util::_long_name        = "maxRetries",
+		util::_description_text = "The number of times a failed claim of a block is retried before giving up.",
+		util::_default_value    = 5);
+
+bool
+BlockLeaseManager::Lease::operator<(const Lease& other) const
+{
+	if (task != other.task)
+		return task < other.task;
+
+	return id < other.id;
+}
+
+BlockLeaseManager::BlockLeaseManager(const std::string& worker, unsigned int leaseDuration) :
+	_worker(worker.empty() ? defaultWorker() : worker),
+	_leaseDuration(leaseDuration == 0 ?
+			optionBlockLeaseDuration.as<unsigned int>() : leaseDuration)
+{
+	LOG_DEBUG(blockleaselog) << "worker " << _worker << " uses leases of " << _leaseDuration
+		<< " seconds" << std::endl;
+}
+
+BlockLeaseManager::~BlockLeaseManager()
+{
+	if (_heartbeat.joinable())
+	{
+		LOG_ERROR(blockleaselog) << "heartbeat was not stopped by the subclass" << std::endl;
+		_heartbeat.interrupt();
+		_heartbeat.join();
+	}
+}
+
+BlockLeaseManager::ClaimResult
+BlockLeaseManager::claim(boost::shared_ptr<Block> block, Task task)
+{
+	bool done = (task == SlicesTask ? block->getSlicesFlag() : block->getSegmentsFlag());
+
+	return claim(Lease(task, block->getId(), block->getCoordinates()), done);
+}
+
+BlockLeaseManager::ClaimResult
+BlockLeaseManager::claim(boost::shared_ptr<Core> core)
+{
+	return claim(Lease(SolutionTask, core->getId(), core->getCoordinates()),
+				 core->getSolutionSetFlag());
+}
+
+BlockLeaseManager::ClaimResult
+BlockLeaseManager::claim(const Lease& lease, bool done)
+{
+	if (done)
+		return Done;
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	if (_leases.count(lease))
+		return Claimed;
+
+	std::time_t expiry = std::time(0) + _leaseDuration;
+
+	ClaimResult result = acquireLease(lease, expiry);
+
+	LOG_DEBUG(blockleaselog) << taskName(lease.task) << " lease on " << lease.coordinates
+		<< (result == Claimed ? " claimed" :
+			(result == Done ? " is done" :
+			(result == InProgress ? " is in progress" : " could not be claimed")))
+		<< std::endl;
+
+	if (result == Claimed)
+	{
+		_leases[lease] = expiry;
+
+		if (!_heartbeat.joinable())
+			_heartbeat = boost::thread(boost::bind(&BlockLeaseManager::heartbeatLoop, this));
+	}
+
+	return result;
+}
+
+BlockLeaseManager::ClaimResult
+BlockLeaseManager::waitAndClaim(boost::shared_ptr<Block> block, Task task)
+{
+	unsigned int pollInterval = std::max(optionBlockLeasePollInterval.as<unsigned int>(), 1u);
+	unsigned int maxRetries   = optionBlockLeaseMaxRetries.as<unsigned int>();
+	unsigned int failures     = 0;
+
+	ClaimResult result = claim(block, task);
+
+	while (result == InProgress || result == Failed)
+	{
+		unsigned int delay = pollInterval;
+
+		if (result == Failed)
+		{
+			if (failures == maxRetries)
+				UTIL_THROW_EXCEPTION(
+						IOError,
+						"could not claim " << taskName(task) << " lease on block " <<
+						block->getCoordinates() << " after " << (failures + 1) << " attempts");
+
+			// back off, but don't wait longer than a lease would last
+			delay = std::min(pollInterval << std::min(failures, 16u),
+							 std::max(_leaseDuration, pollInterval));
+			failures++;
+
+			LOG_ERROR(blockleaselog) << "claim of " << taskName(task) << " in block "
+				<< block->getCoordinates() << " failed, retrying in " << delay
+				<< " seconds..." << std::endl;
+		}
+		else
+		{
+			failures = 0;
+
+			LOG_USER(blockleaselog) << taskName(task) << " in block " << block->getCoordinates()
+				<< " are in progress by another worker, waiting..." << std::endl;
+		}
+
+		boost::this_thread::sleep(boost::posix_time::seconds(delay));
+
+		result = claim(block, task);
+	}
+
+	return result;
+}
+
+boost::shared_ptr<Block>
+BlockLeaseManager::claimNext(boost::shared_ptr<Blocks> blocks, Task task)
+{
+	unsigned int numFailed = 0;
+
+	foreach (boost::shared_ptr<Block> block, *blocks)
+	{
+		ClaimResult result = claim(block, task);
+
+		if (result == Claimed)
+		{
+			return block;
+		}
+
+		if (result == Failed)
+		{
+			numFailed++;
+		}
+	}
+
+	// don't report "nothing to do" if we couldn't ask
+	if (numFailed > 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not claim " << taskName(task) << " leases on " << numFailed << " blocks");
+
+	return boost::shared_ptr<Block>();
+}
+
+void
+BlockLeaseManager::finish(boost::shared_ptr<Block> block, Task task)
+{
+	if (task == SlicesTask)
+		block->setSlicesFlag(true);
+	else
+		block->setSegmentsFlag(true);
+
+	finish(Lease(task, block->getId(), block->getCoordinates()));
+}
+
+void
+BlockLeaseManager::finish(boost::shared_ptr<Core> core)
+{
+	core->setSolutionSetFlag(true);
+
+	finish(Lease(SolutionTask, core->getId(), core->getCoordinates()));
+}
+
+void
+BlockLeaseManager::finish(const Lease& lease)
+{
+	boost::mutex::scoped_lock lock(_mutex);
+
+	releaseLease(lease, true);
+	_leases.erase(lease);
+}
+
+void
+BlockLeaseManager::release(boost::shared_ptr<Block> block, Task task)
+{
+	release(Lease(task, block->getId(), block->getCoordinates()));
+}
+
+void
+BlockLeaseManager::release(boost::shared_ptr<Core> core)
+{
+	release(Lease(SolutionTask, core->getId(), core->getCoordinates()));
+}
+
+void
+BlockLeaseManager::release(const Lease& lease)
+{
+	boost::mutex::scoped_lock lock(_mutex);
+
+	if (_leases.erase(lease))
+		releaseLease(lease, false);
+}
+
+void
+BlockLeaseManager::heartbeat()
+{
+	// don't hold the lock during the requests
+	std::vector<Lease> leases;
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		typedef std::map<Lease, std::time_t>::value_type lease_pair;
+		foreach (const lease_pair& lease, _leases)
+			leases.push_back(lease.first);
+	}
+
+	std::time_t expiry = std::time(0) + _leaseDuration;
+
+	foreach (const Lease& lease, leases)
+	{
+		bool renewed = renewLease(lease, expiry);
+
+		boost::mutex::scoped_lock lock(_mutex);
+
+		std::map<Lease, std::time_t>::iterator i = _leases.find(lease);
+
+		// the lease was finished or released in the meantime
+		if (i == _leases.end())
+			continue;
+
+		if (renewed)
+		{
+			i->second = expiry;
+		}
+		else
+		{
+			LOG_ERROR(blockleaselog) << "lost " << taskName(lease.task) << " lease on "
+				<< lease.coordinates << std::endl;
+			_leases.erase(i);
+		}
+	}
+}
+
+void
+BlockLeaseManager::stopHeartbeat()
+{
+	if (_heartbeat.joinable())
+	{
+		_heartbeat.interrupt();
+		_heartbeat.join();
+	}
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	// called from destructors, so errors are only logged -- the server will
+	// hand out the remaining leases again once they expired
+	typedef std::map<Lease, std::time_t>::value_type lease_pair;
+	foreach (const lease_pair& lease, _leases)
+	{
+		try
+		{
+			releaseLease(lease.first, false);
+		}
+		catch (boost::exception& e)
+		{
+			LOG_ERROR(blockleaselog) << "could not release " << taskName(lease.first.task)
+				<< " lease on " << lease.first.coordinates << ": "
+				<< boost::diagnostic_information(e) << std::endl;
+		}
+		catch (std::exception& e)
+		{
+			LOG_ERROR(blockleaselog) << "could not release " << taskName(lease.first.task)
+				<< " lease on " << lease.first.coordinates << ": " << e.what() << std::endl;
+		}
+	}
+
+	_leases.clear();
+}
+
+void
+BlockLeaseManager::heartbeatLoop()
+{
+	unsigned int interval = std::max(_leaseDuration/3, 1u);
+
+	try
+	{
+		while (true)
+		{
+			boost::this_thread::sleep(boost::posix_time::seconds(interval));
+
+			// an error must not end the thread (and the process), the leases are renewed
+			// again with the next heartbeat
+			try
+			{
+				heartbeat();
+			}
+			catch (boost::thread_interrupted&)
+			{
+				throw;
+			}
+			catch (boost::exception& e)
+			{
+				LOG_ERROR(blockleaselog) << "heartbeat failed: "
+					<< boost::diagnostic_information(e) << std::endl;
+			}
+			catch (std::exception& e)
+			{
+				LOG_ERROR(blockleaselog) << "heartbeat failed: " << e.what() << std::endl;
+			}
+		}
+	}
+	catch (boost::thread_interrupted& e)
+	{
+		// stopHeartbeat() was called
+	}
+}
+
+std::string
+BlockLeaseManager::taskName(Task task)
+{
+	switch (task)
+	{
+		case SlicesTask:
+			return "slices";
+		case SegmentsTask:
+			return "segments";
+		case SolutionTask:
+			return "solution";
+	}
+
+	return "unknown";
+}
+
+std::string
+BlockLeaseManager::defaultWorker()
+{
+	char hostname[256];
+
+	if (gethostname(hostname, sizeof(hostname)) != 0)
+		hostname[0] = '\0';
+	hostname[sizeof(hostname) - 1] = '\0';
+
+	// distinguish several lease managers in the same process
+	static boost::mutex counterMutex;
+	static unsigned int counter = 0;
+
+	boost::mutex::scoped_lock lock(counterMutex);
+
+	std::ostringstream os;
+	os << hostname << ":" << getpid() << ":" << counter++;
+
+	return os.str();
+}
@@ -0,0 +1,222 @@
+#ifndef BLOCK_LEASE_MANAGER_H__
+#define BLOCK_LEASE_MANAGER_H__
+
+#include <ctime>
+#include <map>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <sopnet/block/Block.h>
+#include <sopnet/block/Blocks.h>
+#include <sopnet/block/Core.h>
+#include <util/point3.hpp>
+
+/**
+ * A lease-based work queue on top of the BlockManager flags. Before a worker
+ * extracts slices or segments in a block, or solves a core, it claims a lease
+ * on it. While the lease is held, other workers see the block as in progress
+ * and don't duplicate the work. When the work is done, finish() sets the
+ * corresponding BlockManager flag and drops the lease.
+ *
+ * Leases expire after a fixed duration. A background thread renews all held
+ * leases regularly (the heartbeat), such that leases of crashed workers
+ * expire, but those of busy workers don't.
+ *
+ * Subclasses implement the storage of the leases, which has to be atomic
+ * between all workers that share a BlockManager.
+ */
+class BlockLeaseManager
+{
+public:
+
+	/**
+	 * The kind of work a lease is held for.
+	 */
+	enum Task
+	{
+		/** Slice extraction in a block. */
+		SlicesTask,
+
+		/** Segment extraction in a block. */
+		SegmentsTask,
+
+		/** Solving a core. */
+		SolutionTask
+	};
+
+	/**
+	 * The result of a claim.
+	 */
+	enum ClaimResult
+	{
+		/** The lease was granted to this worker. */
+		Claimed,
+
+		/** The work is already done. */
+		Done,
+
+		/** Another worker holds an unexpired lease. */
+		InProgress,
+
+		/** The lease storage could not be reached or reported an error. */
+		Failed
+	};
+
+	/**
+	 * Identifies a block (or core, for SolutionTask) and the task.
+	 */
+	struct Lease
+	{
+		Lease(Task task_, unsigned int id_, const util::point3<unsigned int>& coordinates_) :
+			task(task_), id(id_), coordinates(coordinates_) {}
+
+		Task task;
+		unsigned int id;
+		util::point3<unsigned int> coordinates;
+
+		bool operator<(const Lease& other) const;
+	};
+
+	/**
+	 * Create a lease manager.
+	 *
+	 * @param worker a name for this worker that is unique among all workers. If empty, it is
+	 *               built from the host name and the process id.
+	 * @param leaseDuration the lease duration in seconds. If 0, the value of the program
+	 *                      option blockLeases.leaseDuration is used.
+	 */
+	BlockLeaseManager(const std::string& worker = "", unsigned int leaseDuration = 0);
+
+	/**
+	 * Stops the heartbeat. Leases that are still held are released without marking them
+	 * done. Subclasses have to call stopHeartbeat() in their destructor.
+	 */
+	virtual ~BlockLeaseManager();
+
+	/**
+	 * Try to claim a lease to extract slices or segments in a block.
+	 */
+	ClaimResult claim(boost::shared_ptr<Block> block, Task task);
+
+	/**
+	 * Try to claim a lease to solve a core.
+	 */
+	ClaimResult claim(boost::shared_ptr<Core> core);
+
+	/**
+	 * Like claim(), but waits while another worker holds the lease. Returns Claimed or Done.
+	 *
+	 * A Failed claim is retried up to blockLeases.maxRetries times, with a delay that doubles
+	 * after each failure. If the claim still fails, an IOError is thrown.
+	 */
+	ClaimResult waitAndClaim(boost::shared_ptr<Block> block, Task task);
+
+	/**
+	 * Claim the first block of the given blocks that is neither done nor in progress.
+	 *
+	 * @return the claimed block, or an empty pointer if there is none.
+	 * @throws IOError if no block was claimed, but claims failed for some of the blocks
+	 */
+	boost::shared_ptr<Block> claimNext(boost::shared_ptr<Blocks> blocks, Task task);
+
+	/**
+	 * Mark the work on a block as done and drop the lease.
+	 */
+	void finish(boost::shared_ptr<Block> block, Task task);
+
+	/**
+	 * Mark the solution of a core as set and drop the lease.
+	 */
+	void finish(boost::shared_ptr<Core> core);
+
+	/**
+	 * Drop the lease on a block without marking the work as done, e.g., after an error.
+	 */
+	void release(boost::shared_ptr<Block> block, Task task);
+
+	/**
+	 * Drop the lease on a core without marking the solution as set.
+	 */
+	void release(boost::shared_ptr<Core> core);
+
+	/**
+	 * Renew all held leases. Called regularly by the heartbeat thread. The leases are renewed
+	 * without holding the lock, such that claims are not blocked by the requests.
+	 */
+	void heartbeat();
+
+	/**
+	 * @return the name of this worker.
+	 */
+	const std::string& getWorker() const { return _worker; }
+
+	/**
+	 * @return the lease duration in seconds.
+	 */
+	unsigned int getLeaseDuration() const { return _leaseDuration; }
+
+	/**
+	 * @return a readable name for a task.
+	 */
+	static std::string taskName(Task task);
+
+protected:
+
+	/**
+	 * Atomically check the lease, and take it if it is free or expired.
+	 *
+	 * @param lease the lease to take
+	 * @param expiry the expiry time of the new lease
+	 * @return Claimed, Done if the work was finished by another worker, InProgress, or
+	 *         Failed if the storage could not be queried
+	 */
+	virtual ClaimResult acquireLease(const Lease& lease, std::time_t expiry) = 0;
+
+	/**
+	 * Extend a held lease.
+	 *
+	 * @return false, if the lease was lost (it expired and was taken by another worker)
+	 */
+	virtual bool renewLease(const Lease& lease, std::time_t expiry) = 0;
+
+	/**
+	 * Drop a held lease.
+	 *
+	 * @param done whether the work was finished
+	 */
+	virtual void releaseLease(const Lease& lease, bool done) = 0;
+
+	/**
+	 * Stop the heartbeat thread and release all held leases. To be called in the destructor
+	 * of subclasses, while the lease storage is still available. Does not throw, errors
+	 * while releasing a lease are logged.
+	 */
+	void stopHeartbeat();
+
+private:
+
+	ClaimResult claim(const Lease& lease, bool done);
+
+	void finish(const Lease& lease);
+
+	void release(const Lease& lease);
+
+	void heartbeatLoop();
+
+	static std::string defaultWorker();
+
+	std::string _worker;
+
+	unsigned int _leaseDuration;
+
+	// the held leases
+	std::map<Lease, std::time_t> _leases;
+
+	boost::mutex _mutex;
+
+	boost::thread _heartbeat;
+};
+
+#endif //BLOCK_LEASE_MANAGER_H__
@@ -0,0 +1,184 @@
+#include <fstream>
+#include <sstream>
+
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <util/exceptions.h>
+#include <util/Logger.h>
+#include "LocalBlockLeaseManager.h"
+
+logger::LogChannel localblockleaselog("localblockleaselog", "[LocalBlockLeaseManager] ");
+
+// The file lock does not synchronize threads of the same process.
+static boost::mutex processMutex;
+
+typedef boost::interprocess::scoped_lock<boost::interprocess::file_lock> file_scoped_lock;
+
+LocalBlockLeaseManager::LocalBlockLeaseManager(
+		const std::string& directory,
+		const std::string& worker,
+		unsigned int leaseDuration) :
+	BlockLeaseManager(worker, leaseDuration),
+	_directory(directory)
+{
+	if (!boost::filesystem::exists(_directory))
+		boost::filesystem::create_directories(_directory);
+
+	if (!boost::filesystem::is_directory(_directory))
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"lease directory " << _directory << " is not a directory");
+
+	boost::filesystem::path lockFile = _directory/"leases.lock";
+
+	// the lock file has to exist to be locked
+	std::ofstream(lockFile.string().c_str(), std::ios::app);
+
+	boost::interprocess::file_lock fileLock(lockFile.string().c_str());
+	_fileLock.swap(fileLock);
+
+	LOG_DEBUG(localblockleaselog) << "keeping leases in " << _directory << std::endl;
+}
+
+LocalBlockLeaseManager::~LocalBlockLeaseManager()
+{
+	stopHeartbeat();
+}
+
+BlockLeaseManager::ClaimResult
+LocalBlockLeaseManager::acquireLease(const Lease& lease, std::time_t expiry)
+{
+	boost::mutex::scoped_lock processLock(processMutex);
+	file_scoped_lock fileLock(_fileLock);
+
+	LeaseState state = readLease(lease);
+
+	if (state.done)
+		return Done;
+
+	if (state.exists && state.worker != getWorker() && state.expiry > std::time(0))
+		return InProgress;
+
+	if (state.exists && state.worker != getWorker())
+		LOG_USER(localblockleaselog) << "taking over expired lease of " << state.worker
+			<< " on " << lease.coordinates << std::endl;
+
+	state.exists = true;
+	state.worker = getWorker();
+	state.expiry = expiry;
+
+	writeLease(lease, state);
+
+	return Claimed;
+}
+
+bool
+LocalBlockLeaseManager::renewLease(const Lease& lease, std::time_t expiry)
+{
+	boost::mutex::scoped_lock processLock(processMutex);
+	file_scoped_lock fileLock(_fileLock);
+
+	LeaseState state = readLease(lease);
+
+	if (!state.exists || state.done || state.worker != getWorker())
+		return false;
+
+	state.expiry = expiry;
+
+	writeLease(lease, state);
+
+	return true;
+}
+
+void
+LocalBlockLeaseManager::releaseLease(const Lease& lease, bool done)
+{
+	boost::mutex::scoped_lock processLock(processMutex);
+	file_scoped_lock fileLock(_fileLock);
+
+	if (done)
+	{
+		LeaseState state;
+		state.exists = true;
+		state.done = true;
+
+		writeLease(lease, state);
+
+		return;
+	}
+
+	LeaseState state = readLease(lease);
+
+	// don't remove a lease that was taken over by another worker
+	if (state.exists && !state.done && state.worker == getWorker())
+		boost::filesystem::remove(leaseFile(lease));
+}
+
+boost::filesystem::path
+LocalBlockLeaseManager::leaseFile(const Lease& lease)
+{
+	std::ostringstream name;
+	name << taskName(lease.task) << "_"
+		<< lease.coordinates.x << "_"
+		<< lease.coordinates.y << "_"
+		<< lease.coordinates.z << ".lease";
+
+	return _directory/name.str();
+}
+
+LocalBlockLeaseManager::LeaseState
+LocalBlockLeaseManager::readLease(const Lease& lease)
+{
+	LeaseState state;
+
+	std::ifstream in(leaseFile(lease).string().c_str());
+
+	if (!in)
+		return state;
+
+	std::string first;
+	in >> first;
+
+	state.exists = true;
+
+	if (first == "done")
+	{
+		state.done = true;
+	}
+	else
+	{
+		state.worker = first;
+		in >> state.expiry;
+
+		// a corrupt lease counts as expired
+		if (!in)
+			state.expiry = 0;
+	}
+
+	return state;
+}
+
+void
+LocalBlockLeaseManager::writeLease(const Lease& lease, const LeaseState& state)
+{
+	boost::filesystem::path file = leaseFile(lease);
+	boost::filesystem::path tmp(file.string() + ".tmp");
+
+	{
+		std::ofstream out(tmp.string().c_str(), std::ios::trunc);
+
+		if (state.done)
+			out << "done" << std::endl;
+		else
+			out << state.worker << " " << state.expiry << std::endl;
+
+		if (!out)
+			UTIL_THROW_EXCEPTION(
+					IOError,
+					"could not write lease file " << tmp);
+	}
+
+	// replace the old lease atomically
+	boost::filesystem::rename(tmp, file);
+}
@@ -0,0 +1,74 @@
+#ifndef LOCAL_BLOCK_LEASE_MANAGER_H__
+#define LOCAL_BLOCK_LEASE_MANAGER_H__
+
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+
+#include "BlockLeaseManager.h"
+
+/**
+ * A BlockLeaseManager that keeps its leases as files in a directory, to be shared by workers
+ * on one machine. Leases are identified by the block (or core) coordinates, since the ids
+ * of LocalBlockManager are only valid within one process.
+ *
+ * Each lease is a file named after the task and coordinates, containing either "done" or
+ * the worker name and the expiry time. All accesses are serialized with a lock file in the
+ * same directory.
+ */
+class LocalBlockLeaseManager : public BlockLeaseManager
+{
+public:
+
+	/**
+	 * Create a local lease manager.
+	 *
+	 * @param directory the directory to keep the leases in. Will be created, if it does not
+	 *                  exist.
+	 * @param worker the name of this worker, see BlockLeaseManager.
+	 * @param leaseDuration the lease duration in seconds, see BlockLeaseManager.
+	 */
+	LocalBlockLeaseManager(
+			const std::string& directory,
+			const std::string& worker = "",
+			unsigned int leaseDuration = 0);
+
+	~LocalBlockLeaseManager();
+
+protected:
+
+	ClaimResult acquireLease(const Lease& lease, std::time_t expiry);
+
+	bool renewLease(const Lease& lease, std::time_t expiry);
+
+	void releaseLease(const Lease& lease, bool done);
+
+private:
+
+	/**
+	 * The content of a lease file.
+	 */
+	struct LeaseState
+	{
+		LeaseState() : exists(false), done(false), expiry(0) {}
+
+		bool exists;
+		bool done;
+		std::string worker;
+		std::time_t expiry;
+	};
+
+	boost::filesystem::path leaseFile(const Lease& lease);
+
+	LeaseState readLease(const Lease& lease);
+
+	void writeLease(const Lease& lease, const LeaseState& state);
+
+	boost::filesystem::path _directory;
+
+	// serializes the access of different processes
+	boost::interprocess::file_lock _fileLock;
+};
+
+#endif //LOCAL_BLOCK_LEASE_MANAGER_H__
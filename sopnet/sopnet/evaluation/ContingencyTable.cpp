@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <iterator>
+
+#include <boost/bind.hpp>
+
+#include <sopnet/parallel/WorkerPool.h>
+#include <util/exceptions.h>
+#include <util/foreach.h>
+#include <util/Logger.h>
+#include "ContingencyTable.h"
+
+logger::LogChannel contingencytablelog("contingencytablelog", "[ContingencyTable] ");
+
+ContingencyTable::ContingencyTable() :
+	_numLocations(0) {}
+
+void
+ContingencyTable::clear() {
+
+	_joint.clear();
+	_counts1.clear();
+	_counts2.clear();
+	_numLocations = 0;
+}
+
+void
+ContingencyTable::compute(const ImageStack& stack1, const ImageStack& stack2, unsigned int numThreads) {
+
+	if (stack1.size() != stack2.size())
+		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("image stacks have different size") << STACK_TRACE);
+
+	ImageStack::const_iterator image1 = stack1.begin();
+	ImageStack::const_iterator image2 = stack2.begin();
+
+	for (; image1 != stack1.end(); image1++, image2++)
+		if ((*image1)->size() != (*image2)->size())
+			BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("images have different size") << STACK_TRACE);
+
+	clear();
+
+	unsigned int depth = stack1.size();
+
+	if (depth == 0)
+		return;
+
+	WorkerPool workers(numThreads);
+
+	// one slab of consecutive sections per thread, such that each table sees 
+	// only a part of the labels
+	unsigned int numSlabs = std::min(workers.size(), depth);
+	std::vector<ContingencyTable> slabTables(numSlabs);
+
+	for (unsigned int i = 0; i < numSlabs; i++) {
+
+		unsigned int begin = (i*depth)/numSlabs;
+		unsigned int end   = ((i + 1)*depth)/numSlabs;
+
+		workers.schedule(
+				boost::bind(
+						&ContingencyTable::count,
+						&slabTables[i],
+						boost::cref(stack1),
+						boost::cref(stack2),
+						begin,
+						end));
+	}
+
+	workers.wait();
+
+	foreach (const ContingencyTable& slabTable, slabTables)
+		merge(slabTable);
+
+	LOG_DEBUG(contingencytablelog)
+			<< "counted " << _numLocations << " locations in " << numSlabs << " slabs, found "
+			<< _counts1.size() << " and " << _counts2.size() << " labels with "
+			<< _joint.size() << " co-occurrences" << std::endl;
+}
+
+void
+ContingencyTable::count(const ImageStack& stack1, const ImageStack& stack2, unsigned int begin, unsigned int end) {
+
+	ImageStack::const_iterator image1 = stack1.begin();
+	ImageStack::const_iterator image2 = stack2.begin();
+
+	std::advance(image1, begin);
+	std::advance(image2, begin);
+
+	for (unsigned int z = begin; z < end; z++, image1++, image2++) {
+
+		Image::iterator i1 = (*image1)->begin();
+		Image::iterator i2 = (*image2)->begin();
+
+		// Labels form large regions, so consecutive pixels often repeat the 
+		// previous label pair. Count runs instead of hashing every pixel.
+		size_t runLength = 0;
+		LabelPair run;
+
+		for (; i1 != (*image1)->end(); i1++, i2++) {
+
+			if (runLength > 0 && run.first == *i1 && run.second == *i2) {
+
+				runLength++;
+				continue;
+			}
+
+			if (runLength > 0) {
+
+				_joint[run]          += runLength;
+				_counts1[run.first]  += runLength;
+				_counts2[run.second] += runLength;
+			}
+
+			run       = LabelPair(*i1, *i2);
+			runLength = 1;
+		}
+
+		if (runLength > 0) {
+
+			_joint[run]          += runLength;
+			_counts1[run.first]  += runLength;
+			_counts2[run.second] += runLength;
+		}
+
+		_numLocations += (*image1)->size();
+	}
+}
+
+void
+ContingencyTable::merge(const ContingencyTable& other) {
+
+	typedef JointCounts::value_type joint_type;
+	typedef Counts::value_type      count_type;
+
+	foreach (const joint_type& j, other._joint)
+		_joint[j.first] += j.second;
+	foreach (const count_type& c, other._counts1)
+		_counts1[c.first] += c.second;
+	foreach (const count_type& c, other._counts2)
+		_counts2[c.first] += c.second;
+
+	_numLocations += other._numLocations;
+}
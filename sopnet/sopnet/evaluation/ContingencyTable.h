@@ -0,0 +1,80 @@
+#ifndef SOPNET_EVALUATION_CONTINGENCY_TABLE_H__
+#define SOPNET_EVALUATION_CONTINGENCY_TABLE_H__
+
+#include <utility>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <imageprocessing/ImageStack.h>
+
+/**
+ * The joint and marginal label counts of two labelings of the same volume. 
+ * This is the common basis of partition comparison measures like the Rand 
+ * index and the variation of information.
+ */
+class ContingencyTable {
+
+public:
+
+	typedef float                                                                Label;
+	typedef std::pair<Label, Label>                                              LabelPair;
+	typedef boost::unordered_map<LabelPair, size_t, boost::hash<LabelPair> >     JointCounts;
+	typedef boost::unordered_map<Label, size_t>                                  Counts;
+
+	ContingencyTable();
+
+	/**
+	 * Count the label co-occurrences of two image stacks in one pass over the 
+	 * images. Slabs of sections are counted in parallel into separate tables, 
+	 * which are merged afterwards.
+	 *
+	 * @param numThreads
+	 *              The number of threads to use. If 0, the default number of 
+	 *              worker threads is used.
+	 */
+	void compute(const ImageStack& stack1, const ImageStack& stack2, unsigned int numThreads = 0);
+
+	/**
+	 * Remove all counts.
+	 */
+	void clear();
+
+	/**
+	 * Add the counts of another table to this one.
+	 */
+	void merge(const ContingencyTable& other);
+
+	/**
+	 * The number of locations with a given pair of labels.
+	 */
+	const JointCounts& getJointCounts() const { return _joint; }
+
+	/**
+	 * The number of locations of each label in the first stack.
+	 */
+	const Counts& getCounts1() const { return _counts1; }
+
+	/**
+	 * The number of locations of each label in the second stack.
+	 */
+	const Counts& getCounts2() const { return _counts2; }
+
+	/**
+	 * The total number of locations.
+	 */
+	size_t getNumLocations() const { return _numLocations; }
+
+private:
+
+	// count the sections [begin, end)
+	void count(const ImageStack& stack1, const ImageStack& stack2, unsigned int begin, unsigned int end);
+
+	JointCounts _joint;
+	Counts      _counts1;
+	Counts      _counts2;
+	size_t      _numLocations;
+};
+
+#endif // SOPNET_EVALUATION_CONTINGENCY_TABLE_H__
+
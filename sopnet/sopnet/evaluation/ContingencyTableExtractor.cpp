@@ -0,0 +1,15 @@
+#include "ContingencyTableExtractor.h"
+
+ContingencyTableExtractor::ContingencyTableExtractor() :
+	_contingencyTable(new ContingencyTable()) {
+
+	registerInput(_stack1, "stack 1");
+	registerInput(_stack2, "stack 2");
+	registerOutput(_contingencyTable, "contingency table");
+}
+
+void
+ContingencyTableExtractor::updateOutputs() {
+
+	_contingencyTable->compute(*_stack1, *_stack2);
+}
@@ -0,0 +1,32 @@
+#ifndef SOPNET_EVALUATION_CONTINGENCY_TABLE_EXTRACTOR_H__
+#define SOPNET_EVALUATION_CONTINGENCY_TABLE_EXTRACTOR_H__
+
+#include <pipeline/all.h>
+
+#include <imageprocessing/ImageStack.h>
+#include "ContingencyTable.h"
+
+/**
+ * Counts the label co-occurrences of two image stacks. Connect the output to 
+ * RandIndex and VariationOfInformation to compute both measures from a single 
+ * pass over the volume.
+ */
+class ContingencyTableExtractor : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	ContingencyTableExtractor();
+
+private:
+
+	void updateOutputs();
+
+	// input image stacks
+	pipeline::Input<ImageStack> _stack1;
+	pipeline::Input<ImageStack> _stack2;
+
+	pipeline::Output<ContingencyTable> _contingencyTable;
+};
+
+#endif // SOPNET_EVALUATION_CONTINGENCY_TABLE_EXTRACTOR_H__
+
@@ -1,8 +1,14 @@
-#include <vigra/multi_distance.hxx>
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
 //#include <vigra/multi_impex.hxx>
 
+#include <sopnet/parallel/WorkerPool.h>
+#include <util/foreach.h>
 #include <util/Logger.h>
 #include "DistanceToleranceFunction.h"
+#include "EuclideanDistanceTransform.h"
 
 logger::LogChannel distancetolerancelog("distancetolerancelog", "[DistanceToleranceFunction] ");
 
@@ -99,21 +105,10 @@ DistanceToleranceFunction::createBoundaryMap(const ImageStack& recLabels) {
 void
 DistanceToleranceFunction::createBoundaryDistanceMap() {
 
-	vigra::Shape3 shape(_width, _height, _depth);
-	_boundaryDistance2.reshape(shape);
-
-	float pitch[3];
-	pitch[0] = _resolutionX;
-	pitch[1] = _resolutionY;
-	pitch[2] = _resolutionZ;
-
 	// compute l2 distance for each pixel to boundary
 	LOG_DEBUG(distancetolerancelog) << "computing boundary distances" << std::endl;
-	vigra::separableMultiDistSquared(
-			_boundaryMap,
-			_boundaryDistance2,
-			true /* background */,
-			pitch);
+	EuclideanDistanceTransform distanceTransform(_resolutionX, _resolutionY, _resolutionZ);
+	distanceTransform(_boundaryMap, _boundaryDistance2);
 }
 
 void
@@ -128,31 +123,40 @@ DistanceToleranceFunction::enumerateCellLabels(const ImageStack& recLabels) {
 	if (_relabelCandidates.size() == 0)
 		return;
 
-	LOG_DEBUG(distancetolerancelog) << "creating distance threshold neighborhood" << std::endl;
+	// find the alternative labels of all candidates in parallel, each 
+	// candidate only reads the boundary map and the reconstruction
+	std::vector<std::set<float> > alternativeLabels(_relabelCandidates.size());
 
-	// list of all location offsets within threshold distance
-	std::vector<cell_t::Location> neighborhood = createNeighborhood();
+	WorkerPool workers;
 
-	LOG_DEBUG(distancetolerancelog) << "there are " << neighborhood.size() << " pixels in the neighborhood for a threshold of " << _maxDistanceThreshold << std::endl;
+	for (unsigned int i = 0; i < _relabelCandidates.size(); i++)
+		workers.schedule(
+				boost::bind(
+						&DistanceToleranceFunction::findAlternativeLabels,
+						this,
+						boost::cref((*_cells)[_relabelCandidates[i]]),
+						boost::cref(recLabels),
+						boost::ref(alternativeLabels[i])));
+
+	workers.wait();
 
 	// for each cell
-	foreach (unsigned int index, _relabelCandidates) {
+	for (unsigned int i = 0; i < _relabelCandidates.size(); i++) {
 
-		cell_t& cell = (*_cells)[index];
+		unsigned int index = _relabelCandidates[i];
+		cell_t&      cell  = (*_cells)[index];
 
 		LOG_ALL(distancetolerancelog) << "processing cell " << index << " (label " << cell.getReconstructionLabel() << ")" << std::flush;
 
-		std::set<float> alternativeLabels = getAlternativeLabels(cell, neighborhood, recLabels);
-
 		// every cell that is small enough to be relabelled is allowed to change
 		// to background label
 		if (_haveBackgroundLabel)
-			alternativeLabels.insert(_backgroundLabel);
+			alternativeLabels[i].insert(_backgroundLabel);
 
 		LOG_ALL(distancetolerancelog) << "; can map to ";
 
 		// for each alternative label
-		foreach (float recLabel, alternativeLabels) {
+		foreach (float recLabel, alternativeLabels[i]) {
 
 			LOG_ALL(distancetolerancelog) << recLabel << " ";
 
@@ -161,9 +165,6 @@ DistanceToleranceFunction::enumerateCellLabels(const ImageStack& recLabels) {
 			registerPossibleMatch(cell.getGroundTruthLabel(), recLabel);
 		}
 		LOG_ALL(distancetolerancelog) << std::endl;
-
-		// DEBUG
-		index++;
 	}
 }
 
@@ -203,137 +204,96 @@ DistanceToleranceFunction::isBoundaryVoxel(int x, int y, int z, const ImageStack
 	return false;
 }
 
-std::vector<DistanceToleranceFunction::cell_t::Location>
-DistanceToleranceFunction::createNeighborhood() {
+void
+DistanceToleranceFunction::findAlternativeLabels(
+		const cell_t& cell,
+		const ImageStack& recLabels,
+		std::set<float>& alternativeLabels) {
 
-	std::vector<cell_t::Location> thresholdOffsets;
+	if (cell.size() == 0)
+		return;
 
-	// quick check first: test on all three axes -- if they contain all covering
-	// labels already, we can abort iterating earlier in getAlternativeLabels()
+	float cellLabel = cell.getReconstructionLabel();
+	float threshold2 = _maxDistanceThreshold*_maxDistanceThreshold;
 
-	for (int z = 1; z <= _maxDistanceThresholdZ; z++) {
+	// All boundary locations within the threshold distance of the cell are in 
+	// the bounding box of the cell, grown by the threshold.
 
-		thresholdOffsets.push_back(cell_t::Location(0, 0,  z));
-		thresholdOffsets.push_back(cell_t::Location(0, 0, -z));
-	}
-	for (int y = 1; y <= _maxDistanceThresholdY; y++) {
+	int minX = _width, minY = _height, minZ = _depth;
+	int maxX = 0, maxY = 0, maxZ = 0;
 
-		thresholdOffsets.push_back(cell_t::Location(0,  y, 0));
-		thresholdOffsets.push_back(cell_t::Location(0, -y, 0));
-	}
-	for (int x = 1; x <= _maxDistanceThresholdX; x++) {
+	foreach (const cell_t::Location& l, cell) {
 
-		thresholdOffsets.push_back(cell_t::Location( x, 0, 0));
-		thresholdOffsets.push_back(cell_t::Location(-x, 0, 0));
+		minX = std::min(minX, l.x); maxX = std::max(maxX, l.x);
+		minY = std::min(minY, l.y); maxY = std::max(maxY, l.y);
+		minZ = std::min(minZ, l.z); maxZ = std::max(maxZ, l.z);
 	}
 
-	for (int z = -_maxDistanceThresholdZ; z <= _maxDistanceThresholdZ; z++)
-		for (int y = -_maxDistanceThresholdY; y <= _maxDistanceThresholdY; y++)
-			for (int x = -_maxDistanceThresholdX; x <= _maxDistanceThresholdX; x++) {
-
-				// axis locations have been added already, center is not needed
-				if ((x == 0 && y == 0) || (x == 0 && z == 0) || (y == 0 && z == 0))
-					continue;
-
-				// is it within threshold distance?
-				if (
-						x*_resolutionX*x*_resolutionX +
-						y*_resolutionY*y*_resolutionY +
-						z*_resolutionZ*z*_resolutionZ <= _maxDistanceThreshold*_maxDistanceThreshold)
+	minX = std::max(minX - _maxDistanceThresholdX, 0); maxX = std::min(maxX + _maxDistanceThresholdX, (int)_width  - 1);
+	minY = std::max(minY - _maxDistanceThresholdY, 0); maxY = std::min(maxY + _maxDistanceThresholdY, (int)_height - 1);
+	minZ = std::max(minZ - _maxDistanceThresholdZ, 0); maxZ = std::min(maxZ + _maxDistanceThresholdZ, (int)_depth  - 1);
 
-					thresholdOffsets.push_back(cell_t::Location(x, y, z));
-			}
+	vigra::Shape3 boxShape(maxX - minX + 1, maxY - minY + 1, maxZ - minZ + 1);
 
-	return thresholdOffsets;
-}
+	// Every alternative label has to be close to the first location of the 
+	// cell. Collect these candidates, together with the boundary labels of the 
+	// box.
 
-std::set<float>
-DistanceToleranceFunction::getAlternativeLabels(
-		const cell_t& cell,
-		const std::vector<cell_t::Location>& neighborhood,
-		const ImageStack& recLabels) {
+	const cell_t::Location& first = *cell.begin();
 
-	float cellLabel = cell.getReconstructionLabel();
+	std::set<float> candidates;
+	vigra::MultiArray<3, float> boxLabels(boxShape);
 
-	// counts for each neighbor label, how often it was found while iterating 
-	// over the cells locations
-	std::map<float, unsigned int> counts;
+	for (int z = minZ; z <= maxZ; z++)
+		for (int y = minY; y <= maxY; y++)
+			for (int x = minX; x <= maxX; x++) {
 
-	// the number of cell locations visited so far
-	unsigned int numVisited = 0;
-
-	// the maximal number of alternative labels, starts with number of labels 
-	// found at first location and decreases whenever one label was not found
-	unsigned int maxAlternativeLabels = 0;
-
-	// for each location i in that cell
-	foreach (const cell_t::Location& i, cell) {
+				if (!_boundaryMap(x, y, z))
+					continue;
 
-		// all the labels in the neighborhood of i
-		std::set<float> neighborhoodLabels;
+				float label = (*(recLabels)[z])(x, y);
 
-		numVisited++;
+				boxLabels(x - minX, y - minY, z - minZ) = label;
 
-		// the number of complete neighbor labels that have been seen at the 
-		// current location
-		unsigned int numComplete = 0;
+				if (label == cellLabel)
+					continue;
 
-		// for all locations within the neighborhood, get alternative labels
-		foreach (const cell_t::Location& n, neighborhood) {
+				float distance2 =
+						(x - first.x)*_resolutionX*(x - first.x)*_resolutionX +
+						(y - first.y)*_resolutionY*(y - first.y)*_resolutionY +
+						(z - first.z)*_resolutionZ*(z - first.z)*_resolutionZ;
 
-			cell_t::Location j(i.x + n.x, i.y + n.y, i.z + n.z);
+				if (distance2 <= threshold2)
+					candidates.insert(label);
+			}
 
-			// are we leaving the image?
-			if (j.x < 0 || j.x >= (int)_width || j.y < 0 || j.y >= (int)_height || j.z < 0 || j.z >= (int)_depth)
-				continue;
+	// A candidate is an alternative label, if all locations of the cell are 
+	// within the threshold distance of a boundary location of this label.
 
-			// is this a boundary?
-			if (!_boundaryMap(j.x, j.y, j.z))
-				continue;
+	EuclideanDistanceTransform distanceTransform(_resolutionX, _resolutionY, _resolutionZ, 1);
+	EuclideanDistanceTransform::mask_type     features(boxShape);
+	EuclideanDistanceTransform::distance_type distance2(boxShape);
 
-			// now we have found a boundary pixel within our neighborhood
-			float label = (*(recLabels)[j.z])(j.x, j.y);
+	foreach (float label, candidates) {
 
-			// count how often we see a neighbor label the first time
-			if (label != cellLabel) {
+		for (int z = minZ; z <= maxZ; z++)
+			for (int y = minY; y <= maxY; y++)
+				for (int x = minX; x <= maxX; x++)
+					features(x - minX, y - minY, z - minZ) =
+							_boundaryMap(x, y, z) && boxLabels(x - minX, y - minY, z - minZ) == label;
 
-				bool firstTime = neighborhoodLabels.insert(label).second;
+		distanceTransform(features, distance2);
 
-				// seen the first time for the current location i
-				if (firstTime)
-					// is a potential alternative label (covers all visited 
-					// locations so far)
-					if (++counts[label] == numVisited) {
+		bool coversCell = true;
 
-						numComplete++;
+		foreach (const cell_t::Location& l, cell)
+			if (distance2(l.x - minX, l.y - minY, l.z - minZ) > threshold2) {
 
-						// if we have seen all the possible complete labels 
-						// already, there is no need to search further for the 
-						// current location i
-						if (numComplete == maxAlternativeLabels)
-							break;
-					}
+				coversCell = false;
+				break;
 			}
-		}
-
-		// the number of labels that we have seen for each location visited so 
-		// far is the maximal possible number of alternative labels
-		maxAlternativeLabels = numComplete;
-
-		// none of the neighbor labels covers the cell
-		if (maxAlternativeLabels == 0)
-			break;
-	}
-
-	std::set<float> alternativeLabels;
 
-	// collect all neighbor labels that we have seen for every location of the 
-	// cell
-	float label;
-	unsigned int count;
-	foreach (boost::tie(label, count), counts)
-		if (count == cell.size())
+		if (coversCell)
 			alternativeLabels.insert(label);
-
-	return alternativeLabels;
+	}
 }
@@ -29,15 +29,12 @@ private:
 	// create a distance2 image of boundary distances
 	void createBoundaryDistanceMap();
 
-	// find all offset locations for the given distance threshold
-	std::vector<cell_t::Location> createNeighborhood();
-
-	// search for all relabeling alternatives for the given cell and 
-	// neighborhood
-	std::set<float> getAlternativeLabels(
+	// search for all relabeling alternatives for the given cell: labels whose 
+	// boundary is within the distance threshold of every location of the cell
+	void findAlternativeLabels(
 			const cell_t& cell,
-			const std::vector<cell_t::Location>& neighborhood,
-			const ImageStack& recLabels);
+			const ImageStack& recLabels,
+			std::set<float>& alternativeLabels);
 
 	// test, whether a voxel is surrounded by at least one other voxel with a 
 	// different label
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <limits>
+
+#include <boost/bind.hpp>
+
+#include <sopnet/parallel/WorkerPool.h>
+#include <util/Logger.h>
+#include "EuclideanDistanceTransform.h"
+
+logger::LogChannel euclideandistancetransformlog("euclideandistancetransformlog", "[EuclideanDistanceTransform] ");
+
+namespace {
+
+const double Infinity = std::numeric_limits<double>::infinity();
+
+} // anonymous namespace
+
+EuclideanDistanceTransform::EuclideanDistanceTransform(
+		float resolutionX,
+		float resolutionY,
+		float resolutionZ,
+		unsigned int numThreads) :
+	_numThreads(numThreads) {
+
+	_resolution[0] = resolutionX;
+	_resolution[1] = resolutionY;
+	_resolution[2] = resolutionZ;
+}
+
+void
+EuclideanDistanceTransform::operator()(const mask_type& features, distance_type& distance2) {
+
+	distance2.reshape(features.shape());
+
+	for (size_t i = 0; i < features.size(); i++)
+		distance2[i] = (features[i] ? 0 : Infinity);
+
+	transform(distance2, 0);
+}
+
+void
+EuclideanDistanceTransform::operator()(const mask_type& features, distance_type& distance2, nearest_type& nearest) {
+
+	distance2.reshape(features.shape());
+	nearest.reshape(features.shape());
+
+	for (size_t i = 0; i < features.size(); i++) {
+
+		distance2[i] = (features[i] ? 0 : Infinity);
+		nearest[i]   = i;
+	}
+
+	transform(distance2, &nearest);
+}
+
+void
+EuclideanDistanceTransform::transform(distance_type& distance2, nearest_type* nearest) {
+
+	if (distance2.size() == 0)
+		return;
+
+	// don't start threads for a single one
+	if (_numThreads == 1) {
+
+		for (unsigned int axis = 0; axis < 3; axis++)
+			transformLines(distance2, nearest, axis, 0, distance2.shape(axis == 2 ? 1 : 2));
+
+		return;
+	}
+
+	WorkerPool workers(_numThreads);
+
+	LOG_DEBUG(euclideandistancetransformlog)
+			<< "transforming volume of size " << distance2.shape()
+			<< " with " << workers.size() << " threads" << std::endl;
+
+	for (unsigned int axis = 0; axis < 3; axis++) {
+
+		// Lines along x and y are split over sections, lines along z over 
+		// rows. Each job works on disjoint lines.
+		unsigned int outer    = (axis == 2 ? 1 : 2);
+		unsigned int numOuter = distance2.shape(outer);
+		unsigned int numJobs  = std::min(workers.size(), numOuter);
+
+		for (unsigned int i = 0; i < numJobs; i++)
+			workers.schedule(
+					boost::bind(
+							&EuclideanDistanceTransform::transformLines,
+							this,
+							boost::ref(distance2),
+							nearest,
+							axis,
+							(i*numOuter)/numJobs,
+							((i + 1)*numOuter)/numJobs));
+
+		// the next pass needs the complete result of this one
+		workers.wait();
+	}
+}
+
+void
+EuclideanDistanceTransform::transformLines(
+		distance_type& distance2,
+		nearest_type*  nearest,
+		unsigned int   axis,
+		unsigned int   begin,
+		unsigned int   end) {
+
+	const int width  = distance2.shape(0);
+	const int height = distance2.shape(1);
+	const int depth  = distance2.shape(2);
+
+	// the scratch space of this job
+	int n = distance2.shape(axis);
+	std::vector<double>       values(n);
+	std::vector<unsigned int> indices(n);
+	std::vector<int>          envelope(n);
+	std::vector<double>       boundaries(n + 1);
+
+	float*        d = distance2.data();
+	unsigned int* k = (nearest ? nearest->data() : 0);
+
+	if (axis == 0) {
+
+		for (int z = begin; z < (int)end; z++)
+			for (int y = 0; y < height; y++) {
+
+				size_t offset = width*(y + (size_t)height*z);
+				transformLine(d + offset, k ? k + offset : 0, width, 1, _resolution[0], values, indices, envelope, boundaries);
+			}
+
+	} else if (axis == 1) {
+
+		for (int z = begin; z < (int)end; z++)
+			for (int x = 0; x < width; x++) {
+
+				size_t offset = x + (size_t)width*height*z;
+				transformLine(d + offset, k ? k + offset : 0, height, width, _resolution[1], values, indices, envelope, boundaries);
+			}
+
+	} else {
+
+		for (int y = begin; y < (int)end; y++)
+			for (int x = 0; x < width; x++) {
+
+				size_t offset = x + (size_t)width*y;
+				transformLine(d + offset, k ? k + offset : 0, depth, (size_t)width*height, _resolution[2], values, indices, envelope, boundaries);
+			}
+	}
+}
+
+void
+EuclideanDistanceTransform::transformLine(
+		float*        f,
+		unsigned int* nearest,
+		int           n,
+		size_t        stride,
+		float         resolution,
+		std::vector<double>&       values,
+		std::vector<unsigned int>& indices,
+		std::vector<int>&          envelope,
+		std::vector<double>&       boundaries) {
+
+	// The envelope is computed in double. In float, the intersections of
+	// parabolas far away from the origin of long lines are rounded to the
+	// wrong side of a sample, which picks a parabola that is not the lowest.
+	const double r2 = (double)resolution*resolution;
+
+	// copy the line, since it is overwritten with the result
+	for (int q = 0; q < n; q++) {
+
+		values[q] = f[q*stride];
+		if (nearest)
+			indices[q] = nearest[q*stride];
+	}
+
+	// compute the lower envelope of the parabolas r2*(x - q)^2 + values[q], 
+	// skipping the ones at infinity
+
+	int numParabolas = 0;
+
+	for (int q = 0; q < n; q++) {
+
+		if (values[q] == Infinity)
+			continue;
+
+		double s = 0;
+
+		while (numParabolas > 0) {
+
+			int v = envelope[numParabolas - 1];
+
+			// intersection of the parabolas at q and v
+			s = ((values[q] + r2*q*q) - (values[v] + r2*v*v))/(2*r2*(q - v));
+
+			if (s > boundaries[numParabolas - 1])
+				break;
+
+			numParabolas--;
+		}
+
+		envelope[numParabolas]   = q;
+		boundaries[numParabolas] = (numParabolas == 0 ? -Infinity : s);
+		numParabolas++;
+	}
+
+	// no finite values on this line
+	if (numParabolas == 0)
+		return;
+
+	boundaries[numParabolas] = Infinity;
+
+	// read the distances from the envelope
+
+	int j = 0;
+
+	for (int q = 0; q < n; q++) {
+
+		while (boundaries[j + 1] < q)
+			j++;
+
+		int v = envelope[j];
+
+		f[q*stride] = r2*(q - v)*(q - v) + values[v];
+		if (nearest)
+			nearest[q*stride] = indices[v];
+	}
+}
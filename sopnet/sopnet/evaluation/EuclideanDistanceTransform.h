@@ -0,0 +1,84 @@
+#ifndef SOPNET_EVALUATION_EUCLIDEAN_DISTANCE_TRANSFORM_H__
+#define SOPNET_EVALUATION_EUCLIDEAN_DISTANCE_TRANSFORM_H__
+
+#include <vector>
+
+#include <vigra/multi_array.hxx>
+
+/**
+ * Exact squared Euclidean distance transform for anisotropic volumes, 
+ * following Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled 
+ * Functions". The transform is computed by three one-dimensional passes along 
+ * x, y, and z, each of which computes the lower envelope of parabolas in 
+ * linear time. The runtime is therefore linear in the number of voxels and 
+ * independent of any distance threshold.
+ *
+ * The lines of each pass are independent and processed in parallel.
+ */
+class EuclideanDistanceTransform {
+
+public:
+
+	typedef vigra::MultiArray<3, bool>         mask_type;
+	typedef vigra::MultiArray<3, float>        distance_type;
+	typedef vigra::MultiArray<3, unsigned int> nearest_type;
+
+	/**
+	 * Create a distance transform for voxels of the given size.
+	 *
+	 * @param numThreads
+	 *              The number of threads to use. If 0, the default number of 
+	 *              worker threads is used.
+	 */
+	EuclideanDistanceTransform(
+			float resolutionX = 4.0,
+			float resolutionY = 4.0,
+			float resolutionZ = 40.0,
+			unsigned int numThreads = 0);
+
+	/**
+	 * Compute the squared distance of every voxel to the closest voxel that 
+	 * is set in features. Feature voxels have a distance of 0, all distances 
+	 * are infinite if there are no features.
+	 */
+	void operator()(const mask_type& features, distance_type& distance2);
+
+	/**
+	 * Same as above, but additionally store for each voxel the scan-order 
+	 * index x + width*(y + height*z) of the closest feature voxel. For voxels 
+	 * without any feature, the index is undefined.
+	 */
+	void operator()(const mask_type& features, distance_type& distance2, nearest_type& nearest);
+
+private:
+
+	// run the transform along one axis for all lines in the given range of 
+	// the outermost remaining axis
+	void transformLines(
+			distance_type& distance2,
+			nearest_type*  nearest,
+			unsigned int   axis,
+			unsigned int   begin,
+			unsigned int   end);
+
+	// one-dimensional transform of a line of n values with the given stride
+	static void transformLine(
+			float*        f,
+			unsigned int* nearest,
+			int           n,
+			size_t        stride,
+			float         resolution,
+			std::vector<double>&       values,
+			std::vector<unsigned int>& indices,
+			std::vector<int>&          envelope,
+			std::vector<double>&       boundaries);
+
+	void transform(distance_type& distance2, nearest_type* nearest);
+
+	float _resolution[3];
+
+	unsigned int _numThreads;
+};
+
+#endif // SOPNET_EVALUATION_EUCLIDEAN_DISTANCE_TRANSFORM_H__
+
@@ -7,29 +7,28 @@ logger::LogChannel randindexlog("randindexlog", "[ResultEvaluator] ");
 RandIndex::RandIndex() :
 	_randIndex(new double(0)) {
 
-	registerInput(_stack1, "stack 1");
-	registerInput(_stack2, "stack 2");
+	registerInput(_stack1, "stack 1", pipeline::Optional);
+	registerInput(_stack2, "stack 2", pipeline::Optional);
+	registerInput(_contingencyTable, "contingency table", pipeline::Optional);
 	registerOutput(_randIndex, "rand index");
 }
 
 void
 RandIndex::updateOutputs() {
 
-	if (_stack1->size() != _stack2->size())
-		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("image stacks have different size") << STACK_TRACE);
+	ContingencyTable ownTable;
 
-	unsigned int depth = _stack1->size();
+	if (!_contingencyTable.isSet()) {
 
-	if (depth == 0) {
+		if (!_stack1.isSet() || !_stack2.isSet())
+			BOOST_THROW_EXCEPTION(UsageError() << error_message("neither image stacks nor a contingency table are set") << STACK_TRACE);
 
-		*_randIndex = 1.0;
-		return;
+		ownTable.compute(*_stack1, *_stack2);
 	}
 
-	unsigned int width  = (*_stack1)[0]->width();
-	unsigned int height = (*_stack1)[0]->height();
+	const ContingencyTable& table = (_contingencyTable.isSet() ? *_contingencyTable : ownTable);
 
-	size_t numLocations = depth*width*height;
+	size_t numLocations = table.getNumLocations();
 
 	if (numLocations == 0) {
 
@@ -37,7 +36,7 @@ RandIndex::updateOutputs() {
 		return;
 	}
 
-	size_t numAgree = getNumAgreeingPairs(*_stack1, *_stack2, numLocations);
+	size_t numAgree = getNumAgreeingPairs(table);
 	double numPairs = (static_cast<double>(numLocations)/2)*(static_cast<double>(numLocations) - 1);
 
 	LOG_DEBUG(randindexlog) << "number of pairs is          " << numPairs << std::endl;;
@@ -51,55 +50,32 @@ RandIndex::updateOutputs() {
 }
 
 size_t
-RandIndex::getNumAgreeingPairs(const ImageStack& stack1, const ImageStack& stack2, size_t numLocations) {
+RandIndex::getNumAgreeingPairs(const ContingencyTable& table) {
 
 	// Implementation following algorith by Bjoern Andres:
 	//
 	// https://github.com/bjoern-andres/partition-comparison/blob/master/include/andres/partition-comparison.hxx
 
-	typedef float                       Label;
-	typedef std::pair<Label,    Label>  LabelPair;
-	typedef std::map<LabelPair, size_t> ContingencyMatrix;
-	typedef std::map<Label,     size_t> SumVector;
-
-	ContingencyMatrix c;
-	SumVector         a;
-	SumVector         b;
-
-	ImageStack::const_iterator image1 = stack1.begin();
-	ImageStack::const_iterator image2 = stack2.begin();
-
-	// for each image in the stacks
-	for(; image1 != stack1.end(); image1++, image2++) {
+	typedef ContingencyTable::JointCounts::value_type JointCount;
+	typedef ContingencyTable::Counts::value_type      Count;
 
-		Image::iterator i1 = (*image1)->begin();
-		Image::iterator i2 = (*image2)->begin();
-
-		for (; i1 != (*image1)->end(); i1++, i2++) {
-
-			c[std::make_pair(*i1, *i2)]++;
-			a[*i1]++;
-			b[*i2]++;
-		}
-	}
-
-	LabelPair labelPair;
-	Label     label;
-	size_t    n;
+	size_t numLocations = table.getNumLocations();
 
 	size_t A = 0;
 	size_t B = numLocations*numLocations;
 
-	foreach (boost::tie(labelPair, n), c) {
+	foreach (const JointCount& c, table.getJointCounts()) {
+
+		size_t n = c.second;
 
 		A += n*(n-1);
 		B += n*n;
 	}
 
-	foreach (boost::tie(label, n), a)
-		B -= n*n;
-	foreach (boost::tie(label, n), b)
-		B -= n*n;
+	foreach (const Count& a, table.getCounts1())
+		B -= a.second*a.second;
+	foreach (const Count& b, table.getCounts2())
+		B -= b.second*b.second;
 
 	return (A+B)/2;
 }
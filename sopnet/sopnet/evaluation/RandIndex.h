@@ -4,7 +4,13 @@
 #include <pipeline/all.h>
 
 #include <imageprocessing/ImageStack.h>
+#include "ContingencyTable.h"
 
+/**
+ * Computes the Rand index of two image stacks. The stacks are either given 
+ * directly, or as the "contingency table" of a ContingencyTableExtractor, 
+ * which can be shared with other measures.
+ */
 class RandIndex : public pipeline::SimpleProcessNode<> {
 
 public:
@@ -15,12 +21,15 @@ private:
 
 	void updateOutputs();
 
-	size_t getNumAgreeingPairs(const ImageStack& stack1, const ImageStack& stack2, size_t numLocations);
+	size_t getNumAgreeingPairs(const ContingencyTable& table);
 
 	// input image stacks
 	pipeline::Input<ImageStack> _stack1;
 	pipeline::Input<ImageStack> _stack2;
 
+	// alternatively, the label counts of the stacks
+	pipeline::Input<ContingencyTable> _contingencyTable;
+
 	// variation of information
 	pipeline::Output<double>    _randIndex;
 };
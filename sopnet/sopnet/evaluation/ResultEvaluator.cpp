@@ -1,6 +1,7 @@
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include <util/helpers.hpp>
+#include <sopnet/slices/SliceIndex.h>
 #include "ResultEvaluator.h"
 
 logger::LogChannel resultevaluatorlog("resultevaluatorlog", "[ResultEvaluator] ");
@@ -35,124 +36,33 @@ ResultEvaluator::updateOutputs() {
 	// First, find all slices in the result and ground-truth.
 	findAllSlicesAndLinks();
 
-	// all mappings of all sections
-	std::vector<Mappings> allMappings;
+	// Every error only shrinks if a result slice is mapped to more of its 
+	// partners: Mapped ground-truth slices are no false negatives, and more 
+	// partners can only match more links. Hence, the mapping of each result 
+	// slice to all of its partners yields a subset of the errors of any other 
+	// mapping, and is optimal in every section.
 
-	// pointers from any mapping of any section to the mapping in the previous 
-	// section with minimal accumulated slice error
-	std::vector<std::map<int, int> > bestPreviousMapping;
+	SliceErrors minSliceErrors;
 
-	// all minimal sliceErrors until a section and a mapping of this section
-	std::vector<std::vector<SliceErrors> > accumulatedSliceErrors;
+	Mapping previousMapping;
 
 	// For each section...
 	for (unsigned int section = 0; section < _numSections; section++) {
 
 		LOG_DEBUG(resultevaluatorlog) << "processing section " << section << std::endl;
 
-		// Get all possible mappings of result to ground truth.
-		allMappings.push_back(getAllMappings(section));
-
-		Mappings& currentMappings = allMappings[section];
-
-		// new map of mappings to mappings for current section
-		bestPreviousMapping.push_back(std::map<int, int>());
-
-		if (section == 0) {
-
-			LOG_ALL(resultevaluatorlog) << "calculating slice errors of first section" << std::endl;
-
-			// The slice errors of the first section consist only of the 
-			// intra-section slice errors.
-			std::vector<SliceErrors> firstSliceErrors;
-
-			foreach (Mapping& mapping, currentMappings)
-				firstSliceErrors.push_back(getIntraSliceErrors(mapping, 0));
-
-			accumulatedSliceErrors.push_back(firstSliceErrors);
-
-			LOG_ALL(resultevaluatorlog) << "section 0: " << firstSliceErrors << std::endl;
-
-			continue;
-		}
-
-		// new vector of slice errors for current section
-		accumulatedSliceErrors.push_back(std::vector<SliceErrors>(currentMappings.size(), SliceErrors()));
-
-		Mappings& previousMappings = allMappings[section - 1];
-
-		// Compute slice errors of all mappings of current section when combined 
-		// with any mapping of previous section.
-
-		std::map<int, std::map<int, SliceErrors> > sliceErrors;
-
-		LOG_DEBUG(resultevaluatorlog)
-				<< "computing slice errors for all " << currentMappings.size() << "x"
-				<< previousMappings.size() << " combinations" << std::endl;
-
-		for (unsigned int i = 0; i < currentMappings.size(); i++)
-			for (unsigned int j = 0; j < previousMappings.size(); j++)
-				sliceErrors[i][j] = getSliceErrors(currentMappings[i], previousMappings[j], section);
-
-		// For each mapping of the current section, get the minimal number of 
-		// slice errors up to the current section, remember which mapping in the 
-		// previous section was involved.
-
-		LOG_ALL(resultevaluatorlog) << "searching for minimal accumulated slice errors" << std::endl;
-
-		for (unsigned int i = 0; i < currentMappings.size(); i++) {
+		Mapping mapping = getMapping(section);
 
-			int numSliceErrors = -1;
-
-			for (unsigned int j = 0; j < previousMappings.size(); j++) {
-
-				// the sliceError until j in the previous section
-				const SliceErrors& previousSliceErrors = accumulatedSliceErrors[section-1][j];
-
-				// the sliceError until i when going over j
-				SliceErrors currentSliceErrors = sliceErrors[i][j] + previousSliceErrors;
-
-				// remember the best j
-				if (currentSliceErrors.total() < numSliceErrors || numSliceErrors == -1) {
-
-					numSliceErrors = currentSliceErrors.total();
-					bestPreviousMapping[section][i] = j;
-					accumulatedSliceErrors[section][i] = currentSliceErrors;
-				}
-			}
-		}
-
-		LOG_ALL(resultevaluatorlog) << "section " << section << ": " << accumulatedSliceErrors[section] << std::endl;
-
-		LOG_ALL(resultevaluatorlog) << "done with section " << section << std::endl;
-	}
-
-	// Choose the mapping with the lowest acummulated slice error.
-
-	SliceErrors minSliceErrors;
-	int bestMapping = -1;
-
-	LOG_DEBUG(resultevaluatorlog) << "walking backwards to find sequence of optimal mappings" << std::endl;
-
-	for (unsigned int i = 0; i < allMappings[_numSections-1].size(); i++) {
-
-		if (accumulatedSliceErrors[_numSections-1][i].total() < minSliceErrors.total() || bestMapping == -1) {
-
-			minSliceErrors   = accumulatedSliceErrors[_numSections-1][i];
-			bestMapping = i;
-		}
-	}
-
-	// Follow shortest path backwards to get all other mappings.
-
-	Mappings bestMappings(_numSections);
-
-	for (int section = _numSections - 1; section >= 0; section--) {
+		// The slice errors of the first section consist only of the 
+		// intra-section slice errors.
+		if (section == 0)
+			minSliceErrors = getIntraSliceErrors(mapping, 0);
+		else
+			minSliceErrors = minSliceErrors + getSliceErrors(mapping, previousMapping, section);
 
-		bestMappings[section] = allMappings[section][bestMapping];
+		LOG_ALL(resultevaluatorlog) << "section " << section << ": " << minSliceErrors << std::endl;
 
-		if (section > 0)
-			bestMapping = bestPreviousMapping[section][bestMapping];
+		previousMapping = mapping;
 	}
 
 	// Set outputs.
@@ -178,10 +88,10 @@ ResultEvaluator::updateOutputs() {
 			<< minSliceErrors.numFalseMerges() << std::endl;
 }
 
-ResultEvaluator::Mappings
-ResultEvaluator::getAllMappings(unsigned int section) {
+ResultEvaluator::Mapping
+ResultEvaluator::getMapping(unsigned int section) {
 
-	LOG_ALL(resultevaluatorlog) << "computing all mappings for section " << section << std::endl;
+	LOG_ALL(resultevaluatorlog) << "computing mapping for section " << section << std::endl;
 
 	// Get all result slices in 'section'.
 	std::vector<boost::shared_ptr<Slice> > resultSlices = getResultSlices(section);
@@ -189,31 +99,32 @@ ResultEvaluator::getAllMappings(unsigned int section) {
 	// Get all ground-truth slices in 'section'.
 	std::vector<boost::shared_ptr<Slice> > groundTruthSlices = getGroundTruthSlices(section);
 
-	// Get all possible partners of one result slice to ground-truth slices.
+	// Map each result slice to all of its partners.
 
-	std::map<int, std::vector<int> > resultPartners;
+	Mapping mapping;
 
 	LOG_ALL(resultevaluatorlog) << "finding partners for each result slice" << std::endl;
 
+	// only ground-truth slices with intersecting bounding boxes can overlap
+	SliceIndex groundTruthIndex;
+	foreach (boost::shared_ptr<Slice> groundTruthSlice, groundTruthSlices)
+		groundTruthIndex.add(groundTruthSlice);
+
 	foreach (boost::shared_ptr<Slice> resultSlice, resultSlices) {
-		foreach (boost::shared_ptr<Slice> groundTruthSlice, groundTruthSlices) {
+		foreach (unsigned int i, groundTruthIndex.find(*resultSlice)) {
+
+			boost::shared_ptr<Slice> groundTruthSlice = groundTruthIndex[i];
 
 			if (_overlap.exceeds(*resultSlice, *groundTruthSlice, _minOverlap)) {
 
-				resultPartners[resultSlice->getId()].push_back(groundTruthSlice->getId());
+				mapping.push_back(std::make_pair(resultSlice->getId(), groundTruthSlice->getId()));
 			}
 		}
 	}
 
-	// Recursively get all possible mappings.
-	Mappings mappings;
-	Mapping  currentMapping;
-
-	createMappings(mappings, currentMapping, resultPartners, resultSlices, (unsigned int)0);
-
-	LOG_ALL(resultevaluatorlog) << mappings.size() << " mappings found" << std::endl;
+	LOG_ALL(resultevaluatorlog) << "mapping contains " << mapping.size() << " pairs" << std::endl;
 
-	return mappings;
+	return mapping;
 }
 
 std::vector<boost::shared_ptr<Slice> >
@@ -355,75 +266,6 @@ ResultEvaluator::insertSlice(
 	sliceSets[slice->getSection()].insert(slice);
 }
 
-void
-ResultEvaluator::createMappings(
-		Mappings&                               mappings,
-		Mapping&                                currentMapping,
-		std::map<int, std::vector<int> >&       resultPartners,
-		std::vector<boost::shared_ptr<Slice> >& resultSlices,
-		unsigned int                            numSlice) {
-
-	// If there are no more slices to assign, add the current mapping to the set 
-	// of all mappings.
-
-	if (numSlice == resultSlices.size()) {
-
-		LOG_ALL(resultevaluatorlog) << "all slices mapped -- this is a new mapping" << std::endl;
-
-		mappings.push_back(currentMapping);
-		return;
-	}
-
-	LOG_ALL(resultevaluatorlog) << "mapping slice #" << numSlice << std::endl;
-
-	unsigned int currentSlice = resultSlices[numSlice]->getId();
-
-	LOG_ALL(resultevaluatorlog) << "slice id is " << currentSlice << std::endl;
-
-	std::vector<int> partners = resultPartners[currentSlice];
-
-	LOG_ALL(resultevaluatorlog) << "this slice has " << partners.size() << " partners" << std::endl;
-
-	// If there are no partners, there's nothing to do here
-	if (partners.size() == 0) {
-
-		// Call create mappings for the next slice.
-		createMappings(mappings, currentMapping, resultPartners, resultSlices, numSlice + 1);
-
-	} else {
-
-		// For each combination of partners...
-		for (unsigned int combination = 1; combination < pow(2, partners.size()); combination++) {
-
-			unsigned int numPartners = 0;
-
-			// ...map to them.
-			for (unsigned int i = 0; i < partners.size(); i++) {
-
-				if (combination & (1 << i)) {
-
-					currentMapping.push_back(std::make_pair(currentSlice, partners[i]));
-					numPartners++;
-				}
-			}
-
-			LOG_ALL(resultevaluatorlog)
-					<< "selecting partner combination " << combination
-					<< ", which maps to " << numPartners << " partners" << std::endl;
-
-			// Call create mappings for the next slice.
-			createMappings(mappings, currentMapping, resultPartners, resultSlices, numSlice + 1);
-
-			LOG_ALL(resultevaluatorlog) << "removing " << numPartners << " mappings from current mapping" << std::endl;
-
-			// Remove this mapping and continue with the next combination.
-			currentMapping.erase(currentMapping.end() - numPartners, currentMapping.end());
-		}
-	}
-
-	LOG_ALL(resultevaluatorlog) << "done with slice #" << numSlice << std::endl;
-}
-
 SliceErrors
 ResultEvaluator::getSliceErrors(
 		const Mapping& mapping,
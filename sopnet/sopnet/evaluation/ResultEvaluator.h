@@ -10,7 +10,6 @@
 class ResultEvaluator : public pipeline::SimpleProcessNode<> {
 
 	typedef std::vector<std::pair<int, int> > Mapping;
-	typedef std::vector<Mapping>              Mappings;
 
 public:
 
@@ -39,20 +38,16 @@ private:
 			std::vector<std::set<boost::shared_ptr<Slice> > >& sliceSets,
 			boost::shared_ptr<Slice>                           slice);
 
-	std::vector<Mapping> getAllMappings(
-			unsigned int section);
+	/**
+	 * Get the mapping of each result slice to all ground-truth slices it 
+	 * sufficiently overlaps with.
+	 */
+	Mapping getMapping(unsigned int section);
 
 	std::vector<boost::shared_ptr<Slice> > getSlices(
 			Segments& segments,
 			unsigned int section);
 
-	void createMappings(
-			Mappings&                               mappings,
-			Mapping&                                currentMapping,
-			std::map<int, std::vector<int> >&       resultPartners,
-			std::vector<boost::shared_ptr<Slice> >& resultSlices,
-			unsigned int                            numSlice);
-
 	SliceErrors getSliceErrors(
 			const Mapping& mapping,
 			const Mapping& previousMapping,
@@ -1,5 +1,6 @@
 #include <algorithm>
 
+#include <boost/bind.hpp>
 #include <boost/range/adaptors.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <vigra/multi_labeling.hxx>
@@ -8,6 +9,7 @@
 #include <inference/LinearObjective.h>
 #include <inference/LinearSolver.h>
 #include <pipeline/Value.h>
+#include <sopnet/parallel/WorkerPool.h>
 #include <util/exceptions.h>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
@@ -40,7 +42,15 @@ util::ProgramOption optionReconstructionBackgroundLabel(
 		util::_description_text = "The value of the reconstruction background label.",
 		util::_default_value    = 0.0);
 
-TolerantEditDistance::TolerantEditDistance() :
+util::ProgramOption optionNumParallelTedComponents(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "numParallelComponents",
+		util::_description_text = "The number of independent components of the tolerant edit distance problem to solve concurrently. The default (0) "
+		                          "uses the number of worker threads. The ILP solvers of concurrent components share these threads, i.e., each solver "
+		                          "gets one thread if all components run at the same time.",
+		util::_default_value    = 0);
+
+TolerantEditDistance::TolerantEditDistance(unsigned int numThreads) :
 	_haveBackgroundLabel(optionHaveBackgroundLabel),
 	_gtBackgroundLabel(optionGroundTruthBackgroundLabel),
 	_recBackgroundLabel(optionReconstructionBackgroundLabel),
@@ -49,7 +59,8 @@ TolerantEditDistance::TolerantEditDistance() :
 	_mergeLocations(new ImageStack()),
 	_fpLocations(new ImageStack()),
 	_fnLocations(new ImageStack()),
-	_errors(_haveBackgroundLabel ? new Errors(_gtBackgroundLabel, _recBackgroundLabel) : new Errors()) {
+	_errors(_haveBackgroundLabel ? new Errors(_gtBackgroundLabel, _recBackgroundLabel) : new Errors()),
+	_numThreads(numThreads == 0 ? WorkerPool::getDefaultNumThreads() : numThreads) {
 
 	if (optionHaveBackgroundLabel) {
 		LOG_ALL(tedlog) << "started TolerantEditDistance with background label" << std::endl;
@@ -93,11 +104,7 @@ void
 TolerantEditDistance::clear() {
 
 	_toleranceFunction->clear();
-	_indicatorVarsByRecLabel.clear();
-	_indicatorVarsByGtToRecLabel.clear();
-	_matchVars.clear();
-	_labelingByVar.clear();
-	_alternativeIndicators.clear();
+	_cellLabels.clear();
 	_errors->clear();
 	_correctedReconstruction->clear();
 	_splitLocations->clear();
@@ -166,15 +173,184 @@ TolerantEditDistance::extractCells() {
 void
 TolerantEditDistance::findBestCellLabels() {
 
+	// every cell keeps its label, unless the solution of its component says 
+	// otherwise
+	_cellLabels.resize(_toleranceFunction->getCells()->size());
+	for (unsigned int cellIndex = 0; cellIndex < _cellLabels.size(); cellIndex++)
+		_cellLabels[cellIndex] = (*_toleranceFunction->getCells())[cellIndex].getReconstructionLabel();
+
+	std::vector<Component> components = findComponents();
+
+	// solve the largest components first, such that they don't end up last 
+	// in the queue
+	std::sort(components.begin(), components.end(), &TolerantEditDistance::isLarger);
+
+	// the only labeling of trivial components is the original one, which we 
+	// already have
+	std::vector<const Component*> nonTrivial;
+	foreach (const Component& component, components)
+		if (!isTrivial(component))
+			nonTrivial.push_back(&component);
+
+	unsigned int numTrivial = components.size() - nonTrivial.size();
+
+	if (!nonTrivial.empty()) {
+
+		// Each component's ILP solver starts its own threads. Split the 
+		// threads between concurrent components and their solvers, such 
+		// that the cores are not oversubscribed.
+		unsigned int numParallel = optionNumParallelTedComponents.as<unsigned int>();
+		if (numParallel == 0)
+			numParallel = _numThreads;
+		numParallel = std::max(1u, std::min(numParallel, (unsigned int)nonTrivial.size()));
+
+		unsigned int numSolverThreads = std::max(1u, _numThreads/numParallel);
+
+		LOG_DEBUG(tedlog)
+				<< "solving " << nonTrivial.size() << " components in "
+				<< numParallel << " threads with " << numSolverThreads
+				<< " solver threads each" << std::endl;
+
+		WorkerPool workers(numParallel);
+
+		foreach (const Component* component, nonTrivial)
+			workers.schedule(boost::bind(&TolerantEditDistance::solveComponent, this, boost::cref(*component), numSolverThreads));
+
+		workers.wait();
+	}
+
+	LOG_DEBUG(tedlog)
+			<< "solved " << components.size() << " components ("
+			<< numTrivial << " trivial, largest has "
+			<< (components.empty() ? 0 : components.front().cells.size()) << " cells)"
+			<< std::endl;
+}
+
+std::vector<TolerantEditDistance::Component>
+TolerantEditDistance::findComponents() {
+
+	// Two labels are in the same component, if they are connected in the 
+	// graph of possible matches. Cells, splits, and merges of different 
+	// components do not interact in the ILP, and the objective is a sum over 
+	// components. Hence, the components can be solved independently.
+
+	std::map<float, unsigned int> gtNodes;
+	std::map<float, unsigned int> recNodes;
+
+	foreach (float gtLabel, _toleranceFunction->getGroundTruthLabels())
+		gtNodes.insert(std::make_pair(gtLabel, gtNodes.size()));
+	foreach (float recLabel, _toleranceFunction->getReconstructionLabels())
+		recNodes.insert(std::make_pair(recLabel, gtNodes.size() + recNodes.size()));
+
+	std::vector<unsigned int> parents(gtNodes.size() + recNodes.size());
+	for (unsigned int i = 0; i < parents.size(); i++)
+		parents[i] = i;
+
+	foreach (float gtLabel, _toleranceFunction->getGroundTruthLabels())
+		foreach (float recLabel, _toleranceFunction->getPossibleMatchesByGt(gtLabel)) {
+
+			unsigned int a = findRoot(parents, gtNodes[gtLabel]);
+			unsigned int b = findRoot(parents, recNodes[recLabel]);
+
+			if (a != b)
+				parents[std::max(a, b)] = std::min(a, b);
+		}
+
+	// collect the labels and cells of each component
+
+	std::map<unsigned int, unsigned int> componentsByRoot;
+	std::vector<Component> components;
+
+	foreach (float gtLabel, _toleranceFunction->getGroundTruthLabels()) {
+
+		unsigned int root = findRoot(parents, gtNodes[gtLabel]);
+
+		if (!componentsByRoot.count(root)) {
+
+			componentsByRoot[root] = components.size();
+			components.push_back(Component());
+		}
+
+		Component& component = components[componentsByRoot[root]];
+
+		component.gtLabels.push_back(gtLabel);
+		component.matchesByGt[gtLabel] = _toleranceFunction->getPossibleMatchesByGt(gtLabel);
+	}
+
+	foreach (float recLabel, _toleranceFunction->getReconstructionLabels()) {
+
+		Component& component = components[componentsByRoot[findRoot(parents, recNodes[recLabel])]];
+
+		component.recLabels.push_back(recLabel);
+		component.matchesByRec[recLabel] = _toleranceFunction->getPossibleMathesByRec(recLabel);
+	}
+
+	for (unsigned int cellIndex = 0; cellIndex < _toleranceFunction->getCells()->size(); cellIndex++) {
+
+		float gtLabel = (*_toleranceFunction->getCells())[cellIndex].getGroundTruthLabel();
+
+		components[componentsByRoot[findRoot(parents, gtNodes[gtLabel])]].cells.push_back(cellIndex);
+	}
+
+	return components;
+}
+
+unsigned int
+TolerantEditDistance::findRoot(std::vector<unsigned int>& parents, unsigned int node) {
+
+	unsigned int root = node;
+	while (parents[root] != root)
+		root = parents[root];
+
+	// path compression
+	while (parents[node] != root) {
+
+		unsigned int next = parents[node];
+		parents[node] = root;
+		node = next;
+	}
+
+	return root;
+}
+
+bool
+TolerantEditDistance::isTrivial(const Component& component) {
+
+	// a component without alternative labels has only one feasible labeling: 
+	// the original one
+	foreach (unsigned int cellIndex, component.cells) {
+
+		const cell_t& cell = (*_toleranceFunction->getCells())[cellIndex];
+
+		foreach (float l, cell.getAlternativeLabels())
+			if (l != cell.getReconstructionLabel())
+				return false;
+	}
+
+	return true;
+}
+
+bool
+TolerantEditDistance::isLarger(const Component& a, const Component& b) {
+
+	return a.cells.size() > b.cells.size();
+}
+
+void
+TolerantEditDistance::solveComponent(const Component& component, unsigned int numSolverThreads) {
+
+	ComponentVariables variables;
+
 	pipeline::Value<LinearConstraints>      constraints;
 	pipeline::Value<LinearSolverParameters> parameters;
 
 	// the default are binary variables
 	parameters->setVariableType(Binary);
+	parameters->setNumThreads(numSolverThreads);
 
 	// introduce indicators for each cell and each possible label of that cell
 	unsigned int var = 0;
-	for (unsigned int cellIndex = 0; cellIndex < _toleranceFunction->getCells()->size(); cellIndex++) {
+	foreach (unsigned int cellIndex, component.cells) {
 
 		cell_t& cell = (*_toleranceFunction->getCells())[cellIndex];
 
@@ -182,14 +358,14 @@ TolerantEditDistance::findBestCellLabels() {
 		unsigned int begin = var;
 
 		// one variable for the default label
-		assignIndicatorVariable(var++, cellIndex, cell.getGroundTruthLabel(), cell.getReconstructionLabel());
+		variables.assignIndicatorVariable(var++, cellIndex, cell.getGroundTruthLabel(), cell.getReconstructionLabel());
 
 		// one variable for each alternative
 		foreach (float l, cell.getAlternativeLabels()) {
 
 			unsigned int ind = var++;
-			_alternativeIndicators.push_back(ind);
-			assignIndicatorVariable(ind, cellIndex, cell.getGroundTruthLabel(), l);
+			variables.alternativeIndicators.push_back(ind);
+			variables.assignIndicatorVariable(ind, cellIndex, cell.getGroundTruthLabel(), l);
 		}
 
 		// last +1 indicator variable for this cell
@@ -203,13 +379,13 @@ TolerantEditDistance::findBestCellLabels() {
 		constraint.setValue(1);
 		constraints->add(constraint);
 	}
-	_numIndicatorVars = var;
+	unsigned int numIndicatorVars = var;
 
 	// labels can not disappear
-	foreach (float recLabel, _toleranceFunction->getReconstructionLabels()) {
+	foreach (float recLabel, component.recLabels) {
 
 		LinearConstraint constraint;
-		foreach (unsigned int v, getIndicatorsByRec(recLabel))
+		foreach (unsigned int v, variables.indicatorVarsByRecLabel[recLabel])
 			constraint.setCoefficient(v, 1.0);
 		constraint.setRelation(GreaterEqual);
 		constraint.setValue(1);
@@ -218,20 +394,20 @@ TolerantEditDistance::findBestCellLabels() {
 
 	// introduce indicators for each match of ground truth label to 
 	// reconstruction label
-	foreach (float gtLabel, _toleranceFunction->getGroundTruthLabels())
-		foreach (float recLabel, _toleranceFunction->getPossibleMatchesByGt(gtLabel))
-			assignMatchVariable(var++, gtLabel, recLabel);
+	foreach (float gtLabel, component.gtLabels)
+		foreach (float recLabel, component.getPossibleMatchesByGt(gtLabel))
+			variables.matchVars[gtLabel][recLabel] = var++;
 
 	// cell label selection activates match
-	foreach (float gtLabel, _toleranceFunction->getGroundTruthLabels()) {
-		foreach (float recLabel, _toleranceFunction->getPossibleMatchesByGt(gtLabel)) {
+	foreach (float gtLabel, component.gtLabels) {
+		foreach (float recLabel, component.getPossibleMatchesByGt(gtLabel)) {
 
-			unsigned int matchVar = getMatchVariable(gtLabel, recLabel);
+			unsigned int matchVar = variables.matchVars[gtLabel][recLabel];
 
 			// no assignment of gtLabel to recLabel -> match is zero
 			LinearConstraint noMatchConstraint;
 
-			foreach (unsigned int v, getIndicatorsGtToRec(gtLabel, recLabel)) {
+			foreach (unsigned int v, variables.indicatorVarsByGtToRecLabel[gtLabel][recLabel]) {
 
 				noMatchConstraint.setCoefficient(v, 1);
 
@@ -256,7 +432,7 @@ TolerantEditDistance::findBestCellLabels() {
 
 	unsigned int splitBegin = var;
 
-	foreach (float gtLabel, _toleranceFunction->getGroundTruthLabels()) {
+	foreach (float gtLabel, component.gtLabels) {
 
 		unsigned int splitVar = var++;
 
@@ -270,8 +446,8 @@ TolerantEditDistance::findBestCellLabels() {
 
 		LinearConstraint numSplits;
 		numSplits.setCoefficient(splitVar, 1);
-		foreach (float recLabel, _toleranceFunction->getPossibleMatchesByGt(gtLabel))
-			numSplits.setCoefficient(getMatchVariable(gtLabel, recLabel), -1);
+		foreach (float recLabel, component.getPossibleMatchesByGt(gtLabel))
+			numSplits.setCoefficient(variables.matchVars[gtLabel][recLabel], -1);
 		numSplits.setRelation(Equal);
 		numSplits.setValue(-1);
 		constraints->add(numSplits);
@@ -281,11 +457,11 @@ TolerantEditDistance::findBestCellLabels() {
 
 	// introduce total split number
 
-	_splits = var++;
-	parameters->setVariableType(_splits, Integer);
+	unsigned int splits = var++;
+	parameters->setVariableType(splits, Integer);
 
 	LinearConstraint sumOfSplits;
-	sumOfSplits.setCoefficient(_splits, 1);
+	sumOfSplits.setCoefficient(splits, 1);
 	for (unsigned int i = splitBegin; i < splitEnd; i++)
 		sumOfSplits.setCoefficient(i, -1);
 	sumOfSplits.setRelation(Equal);
@@ -296,7 +472,7 @@ TolerantEditDistance::findBestCellLabels() {
 
 	unsigned int mergeBegin = var;
 
-	foreach (float recLabel, _toleranceFunction->getReconstructionLabels()) {
+	foreach (float recLabel, component.recLabels) {
 
 		unsigned int mergeVar = var++;
 
@@ -310,8 +486,8 @@ TolerantEditDistance::findBestCellLabels() {
 
 		LinearConstraint numMerges;
 		numMerges.setCoefficient(mergeVar, 1);
-		foreach (float gtLabel, _toleranceFunction->getPossibleMathesByRec(recLabel))
-			numMerges.setCoefficient(getMatchVariable(gtLabel, recLabel), -1);
+		foreach (float gtLabel, component.getPossibleMatchesByRec(recLabel))
+			numMerges.setCoefficient(variables.matchVars[gtLabel][recLabel], -1);
 		numMerges.setRelation(Equal);
 		numMerges.setValue(-1);
 		constraints->add(numMerges);
@@ -321,11 +497,11 @@ TolerantEditDistance::findBestCellLabels() {
 
 	// introduce total merge number
 
-	_merges = var++;
-	parameters->setVariableType(_merges, Integer);
+	unsigned int merges = var++;
+	parameters->setVariableType(merges, Integer);
 
 	LinearConstraint sumOfMerges;
-	sumOfMerges.setCoefficient(_merges, 1);
+	sumOfMerges.setCoefficient(merges, 1);
 	for (unsigned int i = mergeBegin; i < mergeEnd; i++)
 		sumOfMerges.setCoefficient(i, -1);
 	sumOfMerges.setRelation(Equal);
@@ -337,18 +513,18 @@ TolerantEditDistance::findBestCellLabels() {
 	pipeline::Value<LinearObjective> objective(var);
 
 	// we want to minimize the number of split and merges
-	objective->setCoefficient(_splits, 1);
-	objective->setCoefficient(_merges, 1);
+	objective->setCoefficient(splits, 1);
+	objective->setCoefficient(merges, 1);
 	// however, if there are multiple equal solutions, we prefer the ones with 
 	// the least changes -- therefore, we add a small value for each of those 
 	// variables that can not sum up to one and therefor does not change the 
 	// number of splits and merges
-	foreach (unsigned int ind, _alternativeIndicators)
+	foreach (unsigned int ind, variables.alternativeIndicators)
 		objective->setCoefficient(ind, 1.0/(_numCells + 1));
 	// if we have to change a label, slightly prefer the background -- this 
 	// makes merges with background and false positives look nicer
-	if (_haveBackgroundLabel) {
-		foreach (unsigned int ind, getIndicatorsByRec(_recBackgroundLabel))
+	if (_haveBackgroundLabel && variables.indicatorVarsByRecLabel.count(_recBackgroundLabel)) {
+		foreach (unsigned int ind, variables.indicatorVarsByRecLabel[_recBackgroundLabel])
 			objective->setCoefficient(ind, -0.5/(_numCells + 1));
 	}
 	objective->setSense(Minimize);
@@ -361,7 +537,22 @@ TolerantEditDistance::findBestCellLabels() {
 	solver->setInput("linear constraints", constraints);
 	solver->setInput("parameters", parameters);
 
-	_solution = solver->getOutput("solution");
+	pipeline::Value<Solution> solution;
+	solution = solver->getOutput("solution");
+
+	// read the labels of the cells of this component -- the cells of 
+	// different components are disjoint, no need to lock
+
+	for (unsigned int i = 0; i < numIndicatorVars; i++) {
+
+		if ((*solution)[i]) {
+
+			unsigned int cellIndex = variables.labelingByVar[i].first;
+			float        recLabel  = variables.labelingByVar[i].second;
+
+			_cellLabels[cellIndex] = recLabel;
+		}
+	}
 }
 
 void
@@ -384,16 +575,8 @@ TolerantEditDistance::findErrors() {
 
 	// fill error data structure
 
-	for (unsigned int i = 0; i < _numIndicatorVars; i++) {
-
-		if ((*_solution)[i]) {
-
-			unsigned int cellIndex = _labelingByVar[i].first;
-			float        recLabel  = _labelingByVar[i].second;
-
-			_errors->addMapping(cellIndex, recLabel);
-		}
-	}
+	for (unsigned int cellIndex = 0; cellIndex < _cellLabels.size(); cellIndex++)
+		_errors->addMapping(cellIndex, _cellLabels[cellIndex]);
 
 	LOG_DEBUG(tedlog) << "error counts from Errors data structure:" << std::endl;
 	LOG_DEBUG(tedlog) << "num splits: " << _errors->getNumSplits() << std::endl;
@@ -454,49 +637,33 @@ TolerantEditDistance::correctReconstruction() {
 
 	// read solution
 
-	for (unsigned int i = 0; i < _numIndicatorVars; i++) {
-
-		if ((*_solution)[i]) {
+	for (unsigned int cellIndex = 0; cellIndex < _cellLabels.size(); cellIndex++) {
 
-			unsigned int cellIndex = _labelingByVar[i].first;
-			float        recLabel  = _labelingByVar[i].second;
-			cell_t&      cell      = (*_toleranceFunction->getCells())[cellIndex];
+		float   recLabel = _cellLabels[cellIndex];
+		cell_t& cell     = (*_toleranceFunction->getCells())[cellIndex];
 
-			foreach (const cell_t::Location& l, cell)
-				(*(*_correctedReconstruction)[l.z])(l.x, l.y) = recLabel;
-		}
+		foreach (const cell_t::Location& l, cell)
+			(*(*_correctedReconstruction)[l.z])(l.x, l.y) = recLabel;
 	}
 }
 
 void
-TolerantEditDistance::assignIndicatorVariable(unsigned int var, unsigned int cellIndex, float gtLabel, float recLabel) {
+TolerantEditDistance::ComponentVariables::assignIndicatorVariable(unsigned int var, unsigned int cellIndex, float gtLabel, float recLabel) {
 
-	_indicatorVarsByRecLabel[recLabel].push_back(var);
-	_indicatorVarsByGtToRecLabel[gtLabel][recLabel].push_back(var);
+	indicatorVarsByRecLabel[recLabel].push_back(var);
+	indicatorVarsByGtToRecLabel[gtLabel][recLabel].push_back(var);
 
-	_labelingByVar[var] = std::make_pair(cellIndex, recLabel);
+	labelingByVar[var] = std::make_pair(cellIndex, recLabel);
 }
 
-std::vector<unsigned int>&
-TolerantEditDistance::getIndicatorsByRec(float recLabel) {
+const std::set<float>&
+TolerantEditDistance::Component::getPossibleMatchesByGt(float gtLabel) const {
 
-	return _indicatorVarsByRecLabel[recLabel];
+	return matchesByGt.find(gtLabel)->second;
 }
 
-std::vector<unsigned int>&
-TolerantEditDistance::getIndicatorsGtToRec(float gtLabel, float recLabel) {
-
-	return _indicatorVarsByGtToRecLabel[gtLabel][recLabel];
-}
-
-void
-TolerantEditDistance::assignMatchVariable(unsigned int var, float gtLabel, float recLabel) {
-
-	_matchVars[gtLabel][recLabel] = var;
-}
-
-unsigned int
-TolerantEditDistance::getMatchVariable(float gtLabel, float recLabel) {
+const std::set<float>&
+TolerantEditDistance::Component::getPossibleMatchesByRec(float recLabel) const {
 
-	return _matchVars[gtLabel][recLabel];
+	return matchesByRec.find(recLabel)->second;
 }
@@ -1,6 +1,10 @@
 #ifndef SOPNET_EVALUATION_TOLERANT_EDIT_DISTANCE_H__
 #define SOPNET_EVALUATION_TOLERANT_EDIT_DISTANCE_H__
 
+#include <map>
+#include <set>
+#include <vector>
+
 #include <imageprocessing/ImageStack.h>
 #include <pipeline/SimpleProcessNode.h>
 #include <pipeline/Value.h>
@@ -9,11 +13,28 @@
 #include "Errors.h"
 #include "Cell.h"
 
+/**
+ * Computes the tolerant edit distance between a ground truth and a 
+ * reconstruction, i.e., the minimal number of splits and merges after 
+ * relabeling cells within the tolerance of the local tolerance function.
+ *
+ * The labels are partitioned into components that are connected by possible 
+ * matches. Components in which no cell can change its label are accepted as 
+ * they are, all others are solved as independent ILPs in parallel. The 
+ * threads of the ILP solver are limited, such that concurrent components 
+ * together use at most the given number of threads.
+ */
 class TolerantEditDistance : public pipeline::SimpleProcessNode<> {
 
 public:
 
-	TolerantEditDistance();
+	/**
+	 * @param numThreads
+	 *              The number of threads to use for solving components and 
+	 *              their ILPs. If 0, the default number of worker threads is 
+	 *              used.
+	 */
+	TolerantEditDistance(unsigned int numThreads = 0);
 
 	~TolerantEditDistance();
 
@@ -27,21 +48,64 @@ private:
 
 	void extractCells();
 
+	/**
+	 * A set of ground truth and reconstruction labels that are connected by 
+	 * possible matches, together with the cells of these labels.
+	 */
+	struct Component {
+
+		std::vector<float>        gtLabels;
+		std::vector<float>        recLabels;
+		std::vector<unsigned int> cells;
+
+		// possible matches of the labels of this component, copied from the 
+		// tolerance function to be accessible from several threads
+		std::map<float, std::set<float> > matchesByGt;
+		std::map<float, std::set<float> > matchesByRec;
+
+		const std::set<float>& getPossibleMatchesByGt(float gtLabel) const;
+		const std::set<float>& getPossibleMatchesByRec(float recLabel) const;
+	};
+
+	/**
+	 * The variables of the ILP of a single component.
+	 */
+	struct ComponentVariables {
+
+		void assignIndicatorVariable(unsigned int var, unsigned int cellIndex, float gtLabel, float recLabel);
+
+		// reconstruction label indicators by reconstruction label
+		std::map<float, std::vector<unsigned int> > indicatorVarsByRecLabel;
+
+		// reconstruction label indicators by groundtruth label x 
+		// reconstruction label
+		std::map<float, std::map<float, std::vector<unsigned int> > > indicatorVarsByGtToRecLabel;
+
+		// (cell index, new label) by indicator variable
+		std::map<unsigned int, std::pair<unsigned int, float> > labelingByVar;
+
+		// map from ground truth label x reconstruction label to match variable
+		std::map<float, std::map<float, unsigned int> > matchVars;
+
+		// indicators for alternative cell labels
+		std::vector<unsigned int> alternativeIndicators;
+	};
+
 	void findBestCellLabels();
 
-	void findErrors();
+	std::vector<Component> findComponents();
 
-	void correctReconstruction();
+	static unsigned int findRoot(std::vector<unsigned int>& parents, unsigned int node);
 
-	void assignIndicatorVariable(unsigned int var, unsigned int cellIndex, float gtLabel, float recLabel);
+	bool isTrivial(const Component& component);
 
-	std::vector<unsigned int>& getIndicatorsByRec(float recLabel);
+	static bool isLarger(const Component& a, const Component& b);
 
-	std::vector<unsigned int>& getIndicatorsGtToRec(float gtLabel, float recLabel);
+	void solveComponent(const Component& component, unsigned int numSolverThreads);
 
-	void assignMatchVariable(unsigned int var, float gtLabel, float recLabel);
+	void findErrors();
 
-	unsigned int getMatchVariable(float gtLabel, float recLabel);
+	void correctReconstruction();
 
 	// is there a background label?
 	bool _haveBackgroundLabel;
@@ -69,31 +133,11 @@ private:
 	// the number of cells
 	unsigned int _numCells;
 
-	// reconstruction label indicators by reconstruction label
-	std::map<float, std::vector<unsigned int> > _indicatorVarsByRecLabel;
-
-	// reconstruction label indicators by groundtruth label x reconstruction 
-	// label
-	std::map<float, std::map<float, std::vector<unsigned int> > > _indicatorVarsByGtToRecLabel;
-
-	// (cell index, new label) by indicator variable
-	std::map<unsigned int, std::pair<unsigned int, float> > _labelingByVar;
-
-	// map from ground truth label x reconstruction label to match variable
-	std::map<float, std::map<float, unsigned int> > _matchVars;
-
-	// the number of indicator variables in the ILP
-	unsigned int _numIndicatorVars;
-
-	// indicators for alternative cell labels
-	std::vector<unsigned int> _alternativeIndicators;
-
-	// the ILP variables for the number of splits and merges
-	unsigned int _splits;
-	unsigned int _merges;
+	// the total number of threads for solving components
+	unsigned int _numThreads;
 
-	// the solution of the ILP
-	pipeline::Value<Solution> _solution;
+	// the best reconstruction label of each cell
+	std::vector<float> _cellLabels;
 };
 
 #endif // SOPNET_EVALUATION_TOLERANT_EDIT_DISTANCE_H__
@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include <util/Logger.h>
 #include <util/exceptions.h>
 #include "VariationOfInformation.h"
@@ -7,54 +9,33 @@ logger::LogChannel variationofinformationlog("variationofinformationlog", "[Resu
 VariationOfInformation::VariationOfInformation() :
 	_variationOfInformation(new double(0)) {
 
-	registerInput(_stack1, "stack 1");
-	registerInput(_stack2, "stack 2");
+	registerInput(_stack1, "stack 1", pipeline::Optional);
+	registerInput(_stack2, "stack 2", pipeline::Optional);
+	registerInput(_contingencyTable, "contingency table", pipeline::Optional);
 	registerOutput(_variationOfInformation, "variation of information");
 }
 
 void
 VariationOfInformation::updateOutputs() {
 
-	if (_stack1->size() != _stack2->size())
-		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("image stacks have different size") << STACK_TRACE);
-
 	// count label occurences
 
-	_p1.clear();
-	_p2.clear();
-	_p12.clear();
-
-	ImageStack::const_iterator i1  = _stack1->begin();
-	ImageStack::const_iterator i2  = _stack2->begin();
-
-	unsigned int n = 0;
-
-	for (; i1 != _stack1->end(); i1++, i2++) {
-
-		if ((*i1)->size() != (*i2)->size())
-			BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("images have different size") << STACK_TRACE);
+	ContingencyTable ownTable;
 
-		n += (*i1)->size();
+	if (!_contingencyTable.isSet()) {
 
-		Image::iterator j1 = (*i1)->begin();
-		Image::iterator j2 = (*i2)->begin();
+		if (!_stack1.isSet() || !_stack2.isSet())
+			BOOST_THROW_EXCEPTION(UsageError() << error_message("neither image stacks nor a contingency table are set") << STACK_TRACE);
 
-		for (; j1 != (*i1)->end(); j1++, j2++) {
-
-			_p1[*j1]++;
-			_p2[*j2]++;
-			_p12[std::make_pair(*j1, *j2)]++;
-		}
+		ownTable.compute(*_stack1, *_stack2);
 	}
 
-	// normalize
+	const ContingencyTable& table = (_contingencyTable.isSet() ? *_contingencyTable : ownTable);
+
+	typedef ContingencyTable::JointCounts::value_type JointCount;
+	typedef ContingencyTable::Counts::value_type      Count;
 
-	for (typename LabelProb::iterator i = _p1.begin(); i != _p1.end(); i++)
-		i->second /= n;
-	for (typename LabelProb::iterator i = _p2.begin(); i != _p2.end(); i++)
-		i->second /= n;
-	for (typename JointLabelProb::iterator i = _p12.begin(); i != _p12.end(); i++)
-		i->second /= n;
+	const double n = table.getNumLocations();
 
 	// compute information
 
@@ -62,20 +43,23 @@ VariationOfInformation::updateOutputs() {
 	double H1 = 0.0;
 	double I  = 0.0;
 
-	for(typename LabelProb::const_iterator i = _p1.begin(); i != _p1.end(); i++)
-		H0 -= i->second * std::log(i->second);
+	foreach (const Count& c, table.getCounts1()) {
 
-	for(typename LabelProb::const_iterator i = _p2.begin(); i != _p2.end(); i++)
-		H1 -= i->second * std::log(i->second);
+		const double p = c.second/n;
+		H0 -= p * std::log(p);
+	}
 
-	for(typename JointLabelProb::const_iterator i = _p12.begin(); i != _p12.end(); i++) {
+	foreach (const Count& c, table.getCounts2()) {
+
+		const double p = c.second/n;
+		H1 -= p * std::log(p);
+	}
 
-		const float j = i->first.first;
-		const float k = i->first.second;
+	foreach (const JointCount& c, table.getJointCounts()) {
 
-		const double pjk = i->second;
-		const double pj  = _p1[j];
-		const double pk  = _p2[k];
+		const double pjk = c.second/n;
+		const double pj  = table.getCounts1().find(c.first.first)->second/n;
+		const double pk  = table.getCounts2().find(c.first.second)->second/n;
 
 		I += pjk * std::log( pjk / (pj*pk) );
 	}
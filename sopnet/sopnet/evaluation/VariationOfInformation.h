@@ -4,12 +4,15 @@
 #include <pipeline/all.h>
 
 #include <imageprocessing/ImageStack.h>
+#include "ContingencyTable.h"
 
+/**
+ * Computes the variation of information of two image stacks. The stacks are 
+ * either given directly, or as the "contingency table" of a 
+ * ContingencyTableExtractor, which can be shared with other measures.
+ */
 class VariationOfInformation : public pipeline::SimpleProcessNode<> {
 
-	typedef std::map<float, double>                   LabelProb;
-	typedef std::map<std::pair<float, float>, double> JointLabelProb;
-
 public:
 
 	VariationOfInformation();
@@ -22,13 +25,11 @@ private:
 	pipeline::Input<ImageStack> _stack1;
 	pipeline::Input<ImageStack> _stack2;
 
+	// alternatively, the label counts of the stacks
+	pipeline::Input<ContingencyTable> _contingencyTable;
+
 	// variation of information
 	pipeline::Output<double>    _variationOfInformation;
-
-	// label probabilities
-	LabelProb      _p1;
-	LabelProb      _p2;
-	JointLabelProb _p12;
 };
 
 #endif // SOPNET_EVALUATION_VARIATION_OF_INFORMATION_H__
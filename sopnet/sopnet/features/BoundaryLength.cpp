@@ -0,0 +1,87 @@
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/tss.hpp>
+
+#include <imageprocessing/ConnectedComponent.h>
+#include <sopnet/slices/Slice.h>
+#include <util/foreach.h>
+#include "BoundaryLength.h"
+
+namespace {
+
+typedef boost::uint64_t word_type;
+
+const unsigned int BitsPerWord = 64;
+
+inline unsigned int popcount(word_type word) {
+
+	return __builtin_popcountll(word);
+}
+
+// the scratch bitmap of each thread
+boost::thread_specific_ptr<std::vector<word_type> > scratch;
+
+} // anonymous namespace
+
+unsigned int
+BoundaryLength::operator()(const Slice& slice) {
+
+	return (*this)(*slice.getComponent());
+}
+
+unsigned int
+BoundaryLength::operator()(const ConnectedComponent& component) {
+
+	const unsigned int width   = (unsigned int)(component.getBoundingBox().width()  + 1);
+	const unsigned int height  = (unsigned int)(component.getBoundingBox().height() + 1);
+	const unsigned int offsetX = (unsigned int)component.getBoundingBox().minX;
+	const unsigned int offsetY = (unsigned int)component.getBoundingBox().minY;
+
+	// one empty row above and below the component
+	const unsigned int wordsPerRow = (width + BitsPerWord - 1)/BitsPerWord;
+	const unsigned int numRows     = height + 2;
+
+	if (!scratch.get())
+		scratch.reset(new std::vector<word_type>());
+
+	std::vector<word_type>& bitmap = *scratch;
+
+	// does not free the memory, such that the bitmap is only reallocated for
+	// larger components
+	bitmap.assign(wordsPerRow*numRows, 0);
+
+	foreach (const util::point<unsigned int>& p, component.getPixels()) {
+
+		unsigned int x = p.x - offsetX;
+		unsigned int y = p.y - offsetY + 1;
+
+		bitmap[y*wordsPerRow + x/BitsPerWord] |= word_type(1) << (x%BitsPerWord);
+	}
+
+	unsigned int boundaryLength = 0;
+
+	for (unsigned int y = 1; y < numRows; y++) {
+
+		const word_type* row   = &bitmap[y*wordsPerRow];
+		const word_type* above = &bitmap[(y - 1)*wordsPerRow];
+
+		// the highest bit of the previous word, i.e., the pixel left of the
+		// first pixel of the current word
+		word_type carry = 0;
+
+		for (unsigned int w = 0; w < wordsPerRow; w++) {
+
+			// pixels whose left neighbor is not set start a run
+			word_type leftNeighbors = (row[w] << 1) | carry;
+			word_type runStarts     = row[w] & ~leftNeighbors;
+
+			boundaryLength += 2*popcount(runStarts);
+			boundaryLength += popcount(row[w] ^ above[w]);
+
+			carry = row[w] >> (BitsPerWord - 1);
+		}
+	}
+
+	return boundaryLength;
+}
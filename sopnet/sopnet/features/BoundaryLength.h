@@ -0,0 +1,30 @@
+#ifndef SOPNET_FEATURES_BOUNDARY_LENGTH_H__
+#define SOPNET_FEATURES_BOUNDARY_LENGTH_H__
+
+// forward declarations
+class Slice;
+class ConnectedComponent;
+
+/**
+ * Boundary length functor. Computes the number of pixel edges between a pixel
+ * of a slice and a pixel not in the slice, using the 4-neighborhood.
+ *
+ * The pixels are drawn into a bitmap with one bit per pixel, which is reused
+ * between calls of the same thread. The boundary is counted on whole words:
+ * every run of pixels in a row contributes a left and a right edge, and every
+ * bit that differs from the row above contributes a top or bottom edge.
+ */
+struct BoundaryLength {
+
+	/**
+	 * Compute the boundary length of a slice.
+	 */
+	unsigned int operator()(const Slice& slice);
+
+	/**
+	 * Compute the boundary length of a connected component.
+	 */
+	unsigned int operator()(const ConnectedComponent& component);
+};
+
+#endif // SOPNET_FEATURES_BOUNDARY_LENGTH_H__
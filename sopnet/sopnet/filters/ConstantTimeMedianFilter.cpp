@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cmath>
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+
+#include <sopnet/parallel/WorkerPool.h>
+#include <util/exceptions.h>
+#include <util/Logger.h>
+#include "ConstantTimeMedianFilter.h"
+
+logger::LogChannel constanttimemedianfilterlog("constanttimemedianfilterlog", "[ConstantTimeMedianFilter] ");
+
+namespace {
+
+typedef boost::uint16_t count_type;
+
+/**
+ * Two-level histogram of 8-bit values: 16 coarse bins of 16 fine bins each. 
+ * The coarse level allows to find the median by visiting at most 32 bins.
+ *
+ * All operations are plain loops over fixed size arrays, which the compiler 
+ * vectorizes.
+ */
+struct Histogram {
+
+	count_type coarse[16];
+	count_type fine[256];
+
+	void clear() {
+
+		std::fill(coarse, coarse + 16, 0);
+		std::fill(fine, fine + 256, 0);
+	}
+
+	void add(vigra::UInt8 value) {
+
+		coarse[value >> 4]++;
+		fine[value]++;
+	}
+
+	void remove(vigra::UInt8 value) {
+
+		coarse[value >> 4]--;
+		fine[value]--;
+	}
+
+	void add(const Histogram& other) {
+
+		for (int i = 0; i < 16; i++)
+			coarse[i] += other.coarse[i];
+		for (int i = 0; i < 256; i++)
+			fine[i] += other.fine[i];
+	}
+
+	// add one histogram and remove another in a single pass
+	void update(const Histogram& added, const Histogram& removed) {
+
+		for (int i = 0; i < 16; i++)
+			coarse[i] += added.coarse[i] - removed.coarse[i];
+		for (int i = 0; i < 256; i++)
+			fine[i] += added.fine[i] - removed.fine[i];
+	}
+
+	// the value with the given rank, starting at 0
+	vigra::UInt8 select(unsigned int rank) const {
+
+		int c = 0;
+		while (rank >= coarse[c]) {
+
+			rank -= coarse[c];
+			c++;
+		}
+
+		int f = 16*c;
+		while (rank >= fine[f]) {
+
+			rank -= fine[f];
+			f++;
+		}
+
+		return f;
+	}
+};
+
+inline int clamp(int v, int min, int max) {
+
+	return std::min(std::max(v, min), max);
+}
+
+} // anonymous namespace
+
+ConstantTimeMedianFilter::ConstantTimeMedianFilter() :
+	_filtered(new Image()) {
+
+	registerInput(_image, "image");
+	registerInput(_radius, "radius");
+	registerOutput(_filtered, "filtered");
+}
+
+void
+ConstantTimeMedianFilter::updateOutputs() {
+
+	unsigned int width  = _image->width();
+	unsigned int height = _image->height();
+
+	vigra::MultiArray<2, vigra::UInt8> in(vigra::Shape2(width, height));
+	vigra::MultiArray<2, vigra::UInt8> out(vigra::Shape2(width, height));
+
+	for (unsigned int y = 0; y < height; y++)
+		for (unsigned int x = 0; x < width; x++)
+			in(x, y) = static_cast<vigra::UInt8>(clamp(static_cast<int>(std::floor((*_image)(x, y)*255.0 + 0.5)), 0, 255));
+
+	filter(in, out, *_radius);
+
+	_filtered->reshape(_image->shape());
+
+	for (unsigned int y = 0; y < height; y++)
+		for (unsigned int x = 0; x < width; x++)
+			(*_filtered)(x, y) = out(x, y)/255.0;
+}
+
+void
+ConstantTimeMedianFilter::filter(
+		const image8_type& in,
+		image8_type out,
+		int radius,
+		unsigned int numThreads) {
+
+	if (in.shape() != out.shape())
+		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("input and output of median filter have different size") << STACK_TRACE);
+
+	// the window histogram has to fit (2*radius+1)^2 values
+	if (radius < 0 || radius > 127)
+		BOOST_THROW_EXCEPTION(UsageError() << error_message("median filter radius has to be in [0,127]") << STACK_TRACE);
+
+	int width = in.shape(0);
+
+	if (width == 0 || in.shape(1) == 0)
+		return;
+
+	if (numThreads == 1) {
+
+		filterTile(in, out, radius, 0, width);
+		return;
+	}
+
+	WorkerPool workers(numThreads);
+
+	// Tiles should be wide compared to the window, since the column 
+	// histograms where neighboring windows overlap are built by both tiles.
+	int numTiles = std::max(std::min((int)workers.size(), width/(4*radius + 1)), 1);
+
+	LOG_ALL(constanttimemedianfilterlog) << "filtering " << in.shape() << " image in " << numTiles << " tiles" << std::endl;
+
+	for (int i = 0; i < numTiles; i++)
+		workers.schedule(
+				boost::bind(
+						&ConstantTimeMedianFilter::filterTile,
+						boost::cref(in),
+						out,
+						radius,
+						(i*width)/numTiles,
+						((i + 1)*width)/numTiles));
+
+	workers.wait();
+}
+
+void
+ConstantTimeMedianFilter::filterTile(
+		const image8_type& in,
+		image8_type out,
+		int radius,
+		int begin,
+		int end) {
+
+	const int width  = in.shape(0);
+	const int height = in.shape(1);
+
+	const int windowSize = 2*radius + 1;
+	const unsigned int medianRank = (windowSize*windowSize)/2;
+
+	// one histogram for each column of the tile, plus radius columns on each 
+	// side, initialized to the window around the first row
+	const int numColumns = end - begin + 2*radius;
+	std::vector<Histogram> columns(numColumns);
+
+	for (int c = 0; c < numColumns; c++) {
+
+		int x = clamp(begin - radius + c, 0, width - 1);
+
+		columns[c].clear();
+		for (int dy = -radius; dy <= radius; dy++)
+			columns[c].add(in(x, clamp(dy, 0, height - 1)));
+	}
+
+	Histogram window;
+
+	for (int y = 0; y < height; y++) {
+
+		// move the column histograms down by one row
+		if (y > 0) {
+
+			int removedRow = clamp(y - radius - 1, 0, height - 1);
+			int addedRow   = clamp(y + radius,     0, height - 1);
+
+			for (int c = 0; c < numColumns; c++) {
+
+				int x = clamp(begin - radius + c, 0, width - 1);
+
+				columns[c].remove(in(x, removedRow));
+				columns[c].add(in(x, addedRow));
+			}
+		}
+
+		// the window around the first pixel of the row
+		window.clear();
+		for (int c = 0; c < windowSize; c++)
+			window.add(columns[c]);
+
+		out(begin, y) = window.select(medianRank);
+
+		// move the window right by one column
+		for (int x = begin + 1; x < end; x++) {
+
+			int c = x - begin;
+
+			window.update(columns[c + 2*radius], columns[c - 1]);
+
+			out(x, y) = window.select(medianRank);
+		}
+	}
+}
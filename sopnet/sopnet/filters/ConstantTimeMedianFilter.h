@@ -0,0 +1,66 @@
+#ifndef SOPNET_FILTERS_CONSTANT_TIME_MEDIAN_FILTER_H__
+#define SOPNET_FILTERS_CONSTANT_TIME_MEDIAN_FILTER_H__
+
+#include <vigra/multi_array.hxx>
+#include <vigra/stdimage.hxx>
+
+#include <pipeline/all.h>
+#include <imageprocessing/Image.h>
+
+/**
+ * Median filter for 8-bit images with a square window of side 2*radius+1, 
+ * following Perreault and Hébert, "Median Filtering in Constant Time". The 
+ * filter keeps one intensity histogram per image column and one for the 
+ * window, which are updated incrementally while moving over the image. The 
+ * cost per pixel is therefore independent of the radius. Pixels outside the 
+ * image are replaced by the closest pixel inside.
+ *
+ * The input image is expected to have intensities in [0,1], which are 
+ * quantized to 256 levels.
+ */
+class ConstantTimeMedianFilter : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	typedef vigra::MultiArrayView<2, vigra::UInt8> image8_type;
+
+	ConstantTimeMedianFilter();
+
+	/**
+	 * Median filter an 8-bit image. Vertical tiles of the image are filtered 
+	 * in parallel.
+	 *
+	 * @param in, out
+	 *              The input and output image of the same size. They must 
+	 *              not overlap.
+	 * @param radius
+	 *              The radius of the filter window, at most 127.
+	 * @param numThreads
+	 *              The number of threads to use. If 0, the default number of 
+	 *              worker threads is used.
+	 */
+	static void filter(
+			const image8_type& in,
+			image8_type out,
+			int radius,
+			unsigned int numThreads = 0);
+
+private:
+
+	void updateOutputs();
+
+	// filter the columns [begin, end) of the image
+	static void filterTile(
+			const image8_type& in,
+			image8_type out,
+			int radius,
+			int begin,
+			int end);
+
+	pipeline::Input<Image>  _image;
+	pipeline::Input<int>    _radius;
+	pipeline::Output<Image> _filtered;
+};
+
+#endif // SOPNET_FILTERS_CONSTANT_TIME_MEDIAN_FILTER_H__
+
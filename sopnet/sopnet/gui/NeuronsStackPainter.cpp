@@ -15,7 +15,8 @@ NeuronsStackPainter::NeuronsStackPainter() :
 	_showBranches(true),
 	_showSliceIds(false),
 	_alpha(0.8),
-	_zScale(15) {}
+	_zScale(15),
+	_visibleRegion(0, 0, 0, 0) {}
 
 void
 NeuronsStackPainter::setNeurons(boost::shared_ptr<SegmentTrees> neurons) {
@@ -29,7 +30,8 @@ NeuronsStackPainter::setNeurons(boost::shared_ptr<SegmentTrees> neurons) {
 
 	assignColors();
 
-	loadTextures();
+	// textures are loaded when drawn
+	_textures.clear();
 
 	setCurrentSection(_section);
 }
@@ -192,31 +194,47 @@ NeuronsStackPainter::hsvToRgb(double h, double s, double v, double& r, double& g
 }
 
 void
-NeuronsStackPainter::loadTextures() {
+NeuronsStackPainter::prepareTextures() {
 
-	_textures.clear();
+	// nothing was drawn, yet
+	if (_visibleRegion.width() == 0 || _visibleRegion.height() == 0)
+		return;
+
+	std::vector<boost::shared_ptr<Slice> > slices;
+
+	// the slices of the previous and next section are in the intervals
+	// around the two intervals of the current section
+	unsigned int begin = (_section > 0 ? _section - 1 : 0);
+	unsigned int end   = _section + 2;
 
 	foreach (boost::shared_ptr<SegmentTree> neuron, *_neurons) {
 
 		// aquire a read lock on the neuron
 		boost::shared_lock<boost::shared_mutex> lockNeuron(neuron->getMutex());
 
-		foreach (boost::shared_ptr<EndSegment> end, neuron->getEnds())
-			_textures.load(*end->getSlice());
-
-		foreach (boost::shared_ptr<ContinuationSegment> continuation, neuron->getContinuations()) {
+		for (unsigned int interval = begin; interval <= end; interval++) {
 
-			_textures.load(*continuation->getSourceSlice());
-			_textures.load(*continuation->getTargetSlice());
-		}
+			foreach (boost::shared_ptr<EndSegment> segment, neuron->getEnds(interval))
+				addVisibleSlices(*segment, slices);
 
-		foreach (boost::shared_ptr<BranchSegment> branch, neuron->getBranches()) {
+			foreach (boost::shared_ptr<ContinuationSegment> segment, neuron->getContinuations(interval))
+				addVisibleSlices(*segment, slices);
 
-			_textures.load(*branch->getSourceSlice());
-			_textures.load(*branch->getTargetSlice1());
-			_textures.load(*branch->getTargetSlice2());
+			foreach (boost::shared_ptr<BranchSegment> segment, neuron->getBranches(interval))
+				addVisibleSlices(*segment, slices);
 		}
 	}
+
+	_textures.prepare(slices);
+}
+
+void
+NeuronsStackPainter::addVisibleSlices(const Segment& segment, std::vector<boost::shared_ptr<Slice> >& slices) {
+
+	foreach (boost::shared_ptr<Slice> slice, segment.getSlices())
+		if (slice->getSection() != _section &&
+		    util::rect<double>(slice->getComponent()->getBoundingBox()).intersects(_visibleRegion))
+			slices.push_back(slice);
 }
 
 void
@@ -248,6 +266,8 @@ NeuronsStackPainter::setCurrentSection(unsigned int section) {
 
 	setSize(size);
 
+	prepareTextures();
+
 	LOG_DEBUG(neuronsstackpainterlog) << "current section set to " << _section << std::endl;
 	LOG_DEBUG(neuronsstackpainterlog) << "current size set to " << size << std::endl;
 }
@@ -282,6 +302,8 @@ NeuronsStackPainter::draw(
 
 	LOG_ALL(neuronsstackpainterlog) << "redrawing section " << _section << std::endl;
 
+	_visibleRegion = roi;
+
 	// from previous section
 
 	if (_showSingleNeuron) {
@@ -550,6 +572,14 @@ NeuronsStackPainter::drawSlice(
 	if (_drawnSlices.count(slice.getId()))
 		return;
 
+	util::rect<double> bb = slice.getComponent()->getBoundingBox();
+	bb.maxX += 2;
+	bb.maxY += 2;
+
+	// don't load textures of slices that are not visible
+	if (!bb.intersects(roi))
+		return;
+
 	_drawnSlices.insert(slice.getId());
 
 	glCheck(glColor4f(red, green, blue, alpha));
@@ -564,22 +594,10 @@ NeuronsStackPainter::drawSlice(
 	glCheck(glEnable(GL_LIGHT0));
 	glCheck(glEnable(GL_COLOR_MATERIAL));
 
-	try {
-
-		_textures.get(slice.getId())->bind();
-
-	} catch (SliceTextures::MissingTexture& e) {
-
-		loadTextures();
-		_textures.get(slice.getId())->bind();
-	}
+	_textures.get(slice)->bind();
 
 	glBegin(GL_QUADS);
 
-	util::rect<double> bb = slice.getComponent()->getBoundingBox();
-	bb.maxX += 2;
-	bb.maxY += 2;
-
 	// right side
 	glTexCoord2d(0.0, 0.0); glNormal3d(0, 0, 1); glVertex3d(bb.minX, bb.minY, 0);
 	glTexCoord2d(0.0, 1.0); glNormal3d(0, 0, 1); glVertex3d(bb.minX, bb.maxY, 0);
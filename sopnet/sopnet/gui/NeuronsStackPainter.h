@@ -81,8 +81,13 @@ private:
 	// find a random color for each neuron
 	void assignColors();
 
-	// load all slice textures
-	void loadTextures();
+	// rasterise the visible slices of the previous and next section in the 
+	// background
+	void prepareTextures();
+
+	// add the slices of the given segment outside the current section that 
+	// intersect the visible region
+	void addVisibleSlices(const Segment& segment, std::vector<boost::shared_ptr<Slice> >& slices);
 
 	void drawNeuron(
 		SegmentTree& neuron,
@@ -170,6 +175,9 @@ private:
 	std::map<unsigned int, boost::array<double, 3> > _colors;
 
 	std::set<unsigned int> _drawnSlices;
+
+	// the region that was drawn last
+	util::rect<double> _visibleRegion;
 };
 
 #endif // SOPNET_GUI_NEURONS_STACK_PAINTER_H__
@@ -320,7 +320,7 @@ SegmentsPainter::drawSlice(
 
 	glCheck(glColor4f(red, green, blue, 0.5));
 
-	_textures.get(slice->getId())->bind();
+	_textures.get(*slice, _imageStack)->bind();
 
 	glBegin(GL_QUADS);
 
@@ -19,7 +19,8 @@ SegmentsStackPainter::SegmentsStackPainter(double gap) :
 	_showSliceIds(true),
 	_focus(0, 0),
 	_zScale(15),
-	_gap(gap) {}
+	_gap(gap),
+	_visibleRegion(0, 0, 0, 0) {}
 
 void
 SegmentsStackPainter::setSegments(boost::shared_ptr<Segments> segments) {
@@ -232,23 +233,16 @@ SegmentsStackPainter::setCurrentSection(unsigned int section) {
 
 	updateVisibleSegments();
 
-	// get the size of the painter and load missing textures
+	// get the size of the painter (textures are loaded when drawn)
 	util::rect<double> size(0, 0, 0, 0);
 
-	foreach (boost::shared_ptr<EndSegment> end, _segments->getEnds()) {
-
+	foreach (boost::shared_ptr<EndSegment> end, _segments->getEnds())
 		size = sizeAddSlice(size, *end->getSlice());
 
-		_textures.load(*end->getSlice());
-	}
-
 	foreach (boost::shared_ptr<ContinuationSegment> continuation, _segments->getContinuations()) {
 
 		size = sizeAddSlice(size, *continuation->getSourceSlice());
 		size = sizeAddSlice(size, *continuation->getTargetSlice());
-
-		_textures.load(*continuation->getSourceSlice());
-		_textures.load(*continuation->getTargetSlice());
 	}
 
 	foreach (boost::shared_ptr<BranchSegment> branch, _segments->getBranches()) {
@@ -256,10 +250,6 @@ SegmentsStackPainter::setCurrentSection(unsigned int section) {
 		size = sizeAddSlice(size, *branch->getSourceSlice());
 		size = sizeAddSlice(size, *branch->getTargetSlice1());
 		size = sizeAddSlice(size, *branch->getTargetSlice2());
-
-		_textures.load(*branch->getSourceSlice());
-		_textures.load(*branch->getTargetSlice1());
-		_textures.load(*branch->getTargetSlice2());
 	}
 
 	_sectionHeight = size.height();
@@ -274,10 +264,58 @@ SegmentsStackPainter::setCurrentSection(unsigned int section) {
 
 	setSize(size);
 
+	prepareTextures();
+
 	LOG_DEBUG(segmentsstackpainterlog) << "current section set to " << _section << std::endl;
 	LOG_DEBUG(segmentsstackpainterlog) << "current size set to " << size << std::endl;
 }
 
+void
+SegmentsStackPainter::prepareTextures() {
+
+	// nothing was drawn, yet
+	if (_visibleRegion.width() == 0 || _visibleRegion.height() == 0)
+		return;
+
+	std::vector<boost::shared_ptr<Slice> > slices;
+
+	// the segments of the previous and next section are in the intervals
+	// around the two intervals of the current section
+	unsigned int begin = (_section > 0 ? _section - 1 : 0);
+	unsigned int end   = _section + 2;
+
+	for (unsigned int interval = begin; interval <= end; interval++) {
+
+		foreach (boost::shared_ptr<EndSegment> segment, _segments->getEnds(interval))
+			addVisibleSlices(*segment, slices);
+
+		foreach (boost::shared_ptr<ContinuationSegment> segment, _segments->getContinuations(interval))
+			addVisibleSlices(*segment, slices);
+
+		foreach (boost::shared_ptr<BranchSegment> segment, _segments->getBranches(interval))
+			addVisibleSlices(*segment, slices);
+	}
+
+	_textures.prepare(slices);
+}
+
+void
+SegmentsStackPainter::addVisibleSlices(const Segment& segment, std::vector<boost::shared_ptr<Slice> >& slices) {
+
+	double offset = _sectionHeight + _gap;
+
+	foreach (boost::shared_ptr<Slice> slice, segment.getSlices()) {
+
+		util::rect<double> bb = slice->getComponent()->getBoundingBox();
+
+		// slices can be drawn in the current section, or above or below it
+		if (bb.intersects(_visibleRegion) ||
+		    (bb + util::point<double>(0, offset)).intersects(_visibleRegion) ||
+		    (bb - util::point<double>(0, offset)).intersects(_visibleRegion))
+			slices.push_back(slice);
+	}
+}
+
 void
 SegmentsStackPainter::updateVisibleSegments() {
 
@@ -330,6 +368,8 @@ SegmentsStackPainter::draw(
 
 	LOG_ALL(segmentsstackpainterlog) << "redrawing section " << _section << std::endl;
 
+	_visibleRegion = roi;
+
 	// from previous section
 
 	foreach (boost::shared_ptr<EndSegment> end, _prevSegments->getEnds()) {
@@ -458,6 +498,27 @@ SegmentsStackPainter::drawSlice(
 		const util::rect<double>&  roi,
 		const util::point<double>& resolution) {
 
+	const util::rect<double>& bb = slice.getComponent()->getBoundingBox();
+
+	double offset = 0;
+
+	// draw the segment in the previous or next section, instead of in front of 
+	// current section
+	if (z < 0) {
+
+		offset = _sectionHeight + _gap;
+		z = 0;
+
+	} else if (z > 0) {
+
+		offset = -_sectionHeight - _gap;
+		z = 0;
+	}
+
+	// don't load textures of slices that are not visible
+	if (!(bb + util::point<double>(0, offset)).intersects(roi))
+		return;
+
 	// set up lighting
 	GLfloat ambient[4] = { 0, 0, 0, 1 };
 	glCheck(glLightfv(GL_LIGHT0, GL_AMBIENT, ambient));
@@ -479,27 +540,10 @@ SegmentsStackPainter::drawSlice(
 
 	glCheck(glColor4f(red, green, blue, alpha));
 
-	_textures.get(slice.getId())->bind();
+	_textures.get(slice)->bind();
 
 	glBegin(GL_QUADS);
 
-	const util::rect<double>& bb = slice.getComponent()->getBoundingBox();
-
-	double offset = 0;
-
-	// draw the segment in the previous or next section, instead of in front of 
-	// current section
-	if (z < 0) {
-
-		offset = _sectionHeight + _gap;
-		z = 0;
-
-	} else if (z > 0) {
-
-		offset = -_sectionHeight - _gap;
-		z = 0;
-	}
-
 	// left side
 	glTexCoord2d(1.0, 0.0); glNormal3d(0, 0, -1); glVertex3d(bb.maxX, bb.minY + offset, z);
 	glTexCoord2d(1.0, 1.0); glNormal3d(0, 0, -1); glVertex3d(bb.maxX, bb.maxY + offset, z);
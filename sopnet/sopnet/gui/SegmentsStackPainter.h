@@ -97,6 +97,13 @@ private:
 	// fill the sets of prev/next segments
 	void updateVisibleSegments();
 
+	// rasterise the visible slices of the previous and next section in the 
+	// background
+	void prepareTextures();
+
+	// add the slices of the given segment that intersect the visible region
+	void addVisibleSlices(const Segment& segment, std::vector<boost::shared_ptr<Slice> >& slices);
+
 	void drawSlice(
 		const Slice& slice,
 		double z,
@@ -159,6 +166,9 @@ private:
 
 	// the gap between two sections
 	double _gap;
+
+	// the region that was drawn last
+	util::rect<double> _visibleRegion;
 };
 
 #endif // SOPNET_GUI_SEGMENTS_STACK_PAINTER_H__
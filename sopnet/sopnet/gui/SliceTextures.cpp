@@ -1,13 +1,35 @@
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
 #include <imageprocessing/ImageStack.h>
 #include <imageprocessing/ConnectedComponent.h>
 #include <gui/Texture.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
 #include <util/rect.hpp>
 #include <util/point.hpp>
 #include "SliceTextures.h"
 
+static logger::LogChannel slicetextureslog("slicetextureslog", "[SliceTextures] ");
+
+util::ProgramOption optionSliceTextureCacheSize(
+		util::_module           = "gui",
+		util::_long_name        = "sliceTextureCacheSize",
+		util::_description_text = "The maximal memory in MB for slice textures. Least recently used textures are released first.",
+		util::_default_value    = 512);
+
+SliceTextures::SliceTextures() :
+	_maxBytes(optionSliceTextureCacheSize.as<size_t>()*1024*1024),
+	_textureBytes(0),
+	_preparedBytes(0),
+	_generation(0),
+	_stopPreparing(false) {}
 
 SliceTextures::~SliceTextures() {
 
+	stopPreparing();
 	clear();
 }
 
@@ -16,8 +38,120 @@ SliceTextures::load(
 		const Slice& slice,
 		boost::shared_ptr<ImageStack> imageStack) {
 
-	if (_textures.count(slice.getId()))
-		return;
+	get(slice, imageStack);
+}
+
+void
+SliceTextures::prepare(
+		const std::vector<boost::shared_ptr<Slice> >& slices,
+		boost::shared_ptr<ImageStack> imageStack) {
+
+	boost::mutex::scoped_lock lock(_prepareMutex);
+
+	_jobs.clear();
+
+	foreach (boost::shared_ptr<Slice> slice, slices) {
+
+		if (_prepared.count(slice->getId()))
+			continue;
+
+		Job job;
+		job.slice = slice;
+		job.image = imageStack;
+		job.generation = _generation;
+
+		_jobs.push_back(job);
+	}
+
+	LOG_ALL(slicetextureslog) << "preparing " << _jobs.size() << " slices in the background" << std::endl;
+
+	if (!_prepareThread.joinable())
+		_prepareThread = boost::thread(boost::bind(&SliceTextures::prepareLoop, this));
+
+	_jobAvailable.notify_one();
+}
+
+void
+SliceTextures::clear() {
+
+	unsigned int id;
+	CacheEntry entry;
+
+	foreach (boost::tie(id, entry), _textures)
+		if (entry.texture)
+			delete entry.texture;
+
+	_textures.clear();
+	_lru.clear();
+	_textureBytes = 0;
+
+	boost::mutex::scoped_lock lock(_prepareMutex);
+
+	_jobs.clear();
+	_prepared.clear();
+	_preparedOrder.clear();
+	_preparedBytes = 0;
+
+	// results of jobs in progress are outdated now
+	_generation++;
+}
+
+gui::Texture*
+SliceTextures::get(
+		const Slice& slice,
+		boost::shared_ptr<ImageStack> imageStack) {
+
+	std::map<unsigned int, CacheEntry>::iterator i = _textures.find(slice.getId());
+
+	if (i != _textures.end()) {
+
+		// mark as most recently used
+		_lru.splice(_lru.begin(), _lru, i->second.lruPosition);
+
+		return i->second.texture;
+	}
+
+	boost::shared_ptr<PixelData> data = takePrepared(slice.getId());
+
+	if (!data)
+		data = rasterise(slice, imageStack);
+
+	gui::Texture* texture = new gui::Texture(data->size.x, data->size.y, GL_RGBA);
+	texture->loadData(&data->pixels[0]);
+
+	_lru.push_front(slice.getId());
+
+	CacheEntry& entry = _textures[slice.getId()];
+	entry.texture     = texture;
+	entry.bytes       = data->size.x*data->size.y*4;
+	entry.lruPosition = _lru.begin();
+
+	_textureBytes += entry.bytes;
+
+	evict();
+
+	return texture;
+}
+
+gui::Texture*
+SliceTextures::get(unsigned int sliceId) {
+
+	std::map<unsigned int, CacheEntry>::iterator i = _textures.find(sliceId);
+
+	if (i != _textures.end()) {
+
+		_lru.splice(_lru.begin(), _lru, i->second.lruPosition);
+
+		return i->second.texture;
+	}
+
+	BOOST_THROW_EXCEPTION(MissingTexture() << error_message("slice texture does not exist") << STACK_TRACE);
+}
+
+boost::shared_ptr<SliceTextures::PixelData>
+SliceTextures::rasterise(const Slice& slice, boost::shared_ptr<ImageStack> imageStack) {
+
+	boost::shared_ptr<PixelData> data = boost::make_shared<PixelData>();
 
 	// create image data
 	const util::rect<double> bb = slice.getComponent()->getBoundingBox();
@@ -25,8 +159,10 @@ SliceTextures::load(
 	util::point<unsigned int> size(bb.maxX - bb.minX + 2, bb.maxY - bb.minY + 2);
 	util::point<unsigned int> offset(bb.minX, bb.minY);
 
+	data->size = size;
+
 	// rgba data
-	std::vector<boost::array<float, 4> > pixels;
+	std::vector<boost::array<float, 4> >& pixels = data->pixels;
 
 	// fill with opaque value
 
@@ -52,32 +188,103 @@ SliceTextures::load(
 		pixels[index][3] = 1.0;
 	}
 
-	gui::Texture* texture = new gui::Texture(size.x, size.y, GL_RGBA);
+	return data;
+}
+
+boost::shared_ptr<SliceTextures::PixelData>
+SliceTextures::takePrepared(unsigned int sliceId) {
+
+	boost::mutex::scoped_lock lock(_prepareMutex);
+
+	std::map<unsigned int, boost::shared_ptr<PixelData> >::iterator i = _prepared.find(sliceId);
+
+	if (i == _prepared.end())
+		return boost::shared_ptr<PixelData>();
 
-	texture->loadData(&pixels[0]);
+	boost::shared_ptr<PixelData> data = i->second;
 
-	_textures[slice.getId()] = texture;
+	_prepared.erase(i);
+	_preparedOrder.erase(std::find(_preparedOrder.begin(), _preparedOrder.end(), sliceId));
+	_preparedBytes -= data->pixels.size()*sizeof(boost::array<float, 4>);
+
+	return data;
 }
 
 void
-SliceTextures::clear() {
+SliceTextures::evict() {
 
-	unsigned int id;
-	gui::Texture* texture;
+	// never release the most recently used texture, it was just requested
+	while (_textureBytes > _maxBytes && _lru.size() > 1) {
 
-	foreach (boost::tie(id, texture), _textures)
-		if (texture)
-			delete texture;
+		unsigned int id = _lru.back();
+		_lru.pop_back();
 
-	_textures.clear();
+		std::map<unsigned int, CacheEntry>::iterator i = _textures.find(id);
+
+		_textureBytes -= i->second.bytes;
+		delete i->second.texture;
+
+		_textures.erase(i);
+	}
 }
 
-gui::Texture*
-SliceTextures::get(unsigned int sliceId) {
+void
+SliceTextures::prepareLoop() {
 
-	if (_textures.count(sliceId))
-		return _textures[sliceId];
+	while (true) {
 
-	BOOST_THROW_EXCEPTION(MissingTexture() << error_message("slice texture does not exist") << STACK_TRACE);
+		Job job;
+
+		{
+			boost::mutex::scoped_lock lock(_prepareMutex);
+
+			while (_jobs.empty() && !_stopPreparing)
+				_jobAvailable.wait(lock);
+
+			if (_stopPreparing)
+				return;
+
+			job = _jobs.front();
+			_jobs.pop_front();
+
+			if (_prepared.count(job.slice->getId()))
+				continue;
+		}
+
+		boost::shared_ptr<PixelData> data = rasterise(*job.slice, job.image);
+		size_t bytes = data->pixels.size()*sizeof(boost::array<float, 4>);
+
+		boost::mutex::scoped_lock lock(_prepareMutex);
+
+		if (job.generation != _generation || _prepared.count(job.slice->getId()))
+			continue;
+
+		_prepared[job.slice->getId()] = data;
+		_preparedOrder.push_back(job.slice->getId());
+		_preparedBytes += bytes;
+
+		// drop the oldest prepared data that was not used
+		while (_preparedBytes > _maxBytes && _preparedOrder.size() > 1) {
+
+			unsigned int id = _preparedOrder.front();
+			_preparedOrder.pop_front();
+
+			_preparedBytes -= _prepared[id]->pixels.size()*sizeof(boost::array<float, 4>);
+			_prepared.erase(id);
+		}
+	}
 }
 
+void
+SliceTextures::stopPreparing() {
+
+	{
+		boost::mutex::scoped_lock lock(_prepareMutex);
+
+		_stopPreparing = true;
+		_jobAvailable.notify_all();
+	}
+
+	if (_prepareThread.joinable())
+		_prepareThread.join();
+}
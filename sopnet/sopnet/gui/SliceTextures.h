@@ -1,9 +1,16 @@
 #ifndef SOPNET_GUI_SLICE_TEXTURES_H__
 #define SOPNET_GUI_SLICE_TEXTURES_H__
 
+#include <deque>
+#include <list>
 #include <map>
+#include <vector>
 
+#include <boost/array.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 #include <gui/Texture.h>
 #include <sopnet/slices/Slice.h>
@@ -11,6 +18,19 @@
 // forward declaration
 class ImageStack;
 
+/**
+ * A cache of slice textures. Textures are created when they are first needed
+ * and released least-recently-used first, once their total size exceeds the
+ * program option gui.sliceTextureCacheSize.
+ *
+ * Slices that will probably be needed soon (like the ones of the next and
+ * previous section) can be handed to prepare(). Their pixel data is then
+ * rasterised in a background thread, such that only the upload to the
+ * graphics card is left when the texture is needed.
+ *
+ * All methods except prepare() create or delete OpenGL textures and have to
+ * be called with an active OpenGL context.
+ */
 class SliceTextures {
 
 public:
@@ -18,26 +38,99 @@ public:
 	// missing texture exception
 	struct MissingTexture : virtual GuiError {};
 
+	SliceTextures();
+
 	~SliceTextures();
 
 	/**
-	 * Load the texture for a slice. Optionally, an image can be given to texture the slice.
+	 * Load the texture for a slice, if it is not in the cache. Optionally, an
+	 * image can be given to texture the slice.
 	 */
 	void load(const Slice& slice, boost::shared_ptr<ImageStack> image = boost::shared_ptr<ImageStack>());
 
+	/**
+	 * Rasterise the given slices in the background. Slices that were handed to
+	 * a previous call and are not prepared yet are dropped.
+	 */
+	void prepare(
+			const std::vector<boost::shared_ptr<Slice> >& slices,
+			boost::shared_ptr<ImageStack> image = boost::shared_ptr<ImageStack>());
+
 	/**
 	 * Delete all textures.
 	 */
 	void clear();
 
 	/**
-	 * Get the texture for the given slice id.
+	 * Get the texture for the given slice, load it if needed. The texture
+	 * stays valid until the next call to get() or load().
+	 */
+	gui::Texture* get(const Slice& slice, boost::shared_ptr<ImageStack> image = boost::shared_ptr<ImageStack>());
+
+	/**
+	 * Get the texture for the given slice id. Throws MissingTexture, if it has
+	 * not been loaded or was released since.
 	 */
 	gui::Texture* get(unsigned int sliceId);
 
 private:
 
-	std::map<unsigned int, gui::Texture*> _textures;
+	// rasterised rgba data of a slice
+	struct PixelData {
+
+		util::point<unsigned int>             size;
+		std::vector<boost::array<float, 4> >  pixels;
+	};
+
+	// a slice waiting to be rasterised
+	struct Job {
+
+		boost::shared_ptr<Slice>      slice;
+		boost::shared_ptr<ImageStack> image;
+		unsigned int                  generation;
+	};
+
+	struct CacheEntry {
+
+		gui::Texture*                     texture;
+		size_t                            bytes;
+		std::list<unsigned int>::iterator lruPosition;
+	};
+
+	static boost::shared_ptr<PixelData> rasterise(const Slice& slice, boost::shared_ptr<ImageStack> image);
+
+	// get the prepared pixel data for a slice, if there is any
+	boost::shared_ptr<PixelData> takePrepared(unsigned int sliceId);
+
+	// release least recently used textures until the cache fits into its size
+	void evict();
+
+	void prepareLoop();
+
+	void stopPreparing();
+
+	// the maximal size of all textures in bytes
+	size_t _maxBytes;
+
+	// the textures, owned by the OpenGL thread
+	std::map<unsigned int, CacheEntry> _textures;
+
+	// slice ids of the textures, most recently used first
+	std::list<unsigned int> _lru;
+
+	size_t _textureBytes;
+
+	// the state of the preparation thread, guarded by _prepareMutex
+	std::deque<Job>                                    _jobs;
+	std::map<unsigned int, boost::shared_ptr<PixelData> > _prepared;
+	std::deque<unsigned int>                           _preparedOrder;
+	size_t                                             _preparedBytes;
+	unsigned int                                       _generation;
+	bool                                               _stopPreparing;
+
+	boost::mutex              _prepareMutex;
+	boost::condition_variable _jobAvailable;
+	boost::thread             _prepareThread;
 };
 
 #endif // SOPNET_GUI_SLICE_TEXTURES_H__
@@ -139,6 +139,7 @@ GridSearch::next() {
 	}
 
 	setDirty(_priorCostFunctionParameters);
+	setDirty(_segmentationCostFunctionParameters);
 
 	return true;
 }
@@ -0,0 +1,153 @@
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+#include <inference/DefaultFactory.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
+#include <trace/Tracer.h>
+#include "GridSearchSolver.h"
+
+static logger::LogChannel gridsearchsolverlog("gridsearchsolverlog", "[GridSearchSolver] ");
+
+util::ProgramOption optionGridSearchPointsPerWorker(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "gridSearchPointsPerWorker",
+		util::_description_text = "The number of consecutive grid points each worker solves in one batch of the grid search. "
+		                          "Larger values make better use of warm starts, but keep more objectives in memory.",
+		util::_default_value    = 4);
+
+GridSearchSolver::GridSearchSolver(
+		boost::shared_ptr<LinearConstraints> linearConstraints,
+		const LinearSolverParameters&        parameters,
+		unsigned int                         numThreads) :
+	_linearConstraints(linearConstraints),
+	_parameters(parameters),
+	_numConstraintVariables(0),
+	_workerPool(numThreads) {
+
+	unsigned int varNum;
+	double coef;
+	foreach (const LinearConstraint& constraint, *_linearConstraints)
+		foreach (boost::tie(varNum, coef), constraint.getCoefficients())
+			_numConstraintVariables = std::max(_numConstraintVariables, varNum + 1);
+
+	DefaultFactory factory;
+
+	_workers.resize(_workerPool.size());
+	foreach (Worker& worker, _workers) {
+
+		worker.solver = boost::shared_ptr<LinearSolverBackend>(factory.createLinearSolverBackend());
+		worker.numVariables = 0;
+	}
+
+	LOG_DEBUG(gridsearchsolverlog)
+			<< "created " << _workers.size() << " solvers for "
+			<< _linearConstraints->size() << " constraints" << std::endl;
+}
+
+unsigned int
+GridSearchSolver::getBatchSize() const {
+
+	return _workers.size()*std::max(1u, optionGridSearchPointsPerWorker.as<unsigned int>());
+}
+
+std::vector<boost::shared_ptr<Solution> >
+GridSearchSolver::solve(const std::vector<boost::shared_ptr<LinearObjective> >& objectives) {
+
+	TRACE_SCOPE("GridSearchSolver::solve");
+
+	std::vector<boost::shared_ptr<Solution> > solutions(objectives.size());
+
+	// give each worker a contiguous run of objectives
+	unsigned int runLength = (objectives.size() + _workers.size() - 1)/_workers.size();
+
+	for (unsigned int i = 0; i < _workers.size(); i++) {
+
+		unsigned int begin = std::min<unsigned int>(i*runLength, objectives.size());
+		unsigned int end   = std::min<unsigned int>(begin + runLength, objectives.size());
+
+		if (begin == end)
+			break;
+
+		_workerPool.schedule(
+				boost::bind(
+						&GridSearchSolver::solveRun,
+						this,
+						boost::ref(_workers[i]),
+						boost::cref(objectives),
+						begin,
+						end,
+						boost::ref(solutions)));
+	}
+
+	_workerPool.wait();
+
+	TRACE_COUNT("grid points", objectives.size());
+
+	return solutions;
+}
+
+void
+GridSearchSolver::solveRun(
+		Worker&                                                 worker,
+		const std::vector<boost::shared_ptr<LinearObjective> >& objectives,
+		unsigned int                                            begin,
+		unsigned int                                            end,
+		std::vector<boost::shared_ptr<Solution> >&              solutions) {
+
+	for (unsigned int i = begin; i < end; i++) {
+
+		const LinearObjective& objective = *objectives[i];
+
+		unsigned int numVariables = std::max<unsigned int>(objective.getCoefficients().size(), _numConstraintVariables);
+
+		if (numVariables != worker.numVariables)
+			initialize(worker, numVariables);
+
+		worker.solver->setObjective(objective);
+
+		if (worker.solution)
+			worker.solver->setInitialSolution(*worker.solution);
+
+		boost::shared_ptr<Solution> solution = boost::make_shared<Solution>();
+
+		double value;
+		std::string message;
+
+		if (worker.solver->solve(*solution, value, message)) {
+
+			LOG_DEBUG(gridsearchsolverlog) << "grid point " << i << ": " << message << ", value " << value << std::endl;
+
+			worker.solution = solution;
+
+		} else {
+
+			LOG_ERROR(gridsearchsolverlog) << "grid point " << i << ": " << message << std::endl;
+
+			// report an empty reconstruction for this grid point
+			solution->resize(numVariables);
+		}
+
+		solutions[i] = solution;
+	}
+}
+
+void
+GridSearchSolver::initialize(Worker& worker, unsigned int numVariables) {
+
+	LOG_DEBUG(gridsearchsolverlog) << "initializing solver for " << numVariables << " variables" << std::endl;
+
+	worker.solver->initialize(
+			numVariables,
+			_parameters.getDefaultVariableType(),
+			_parameters.getSpecialVariableTypes());
+
+	worker.solver->setConstraints(*_linearConstraints);
+
+	worker.numVariables = numVariables;
+	worker.solution.reset();
+}
+
@@ -0,0 +1,97 @@
+#ifndef SOPNET_INFERENCE_GRID_SEARCH_SOLVER_H__
+#define SOPNET_INFERENCE_GRID_SEARCH_SOLVER_H__
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <inference/LinearConstraints.h>
+#include <inference/LinearObjective.h>
+#include <inference/LinearSolverBackend.h>
+#include <inference/LinearSolverParameters.h>
+#include <inference/Solution.h>
+#include <sopnet/parallel/WorkerPool.h>
+
+/**
+ * Solves a sequence of problems that share their linear constraints and
+ * differ only in the objective, like the points of a grid search.
+ *
+ * The objectives are distributed over a pool of workers. Each worker owns a
+ * solver backend, in which the constraints are set only once, and solves a
+ * contiguous run of the given objectives. Each solve is started from the
+ * solution of the previous objective of the same worker, which for
+ * neighbouring grid points is usually close to the optimum.
+ */
+class GridSearchSolver {
+
+public:
+
+	/**
+	 * Create a new grid search solver.
+	 *
+	 * @param linearConstraints
+	 *              The constraints shared by all problems.
+	 *
+	 * @param parameters
+	 *              The variable types of the problems.
+	 *
+	 * @param numThreads
+	 *              The number of concurrent solves. If 0, the default of the
+	 *              WorkerPool is used.
+	 */
+	GridSearchSolver(
+			boost::shared_ptr<LinearConstraints> linearConstraints,
+			const LinearSolverParameters&        parameters,
+			unsigned int                         numThreads = 0);
+
+	/**
+	 * Solve the problems for the given objectives. Objectives of neighbouring
+	 * grid points should be neighbours in the vector.
+	 *
+	 * @return The solutions, in the order of the objectives.
+	 */
+	std::vector<boost::shared_ptr<Solution> > solve(
+			const std::vector<boost::shared_ptr<LinearObjective> >& objectives);
+
+	/**
+	 * Get the number of objectives that should be passed to solve() at once,
+	 * such that all workers are kept busy.
+	 */
+	unsigned int getBatchSize() const;
+
+private:
+
+	struct Worker {
+
+		boost::shared_ptr<LinearSolverBackend> solver;
+
+		// the number of variables the solver was initialized with
+		unsigned int numVariables;
+
+		// the last solution found by this worker
+		boost::shared_ptr<Solution> solution;
+	};
+
+	void solveRun(
+			Worker&                                                 worker,
+			const std::vector<boost::shared_ptr<LinearObjective> >& objectives,
+			unsigned int                                            begin,
+			unsigned int                                            end,
+			std::vector<boost::shared_ptr<Solution> >&              solutions);
+
+	void initialize(Worker& worker, unsigned int numVariables);
+
+	boost::shared_ptr<LinearConstraints> _linearConstraints;
+
+	LinearSolverParameters _parameters;
+
+	// the number of variables used in the constraints
+	unsigned int _numConstraintVariables;
+
+	WorkerPool _workerPool;
+
+	std::vector<Worker> _workers;
+};
+
+#endif // SOPNET_INFERENCE_GRID_SEARCH_SOLVER_H__
+
@@ -1,5 +1,7 @@
+#include <cmath>
 #include "SegmentationCostFunction.h"
 #include <imageprocessing/ConnectedComponent.h>
+#include <sopnet/features/BoundaryLength.h>
 #include <sopnet/segments/EndSegment.h>
 #include <sopnet/segments/ContinuationSegment.h>
 #include <sopnet/segments/BranchSegment.h>
@@ -53,6 +55,9 @@ SegmentationCostFunction::costs(
 
 		computeSegmentationCosts(ends, continuations, branches);
 
+		// don't keep the pixel lists and cost images alive
+		clearCostCaches();
+
 		LOG_DEBUG(segmentationcostfunctionlog)
 				<< "computed " << _segmentationCosts.size() << " segmentation cost values" << std::endl;
 	}
@@ -182,94 +187,168 @@ SegmentationCostFunction::computeSegmentationCost(const Slice& slice) {
 	
 	unsigned int section = slice.getSection() - offset.z;
 
-	double costs = 0.0;
+	boost::shared_ptr<ConnectedComponent> component = slice.getComponent();
+	const std::vector<double>& cumulativeCosts = getCumulativeCosts(slice, section);
 
-	// for each pixel in the slice
-	foreach (const util::point<unsigned int>& pixel, slice.getComponent()->getPixels()) {
+	unsigned int begin = component->getPixels().first  - component->getPixelList()->begin();
+	unsigned int end   = component->getPixels().second - component->getPixelList()->begin();
 
-		// get the membrane data probability p(x|y=membrane)
-		double probMembrane = (*(*_membranes)[section])(pixel.x - offset.x, pixel.y - offset.y);
+	double costs = cumulativeCosts[end] - cumulativeCosts[begin];
 
-		if (optionInvertMembraneMaps)
-			probMembrane = 1.0 - probMembrane;
+	_sliceSegmentationCosts[slice.getId()] = costs;
 
-		// get the neuron data probability p(x|y=neuron)
-		double probNeuron = 1.0 - probMembrane;
+	return costs;
+}
 
-		// multiply both with the respective prior p(y)
-		probMembrane *= (1.0 - _parameters->priorForeground);
-		probNeuron   *= _parameters->priorForeground;
+const std::vector<double>&
+SegmentationCostFunction::getCumulativeCosts(const Slice& slice, unsigned int section) {
 
-		// normalize both probabilities, so that we get p(y|x)
-		probMembrane /= probMembrane + probNeuron;
-		probNeuron   /= probMembrane + probNeuron;
+	boost::shared_ptr<pixel_list_type> pixelList = slice.getComponent()->getPixelList();
 
-		// ensure numerical stability
-		probMembrane = std::max(0.0001, std::min(0.9999, probMembrane));
-		probNeuron   = std::max(0.0001, std::min(0.9999, probNeuron));
+	std::pair<boost::shared_ptr<pixel_list_type>, std::vector<double> >& cumulativeCosts =
+			_cumulativeCosts[pixelList.get()];
 
-		// compute the corresponding costs
-		double costsMembrane = -log(probMembrane);
-		double costsNeuron   = -log(probNeuron);
+	if (cumulativeCosts.first)
+		return cumulativeCosts.second;
 
-		// costs for accepting the segmentation is the cost difference between
-		// segmenting the region as background and segmenting the region as
-		// foreground
-		costs += costsNeuron - costsMembrane;
+	util::point3<unsigned int> offset = _cropOffset.isSet() ? *_cropOffset :
+		util::point3<unsigned int>(0, 0, 0);
+
+	cumulativeCosts.first = pixelList;
+	cumulativeCosts.second.resize(pixelList->size() + 1, 0.0);
+
+	if (section >= _membranes->size()) {
+
+		LOG_ERROR(segmentationcostfunctionlog)
+				<< "slice " << slice.getId() << " in section " << slice.getSection()
+				<< " is outside of the membrane stack, assuming zero costs" << std::endl;
+
+		return cumulativeCosts.second;
 	}
 
-	_sliceSegmentationCosts[slice.getId()] = costs;
+	const std::vector<double>& costImage = getCostImage(section);
+	const unsigned int width  = (*_membranes)[section]->width();
+	const unsigned int height = (*_membranes)[section]->height();
 
-	return costs;
+	double sum = 0.0;
+	unsigned int i = 0;
+	unsigned int numOutside = 0;
+
+	cumulativeCosts.second[i++] = sum;
+	foreach (const util::point<unsigned int>& pixel, *pixelList) {
+
+		// skip pixels outside of the (cropped) membrane image
+		if (pixel.x >= offset.x && pixel.y >= offset.y &&
+		    pixel.x - offset.x < width && pixel.y - offset.y < height)
+			sum += costImage[(pixel.x - offset.x) + (pixel.y - offset.y)*width];
+		else
+			numOutside++;
+
+		cumulativeCosts.second[i++] = sum;
+	}
+
+	if (numOutside > 0)
+		LOG_DEBUG(segmentationcostfunctionlog)
+				<< numOutside << " pixels of slice " << slice.getId()
+				<< " are outside of the membrane image and were skipped" << std::endl;
+
+	return cumulativeCosts.second;
 }
 
-unsigned int
-SegmentationCostFunction::computeBoundaryLength(const Slice& slice) {
+const std::vector<double>&
+SegmentationCostFunction::getCostImage(unsigned int section) {
 
-	if (_sliceBoundaryLengths.count(slice.getId()))
-		return _sliceBoundaryLengths[slice.getId()];
+	std::vector<double>& costImage = _costImages[section];
 
-	boost::shared_ptr<ConnectedComponent> component = slice.getComponent();
+	if (!costImage.empty())
+		return costImage;
 
-	unsigned int width   = (unsigned int)(component->getBoundingBox().width()  + 1);
-	unsigned int height  = (unsigned int)(component->getBoundingBox().height() + 1);
-	unsigned int offsetX = (unsigned int)component->getBoundingBox().minX;
-	unsigned int offsetY = (unsigned int)component->getBoundingBox().minY;
+	const Image& membrane = *(*_membranes)[section];
 
-	std::vector<bool> pixels(width*height, false);
+	const unsigned int width  = membrane.width();
+	const unsigned int height = membrane.height();
 
-	foreach (const util::point<unsigned int>& p, component->getPixels()) {
+	// Membrane maps are usually 8-bit images, i.e., all probabilities are 
+	// multiples of 1/255. For those, the costs are looked up in a table.
+	double lookupTable[256];
+	for (unsigned int k = 0; k < 256; k++)
+		lookupTable[k] = computePixelCost(k/255.0);
 
-		unsigned int x = p.x - offsetX;
-		unsigned int y = p.y - offsetY;
+	costImage.resize(width*height);
 
-		pixels[x + y*width] = true;
-	}
+	unsigned int numComputed = 0;
 
-	unsigned int boundaryLength = 0;
+	for (unsigned int y = 0; y < height; y++)
+		for (unsigned int x = 0; x < width; x++) {
 
-	foreach (const util::point<unsigned int>& p, component->getPixels()) {
+			double probMembrane = membrane(x, y);
+			double scaled = probMembrane*255.0;
+			int k = (int)(scaled + 0.5);
 
-		// for neighborhood testing with offset
-		unsigned int x = p.x - offsetX;
-		unsigned int y = p.y - offsetY;
+			if (k >= 0 && k < 256 && std::abs(scaled - k) < 1e-4) {
 
-		// left
-		if (x == 0 || !pixels[(x - 1) + y*width])
-			boundaryLength++;
+				costImage[x + y*width] = lookupTable[k];
 
-		// right
-		if (x == width - 1 || !pixels[(x + 1) + y*width])
-			boundaryLength++;
+			} else {
 
-		// top
-		if (y == 0 || !pixels[x + (y - 1)*width])
-			boundaryLength++;
+				costImage[x + y*width] = computePixelCost(probMembrane);
+				numComputed++;
+			}
+		}
 
-		// bottom
-		if (y == height - 1 || !pixels[x + (y + 1)*width])
-			boundaryLength++;
-	}
+	LOG_ALL(segmentationcostfunctionlog)
+			<< "computed cost image for section " << section << ", "
+			<< numComputed << " of " << width*height
+			<< " pixels not covered by the lookup table" << std::endl;
+
+	return costImage;
+}
+
+double
+SegmentationCostFunction::computePixelCost(double probMembrane) {
+
+	if (optionInvertMembraneMaps)
+		probMembrane = 1.0 - probMembrane;
+
+	// get the neuron data probability p(x|y=neuron)
+	double probNeuron = 1.0 - probMembrane;
+
+	// multiply both with the respective prior p(y)
+	probMembrane *= (1.0 - _parameters->priorForeground);
+	probNeuron   *= _parameters->priorForeground;
+
+	// normalize both probabilities, so that we get p(y|x)
+	probMembrane /= probMembrane + probNeuron;
+	probNeuron   /= probMembrane + probNeuron;
+
+	// ensure numerical stability
+	probMembrane = std::max(0.0001, std::min(0.9999, probMembrane));
+	probNeuron   = std::max(0.0001, std::min(0.9999, probNeuron));
+
+	// compute the corresponding costs
+	double costsMembrane = -log(probMembrane);
+	double costsNeuron   = -log(probNeuron);
+
+	// costs for accepting the segmentation is the cost difference between
+	// segmenting the region as background and segmenting the region as
+	// foreground
+	return costsNeuron - costsMembrane;
+}
+
+void
+SegmentationCostFunction::clearCostCaches() {
+
+	_costImages.clear();
+	_cumulativeCosts.clear();
+}
+
+unsigned int
+SegmentationCostFunction::computeBoundaryLength(const Slice& slice) {
+
+	if (_sliceBoundaryLengths.count(slice.getId()))
+		return _sliceBoundaryLengths[slice.getId()];
+
+	unsigned int boundaryLength = BoundaryLength()(slice);
 
 	_sliceBoundaryLengths[slice.getId()] = boundaryLength;
 
@@ -2,6 +2,7 @@
 #define SOPNET_INFERENCE_SEGMENTATION_COST_FUNCTION_H__
 
 #include <util/point3.hpp>
+#include <imageprocessing/ConnectedComponent.h>
 #include <imageprocessing/ImageStack.h>
 #include "SegmentationCostFunctionParameters.h"
 
@@ -61,6 +62,31 @@ private:
 
 	unsigned int computeBoundaryLength(const Slice& slice);
 
+	/**
+	 * Get the per-pixel segmentation costs of a section, in row-major order.
+	 * Computed once per section.
+	 */
+	const std::vector<double>& getCostImage(unsigned int section);
+
+	/**
+	 * Get the cumulative segmentation costs along the pixel list of the given 
+	 * slice. Nested slices share one pixel list, in which each slice covers a 
+	 * contiguous range, such that the cost of a slice is the difference of 
+	 * two entries.
+	 */
+	const std::vector<double>& getCumulativeCosts(const Slice& slice, unsigned int section);
+
+	/**
+	 * The cost of accepting a pixel with the given membrane probability as 
+	 * foreground.
+	 */
+	double computePixelCost(double probMembrane);
+
+	/**
+	 * Clear the cost images and cumulative costs.
+	 */
+	void clearCostCaches();
+
 	pipeline::Input<ImageStack> _membranes;
 
 	pipeline::Input<SegmentationCostFunctionParameters> _parameters;
@@ -78,6 +104,16 @@ private:
 	std::map<unsigned int, double> _sliceSegmentationCosts;
 
 	std::map<unsigned int, unsigned int> _sliceBoundaryLengths;
+
+	// per-pixel costs for each section
+	std::map<unsigned int, std::vector<double> > _costImages;
+
+	typedef ConnectedComponent::pixel_list_type pixel_list_type;
+
+	// cumulative costs for each shared pixel list, the pixel list is kept to 
+	// ensure that its address is not reused
+	std::map<const pixel_list_type*,
+	         std::pair<boost::shared_ptr<pixel_list_type>, std::vector<double> > > _cumulativeCosts;
 };
 
 #endif // SOPNET_INFERENCE_SEGMENTATION_COST_FUNCTION_H__
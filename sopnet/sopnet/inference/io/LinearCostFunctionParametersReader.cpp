@@ -1,5 +1,6 @@
 #include <fstream>
 #include "LinearCostFunctionParametersReader.h"
+#include "ModelCache.h"
 
 LinearCostFunctionParametersReader::LinearCostFunctionParametersReader(std::string filename) :
 	_parameters(new LinearCostFunctionParameters()),
@@ -12,17 +13,15 @@ LinearCostFunctionParametersReader::LinearCostFunctionParametersReader(std::stri
 void
 LinearCostFunctionParametersReader::updateOutputs() {
 
-	boost::shared_ptr<std::ifstream> in;
+	if (!_fileContent.isSet()) {
 
-	if (_fileContent.isSet()) {
-
-		in = _fileContent.getSharedPointer();
-
-	} else {
-
-		in = boost::make_shared<std::ifstream>(_filename.c_str());
+		_parameters->setWeights(
+				ModelCache::getLinearCostFunctionParameters(_filename)->getWeights());
+		return;
 	}
 
+	boost::shared_ptr<std::ifstream> in = _fileContent.getSharedPointer();
+
 	// reset input stream to beginning of file
 	in->clear();
 	in->seekg(0);
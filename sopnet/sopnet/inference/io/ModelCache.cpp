@@ -0,0 +1,94 @@
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+#include <util/Logger.h>
+#include "ModelCache.h"
+
+logger::LogChannel modelcachelog("modelcachelog", "[ModelCache] ");
+
+std::map<std::string, ModelCache::Entry<LinearCostFunctionParameters> > ModelCache::_parameters;
+std::map<std::string, ModelCache::Entry<RandomForest> >                  ModelCache::_randomForests;
+boost::mutex                                                             ModelCache::_mutex;
+
+boost::shared_ptr<LinearCostFunctionParameters>
+ModelCache::getLinearCostFunctionParameters(const std::string& filename) {
+
+	return get(filename, _parameters, &ModelCache::readLinearCostFunctionParameters);
+}
+
+boost::shared_ptr<RandomForest>
+ModelCache::getRandomForest(const std::string& filename) {
+
+	return get(filename, _randomForests, &ModelCache::readRandomForest);
+}
+
+void
+ModelCache::clear() {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	_parameters.clear();
+	_randomForests.clear();
+}
+
+template <typename T>
+boost::shared_ptr<T>
+ModelCache::get(
+		const std::string& filename,
+		std::map<std::string, Entry<T> >& entries,
+		boost::shared_ptr<T> (*read)(const std::string&)) {
+
+	boost::system::error_code error;
+	std::time_t modificationTime = boost::filesystem::last_write_time(filename, error);
+
+	// don't cache what can't be identified, just read it as before
+	if (error) {
+
+		LOG_ERROR(modelcachelog) << "can not access " << filename << ": " << error.message() << std::endl;
+		return read(filename);
+	}
+
+	// Reading under the lock ensures that each file is read only once, even
+	// if several threads ask for it at the same time.
+	boost::mutex::scoped_lock lock(_mutex);
+
+	Entry<T>& entry = entries[filename];
+
+	if (!entry.model || entry.modificationTime != modificationTime) {
+
+		LOG_DEBUG(modelcachelog) << "reading " << filename << std::endl;
+
+		entry.model            = read(filename);
+		entry.modificationTime = modificationTime;
+	}
+
+	return entry.model;
+}
+
+boost::shared_ptr<LinearCostFunctionParameters>
+ModelCache::readLinearCostFunctionParameters(const std::string& filename) {
+
+	std::ifstream in(filename.c_str());
+
+	std::vector<double> weights;
+	double weight;
+	while (in >> weight)
+		weights.push_back(weight);
+
+	boost::shared_ptr<LinearCostFunctionParameters> parameters =
+			boost::make_shared<LinearCostFunctionParameters>();
+	parameters->setWeights(weights);
+
+	return parameters;
+}
+
+boost::shared_ptr<RandomForest>
+ModelCache::readRandomForest(const std::string& filename) {
+
+	boost::shared_ptr<RandomForest> randomForest = boost::make_shared<RandomForest>();
+	randomForest->read(filename);
+
+	return randomForest;
+}
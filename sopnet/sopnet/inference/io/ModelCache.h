@@ -0,0 +1,69 @@
+#ifndef SOPNET_INFERENCE_IO_MODEL_CACHE_H__
+#define SOPNET_INFERENCE_IO_MODEL_CACHE_H__
+
+#include <ctime>
+#include <map>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <inference/RandomForest.h>
+#include <sopnet/inference/LinearCostFunctionParameters.h>
+
+/**
+ * A process-wide cache of cost function parameters and random forests read
+ * from files. Entries are keyed by the path of the file and its modification
+ * time, such that a changed file is read again. All methods are thread-safe.
+ *
+ * The returned objects are shared between all users of the cache and must not
+ * be modified.
+ */
+class ModelCache {
+
+public:
+
+	/**
+	 * Get the linear cost function parameters stored in the given file.
+	 */
+	static boost::shared_ptr<LinearCostFunctionParameters> getLinearCostFunctionParameters(
+			const std::string& filename);
+
+	/**
+	 * Get the random forest stored in the given HDF5 file.
+	 */
+	static boost::shared_ptr<RandomForest> getRandomForest(const std::string& filename);
+
+	/**
+	 * Remove all entries from the cache.
+	 */
+	static void clear();
+
+private:
+
+	template <typename T>
+	struct Entry {
+
+		std::time_t          modificationTime;
+		boost::shared_ptr<T> model;
+	};
+
+	template <typename T>
+	static boost::shared_ptr<T> get(
+			const std::string& filename,
+			std::map<std::string, Entry<T> >& entries,
+			boost::shared_ptr<T> (*read)(const std::string&));
+
+	static boost::shared_ptr<LinearCostFunctionParameters> readLinearCostFunctionParameters(
+			const std::string& filename);
+
+	static boost::shared_ptr<RandomForest> readRandomForest(const std::string& filename);
+
+	static std::map<std::string, Entry<LinearCostFunctionParameters> > _parameters;
+
+	static std::map<std::string, Entry<RandomForest> > _randomForests;
+
+	static boost::mutex _mutex;
+};
+
+#endif // SOPNET_INFERENCE_IO_MODEL_CACHE_H__
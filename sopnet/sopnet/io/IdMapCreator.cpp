@@ -1,3 +1,7 @@
+#include <boost/bind.hpp>
+
+#include <sopnet/parallel/WorkerPool.h>
+#include "NeuronsRasterizer.h"
 #include "IdMapCreator.h"
 
 static logger::LogChannel idMapCreatorLog("idMapCreatorLog", "[IdMapCreator] ");
@@ -44,50 +48,25 @@ IdMapCreator::updateOutputs() {
 		_height = _reference->height();
 	}
 
-	// prepare output images
-
-	std::vector<boost::shared_ptr<Image> > idImages;
-	
-	for (unsigned int i = 0; i < _numSections; i++)
-		idImages.push_back(boost::make_shared<Image>(_width, _height, 0.0));
-
-	// draw each neuron to output images
-
-	unsigned int id = 1;
-
-	foreach (boost::shared_ptr<SegmentTree> neuron, *_neurons) {
-
-		foreach (boost::shared_ptr<EndSegment> end, neuron->getEnds()) {
-
-			drawSlice(*end->getSlice(), idImages, id);
-		}
-
-		foreach (boost::shared_ptr<ContinuationSegment> continuation, neuron->getContinuations()) {
-
-			if (continuation->getDirection() == Left)
+	// sort the slices into sections once
 
-				drawSlice(*continuation->getSourceSlice(), idImages, id);
+	NeuronsRasterizer rasterizer(_neurons.getSharedPointer(), _numSections);
 
-			else
+	// draw each section in parallel, every job writes to its own image only
 
-				drawSlice(*continuation->getTargetSlice(), idImages, id);
-		}
-
-		foreach (boost::shared_ptr<BranchSegment> branch, neuron->getBranches()) {
+	std::vector<boost::shared_ptr<Image> > idImages;
 
-			if (branch->getDirection() == Left)
+	for (unsigned int i = 0; i < _numSections; i++)
+		idImages.push_back(boost::make_shared<Image>(_width, _height, 0.0));
 
-				drawSlice(*branch->getSourceSlice(), idImages, id);
+	WorkerPool workers;
 
-			else {
+	for (unsigned int i = 0; i < _numSections; i++)
+		workers.schedule(boost::bind(&NeuronsRasterizer::draw, &rasterizer, i, boost::ref(*idImages[i])));
 
-				drawSlice(*branch->getTargetSlice1(), idImages, id);
-				drawSlice(*branch->getTargetSlice2(), idImages, id);
-			}
-		}
+	workers.wait();
 
-		id++;
-	}
+	LOG_DEBUG(idMapCreatorLog) << "drew " << _numSections << " sections with " << workers.size() << " threads" << std::endl;
 
 	// store output images in image stack
 
@@ -97,14 +76,3 @@ IdMapCreator::updateOutputs() {
 		_idMap->add(idImages[i]);
 
 }
-
-void
-IdMapCreator::drawSlice(const Slice& slice, std::vector<boost::shared_ptr<Image> >& images, unsigned int id) {
-
-	unsigned int section = slice.getSection();
-
-	foreach (const util::point<unsigned int>& pixel, slice.getComponent()->getPixels()){
-
-		(*images[section])(pixel.x, pixel.y) = static_cast<float>(id);
-	}
-}
@@ -8,7 +8,11 @@
 
 /**
  * Creates an image stack from a set of neurons, such that same intensity values 
- * correspond to pixels of the same neuron.
+ * correspond to pixels of the same neuron. The sections are drawn in 
+ * parallel.
+ *
+ * For volumes that do not fit into memory, use NeuronsImageWriter with the 
+ * neurons as input instead, which draws and writes a few sections at a time.
  */
 class IdMapCreator : public pipeline::SimpleProcessNode<> {
 
@@ -23,8 +27,6 @@ private:
 
 	void updateOutputs();
 
-	void drawSlice(const Slice& slice, std::vector<boost::shared_ptr<Image> >& images, unsigned int id);
-
 	pipeline::Input<SegmentTrees> _neurons;
 	pipeline::Input<ImageStack>   _reference;
 	pipeline::Output<ImageStack>  _idMap;
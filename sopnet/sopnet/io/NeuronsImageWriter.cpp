@@ -1,11 +1,37 @@
+#include <algorithm>
 #include <sstream>
 
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
 
 #include <vigra/impex.hxx>
-
+#include <vigra/hdf5impex.hxx>
+#include <vigra/multi_array.hxx>
+
+#include <sopnet/parallel/WorkerPool.h>
+#include <util/exceptions.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include "NeuronsRasterizer.h"
 #include "NeuronsImageWriter.h"
 
+static logger::LogChannel neuronsimagewriterlog("neuronsimagewriterlog", "[NeuronsImageWriter] ");
+
+util::ProgramOption optionNeuronsImageFormat(
+		util::_module           = "neuronsImageWriter",
+		util::_long_name        = "format",
+		util::_description_text = "The format of the written neuron images: 'tiff' for one image per section, or 'hdf5' for a single chunked and "
+		                          "compressed volume <directory>/<basename>.h5.",
+		util::_default_value    = "tiff");
+
+util::ProgramOption optionNeuronsImageChunkSize(
+		util::_module           = "neuronsImageWriter",
+		util::_long_name        = "chunkSize",
+		util::_description_text = "The number of sections to draw and write at a time, when writing neurons directly. The default (0) uses the number "
+		                          "of worker threads.",
+		util::_default_value    = 0);
+
 NeuronsImageWriter::NeuronsImageWriter(
 		std::string  directory,
 		std::string  basename,
@@ -14,25 +40,44 @@ NeuronsImageWriter::NeuronsImageWriter(
 		_basename(basename),
 		_firstSection(firstSection) {
 
-	registerInput(_idMap, "id map");
+	registerInput(_idMap, "id map", pipeline::Optional);
+	registerInput(_neurons, "neurons", pipeline::Optional);
+	registerInput(_reference, "reference", pipeline::Optional);
 	registerInput(_annotation, "annotation", pipeline::Optional);
 }
 
 void
 NeuronsImageWriter::write() {
 
-	// make sure we have a recent id map
+	// make sure we have a recent id map or recent neurons
 	updateInputs();
 
-	unsigned int numSections = _idMap->size();
+	bool fromNeurons = _neurons.isSet();
+
+	if (fromNeurons && !_reference.isSet())
+		BOOST_THROW_EXCEPTION(UsageError() << error_message("writing neurons requires a reference image stack") << STACK_TRACE);
+
+	if (!fromNeurons && !_idMap.isSet())
+		BOOST_THROW_EXCEPTION(UsageError() << error_message("neither an id map nor neurons are set") << STACK_TRACE);
+
+	unsigned int numSections = (fromNeurons ? _reference->size()   : _idMap->size());
+	unsigned int width       = (fromNeurons ? _reference->width()  : _idMap->width());
+	unsigned int height      = (fromNeurons ? _reference->height() : _idMap->height());
+
+	std::string format = optionNeuronsImageFormat.as<std::string>();
+
+	if (format != "tiff" && format != "hdf5")
+		BOOST_THROW_EXCEPTION(UsageError() << error_message(std::string("unknown neuron image format \"") + format + "\"") << STACK_TRACE);
+
+	std::string directoryName = _directory;
 
 	if (_annotation.isSet()) {
 
-		_directory += std::string("_") + boost::lexical_cast<std::string>(*_annotation);
+		directoryName += std::string("_") + boost::lexical_cast<std::string>(*_annotation);
 	}
 
 	// prepare the output directory
-	boost::filesystem::path directory(_directory);
+	boost::filesystem::path directory(directoryName);
 
 	if (!boost::filesystem::exists(directory)) {
 
@@ -40,16 +85,165 @@ NeuronsImageWriter::write() {
 
 	} else if (!boost::filesystem::is_directory(directory)) {
 
-		BOOST_THROW_EXCEPTION(IOError() << error_message(std::string("\"") + _directory + "\" is not a directory") << STACK_TRACE);
+		BOOST_THROW_EXCEPTION(IOError() << error_message(std::string("\"") + directoryName + "\" is not a directory") << STACK_TRACE);
 	}
 
-	// save output images
-	for (unsigned int i = 0; i < numSections; i++) {
+	_directory = directoryName;
+
+	// prepare the output volume
+	boost::shared_ptr<vigra::HDF5File> hdf5File;
+
+	if (format == "hdf5") {
 
-		std::stringstream filename;
+		std::string filename = _directory + "/" + _basename + ".h5";
 
-		filename << _directory << "/" << _basename << std::setw(4) << std::setfill('0') << (i + _firstSection) << ".tiff";
+		LOG_DEBUG(neuronsimagewriterlog) << "writing " << numSections << " sections to " << filename << std::endl;
 
-		vigra::exportImage(srcImageRange(*(*_idMap)[i]), vigra::ImageExportInfo(filename.str().c_str()));
+		hdf5File = boost::make_shared<vigra::HDF5File>(filename, vigra::HDF5File::New);
+
+		// one chunk per section tile, such that single sections can be read 
+		// efficiently
+		typedef vigra::MultiArrayShape<3>::type Shape;
+		Shape shape(width, height, numSections);
+		Shape chunkShape(std::min(width, 256u), std::min(height, 256u), 1);
+
+		hdf5File->createDataset<3, unsigned int>("neurons", shape, 0, chunkShape, 6);
+		hdf5File->writeAttribute("neurons", "firstSection", _firstSection);
 	}
+
+	unsigned int chunkSize = optionNeuronsImageChunkSize.as<unsigned int>();
+	if (chunkSize == 0)
+		chunkSize = WorkerPool::getDefaultNumThreads();
+	chunkSize = std::max(chunkSize, 1u);
+
+	if (fromNeurons) {
+
+		NeuronsRasterizer rasterizer(_neurons.getSharedPointer(), numSections);
+
+		// the images of one chunk, reused for all chunks
+		std::vector<boost::shared_ptr<Image> > buffers;
+		for (unsigned int i = 0; i < std::min(chunkSize, numSections); i++)
+			buffers.push_back(boost::make_shared<Image>(width, height));
+
+		for (unsigned int begin = 0; begin < numSections; begin += chunkSize)
+			writeNeuronsChunk(rasterizer, begin, std::min(begin + chunkSize, numSections), buffers, hdf5File.get());
+
+	} else {
+
+		for (unsigned int begin = 0; begin < numSections; begin += chunkSize)
+			writeIdMapChunk(begin, std::min(begin + chunkSize, numSections), hdf5File.get());
+	}
+}
+
+void
+NeuronsImageWriter::writeNeuronsChunk(
+		const NeuronsRasterizer& rasterizer,
+		unsigned int begin,
+		unsigned int end,
+		std::vector<boost::shared_ptr<Image> >& buffers,
+		vigra::HDF5File* hdf5File) {
+
+	LOG_DEBUG(neuronsimagewriterlog) << "drawing sections " << begin << " to " << (end - 1) << std::endl;
+
+	// tiff images are written by the drawing jobs, HDF5 is not thread-safe 
+	// and written afterwards
+	WorkerPool workers;
+
+	for (unsigned int section = begin; section < end; section++)
+		workers.schedule(
+				boost::bind(
+						&NeuronsImageWriter::drawSection,
+						this,
+						boost::cref(rasterizer),
+						section,
+						boost::ref(*buffers[section - begin]),
+						hdf5File == 0));
+
+	workers.wait();
+
+	if (hdf5File) {
+
+		std::vector<const Image*> images;
+		for (unsigned int section = begin; section < end; section++)
+			images.push_back(buffers[section - begin].get());
+
+		writeHdf5(*hdf5File, begin, images);
+	}
+}
+
+void
+NeuronsImageWriter::writeIdMapChunk(
+		unsigned int begin,
+		unsigned int end,
+		vigra::HDF5File* hdf5File) {
+
+	if (hdf5File) {
+
+		std::vector<const Image*> images;
+		for (unsigned int section = begin; section < end; section++)
+			images.push_back((*_idMap)[section].get());
+
+		writeHdf5(*hdf5File, begin, images);
+
+		return;
+	}
+
+	WorkerPool workers;
+
+	for (unsigned int section = begin; section < end; section++)
+		workers.schedule(
+				boost::bind(
+						&NeuronsImageWriter::writeTiff,
+						this,
+						section,
+						boost::cref(*(*_idMap)[section])));
+
+	workers.wait();
+}
+
+void
+NeuronsImageWriter::drawSection(
+		const NeuronsRasterizer& rasterizer,
+		unsigned int section,
+		Image& image,
+		bool writeTiff) {
+
+	image.init(0.0);
+
+	rasterizer.draw(section, image);
+
+	if (writeTiff)
+		this->writeTiff(section, image);
+}
+
+void
+NeuronsImageWriter::writeTiff(unsigned int section, const Image& image) {
+
+	std::stringstream filename;
+
+	filename << _directory << "/" << _basename << std::setw(4) << std::setfill('0') << (section + _firstSection) << ".tiff";
+
+	vigra::exportImage(srcImageRange(image), vigra::ImageExportInfo(filename.str().c_str()));
+}
+
+void
+NeuronsImageWriter::writeHdf5(
+		vigra::HDF5File& file,
+		unsigned int begin,
+		const std::vector<const Image*>& images) {
+
+	if (images.empty())
+		return;
+
+	unsigned int width  = images[0]->width();
+	unsigned int height = images[0]->height();
+
+	vigra::MultiArray<3, unsigned int> block(vigra::MultiArrayShape<3>::type(width, height, images.size()));
+
+	for (unsigned int z = 0; z < images.size(); z++)
+		for (unsigned int y = 0; y < height; y++)
+			for (unsigned int x = 0; x < width; x++)
+				block(x, y, z) = static_cast<unsigned int>((*images[z])(x, y));
+
+	file.writeBlock("neurons", vigra::MultiArrayShape<3>::type(0, 0, begin), block);
 }
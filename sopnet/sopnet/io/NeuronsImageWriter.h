@@ -2,14 +2,28 @@
 #define SOPNET_IO_NEURONS_IMAGE_WRITER_H__
 
 #include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
 
 #include <pipeline/all.h>
 #include <imageprocessing/ImageStack.h>
 #include <sopnet/segments/SegmentTrees.h>
 
+// forward declarations
+namespace vigra { class HDF5File; }
+class NeuronsRasterizer;
+
 /**
- * Writes a set of neurons to a sequence of png images. The intensity of the 
+ * Writes a set of neurons to a sequence of tiff images or a chunked HDF5 
+ * volume (see program option neuronsImageWriter.format). The intensity of the 
  * images corresponds to the id of the neurons.
+ *
+ * The neurons are either given as an "id map" (see IdMapCreator), or directly 
+ * as "neurons" together with a "reference" image stack that determines the 
+ * size of the output. In the latter case, the id map is never held in memory 
+ * as a whole: the sections are drawn in parallel and written in chunks of a 
+ * few sections at a time.
  */
 class NeuronsImageWriter : public pipeline::SimpleProcessNode<> {
 
@@ -30,8 +44,39 @@ private:
 
 	void updateOutputs() {}
 
-	pipeline::Input<ImageStack> _idMap;
-	pipeline::Input<double>     _annotation;
+	// draw and write the sections in [begin, end) from the neurons
+	void writeNeuronsChunk(
+			const NeuronsRasterizer& rasterizer,
+			unsigned int begin,
+			unsigned int end,
+			std::vector<boost::shared_ptr<Image> >& buffers,
+			vigra::HDF5File* hdf5File);
+
+	// write the sections in [begin, end) from the id map
+	void writeIdMapChunk(
+			unsigned int begin,
+			unsigned int end,
+			vigra::HDF5File* hdf5File);
+
+	// draw a section into a cleared buffer and write it as a tiff image, if 
+	// requested
+	void drawSection(
+			const NeuronsRasterizer& rasterizer,
+			unsigned int section,
+			Image& image,
+			bool writeTiff);
+
+	void writeTiff(unsigned int section, const Image& image);
+
+	void writeHdf5(
+			vigra::HDF5File& file,
+			unsigned int begin,
+			const std::vector<const Image*>& images);
+
+	pipeline::Input<ImageStack>   _idMap;
+	pipeline::Input<SegmentTrees> _neurons;
+	pipeline::Input<ImageStack>   _reference;
+	pipeline::Input<double>       _annotation;
 
 	std::string  _directory;
 	std::string  _basename;
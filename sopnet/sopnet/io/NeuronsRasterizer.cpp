@@ -0,0 +1,78 @@
+#include <util/foreach.h>
+#include <util/Logger.h>
+#include "NeuronsRasterizer.h"
+
+static logger::LogChannel neuronsrasterizerlog("neuronsrasterizerlog", "[NeuronsRasterizer] ");
+
+NeuronsRasterizer::NeuronsRasterizer(boost::shared_ptr<SegmentTrees> neurons, unsigned int numSections) :
+	_neurons(neurons),
+	_sectionSlices(numSections) {
+
+	unsigned int id = 1;
+
+	foreach (boost::shared_ptr<SegmentTree> neuron, *_neurons) {
+
+		foreach (boost::shared_ptr<EndSegment> end, neuron->getEnds()) {
+
+			addSlice(*end->getSlice(), id);
+		}
+
+		foreach (boost::shared_ptr<ContinuationSegment> continuation, neuron->getContinuations()) {
+
+			if (continuation->getDirection() == Left)
+
+				addSlice(*continuation->getSourceSlice(), id);
+
+			else
+
+				addSlice(*continuation->getTargetSlice(), id);
+		}
+
+		foreach (boost::shared_ptr<BranchSegment> branch, neuron->getBranches()) {
+
+			if (branch->getDirection() == Left)
+
+				addSlice(*branch->getSourceSlice(), id);
+
+			else {
+
+				addSlice(*branch->getTargetSlice1(), id);
+				addSlice(*branch->getTargetSlice2(), id);
+			}
+		}
+
+		id++;
+	}
+
+	LOG_DEBUG(neuronsrasterizerlog) << "sorted slices of " << (id - 1) << " neurons into " << numSections << " sections" << std::endl;
+}
+
+void
+NeuronsRasterizer::addSlice(const Slice& slice, unsigned int id) {
+
+	unsigned int section = slice.getSection();
+
+	if (section >= _sectionSlices.size()) {
+
+		LOG_ERROR(neuronsrasterizerlog) << "slice " << slice.getId() << " is in section " << section << ", but there are only " << _sectionSlices.size() << " sections -- skipping it" << std::endl;
+		return;
+	}
+
+	_sectionSlices[section].push_back(std::make_pair(&slice, id));
+}
+
+void
+NeuronsRasterizer::draw(unsigned int section, Image& image) const {
+
+	typedef std::pair<const Slice*, unsigned int> slice_id_type;
+
+	// slices are drawn in the same order as they were added, such that 
+	// overlapping slices are resolved as before
+	foreach (const slice_id_type& sliceId, _sectionSlices[section]) {
+
+		float value = static_cast<float>(sliceId.second);
+
+		foreach (const util::point<unsigned int>& pixel, sliceId.first->getComponent()->getPixels())
+			image(pixel.x, pixel.y) = value;
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef SOPNET_IO_NEURONS_RASTERIZER_H__
+#define SOPNET_IO_NEURONS_RASTERIZER_H__
+
+#include <utility>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <imageprocessing/Image.h>
+#include <sopnet/segments/SegmentTrees.h>
+
+/**
+ * Draws the slices of a set of neurons section by section. The slices are 
+ * sorted into one bucket per section once, such that each section can be 
+ * drawn without visiting all neurons. Drawing different sections is 
+ * independent and can be done concurrently.
+ *
+ * The intensity of a pixel is the id of the neuron it belongs to, starting 
+ * with 1 for the first neuron. Pixels not covered by any neuron are 0.
+ */
+class NeuronsRasterizer {
+
+public:
+
+	/**
+	 * Create a rasterizer for the given neurons and number of sections. The 
+	 * neurons are kept alive by the rasterizer.
+	 */
+	NeuronsRasterizer(boost::shared_ptr<SegmentTrees> neurons, unsigned int numSections);
+
+	/**
+	 * Draw all slices of the given section into an image. The image is 
+	 * expected to be cleared to 0.
+	 */
+	void draw(unsigned int section, Image& image) const;
+
+	/**
+	 * Get the number of sections of this rasterizer.
+	 */
+	unsigned int getNumSections() const { return _sectionSlices.size(); }
+
+private:
+
+	void addSlice(const Slice& slice, unsigned int id);
+
+	boost::shared_ptr<SegmentTrees> _neurons;
+
+	// the slices of each section with the id of their neuron
+	std::vector<std::vector<std::pair<const Slice*, unsigned int> > > _sectionSlices;
+};
+
+#endif // SOPNET_IO_NEURONS_RASTERIZER_H__
+
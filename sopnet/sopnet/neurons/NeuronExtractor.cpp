@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "NeuronExtractor.h"
 #include <util/Logger.h>
 
@@ -15,29 +17,34 @@ NeuronExtractor::updateOutputs() {
 	if (!_neurons)
 		_neurons = new SegmentTrees();
 
-	_slices.clear();
-	_neuronIds.clear();
+	_sliceIndices.clear();
+	_parents.clear();
+	_ranks.clear();
 	_neurons->clear();
 
-	LOG_ALL(neuronextractorlog) << "processing " << _segments->getEnds().size() << " ends" << std::endl;
+	const std::vector<boost::shared_ptr<EndSegment> >&          ends          = _segments->getEnds();
+	const std::vector<boost::shared_ptr<ContinuationSegment> >& continuations = _segments->getContinuations();
+	const std::vector<boost::shared_ptr<BranchSegment> >&       branches      = _segments->getBranches();
+
+	LOG_ALL(neuronextractorlog) << "processing " << ends.size() << " ends" << std::endl;
 
 	// collect all end slices
-	foreach (boost::shared_ptr<EndSegment> end, _segments->getEnds())
+	foreach (boost::shared_ptr<EndSegment> end, ends)
 		addSlice(end->getSlice()->getId());
 
-	LOG_ALL(neuronextractorlog) << "processing " << _segments->getContinuations().size() << " continuations" << std::endl;
+	LOG_ALL(neuronextractorlog) << "processing " << continuations.size() << " continuations" << std::endl;
 
 	// identify slices belonging to the same neuron
-	foreach (boost::shared_ptr<ContinuationSegment> continuation, _segments->getContinuations()) {
+	foreach (boost::shared_ptr<ContinuationSegment> continuation, continuations) {
 
 		mergeSlices(
 				continuation->getSourceSlice()->getId(),
 				continuation->getTargetSlice()->getId());
 	}
 
-	LOG_ALL(neuronextractorlog) << "processing " << _segments->getBranches().size() << " branches" << std::endl;
+	LOG_ALL(neuronextractorlog) << "processing " << branches.size() << " branches" << std::endl;
 
-	foreach (boost::shared_ptr<BranchSegment> branch, _segments->getBranches()) {
+	foreach (boost::shared_ptr<BranchSegment> branch, branches) {
 
 		mergeSlices(
 				branch->getSourceSlice()->getId(),
@@ -48,100 +55,141 @@ NeuronExtractor::updateOutputs() {
 				branch->getTargetSlice2()->getId());
 	}
 
-	LOG_ALL(neuronextractorlog) << "found " << _slices.size() << " slices" << std::endl;
-
-	// assign a neuron id to each slice
+	const unsigned int numSlices = _parents.size();
 
-	unsigned int sliceId;
-	std::set<unsigned int> sameNeuronSlices;
+	LOG_ALL(neuronextractorlog) << "found " << numSlices << " slices" << std::endl;
 
-	unsigned int neuronId = 0;
+	// assign a neuron id to each set, in the order of the smallest slice id
 
-	foreach (boost::tie(sliceId, sameNeuronSlices), _slices) {
+	std::vector<std::pair<unsigned int, unsigned int> > sortedSlices;
+	sortedSlices.reserve(numSlices);
 
-		bool alreadyAssigned = false;
+	unsigned int sliceId, index;
+	foreach (boost::tie(sliceId, index), _sliceIndices)
+		sortedSlices.push_back(std::make_pair(sliceId, index));
 
-		foreach (unsigned int id, sameNeuronSlices) {
+	std::sort(sortedSlices.begin(), sortedSlices.end());
 
-			if (!_neuronIds.count(id)) {
+	const unsigned int unassigned = numSlices;
+	std::vector<unsigned int> rootNeuronIds(numSlices, unassigned);
 
-				_neuronIds[id] = neuronId;
+	unsigned int numNeurons = 0;
 
-			} else {
+	for (unsigned int i = 0; i < numSlices; i++) {
 
-				alreadyAssigned = true;
-				break;
-			}
-		}
+		unsigned int root = findRoot(sortedSlices[i].second);
 
-		if (!alreadyAssigned)
-			neuronId++;
+		if (rootNeuronIds[root] == unassigned)
+			rootNeuronIds[root] = numNeurons++;
 	}
 
-	// sort segments according to the neuron their slices belong to
+	// sort segments according to the neuron their slices belong to, with a 
+	// counting sort over all ends, continuations, and branches (in this order)
 
-	// prepare neurons
-	std::vector<boost::shared_ptr<SegmentTree> > neurons(neuronId);
-	for (unsigned int i = 0; i < neuronId; i++)
-		neurons[i] = boost::make_shared<SegmentTree>();
+	const unsigned int numEnds          = ends.size();
+	const unsigned int numContinuations = continuations.size();
+	const unsigned int numSegments      = numEnds + numContinuations + branches.size();
 
-	// collect all end segments
-	foreach (boost::shared_ptr<EndSegment> end, _segments->getEnds()) {
+	std::vector<unsigned int> segmentNeuronIds;
+	segmentNeuronIds.reserve(numSegments);
 
-		unsigned int id = _neuronIds[end->getSlice()->getId()];
+	foreach (boost::shared_ptr<EndSegment> end, ends)
+		segmentNeuronIds.push_back(
+				rootNeuronIds[findRoot(_sliceIndices[end->getSlice()->getId()])]);
 
-		neurons[id]->add(end);
-	}
+	foreach (boost::shared_ptr<ContinuationSegment> continuation, continuations)
+		segmentNeuronIds.push_back(
+				rootNeuronIds[findRoot(_sliceIndices[continuation->getSourceSlice()->getId()])]);
 
-	// collect all continuation segments
-	foreach (boost::shared_ptr<ContinuationSegment> continuation, _segments->getContinuations()) {
+	foreach (boost::shared_ptr<BranchSegment> branch, branches)
+		segmentNeuronIds.push_back(
+				rootNeuronIds[findRoot(_sliceIndices[branch->getSourceSlice()->getId()])]);
 
-		unsigned int id = _neuronIds[continuation->getSourceSlice()->getId()];
+	// the first position of each neuron in the sorted order
+	std::vector<unsigned int> offsets(numNeurons + 1, 0);
+	foreach (unsigned int id, segmentNeuronIds)
+		offsets[id + 1]++;
+	for (unsigned int i = 0; i < numNeurons; i++)
+		offsets[i + 1] += offsets[i];
 
-		neurons[id]->add(continuation);
-	}
+	std::vector<unsigned int> sortedSegments(numSegments);
+	for (unsigned int i = 0; i < numSegments; i++)
+		sortedSegments[offsets[segmentNeuronIds[i]]++] = i;
 
-	// collect all branch segments
-	foreach (boost::shared_ptr<BranchSegment> branch, _segments->getBranches()) {
+	// fill the neurons bucket by bucket
 
-		unsigned int id = _neuronIds[branch->getSourceSlice()->getId()];
+	unsigned int i = 0;
+	for (unsigned int id = 0; id < numNeurons; id++) {
 
-		neurons[id]->add(branch);
-	}
+		boost::shared_ptr<SegmentTree> neuron = boost::make_shared<SegmentTree>();
+
+		// offsets[id] now points to the end of the bucket of neuron id
+		for (; i < offsets[id]; i++) {
 
-	// finally, put found neurons in output data structure
+			unsigned int segment = sortedSegments[i];
+
+			if (segment < numEnds)
+				neuron->add(ends[segment]);
+			else if (segment < numEnds + numContinuations)
+				neuron->add(continuations[segment - numEnds]);
+			else
+				neuron->add(branches[segment - numEnds - numContinuations]);
+		}
 
-	foreach (boost::shared_ptr<SegmentTree> neuron, neurons)
 		_neurons->add(neuron);
+	}
 
 	LOG_ALL(neuronextractorlog) << "found " << _neurons->size() << " neurons" << std::endl;
 }
 
-void
+unsigned int
 NeuronExtractor::addSlice(unsigned int slice) {
 
-	_slices[slice].insert(slice);
+	std::pair<boost::unordered_map<unsigned int, unsigned int>::iterator, bool> inserted =
+			_sliceIndices.insert(std::make_pair(slice, (unsigned int)_parents.size()));
+
+	if (inserted.second) {
+
+		_parents.push_back(inserted.first->second);
+		_ranks.push_back(0);
+	}
+
+	return inserted.first->second;
 }
 
 void
 NeuronExtractor::mergeSlices(unsigned int slice1, unsigned int slice2) {
 
-	// make sure we have partner sets for the given slices
-	addSlice(slice1);
-	addSlice(slice2);
+	unsigned int root1 = findRoot(addSlice(slice1));
+	unsigned int root2 = findRoot(addSlice(slice2));
 
-	// get all partners of slice2 and add them to the partners of slice1
-	foreach (unsigned int id, _slices[slice2])
-		_slices[slice1].insert(id);
+	if (root1 == root2)
+		return;
 
-	// slice1 is now the only one who knows all its partners
+	// union by rank
+	if (_ranks[root1] < _ranks[root2])
+		std::swap(root1, root2);
 
-	// the partners of slice1 might not know about slice2 or any of its partners
+	_parents[root2] = root1;
 
-	// for each partner of slice1, add all partners of slice1 to the partner list
-	foreach (unsigned int id, _slices[slice1]) {
+	if (_ranks[root1] == _ranks[root2])
+		_ranks[root1]++;
+}
+
+unsigned int
+NeuronExtractor::findRoot(unsigned int index) {
+
+	unsigned int root = index;
+	while (_parents[root] != root)
+		root = _parents[root];
 
-		foreach (unsigned int partner, _slices[slice1])
-			_slices[id].insert(partner);
+	// path compression
+	while (_parents[index] != root) {
+
+		unsigned int next = _parents[index];
+		_parents[index] = root;
+		index = next;
 	}
+
+	return root;
 }
@@ -1,6 +1,10 @@
 #ifndef SOPNET_NEURONS_NEURON_EXTRACTOR_H__
 #define SOPNET_NEURONS_NEURON_EXTRACTOR_H__
 
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
 #include <pipeline/all.h>
 #include <sopnet/segments/Segments.h>
 #include <sopnet/segments/SegmentTrees.h>
@@ -8,6 +12,10 @@
 /**
  * Given a set of segments, extracts all connected components of slices as 
  * neurons.
+ *
+ * Slices are merged in a disjoint-set forest (union by rank with path 
+ * compression) over dense slice indices. Neurons are numbered in the order of 
+ * their smallest slice id.
  */
 class NeuronExtractor : public pipeline::SimpleProcessNode<> {
 
@@ -19,20 +27,24 @@ private:
 
 	void updateOutputs();
 
-	// add a slice to the same-neuron lookup table
-	void addSlice(unsigned int slice);
+	// get the dense index of a slice, add it as a singleton set if necessary
+	unsigned int addSlice(unsigned int slice);
 
-	// merge the slices of the neurons belonging to slice1 and slice2
+	// merge the sets of the slices slice1 and slice2
 	void mergeSlices(unsigned int slice1, unsigned int slice2);
 
+	// find the representative of the set of a slice index
+	unsigned int findRoot(unsigned int index);
+
 	pipeline::Input<Segments> _segments;
 	pipeline::Output<SegmentTrees> _neurons;
 
-	// a lookup table for slices of the same neuron
-	std::map<unsigned int, std::set<unsigned int> > _slices;
+	// dense indices of slice ids
+	boost::unordered_map<unsigned int, unsigned int> _sliceIndices;
 
-	// a lookup table for neuron ids from slice ids
-	std::map<unsigned int, unsigned int> _neuronIds;
+	// the disjoint-set forest over slice indices
+	std::vector<unsigned int> _parents;
+	std::vector<unsigned int> _ranks;
 };
 
 #endif // SOPNET_NEURONS_NEURON_EXTRACTOR_H__
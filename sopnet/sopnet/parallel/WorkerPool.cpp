@@ -0,0 +1,131 @@
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include "WorkerPool.h"
+
+static logger::LogChannel workerpoollog("workerpoollog", "[WorkerPool] ");
+
+util::ProgramOption optionNumWorkerThreads(
+		util::_module           = "sopnet.parallel",
+		util::_long_name        = "numWorkerThreads",
+		util::_description_text = "The number of worker threads to use for parallel processing. The default (0) uses all available CPUs.",
+		util::_default_value    = 0);
+
+WorkerPool::WorkerPool(unsigned int numThreads) :
+	_numThreads(numThreads == 0 ? getDefaultNumThreads() : numThreads),
+	_numBusy(0),
+	_stopped(false) {
+
+	LOG_DEBUG(workerpoollog) << "starting " << _numThreads << " worker threads" << std::endl;
+
+	for (unsigned int i = 0; i < _numThreads; i++)
+		_threads.create_thread(boost::bind(&WorkerPool::work, this));
+}
+
+WorkerPool::~WorkerPool() {
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		while (!_jobs.empty() || _numBusy > 0)
+			_allDone.wait(lock);
+
+		_stopped = true;
+	}
+
+	_jobAvailable.notify_all();
+
+	_threads.join_all();
+}
+
+unsigned int
+WorkerPool::getDefaultNumThreads() {
+
+	unsigned int numThreads = optionNumWorkerThreads.as<unsigned int>();
+
+	if (numThreads == 0)
+		numThreads = boost::thread::hardware_concurrency();
+
+	return std::max(numThreads, 1u);
+}
+
+void
+WorkerPool::schedule(const job_type& job) {
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		_jobs.push_back(job);
+	}
+
+	_jobAvailable.notify_one();
+}
+
+void
+WorkerPool::wait() {
+
+	boost::exception_ptr exception;
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		while (!_jobs.empty() || _numBusy > 0)
+			_allDone.wait(lock);
+
+		exception = _exception;
+		_exception = boost::exception_ptr();
+	}
+
+	if (exception)
+		boost::rethrow_exception(exception);
+}
+
+void
+WorkerPool::work() {
+
+	while (true) {
+
+		job_type job;
+
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+
+			while (_jobs.empty() && !_stopped)
+				_jobAvailable.wait(lock);
+
+			if (_jobs.empty())
+				return;
+
+			job = _jobs.front();
+			_jobs.pop_front();
+
+			_numBusy++;
+		}
+
+		try {
+
+			job();
+
+		} catch (...) {
+
+			LOG_ERROR(workerpoollog) << "a job threw an exception" << std::endl;
+
+			boost::mutex::scoped_lock lock(_mutex);
+
+			if (!_exception)
+				_exception = boost::current_exception();
+		}
+
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+
+			_numBusy--;
+
+			if (_jobs.empty() && _numBusy == 0)
+				_allDone.notify_all();
+		}
+	}
+}
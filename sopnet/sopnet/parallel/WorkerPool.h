@@ -0,0 +1,91 @@
+#ifndef SOPNET_PARALLEL_WORKER_POOL_H__
+#define SOPNET_PARALLEL_WORKER_POOL_H__
+
+#include <deque>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+/**
+ * A fixed set of worker threads that process jobs from a queue.
+ *
+ * Jobs are scheduled with schedule() and processed in the order they were 
+ * added. wait() blocks until all scheduled jobs are done. If a job throws an 
+ * exception, the remaining jobs are still processed and the first exception 
+ * is rethrown by wait().
+ *
+ * Jobs must not share unsynchronized data. In particular, pipeline process 
+ * nodes and stores are not thread-safe and should be used by at most one job 
+ * at a time.
+ */
+class WorkerPool {
+
+public:
+
+	typedef boost::function<void()> job_type;
+
+	/**
+	 * Create a new worker pool.
+	 *
+	 * @param numThreads
+	 *              The number of worker threads. If 0, the value of the 
+	 *              program option numWorkerThreads is used, which in turn 
+	 *              defaults to the number of available CPUs.
+	 */
+	WorkerPool(unsigned int numThreads = 0);
+
+	/**
+	 * Waits for all scheduled jobs and stops the worker threads. Exceptions 
+	 * of jobs that were not collected by wait() are dropped.
+	 */
+	~WorkerPool();
+
+	/**
+	 * Add a job to the queue.
+	 */
+	void schedule(const job_type& job);
+
+	/**
+	 * Wait until all scheduled jobs are done. Rethrows the first exception 
+	 * thrown by any of the jobs since the last call to wait().
+	 */
+	void wait();
+
+	/**
+	 * Get the number of worker threads of this pool.
+	 */
+	unsigned int size() const { return _numThreads; }
+
+	/**
+	 * Get the default number of worker threads, as set by the program option 
+	 * numWorkerThreads or the number of available CPUs.
+	 */
+	static unsigned int getDefaultNumThreads();
+
+private:
+
+	// the main loop of each worker thread
+	void work();
+
+	unsigned int _numThreads;
+
+	boost::thread_group _threads;
+
+	std::deque<job_type> _jobs;
+
+	// number of jobs that are currently being processed
+	unsigned int _numBusy;
+
+	bool _stopped;
+
+	// the first exception thrown by a job
+	boost::exception_ptr _exception;
+
+	boost::mutex              _mutex;
+	boost::condition_variable _jobAvailable;
+	boost::condition_variable _allDone;
+};
+
+#endif // SOPNET_PARALLEL_WORKER_POOL_H__
+
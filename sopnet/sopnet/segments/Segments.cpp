@@ -4,14 +4,64 @@ std::vector<boost::shared_ptr<EndSegment> >          Segments::EmptyEnds;
 std::vector<boost::shared_ptr<ContinuationSegment> > Segments::EmptyContinuations;
 std::vector<boost::shared_ptr<BranchSegment> >       Segments::EmptyBranches;
 
+Segments::Segments() :
+	_size(0),
+	_viewsDirty(true) {}
+
+Segments::Segments(const Segments& other) :
+	pipeline::Data(),
+	_size(0),
+	_viewsDirty(true) {
+
+	*this = other;
+}
+
 Segments::~Segments() {
 
 	clear();
 }
 
+Segments&
+Segments::operator=(const Segments& other) {
+
+	if (this == &other)
+		return *this;
+
+	clear();
+
+	resize(other._ends.size());
+
+	_ends          = other._ends;
+	_continuations = other._continuations;
+	_branches      = other._branches;
+
+	_size = other._size;
+
+	return *this;
+}
+
 void
 Segments::clear() {
 
+	clearTrees();
+
+	// clear all segments
+
+	_ends.clear();
+	_continuations.clear();
+	_branches.clear();
+
+	_endTreeDirty.clear();
+	_continuationTreeDirty.clear();
+	_branchTreeDirty.clear();
+
+	_size = 0;
+	_viewsDirty = true;
+}
+
+void
+Segments::clearTrees() {
+
 	// delete all trees
 
 	foreach (EndSegmentKdTree* endTree, _endTrees)
@@ -45,12 +95,6 @@ Segments::clear() {
 		if (branchVectorAdaptor)
 			delete branchVectorAdaptor;
 	_branchAdaptors.clear();
-
-	// clear all segments
-
-	_ends.clear();
-	_continuations.clear();
-	_branches.clear();
 }
 
 void
@@ -118,6 +162,9 @@ Segments::add(boost::shared_ptr<EndSegment> end) {
 	_endTreeDirty[interSectionInterval] = true;
 
 	_ends[interSectionInterval].push_back(end);
+
+	_size++;
+	_viewsDirty = true;
 }
 
 void
@@ -135,6 +182,9 @@ Segments::add(boost::shared_ptr<ContinuationSegment> continuation) {
 	_continuationTreeDirty[interSectionInterval] = true;
 
 	_continuations[interSectionInterval].push_back(continuation);
+
+	_size++;
+	_viewsDirty = true;
 }
 
 void
@@ -152,6 +202,9 @@ Segments::add(boost::shared_ptr<BranchSegment> branch) {
 	_branchTreeDirty[interSectionInterval] = true;
 
 	_branches[interSectionInterval].push_back(branch);
+
+	_size++;
+	_viewsDirty = true;
 }
 
 void
@@ -189,38 +242,57 @@ Segments::getBranches(unsigned int interval) {
 	return _branches[interval];
 }
 
-std::vector<boost::shared_ptr<EndSegment> >
+const std::vector<boost::shared_ptr<EndSegment> >&
 Segments::getEnds() const {
 
-	return get(_ends);
+	updateViews();
+
+	return _allEnds;
 }
 
-std::vector<boost::shared_ptr<ContinuationSegment> >
+const std::vector<boost::shared_ptr<ContinuationSegment> >&
 Segments::getContinuations() const {
 
-	return get(_continuations);
+	updateViews();
+
+	return _allContinuations;
 }
 
-std::vector<boost::shared_ptr<BranchSegment> >
+const std::vector<boost::shared_ptr<BranchSegment> >&
 Segments::getBranches() const {
 
-	return get(_branches);
+	updateViews();
+
+	return _allBranches;
 }
 
-std::vector<boost::shared_ptr<Segment> >
+const std::vector<boost::shared_ptr<Segment> >&
 Segments::getSegments() const {
 
-	std::vector<boost::shared_ptr<Segment> > allSegments;
+	updateViews();
 
-	std::vector<boost::shared_ptr<EndSegment> >          ends          = get(_ends);
-	std::vector<boost::shared_ptr<ContinuationSegment> > continuations = get(_continuations);
-	std::vector<boost::shared_ptr<BranchSegment> >       branches      = get(_branches);
+	return _allSegments;
+}
 
-	std::copy(ends.begin(), ends.end(), std::back_inserter(allSegments));
-	std::copy(continuations.begin(), continuations.end(), std::back_inserter(allSegments));
-	std::copy(branches.begin(), branches.end(), std::back_inserter(allSegments));
+void
+Segments::updateViews() const {
 
-	return allSegments;
+	boost::mutex::scoped_lock lock(_viewsMutex);
+
+	if (!_viewsDirty)
+		return;
+
+	get(_ends, _allEnds);
+	get(_continuations, _allContinuations);
+	get(_branches, _allBranches);
+
+	_allSegments.clear();
+	_allSegments.reserve(_size);
+	_allSegments.insert(_allSegments.end(), _allEnds.begin(), _allEnds.end());
+	_allSegments.insert(_allSegments.end(), _allContinuations.begin(), _allContinuations.end());
+	_allSegments.insert(_allSegments.end(), _allBranches.begin(), _allBranches.end());
+
+	_viewsDirty = false;
 }
 
 std::vector<boost::shared_ptr<Segment> >
@@ -296,21 +368,6 @@ Segments::getNumInterSectionIntervals() {
 	return std::max(_ends.size(), std::max(_continuations.size(), _branches.size()));
 }
 
-unsigned int
-Segments::size() const {
-
-	unsigned int size = 0;
-
-	foreach (std::vector<boost::shared_ptr<EndSegment> > ends, _ends)
-		size += ends.size();
-	foreach (std::vector<boost::shared_ptr<ContinuationSegment> > continuations, _continuations)
-		size += continuations.size();
-	foreach (std::vector<boost::shared_ptr<BranchSegment> > branches, _branches)
-		size += branches.size();
-
-	return size;
-}
-
 bool
 Segments::operator==(const Segments& other) const
 {
@@ -1,6 +1,8 @@
 #ifndef CELLTRACKER_TRACKLETS_H__
 #define CELLTRACKER_TRACKLETS_H__
 
+#include <boost/thread/mutex.hpp>
+
 #include <external/nanoflann/nanoflann.hpp>
 
 #include <pipeline/all.h>
@@ -69,6 +71,17 @@ private:
 	const segments_type& _segments;
 };
 
+/**
+ * A set of end, continuation, and branch segments, sorted by inter-section
+ * interval.
+ *
+ * Threading: methods that only read the set (the getters, contains(),
+ * size()) can be called concurrently from several threads, as long as no
+ * thread modifies the set at the same time. The whole-collection views are
+ * built lazily under a lock. Methods that modify the set (add, remove,
+ * clear, assignment) and the find methods, which build kd-trees on demand,
+ * require exclusive access.
+ */
 class Segments : public pipeline::Data {
 
 	// nanoflann segment vector adaptors for each segment type
@@ -95,8 +108,21 @@ class Segments : public pipeline::Data {
 
 public:
 
+	Segments();
+
+	/**
+	 * Copy constructor. The kd-trees of other are not copied, they will be 
+	 * rebuilt on demand.
+	 */
+	Segments(const Segments& other);
+
 	~Segments();
 
+	/**
+	 * Assignment operator.
+	 */
+	Segments& operator=(const Segments& other);
+
 	/**
 	 * Remove all segments.
 	 */
@@ -139,24 +165,27 @@ public:
 	}
 
 	/**
-	 * Get all end segments.
+	 * Get all end segments. The returned vector is a view that is kept until 
+	 * the next modification of this set of segments, i.e., repeated calls 
+	 * without modifications in-between don't copy any segments.
 	 */
-	std::vector<boost::shared_ptr<EndSegment> > getEnds() const;
+	const std::vector<boost::shared_ptr<EndSegment> >& getEnds() const;
 
 	/**
-	 * Get all continuation segments.
+	 * Get all continuation segments. See getEnds().
 	 */
-	std::vector<boost::shared_ptr<ContinuationSegment> > getContinuations() const;
+	const std::vector<boost::shared_ptr<ContinuationSegment> >& getContinuations() const;
 
 	/**
-	 * Get all branch segments.
+	 * Get all branch segments. See getEnds().
 	 */
-	std::vector<boost::shared_ptr<BranchSegment> > getBranches() const;
+	const std::vector<boost::shared_ptr<BranchSegment> >& getBranches() const;
 
 	/**
-	 * Get all segments.
+	 * Get all segments, ordered by type (ends, continuations, branches) and 
+	 * inter-section interval. See getEnds().
 	 */
-	std::vector<boost::shared_ptr<Segment> > getSegments() const;
+	const std::vector<boost::shared_ptr<Segment> >& getSegments() const;
 
 	/**
 	 * Get all segments in the given inter-section interval.
@@ -266,13 +295,13 @@ public:
 	/**
 	 * Remove the given segment from this set.
 	 */
-	void remove(boost::shared_ptr<EndSegment>          end)          { remove(getEnds(end->getInterSectionInterval()), end); }
-	void remove(boost::shared_ptr<ContinuationSegment> continuation) { remove(getContinuations(continuation->getInterSectionInterval()), continuation); }
-	void remove(boost::shared_ptr<BranchSegment>       branch)       { remove(getBranches(branch->getInterSectionInterval()), branch); }
+	void remove(boost::shared_ptr<EndSegment>          end)          { remove(getEnds(end->getInterSectionInterval()), end, _endTreeDirty); }
+	void remove(boost::shared_ptr<ContinuationSegment> continuation) { remove(getContinuations(continuation->getInterSectionInterval()), continuation, _continuationTreeDirty); }
+	void remove(boost::shared_ptr<BranchSegment>       branch)       { remove(getBranches(branch->getInterSectionInterval()), branch, _branchTreeDirty); }
 	void remove(boost::shared_ptr<Segment> segment) {
-		remove(getEnds(         segment->getInterSectionInterval()), segment);
-		remove(getContinuations(segment->getInterSectionInterval()), segment);
-		remove(getBranches(     segment->getInterSectionInterval()), segment);
+		remove(getEnds(         segment->getInterSectionInterval()), segment, _endTreeDirty);
+		remove(getContinuations(segment->getInterSectionInterval()), segment, _continuationTreeDirty);
+		remove(getBranches(     segment->getInterSectionInterval()), segment, _branchTreeDirty);
 	}
 
 	/**
@@ -286,7 +315,7 @@ public:
 	/**
 	 * Get the number of segments.
 	 */
-	unsigned int size() const;
+	unsigned int size() const { return _size; }
 	
 	bool operator==(const Segments& other) const;
 	
@@ -301,16 +330,21 @@ private:
 	// resize to hold segments in the given number of inter-section intervals
 	void resize(int numInterSectionInterval);
 
+	// delete all kd-trees and their adaptors
+	void clearTrees();
+
+	// (re)build the whole-collection views, if they are out of date
+	void updateViews() const;
+
 	template <typename SegmentType>
-	std::vector<boost::shared_ptr<SegmentType> > get(
-			const std::vector<std::vector<boost::shared_ptr<SegmentType> > >& allSegments) const {
+	void get(
+			const std::vector<std::vector<boost::shared_ptr<SegmentType> > >& allSegments,
+			std::vector<boost::shared_ptr<SegmentType> >&                     segments) const {
 
-		std::vector<boost::shared_ptr<SegmentType> > segments;
+		segments.clear();
 
 		foreach (const std::vector<boost::shared_ptr<SegmentType> >& interSegments, allSegments)
-			std::copy(interSegments.begin(), interSegments.end(), std::back_inserter(segments));
-
-		return segments;
+			segments.insert(segments.end(), interSegments.begin(), interSegments.end());
 	}
 
 	template <typename SegmentType, typename SegmentAdaptorType, typename SegmentKdTreeType>
@@ -385,7 +419,10 @@ private:
 	}
 
 	template <typename SegmentType>
-	bool remove(std::vector<boost::shared_ptr<SegmentType> >& segments, boost::shared_ptr<Segment> segment) {
+	bool remove(
+			std::vector<boost::shared_ptr<SegmentType> >& segments,
+			boost::shared_ptr<Segment>                    segment,
+			std::vector<bool>&                            treeDirty) {
 
 		typename std::vector<boost::shared_ptr<SegmentType> >::iterator i;
 		for (i = segments.begin(); i != segments.end(); i++)
@@ -395,6 +432,11 @@ private:
 		if (i != segments.end()) {
 
 			segments.erase(i);
+
+			treeDirty[segment->getInterSectionInterval()] = true;
+			_viewsDirty = true;
+			_size--;
+
 			return true;
 		}
 
@@ -420,6 +462,21 @@ private:
 	std::vector<bool> _endTreeDirty;
 	std::vector<bool> _continuationTreeDirty;
 	std::vector<bool> _branchTreeDirty;
+
+	// the total number of segments
+	unsigned int _size;
+
+	// views on all segments over all inter-section intervals, built on demand
+	mutable std::vector<boost::shared_ptr<EndSegment> >          _allEnds;
+	mutable std::vector<boost::shared_ptr<ContinuationSegment> > _allContinuations;
+	mutable std::vector<boost::shared_ptr<BranchSegment> >       _allBranches;
+	mutable std::vector<boost::shared_ptr<Segment> >             _allSegments;
+
+	// indicate that the views have to be rebuilt
+	mutable bool _viewsDirty;
+
+	// serializes the lazy rebuild of the views between concurrent readers
+	mutable boost::mutex _viewsMutex;
 };
 
 #endif // CELLTRACKER_TRACKLETS_H__
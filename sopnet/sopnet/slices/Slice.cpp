@@ -32,6 +32,12 @@ Slice::getComponent() const {
 	return _component;
 }
 
+void
+Slice::setComponent(boost::shared_ptr<ConnectedComponent> component) {
+
+	_component = component;
+}
+
 void
 Slice::intersect(const Slice& other) {
 
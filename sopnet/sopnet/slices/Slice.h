@@ -40,6 +40,13 @@ public:
 	 */
 	boost::shared_ptr<ConnectedComponent> getComponent() const;
 
+	/**
+	 * Replace the blob of this slice. Used by Slices to exchange the 
+	 * components of several slices at once, e.g., with views into a shared 
+	 * pixel list after a translation.
+	 */
+	void setComponent(boost::shared_ptr<ConnectedComponent> component);
+
 	/**
 	 * Set the wholeness flag on this slice. If set false, this slice is
 	 * marked as one that has been split across a sub-image boundary.
@@ -0,0 +1,123 @@
+#include <algorithm>
+
+#include <imageprocessing/ConnectedComponent.h>
+#include <util/Logger.h>
+#include <util/foreach.h>
+#include "SliceIndex.h"
+
+static logger::LogChannel sliceindexlog("sliceindexlog", "[SliceIndex] ");
+
+SliceIndex::SliceIndex() :
+	_extent(0, 0, 0, 0),
+	_cellSize(1),
+	_numCellsX(0),
+	_numCellsY(0),
+	_query(0),
+	_dirty(false) {}
+
+unsigned int
+SliceIndex::add(boost::shared_ptr<Slice> slice) {
+
+	_slices.push_back(slice);
+	_boundingBoxes.push_back(slice->getComponent()->getBoundingBox());
+	_lastFound.push_back(0);
+
+	_dirty = true;
+
+	return _slices.size() - 1;
+}
+
+std::vector<unsigned int>
+SliceIndex::find(const Slice& slice) {
+
+	return find(slice.getComponent()->getBoundingBox());
+}
+
+std::vector<unsigned int>
+SliceIndex::find(const util::rect<int>& boundingBox) {
+
+	if (_dirty)
+		build();
+
+	std::vector<unsigned int> found;
+
+	if (_slices.empty() || !intersects(boundingBox, _extent))
+		return found;
+
+	// the range of cells covered by the box
+	unsigned int beginX = std::max(boundingBox.minX - _extent.minX, 0)/_cellSize;
+	unsigned int beginY = std::max(boundingBox.minY - _extent.minY, 0)/_cellSize;
+	unsigned int endX   = std::min((unsigned int)(boundingBox.maxX - _extent.minX)/_cellSize + 1, _numCellsX);
+	unsigned int endY   = std::min((unsigned int)(boundingBox.maxY - _extent.minY)/_cellSize + 1, _numCellsY);
+
+	_query++;
+
+	for (unsigned int y = beginY; y < endY; y++)
+		for (unsigned int x = beginX; x < endX; x++)
+			foreach (unsigned int i, _cells[x + y*_numCellsX]) {
+
+				if (_lastFound[i] == _query)
+					continue;
+
+				_lastFound[i] = _query;
+
+				if (intersects(boundingBox, _boundingBoxes[i]))
+					found.push_back(i);
+			}
+
+	std::sort(found.begin(), found.end());
+
+	return found;
+}
+
+void
+SliceIndex::build() {
+
+	_extent = _boundingBoxes[0];
+
+	double meanSize = 0;
+
+	foreach (const util::rect<int>& bb, _boundingBoxes) {
+
+		_extent.minX = std::min(_extent.minX, bb.minX);
+		_extent.minY = std::min(_extent.minY, bb.minY);
+		_extent.maxX = std::max(_extent.maxX, bb.maxX);
+		_extent.maxY = std::max(_extent.maxY, bb.maxY);
+
+		meanSize += std::max(bb.maxX - bb.minX, bb.maxY - bb.minY) + 1;
+	}
+
+	meanSize /= _boundingBoxes.size();
+
+	unsigned int width  = _extent.maxX - _extent.minX + 1;
+	unsigned int height = _extent.maxY - _extent.minY + 1;
+
+	// cells of the size of an average slice, but not (many) more cells than
+	// slices
+	_cellSize = std::max(1u, (unsigned int)meanSize);
+	while ((width/_cellSize + 1)*(height/_cellSize + 1) > 4*_slices.size())
+		_cellSize *= 2;
+
+	_numCellsX = width/_cellSize + 1;
+	_numCellsY = height/_cellSize + 1;
+
+	_cells.clear();
+	_cells.resize(_numCellsX*_numCellsY);
+
+	for (unsigned int i = 0; i < _boundingBoxes.size(); i++) {
+
+		const util::rect<int>& bb = _boundingBoxes[i];
+
+		for (unsigned int y = (bb.minY - _extent.minY)/_cellSize; y <= (bb.maxY - _extent.minY)/_cellSize; y++)
+			for (unsigned int x = (bb.minX - _extent.minX)/_cellSize; x <= (bb.maxX - _extent.minX)/_cellSize; x++)
+				_cells[x + y*_numCellsX].push_back(i);
+	}
+
+	LOG_ALL(sliceindexlog)
+			<< "indexed " << _slices.size() << " slices in "
+			<< _numCellsX << "x" << _numCellsY << " cells of size "
+			<< _cellSize << std::endl;
+
+	_dirty = false;
+}
+
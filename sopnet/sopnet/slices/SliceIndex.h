@@ -0,0 +1,89 @@
+#ifndef SOPNET_SLICES_SLICE_INDEX_H__
+#define SOPNET_SLICES_SLICE_INDEX_H__
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <util/rect.hpp>
+#include "Slice.h"
+
+/**
+ * A spatial index of the slices of one section, by their bounding boxes.
+ *
+ * Finds the slices whose bounding box intersects a given box. This is meant
+ * to be used as a cheap prefilter for pixel-wise tests like Overlap, which
+ * can only succeed for slices with intersecting bounding boxes.
+ *
+ * The slices are sorted into a uniform grid, which is built on the first
+ * query after slices have been added. A SliceIndex must not be used by
+ * several threads at the same time.
+ */
+class SliceIndex {
+
+public:
+
+	SliceIndex();
+
+	/**
+	 * Add a slice to the index.
+	 *
+	 * @return The number of the slice, i.e., the number of slices added before.
+	 */
+	unsigned int add(boost::shared_ptr<Slice> slice);
+
+	/**
+	 * Get the number of slices in this index.
+	 */
+	unsigned int size() const { return _slices.size(); }
+
+	/**
+	 * Get a slice by its number.
+	 */
+	boost::shared_ptr<Slice> operator[](unsigned int i) const { return _slices[i]; }
+
+	/**
+	 * Find all slices whose bounding box intersects or touches the given box.
+	 *
+	 * @return The numbers of the found slices, in increasing order.
+	 */
+	std::vector<unsigned int> find(const util::rect<int>& boundingBox);
+
+	/**
+	 * Find all slices whose bounding box intersects or touches the bounding
+	 * box of the given slice.
+	 */
+	std::vector<unsigned int> find(const Slice& slice);
+
+private:
+
+	void build();
+
+	inline bool intersects(const util::rect<int>& a, const util::rect<int>& b) const {
+
+		return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+	}
+
+	std::vector<boost::shared_ptr<Slice> > _slices;
+
+	std::vector<util::rect<int> > _boundingBoxes;
+
+	// the bounding box of all slices
+	util::rect<int> _extent;
+
+	// the grid, a list of slice numbers for each cell
+	std::vector<std::vector<unsigned int> > _cells;
+
+	unsigned int _cellSize;
+	unsigned int _numCellsX;
+	unsigned int _numCellsY;
+
+	// the last query in which a slice was found, to report each slice once
+	std::vector<unsigned int> _lastFound;
+	unsigned int              _query;
+
+	bool _dirty;
+};
+
+#endif // SOPNET_SLICES_SLICE_INDEX_H__
+
@@ -1,5 +1,12 @@
+#include <map>
+
+#include <boost/make_shared.hpp>
+
+#include <util/Logger.h>
 #include "Slices.h"
 
+static logger::LogChannel sliceslog("sliceslog", "[Slices] ");
+
 Slices::Slices() :
 	_adaptor(0),
 	_kdTree(0),
@@ -164,8 +171,53 @@ Slices::setConflicts(unsigned int id, std::vector<unsigned int> conflicts)
 void
 Slices::translate(const util::point<int>& offset) {
 
-	foreach (boost::shared_ptr<Slice> slice, _slices)
-		slice->translate(offset);
+	// Slices that were extracted from the same component tree share one pixel 
+	// list, in which the pixels of each slice form a contiguous range that 
+	// contains the ranges of all its children. Instead of letting every slice 
+	// copy its pixels into a new list, we translate each shared pixel list only 
+	// once and make the translated components views into the same ranges of 
+	// the translated list.
+
+	typedef ConnectedComponent::pixel_list_type pixel_list_type;
+
+	std::map<const pixel_list_type*, boost::shared_ptr<pixel_list_type> > translatedLists;
+
+	foreach (boost::shared_ptr<Slice> slice, _slices) {
+
+		boost::shared_ptr<ConnectedComponent> component = slice->getComponent();
+		boost::shared_ptr<pixel_list_type>    pixelList = component->getPixelList();
+
+		boost::shared_ptr<pixel_list_type>& translatedList = translatedLists[pixelList.get()];
+
+		if (!translatedList) {
+
+			translatedList = boost::make_shared<pixel_list_type>();
+			translatedList->reserve(pixelList->size());
+
+			foreach (const ConnectedComponent::pixel_type& pixel, *pixelList)
+				translatedList->push_back(
+						ConnectedComponent::pixel_type(
+								pixel.x + offset.x,
+								pixel.y + offset.y));
+		}
+
+		unsigned int begin = component->getPixels().first  - pixelList->begin();
+		unsigned int end   = component->getPixels().second - pixelList->begin();
+
+		// The source image is not set, since it is given in the untranslated 
+		// coordinates.
+		slice->setComponent(
+				boost::make_shared<ConnectedComponent>(
+						boost::shared_ptr<Image>(),
+						component->getValue(),
+						translatedList,
+						begin,
+						end));
+	}
+
+	LOG_ALL(sliceslog)
+			<< "translated " << _slices.size() << " slices using "
+			<< translatedLists.size() << " shared pixel lists" << std::endl;
 
 	_kdTreeDirty = true;
 }
@@ -202,7 +202,9 @@ public:
 	std::vector<boost::shared_ptr<Slice> > find(const util::point<double>& center, double distance);
 
 	/**
-	 * Move all slices in 2D.
+	 * Move all slices in 2D. Slices that share a pixel list (e.g., all slices 
+	 * extracted from the same component tree) will share the translated pixel 
+	 * list as well.
 	 */
 	void translate(const util::point<int>& offset);
 
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <pipeline/Process.h>
 #include <util/Logger.h>
 #include <sopnet/exceptions.h>
@@ -18,7 +20,11 @@ GoldStandardCostFunction::GoldStandardCostFunction() :
 }
 
 void
-GoldStandardCostFunction::updateOutputs() {}
+GoldStandardCostFunction::updateOutputs() {
+
+	// the ground truth might have changed
+	_groundTruthIndices.clear();
+}
 
 void
 GoldStandardCostFunction::costs(
@@ -79,23 +85,75 @@ GoldStandardCostFunction::costs(const Segment& segment) {
 pipeline::Value<Segments>
 GoldStandardCostFunction::getOverlappingGroundTruthSegments(const Segment& segment) {
 
-	unsigned int interSectionInterval = segment.getInterSectionInterval();
+	GroundTruthIndex& index = getGroundTruthIndex(segment.getInterSectionInterval());
+
+	std::vector<boost::shared_ptr<Slice> > leftSlices;
+	std::vector<boost::shared_ptr<Slice> > rightSlices;
+
+	addLeftRightSlices(segment, leftSlices, rightSlices);
+
+	// only ground-truth segments with slices whose bounding boxes intersect 
+	// the ones of the segment can overlap
+	std::vector<unsigned int> candidates;
+
+	foreach (boost::shared_ptr<Slice> slice, leftSlices)
+		foreach (unsigned int i, index.leftSlices.find(*slice))
+			candidates.push_back(index.leftSegments[i]);
+	foreach (boost::shared_ptr<Slice> slice, rightSlices)
+		foreach (unsigned int i, index.rightSlices.find(*slice))
+			candidates.push_back(index.rightSegments[i]);
+
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
 
 	pipeline::Value<Segments> overlappingGtSegments;
 
-	foreach (boost::shared_ptr<EndSegment> gtSegment, _groundTruth->getEnds(interSectionInterval))
-		if (overlaps(segment, *gtSegment))
-			overlappingGtSegments->add(gtSegment);
-	foreach (boost::shared_ptr<ContinuationSegment> gtSegment, _groundTruth->getContinuations(interSectionInterval))
-		if (overlaps(segment, *gtSegment))
-			overlappingGtSegments->add(gtSegment);
-	foreach (boost::shared_ptr<BranchSegment> gtSegment, _groundTruth->getBranches(interSectionInterval))
-		if (overlaps(segment, *gtSegment))
-			overlappingGtSegments->add(gtSegment);
+	foreach (unsigned int candidate, candidates)
+		if (overlaps(segment, *index.segments[candidate]))
+			overlappingGtSegments->add(index.segments[candidate]);
 
 	return overlappingGtSegments;
 }
 
+GoldStandardCostFunction::GroundTruthIndex&
+GoldStandardCostFunction::getGroundTruthIndex(unsigned int interSectionInterval) {
+
+	std::map<unsigned int, GroundTruthIndex>::iterator i = _groundTruthIndices.find(interSectionInterval);
+
+	if (i != _groundTruthIndices.end())
+		return i->second;
+
+	GroundTruthIndex& index = _groundTruthIndices[interSectionInterval];
+
+	index.segments = _groundTruth->getSegments(interSectionInterval);
+
+	for (unsigned int j = 0; j < index.segments.size(); j++) {
+
+		std::vector<boost::shared_ptr<Slice> > leftSlices;
+		std::vector<boost::shared_ptr<Slice> > rightSlices;
+
+		addLeftRightSlices(*index.segments[j], leftSlices, rightSlices);
+
+		foreach (boost::shared_ptr<Slice> slice, leftSlices) {
+
+			index.leftSlices.add(slice);
+			index.leftSegments.push_back(j);
+		}
+
+		foreach (boost::shared_ptr<Slice> slice, rightSlices) {
+
+			index.rightSlices.add(slice);
+			index.rightSegments.push_back(j);
+		}
+	}
+
+	LOG_DEBUG(linearcostfunctionlog)
+			<< "indexed " << index.segments.size() << " ground-truth segments in interval "
+			<< interSectionInterval << std::endl;
+
+	return index;
+}
+
 double
 GoldStandardCostFunction::getDefaultCosts(const Segment& segment) {
 
@@ -5,6 +5,7 @@
 #include <pipeline/Value.h>
 #include <sopnet/features/Overlap.h>
 #include <sopnet/segments/Segments.h>
+#include <sopnet/slices/SliceIndex.h>
 
 // forward declarations
 class EndSegment;
@@ -80,8 +81,34 @@ private:
 			const std::vector<boost::shared_ptr<Slice> >& aSlices,
 			const std::vector<boost::shared_ptr<Slice> >& bSlices);
 
+	/**
+	 * Bounding-box indices of the left and right slices of the ground-truth 
+	 * segments in one inter-section interval.
+	 */
+	struct GroundTruthIndex {
+
+		// the ground-truth segments, ends first, then continuations and 
+		// branches
+		std::vector<boost::shared_ptr<Segment> > segments;
+
+		SliceIndex leftSlices;
+		SliceIndex rightSlices;
+
+		// the number of the segment for each indexed slice
+		std::vector<unsigned int> leftSegments;
+		std::vector<unsigned int> rightSegments;
+	};
+
+	/**
+	 * Get the index of the ground-truth segments in the given inter-section 
+	 * interval, create it if needed.
+	 */
+	GroundTruthIndex& getGroundTruthIndex(unsigned int interSectionInterval);
+
 	pipeline::Input<Segments> _groundTruth;
 
+	std::map<unsigned int, GroundTruthIndex> _groundTruthIndices;
+
 	pipeline::Output<costs_function_type> _costFunction;
 
 	Overlap _overlap;
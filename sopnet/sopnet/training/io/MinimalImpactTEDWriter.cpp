@@ -2,21 +2,31 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <set>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include <vigra/hdf5impex.hxx>
+#include <vigra/multi_array.hxx>
+
+#include <sopnet/parallel/WorkerPool.h>
+#include <util/exceptions.h>
+#include <util/ProgramOptions.h>
 
 static logger::LogChannel minimalImpactTEDlog("minimalImpactTEDlog", "[minimalImapctTED] ");
 
-MinimalImpactTEDWriter::MinimalImpactTEDWriter() :
-	_teDistance(boost::make_shared<TolerantEditDistance>()),
-	_gsimCreator(boost::make_shared<IdMapCreator>()),
-	_rimCreator(boost::make_shared<IdMapCreator>()),
-	_rNeuronExtractor(boost::make_shared<NeuronExtractor>()),
-	_gsNeuronExtractor(boost::make_shared<NeuronExtractor>()),
-	_rReconstructor(boost::make_shared<Reconstructor>()),
-	_linearSolver(boost::make_shared<LinearSolver>()),
-	_objectiveGenerator(boost::make_shared<ObjectiveGenerator>()),
-	_hammingCostFunction(boost::make_shared<HammingCostFunction>())
-	{
-	
+util::ProgramOption optionMinimalImpactTEDNumThreads(
+		util::_module           = "minimalImpactTED",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of variables to compute the minimal impact TED for in parallel. Each thread keeps its own "
+		                          "reconstruction and id maps. The default (0) uses the number of worker threads.",
+		util::_default_value    = 0);
+
+extern util::ProgramOption optionStructuredLearningFormat;
+
+MinimalImpactTEDWriter::MinimalImpactTEDWriter() {
+
 	registerInput(_goldStandard, "gold standard");
 	registerInput(_linearConstraints, "linear constraints");
 	registerInput(_segments, "segments");
@@ -30,144 +40,235 @@ MinimalImpactTEDWriter::write(std::string filename) {
 
 	updateInputs();
 
-	// Create the internal pipeline
-	createPipeline();
+	std::string format = optionStructuredLearningFormat.as<std::string>();
+
+	if (format != "text" && format != "hdf5")
+		BOOST_THROW_EXCEPTION(UsageError() << error_message(std::string("unknown structured learning format \"") + format + "\"") << STACK_TRACE);
+
+	LOG_DEBUG(minimalImpactTEDlog) << "in write function." << std::endl;
+
+	// Get the ids of all gold standard segments.
+	std::set<unsigned int> goldStandardIds;
+	foreach (boost::shared_ptr<Segment> s, _goldStandard->getSegments())
+		goldStandardIds.insert(s->getId());
+
+	// Is the segment that corresponds to a variable part of the gold standard?
+	unsigned int numVariables = _problemConfiguration->getVariables().size();
+
+	std::vector<bool> inGoldStandard(numVariables);
+	for (unsigned int varNum = 0; varNum < numVariables; varNum++)
+		inGoldStandard[varNum] = goldStandardIds.count(_problemConfiguration->getSegmentId(varNum));
+
+	// Distribute contiguous runs of variables over independent pipelines.
+	unsigned int numThreads = optionMinimalImpactTEDNumThreads.as<unsigned int>();
+	if (numThreads == 0)
+		numThreads = WorkerPool::getDefaultNumThreads();
+	numThreads = std::max(1u, std::min(numThreads, numVariables));
+
+	// The pipelines share the segments read-only. Build their lazy views now,
+	// instead of in all threads at once.
+	_segments->getSegments();
+	_goldStandard->getSegments();
+
+	// the solvers of all pipelines share the cores
+	unsigned int numThreadsPerPipeline = std::max(1u, WorkerPool::getDefaultNumThreads()/numThreads);
+
+	std::vector<ImpactPipeline> pipelines(numThreads);
+	foreach (ImpactPipeline& pipeline, pipelines)
+		createPipeline(pipeline, numThreadsPerPipeline);
+
+	LOG_DEBUG(minimalImpactTEDlog)
+			<< "computing the minimal impact TED of " << numVariables
+			<< " variables in " << numThreads << " threads" << std::endl;
 
-	// Remove the old file
-	/*if( std::remove( filename ) != 0 ) {
-		LOG_DEBUG(minimalImpactTEDlog) << "Old file to output minimal impact TED approximation sucessfully deleted." << std::endl;
-	} 
-	else {
-		LOG_DEBUG(minimalImpactTEDlog) << "Could not delete old file to output minimal impact TED approximation." << std::endl;
-	}*/
+	std::vector<int> errors(numVariables);
 
-	 // Get a vector with all gold standard segments.
-        const std::vector<boost::shared_ptr<Segment> > goldStandard = _goldStandard->getSegments();
+	unsigned int runLength = (numVariables + numThreads - 1)/numThreads;
+
+	WorkerPool workers(numThreads);
+
+	for (unsigned int i = 0; i < numThreads; i++) {
+
+		unsigned int begin = std::min(i*runLength, numVariables);
+		unsigned int end   = std::min(begin + runLength, numVariables);
+
+		if (begin == end)
+			break;
+
+		workers.schedule(
+				boost::bind(
+						&MinimalImpactTEDWriter::computeErrors,
+						this,
+						boost::ref(pipelines[i]),
+						boost::cref(inGoldStandard),
+						begin,
+						end,
+						boost::ref(errors)));
+	}
+
+	workers.wait();
 
 	int constant = 0;
 
-	LOG_DEBUG(minimalImpactTEDlog) << "in write function." << std::endl;
+	std::vector<int> values(numVariables);
+	for (unsigned int varNum = 0; varNum < numVariables; varNum++) {
+
+		if (inGoldStandard[varNum]) {
+			// Forced segment to not be part of the reconstruction.
+			// This resulted in a number of errors that are going to be stored in the constant.
+			// To make net 0 errors when the variable is on, minus the number of errors will be written to the file.
+
+			values[varNum] = -errors[varNum];
+
+			constant += errors[varNum];
+		}
+		else {
+			// Forced segment to be part of the reconstruction.
+			// This resulted in a number of errors that are going to be written to the file.
+
+			values[varNum] = errors[varNum];
+		}
+	}
+
+	if (format == "hdf5")
+		writeToHdf5(boost::filesystem::path(filename).replace_extension(".h5").string(), values, constant);
+	else
+		writeToFile(filename, values, constant);
+}
+
+void
+MinimalImpactTEDWriter::computeErrors(
+		ImpactPipeline&          pipeline,
+		const std::vector<bool>& inGoldStandard,
+		unsigned int             begin,
+		unsigned int             end,
+		std::vector<int>&        errors) {
 
 	// Loop through variables
-	std::set<unsigned int> variables = _problemConfiguration->getVariables();
-	for ( unsigned int varNum = 0 ; varNum < variables.size() ; varNum++ ) {
+	for (unsigned int varNum = begin; varNum < end; varNum++) {
 
 		// Introduce constraints that flip the segment corresponding to the ith variable
 		// compared to the goldstandard.
-	
-		// Is the segment that corresponds to the variable part of the gold standard?
-                unsigned int segmentId = _problemConfiguration->getSegmentId(varNum);
-
-                bool isContained = false;
-                foreach (boost::shared_ptr<Segment> s, goldStandard) {
-                        if (s->getId() == segmentId) {
-                                isContained = true;
-                        }
-                }
-	
 		LinearConstraint constraint;
 		constraint.setRelation(Equal);
 
-                if (isContained == true) {
+		if (inGoldStandard[varNum]) {
 			// Force segment to not be used in reconstruction
 			constraint.setCoefficient(varNum,1.0);
 			constraint.setValue(0);
-                }
-                else {
+		}
+		else {
 			// Force segment to be used in reconstruction
 			constraint.setCoefficient(varNum,1.0);
 			constraint.setValue(1);
-                }
-
-		_linearConstraints->add(constraint);
-		
-		_linearSolver->setInput("linear constraints",_linearConstraints);
+		}
 
-		pipeline::Value<Errors> errors = _teDistance->getOutput("errors");
-		unsigned int sumErrors = errors->getNumSplits() + errors->getNumMerges() + errors->getNumFalsePositives() + errors->getNumFalseNegatives();
-		int sumErrorsInt = (int) sumErrors;
+		pipeline.linearConstraints->add(constraint);
 
-		if (isContained == true) {
-			// Forced segment to not be part of the reconstruction.
-			// This resulted in a number of errors that are going to be stored in the constant.
-			// To make net 0 errors when the variable is on, minus the number of errors will be written to the file.
+		pipeline.linearSolver->setInput("linear constraints", pipeline.linearConstraints);
 
-			writeToFile(filename, -sumErrorsInt, varNum, false);
+		pipeline::Value<Errors> tedErrors = pipeline.teDistance->getOutput("errors");
+		unsigned int sumErrors = tedErrors->getNumSplits() + tedErrors->getNumMerges() + tedErrors->getNumFalsePositives() + tedErrors->getNumFalseNegatives();
 
-			constant += sumErrorsInt;
-		}
-		else {
-			// Forced segment to be part of the reconstruction.
-			// This resulted in a number of errors that are going to be written to the file.
+		errors[varNum] = (int) sumErrors;
 
-			writeToFile(filename, sumErrorsInt, varNum, false);
-		}
+		LOG_ALL(minimalImpactTEDlog) << "variable " << varNum << ": " << sumErrors << " errors" << std::endl;
 
 		// Remove constraint
-		_linearConstraints->removeLastConstraint();
+		pipeline.linearConstraints->removeLastConstraint();
 	}
-
-	// Write constant to file
-	writeToFile(filename, constant, 0, true);
 }
 
 void
-MinimalImpactTEDWriter::writeToFile(std::string filename, int value, int varNum, bool isConstant) {
+MinimalImpactTEDWriter::writeToFile(std::string filename, const std::vector<int>& values, int constant) {
 
 	std::ofstream outfile;
-	outfile.open(filename.c_str(), std::ios_base::app);
-	
-	if (isConstant == false) {
-		outfile << "c" << varNum << " " << value << std::endl;
-	}
-	else {
-		outfile << "constant " << value << std::endl;
-	}
+	outfile.open(filename.c_str());
+
+	for (unsigned int varNum = 0; varNum < values.size(); varNum++)
+		outfile << "c" << varNum << " " << values[varNum] << std::endl;
+
+	outfile << "constant " << constant << std::endl;
 
 	outfile.close();
+}
 
+void
+MinimalImpactTEDWriter::writeToHdf5(std::string filename, const std::vector<int>& values, int constant) {
+
+	LOG_DEBUG(minimalImpactTEDlog) << "writing coefficients to " << filename << std::endl;
+
+	vigra::HDF5File file(filename, vigra::HDF5File::New);
+
+	vigra::MultiArrayView<1, int> view(
+			vigra::MultiArrayShape<1>::type(values.size()),
+			const_cast<int*>(values.empty() ? 0 : &values[0]));
+
+	// HDF5 does not allow chunked datasets without elements
+	int chunkSize = std::min<int>(values.size(), 65536);
+
+	file.write("coefficients", view, chunkSize, chunkSize > 0 ? 6 : 0);
+	file.writeAttribute("coefficients", "constant", constant);
 }
 
 void
-MinimalImpactTEDWriter::createPipeline() {
+MinimalImpactTEDWriter::createPipeline(ImpactPipeline& pipeline, unsigned int numThreads) {
+
+	pipeline.teDistance          = boost::make_shared<TolerantEditDistance>(numThreads);
+	pipeline.gsimCreator         = boost::make_shared<IdMapCreator>();
+	pipeline.rimCreator          = boost::make_shared<IdMapCreator>();
+	pipeline.rNeuronExtractor    = boost::make_shared<NeuronExtractor>();
+	pipeline.gsNeuronExtractor   = boost::make_shared<NeuronExtractor>();
+	pipeline.rReconstructor      = boost::make_shared<Reconstructor>();
+	pipeline.linearSolver        = boost::make_shared<LinearSolver>();
+	pipeline.objectiveGenerator  = boost::make_shared<ObjectiveGenerator>();
+	pipeline.hammingCostFunction = boost::make_shared<HammingCostFunction>();
+
+	// The pipelines are used concurrently, so they get the (up-to-date) input
+	// data directly instead of sharing the upstream process nodes. The
+	// constraints are copied, such that each pipeline can add its own flip
+	// constraint.
+	pipeline.linearConstraints = boost::make_shared<LinearConstraints>(*_linearConstraints);
 
 	// Set inputs
 
 	// The name ground truth is slightly misleading here because really we are setting the gold standard as input,
 	// but that is what the correct input in the TED is called.
 	// IdMapCreator [gold standard] ----> TED
-	_teDistance->setInput("ground truth", _gsimCreator->getOutput("id map"));
+	pipeline.teDistance->setInput("ground truth", pipeline.gsimCreator->getOutput("id map"));
 	// -- gold standard --> NeuronExtractor [gold standard]
-	_gsNeuronExtractor->setInput("segments",_goldStandard);
+	pipeline.gsNeuronExtractor->setInput("segments", _goldStandard.getSharedPointer());
 	// NeuronExtractor [gold standard] ----> IdMapCreator [gold standard]
-	_gsimCreator->setInput("neurons", _gsNeuronExtractor->getOutput("neurons"));
+	pipeline.gsimCreator->setInput("neurons", pipeline.gsNeuronExtractor->getOutput("neurons"));
 	// reference image stack for width height and size of output image stacks
 	// -- reference --> IdMapCreator
-	_gsimCreator->setInput("reference",_reference);
+	pipeline.gsimCreator->setInput("reference", _reference.getSharedPointer());
 	// IdMapCreator [reconstruction] ----> TED
-	_teDistance->setInput("reconstruction", _rimCreator->getOutput("id map"));
+	pipeline.teDistance->setInput("reconstruction", pipeline.rimCreator->getOutput("id map"));
 	// Reconstructor ----> NeuronExtractor [reconstruction]
-	_rNeuronExtractor->setInput("segments", _rReconstructor->getOutput("reconstruction"));
+	pipeline.rNeuronExtractor->setInput("segments", pipeline.rReconstructor->getOutput("reconstruction"));
 	// NeuronExtractor [reconstruction] ----> IdMapCreator [reconstruction]
-	_rimCreator->setInput("neurons", _rNeuronExtractor->getOutput("neurons"));
+	pipeline.rimCreator->setInput("neurons", pipeline.rNeuronExtractor->getOutput("neurons"));
 	// reference image stack for width height and size of output image stack
 	// -- reference --> IdMapCreator
-	_rimCreator->setInput("reference",_reference);
+	pipeline.rimCreator->setInput("reference", _reference.getSharedPointer());
 	// Linear Solver ----> Reconstructor
-	_rReconstructor->setInput("solution", _linearSolver->getOutput("solution"));
+	pipeline.rReconstructor->setInput("solution", pipeline.linearSolver->getOutput("solution"));
 	// -- Segments --> Reconstructor
-	_rReconstructor->setInput("segments",_segments);
+	pipeline.rReconstructor->setInput("segments", _segments.getSharedPointer());
 	// -- Linear Constraints --> Linear Solver
-	_linearSolver->setInput("linear constraints",_linearConstraints);
+	pipeline.linearSolver->setInput("linear constraints", pipeline.linearConstraints);
 	// -- Parameters --> Linear Solver
-	_linearSolver->setInput("parameters", boost::make_shared<LinearSolverParameters>(Binary));
+	boost::shared_ptr<LinearSolverParameters> parameters = boost::make_shared<LinearSolverParameters>(Binary);
+	parameters->setNumThreads(numThreads);
+	pipeline.linearSolver->setInput("parameters", parameters);
 	// Objective Generator ----> Linear Solver
-	_linearSolver->setInput("objective", _objectiveGenerator->getOutput());
+	pipeline.linearSolver->setInput("objective", pipeline.objectiveGenerator->getOutput());
 	// -- Segments --> Objective Generator
-        _objectiveGenerator->setInput("segments", _segments);
+	pipeline.objectiveGenerator->setInput("segments", _segments.getSharedPointer());
 	// -- Gold Standard --> Hamming Cost Function
-       	_hammingCostFunction->setInput("gold standard", _goldStandard);
+	pipeline.hammingCostFunction->setInput("gold standard", _goldStandard.getSharedPointer());
 	// Hamming Cost Function ----> Objective Generator
-        _objectiveGenerator->addInput("cost functions", _hammingCostFunction->getOutput());
+	pipeline.objectiveGenerator->addInput("cost functions", pipeline.hammingCostFunction->getOutput());
 
 }
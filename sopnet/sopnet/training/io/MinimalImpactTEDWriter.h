@@ -16,6 +16,17 @@
 #include <sopnet/inference/ObjectiveGenerator.h>
 #include <sopnet/training/HammingCostFunction.h>
 
+/**
+ * Writes, for each variable, the tolerant edit distance of the reconstruction
+ * closest to the gold standard in which the variable is flipped. Together 
+ * with a constant, these coefficients linearly approximate the TED for 
+ * structured learning.
+ *
+ * Each variable requires its own solve and TED evaluation. The variables are
+ * distributed over several private copies of the evaluation pipeline, which 
+ * are processed in parallel (see program option 
+ * minimalImpactTED.numThreads).
+ */
 class MinimalImpactTEDWriter : public pipeline::SimpleProcessNode<> {
 
 public:
@@ -26,11 +37,68 @@ public:
 
 private:
 
+	/**
+	 * The pipeline to compute the TED of the reconstruction with one variable
+	 * flipped. Not thread-safe, each thread uses its own.
+	 */
+	struct ImpactPipeline {
+
+		// The node that calculates the tolerant edit distance
+		boost::shared_ptr<TolerantEditDistance>		teDistance;
+
+		// The id map creator that creates image stacks for the TED from the gold standard
+		boost::shared_ptr<IdMapCreator>			gsimCreator;
+
+		// The id map creator that creates images stacks for the TED from the reconstruction
+		boost::shared_ptr<IdMapCreator>			rimCreator;
+
+		// A neuron extractor to convert the solution of the reconstructor into component trees
+		boost::shared_ptr<NeuronExtractor> 		rNeuronExtractor;
+
+		// A neuron extractor to convert the gold standard segments into component trees
+		boost::shared_ptr<NeuronExtractor>		gsNeuronExtractor;
+
+		// The process node that reconstructs the reconstruction solution
+		boost::shared_ptr<Reconstructor>              	rReconstructor;
+
+		// Linear solver to find the closest reconstruction to the goldstandard with one
+		// of the segments fliped that still adheres to all the constraints. Fliped here
+		// means: if the segment is in the gold standard it is not in the reconstruction,
+		// and if it is not in the gold standard then it is in the reconstruction.
+		boost::shared_ptr<LinearSolver>                 linearSolver;
+
+		// Objective generator to generate the hamming distance objective
+		boost::shared_ptr<ObjectiveGenerator>       	objectiveGenerator;
+
+		// Hamming cost function for the objective generator
+		boost::shared_ptr<HammingCostFunction> 		hammingCostFunction;
+
+		// A private copy of the linear constraints, to add the flip constraint to
+		boost::shared_ptr<LinearConstraints>		linearConstraints;
+	};
+
 	void updateOutputs() {}
 
-	void createPipeline();
+	/**
+	 * Create a pipeline whose TED and solver together use at most the given 
+	 * number of threads.
+	 */
+	void createPipeline(ImpactPipeline& pipeline, unsigned int numThreads);
+
+	/**
+	 * Compute the number of errors for the variables in [begin, end), each
+	 * flipped compared to the gold standard.
+	 */
+	void computeErrors(
+			ImpactPipeline&          pipeline,
+			const std::vector<bool>& inGoldStandard,
+			unsigned int             begin,
+			unsigned int             end,
+			std::vector<int>&        errors);
 
-	void writeToFile(std::string filename, int value, int varNum, bool isConstant);
+	void writeToFile(std::string filename, const std::vector<int>& values, int constant);
+
+	void writeToHdf5(std::string filename, const std::vector<int>& values, int constant);
 
 	/*********
 	* Inputs *
@@ -46,47 +114,11 @@ private:
 	pipeline::Input<Segments> 			_segments;
 
 	// The reference that the IdMapCreators need to determin the size of the the output images.
-	// Alternatively the size could be calculated from the segment hypotheses. 
+	// Alternatively the size could be calculated from the segment hypotheses.
 	pipeline::Input<ImageStack>   			_reference;
 
 	// A problem configuration to map segments to the corresponding variables.
 	pipeline::Input<ProblemConfiguration> 		_problemConfiguration;
-	
-	/********************
-	* Internal pipeline *
-	********************/
-
-	// The node that calculates the tolerant edit distance	
-	boost::shared_ptr<TolerantEditDistance>		_teDistance;
-	
-	// The id map creator that creates image stacks for the TED from the gold standard
-	boost::shared_ptr<IdMapCreator>			_gsimCreator;
-
-	// The id map creator that creates images stacks for the TED from the reconstruction
-	boost::shared_ptr<IdMapCreator>			_rimCreator;
-
-	// A neuron extractor to convert the solution of the reconstructor into component trees	
-	boost::shared_ptr<NeuronExtractor> 		_rNeuronExtractor; 
-
-	// A neuron extractor to convert the gold standard segments into component trees
-	boost::shared_ptr<NeuronExtractor>		_gsNeuronExtractor;
-
-	// The process node that reconstructs the reconstruction solution
-	boost::shared_ptr<Reconstructor>              	_rReconstructor;
-
-	// Linear solver to find the closest reconstruction to the goldstandard with one
-	// of the segments fliped that still adheres to all the constraints. Fliped here 
-	// means: if the segment is in the gold standard it is not in the reconstruction,
-	// and if it is not in the gold standard then it is in the reconstruction.
-	boost::shared_ptr<LinearSolver>                 _linearSolver;
-
-	// Objective generator to generate the hamming distance objective
-	boost::shared_ptr<ObjectiveGenerator>       	_objectiveGenerator;
-
-	// Hamming cost function for the objective generator
-	boost::shared_ptr<HammingCostFunction> 		_hammingCostFunction;
-
 };
 
 #endif // SOPNET_MINIMAL_IMPACT_TED_WRITER_H___
-
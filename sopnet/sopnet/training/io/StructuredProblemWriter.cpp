@@ -2,6 +2,54 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <set>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/tuple/tuple.hpp>
+
+#include <vigra/hdf5impex.hxx>
+#include <vigra/multi_array.hxx>
+
+#include <util/exceptions.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+
+static logger::LogChannel structuredproblemwriterlog("structuredproblemwriterlog", "[StructuredProblemWriter] ");
+
+util::ProgramOption optionStructuredLearningFormat(
+		util::_module           = "structuredLearning",
+		util::_long_name        = "format",
+		util::_description_text = "The format of the files written for structured learning: 'text', or 'hdf5' for chunked and compressed "
+		                          "HDF5 files with the extension '.h5'.",
+		util::_default_value    = "text");
+
+// the number of variables per chunk of the HDF5 datasets
+static const unsigned int Hdf5ChunkSize = 4096;
+
+namespace {
+
+std::string
+hdf5Filename(std::string filename) {
+
+	return boost::filesystem::path(filename).replace_extension(".h5").string();
+}
+
+template <typename T>
+void
+writeHdf5(vigra::HDF5File& file, std::string dataset, const std::vector<T>& data) {
+
+	vigra::MultiArrayView<1, T> view(
+			vigra::MultiArrayShape<1>::type(data.size()),
+			const_cast<T*>(data.empty() ? 0 : &data[0]));
+
+	// HDF5 does not allow chunked datasets without elements
+	int chunkSize = std::min<int>(data.size(), 16*Hdf5ChunkSize);
+
+	file.write(dataset, view, chunkSize, chunkSize > 0 ? 6 : 0);
+}
+
+} // anonymous namespace
 
 StructuredProblemWriter::StructuredProblemWriter()
 {
@@ -22,53 +70,39 @@ StructuredProblemWriter::write(std::string filename_labels,
 
 	updateInputs();
 
+	std::string format = optionStructuredLearningFormat.as<std::string>();
+
 	// call write functions for the different files to write.
-	writeLabels(filename_labels);
-	writeFeatures(filename_features);
-	writeConstraints(filename_constraints);
+	if (format == "text") {
 
+		writeLabels(filename_labels);
+		writeFeatures(filename_features);
+		writeConstraints(filename_constraints);
+
+	} else if (format == "hdf5") {
+
+		writeLabelsHdf5(hdf5Filename(filename_labels));
+		writeFeaturesHdf5(hdf5Filename(filename_features));
+		writeConstraintsHdf5(hdf5Filename(filename_constraints));
+
+	} else {
+
+		BOOST_THROW_EXCEPTION(UsageError() << error_message(std::string("unknown structured learning format \"") + format + "\"") << STACK_TRACE);
+	}
 }
 
 void
 StructuredProblemWriter::writeLabels(std::string filename_labels) {
-	
-	// write only the labels.
-	// How many variables are there?
-	unsigned int maxVariable = 0;
-        foreach (boost::shared_ptr<Segment> segment, _segments->getSegments()) {
-                maxVariable = std::max(maxVariable,_problemConfiguration->getVariable(segment->getId()));
-        }
-
-	// Get a vector with all ground truth segments.
-	//const std::vector<boost::shared_ptr<Segment> > groundTruthSegments = _groundTruthSegments->getSegments();
 
-	// Get a vector with all gold standard segments.
-	const std::vector<boost::shared_ptr<Segment> > goldStandard = _goldStandard->getSegments();
+	// write only the labels.
+	std::vector<unsigned char> labels = getLabels();
 
 	// Output stream
 	std::ofstream labelsOutput;
-        labelsOutput.open(filename_labels.c_str());
-
-	// For every variable...
-	for (unsigned int i = 0; i <= maxVariable; i++) {
-		
-		// ...check if the segment that corresponds to that variable is contained in the gold standard.
-		unsigned int segmentId = _problemConfiguration->getSegmentId(i);
-				
-		bool isContained = false;
-		foreach (boost::shared_ptr<Segment> s, goldStandard) {
-                        if (s->getId() == segmentId) {
-                                isContained = true;
-			}
-		}
-		
-		if (isContained == true) {
-			labelsOutput << 1 << std::endl;
-		} 
-		else {
-			labelsOutput << 0 << std::endl;
-		}
-	}
+	labelsOutput.open(filename_labels.c_str());
+
+	foreach (unsigned char label, labels)
+		labelsOutput << (int)label << std::endl;
 
 	labelsOutput.close();
 }
@@ -77,24 +111,16 @@ void
 StructuredProblemWriter::writeFeatures(std::string filename_features) {
 
 	// write only the features.
-
-	// Figure out how many variables there are.
-	// After that iterate through all the segments and get the variable number for the segmend id of that segment from
-	// the problem assembler. 
-	// Maybe there is a better way to do this?
-	unsigned int maxVariable = 0;
-	foreach (boost::shared_ptr<Segment> segment, _segments->getSegments()) {
-		maxVariable = std::max(maxVariable,_problemConfiguration->getVariable(segment->getId()));
-	}
+	unsigned int numVariables = getNumVariables();
 
 	std::ofstream featuresOutput;
 	featuresOutput.open(filename_features.c_str());
-	for (unsigned int i = 0; i <= maxVariable; i++) {
+	for (unsigned int i = 0; i < numVariables; i++) {
 
 		const std::vector<double>& features = _features->get(_problemConfiguration->getSegmentId(i));
 		for (unsigned int j = 0; j < features.size(); j++) {
 			featuresOutput << features[j] << " ";
-		}	
+		}
 		featuresOutput << std::endl;
 	}
 	featuresOutput.close();
@@ -106,11 +132,156 @@ StructuredProblemWriter::writeConstraints(std::string filenames_constraints) {
 
 	// write only the constraints.
 
-        std::ofstream constraintOutput;
-        constraintOutput.open(filenames_constraints.c_str());
+	std::ofstream constraintOutput;
+	constraintOutput.open(filenames_constraints.c_str());
 	foreach (const LinearConstraint& constraint, *_linearConstraints) {
-        	constraintOutput << constraint << std::endl;
+		constraintOutput << constraint << std::endl;
 	}
-        constraintOutput.close();
+	constraintOutput.close();
+
+}
+
+void
+StructuredProblemWriter::writeLabelsHdf5(std::string filename_labels) {
+
+	LOG_DEBUG(structuredproblemwriterlog) << "writing labels to " << filename_labels << std::endl;
+
+	vigra::HDF5File file(filename_labels, vigra::HDF5File::New);
+
+	writeHdf5(file, "labels", getLabels());
+}
+
+void
+StructuredProblemWriter::writeFeaturesHdf5(std::string filename_features) {
+
+	LOG_DEBUG(structuredproblemwriterlog) << "writing features to " << filename_features << std::endl;
+
+	unsigned int numVariables = getNumVariables();
+	unsigned int numFeatures  = (numVariables > 0 ? _features->get(_problemConfiguration->getSegmentId(0)).size() : 0);
+
+	vigra::HDF5File file(filename_features, vigra::HDF5File::New);
+
+	if (numVariables == 0 || numFeatures == 0) {
+
+		writeHdf5(file, "features", std::vector<double>());
+		return;
+	}
+
+	typedef vigra::MultiArrayShape<2>::type Shape;
+
+	// one row of features per variable, chunked in blocks of variables
+	unsigned int blockSize = std::min(numVariables, Hdf5ChunkSize);
+
+	file.createDataset<2, double>("features", Shape(numFeatures, numVariables), 0, Shape(numFeatures, blockSize), 6);
+
+	vigra::MultiArray<2, double> block(Shape(numFeatures, blockSize));
+
+	for (unsigned int begin = 0; begin < numVariables; begin += blockSize) {
+
+		unsigned int end = std::min(begin + blockSize, numVariables);
+
+		for (unsigned int i = begin; i < end; i++) {
+
+			const std::vector<double>& features = _features->get(_problemConfiguration->getSegmentId(i));
+
+			if (features.size() != numFeatures)
+				BOOST_THROW_EXCEPTION(
+						SizeMismatchError()
+						<< error_message(
+								std::string("variable ") + boost::lexical_cast<std::string>(i) + " has " +
+								boost::lexical_cast<std::string>(features.size()) + " features, expected " +
+								boost::lexical_cast<std::string>(numFeatures))
+						<< STACK_TRACE);
+
+			std::copy(features.begin(), features.end(), block.bindOuter(i - begin).begin());
+		}
+
+		file.writeBlock("features", Shape(0, begin), block.subarray(Shape(0, 0), Shape(numFeatures, end - begin)));
+	}
+}
+
+void
+StructuredProblemWriter::writeConstraintsHdf5(std::string filename_constraints) {
+
+	LOG_DEBUG(structuredproblemwriterlog) << "writing constraints to " << filename_constraints << std::endl;
+
+	std::vector<unsigned int> indptr;
+	std::vector<unsigned int> indices;
+	std::vector<double>       coefficients;
+	std::vector<signed char>  relations;
+	std::vector<double>       values;
+
+	indptr.reserve(_linearConstraints->size() + 1);
+	relations.reserve(_linearConstraints->size());
+	values.reserve(_linearConstraints->size());
+
+	indptr.push_back(0);
+
+	unsigned int varNum;
+	double coef;
+	foreach (const LinearConstraint& constraint, *_linearConstraints) {
+
+		foreach (boost::tie(varNum, coef), constraint.getCoefficients()) {
+
+			indices.push_back(varNum);
+			coefficients.push_back(coef);
+		}
+
+		indptr.push_back(indices.size());
+
+		switch (constraint.getRelation()) {
+
+			case LessEqual:
+				relations.push_back(-1);
+				break;
+			case Equal:
+				relations.push_back(0);
+				break;
+			case GreaterEqual:
+				relations.push_back(1);
+				break;
+		}
+
+		values.push_back(constraint.getValue());
+	}
+
+	vigra::HDF5File file(filename_constraints, vigra::HDF5File::New);
+
+	writeHdf5(file, "constraints/indptr", indptr);
+	writeHdf5(file, "constraints/indices", indices);
+	writeHdf5(file, "constraints/coefficients", coefficients);
+	writeHdf5(file, "constraints/relations", relations);
+	writeHdf5(file, "constraints/values", values);
+}
+
+unsigned int
+StructuredProblemWriter::getNumVariables() {
+
+	// Figure out how many variables there are: iterate through all the
+	// segments and get the variable number for the segment id of that
+	// segment from the problem configuration.
+	unsigned int numVariables = 0;
+	foreach (boost::shared_ptr<Segment> segment, _segments->getSegments())
+		numVariables = std::max(numVariables, _problemConfiguration->getVariable(segment->getId()) + 1);
+
+	return numVariables;
+}
+
+std::vector<unsigned char>
+StructuredProblemWriter::getLabels() {
+
+	// Get the ids of all gold standard segments.
+	std::set<unsigned int> goldStandardIds;
+	foreach (boost::shared_ptr<Segment> s, _goldStandard->getSegments())
+		goldStandardIds.insert(s->getId());
+
+	unsigned int numVariables = getNumVariables();
+
+	// For every variable, check if the segment that corresponds to that
+	// variable is contained in the gold standard.
+	std::vector<unsigned char> labels(numVariables);
+	for (unsigned int i = 0; i < numVariables; i++)
+		labels[i] = (goldStandardIds.count(_problemConfiguration->getSegmentId(i)) ? 1 : 0);
 
+	return labels;
 }
@@ -7,6 +7,27 @@
 #include <sopnet/features/Features.h>
 #include <sopnet/segments/Segments.h>
 
+/**
+ * Writes the labels, features, and constraints of the current problem for
+ * structured learning.
+ *
+ * Depending on the program option structuredLearning.format, the files are
+ * written as text or as HDF5. For HDF5, the extension of each given
+ * filename is replaced by ".h5", and the files contain:
+ *
+ *   labels.h5       "labels"        uint8 [numVariables]
+ *   features.h5     "features"      float64 [numVariables x numFeatures]
+ *   constraints.h5  "constraints/"  the constraints in compressed sparse
+ *                                   row format:
+ *                   "indptr"        uint32 [numConstraints + 1]
+ *                   "indices"       uint32 [numCoefficients]
+ *                   "coefficients"  float64 [numCoefficients]
+ *                   "relations"     int8 [numConstraints], -1 for <=, 0
+ *                                   for ==, 1 for >=
+ *                   "values"        float64 [numConstraints]
+ *
+ * All datasets are chunked and compressed.
+ */
 class StructuredProblemWriter : public pipeline::SimpleProcessNode<> {
 
 public:
@@ -24,7 +45,18 @@ private:
 	void writeLabels(std::string filename_labels);
 	void writeFeatures(std::string filename_features);
 	void writeConstraints(std::string filename_constraints);
- 
+
+	void writeLabelsHdf5(std::string filename_labels);
+	void writeFeaturesHdf5(std::string filename_features);
+	void writeConstraintsHdf5(std::string filename_constraints);
+
+	// the number of variables, i.e., the highest variable number plus one
+	unsigned int getNumVariables();
+
+	// 1 for each variable that corresponds to a gold standard segment, 0
+	// otherwise
+	std::vector<unsigned char> getLabels();
+
 	pipeline::Input<LinearConstraints> _linearConstraints;
 	pipeline::Input<ProblemConfiguration> _problemConfiguration;
 	pipeline::Input<Features> _features;
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/once.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
+#include "Tracer.h"
+
+static logger::LogChannel tracerlog("tracerlog", "[Tracer] ");
+
+util::ProgramOption optionTraceFile(
+		util::_module           = "trace",
+		util::_long_name        = "file",
+		util::_description_text = "Write a Chrome trace-event file of the processing stages to the given path. Open it with chrome://tracing.",
+		util::_default_value    = "");
+
+util::ProgramOption optionTraceSummary(
+		util::_module           = "trace",
+		util::_long_name        = "summary",
+		util::_description_text = "Log the total time spent in each processing stage and the values of all counters when the program exits.");
+
+namespace {
+
+// the time all trace events are relative to
+const boost::posix_time::ptime programStart = boost::posix_time::microsec_clock::universal_time();
+
+boost::once_flag registerWriteFlag = BOOST_ONCE_INIT;
+
+// the number of the current thread in the trace
+boost::thread_specific_ptr<unsigned int> threadNumber;
+
+} // anonymous namespace
+
+std::vector<Tracer::ScopeEvent>     Tracer::_scopes;
+std::vector<Tracer::CounterEvent>   Tracer::_counterEvents;
+std::map<std::string, double>       Tracer::_counters;
+boost::mutex                        Tracer::_mutex;
+std::string                         Tracer::_traceFile;
+bool                                Tracer::_summary = false;
+
+// the environment is read when the library is loaded, such that tracing
+// works without program options (e.g., in pysopnet)
+volatile bool                       Tracer::_enabled = Tracer::enableFromEnvironment();
+
+bool
+Tracer::enableFromEnvironment() {
+
+	const char* traceFile = std::getenv("SOPNET_TRACE_FILE");
+	const char* summary   = std::getenv("SOPNET_TRACE_SUMMARY");
+
+	bool withFile    = (traceFile && *traceFile);
+	bool withSummary = (summary && *summary && std::string(summary) != "0");
+
+	if (withFile || withSummary)
+		enable(withFile ? traceFile : "", withSummary);
+
+	return _enabled;
+}
+
+void
+Tracer::configure() {
+
+	std::string traceFile = optionTraceFile.as<std::string>();
+	bool        summary   = optionTraceSummary;
+
+	if (!traceFile.empty() || summary) {
+
+		LOG_DEBUG(tracerlog) << "tracing enabled" << std::endl;
+		enable(traceFile, summary);
+	}
+}
+
+void
+Tracer::enable(const std::string& traceFile, bool summary) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	if (!traceFile.empty())
+		_traceFile = traceFile;
+
+	_summary = (_summary || summary);
+
+	_enabled = true;
+}
+
+void
+Tracer::registerWrite() {
+
+	// registered with the first event, not in enable(), which might run
+	// during static initialization
+
+	struct Registration {
+
+		static void registerWrite() {
+
+			std::atexit(&Tracer::write);
+		}
+	};
+
+	boost::call_once(&Registration::registerWrite, registerWriteFlag);
+}
+
+boost::int64_t
+Tracer::now() {
+
+	return (boost::posix_time::microsec_clock::universal_time() - programStart).total_microseconds();
+}
+
+void
+Tracer::addScope(const char* name, boost::int64_t start, boost::int64_t duration) {
+
+	ScopeEvent event;
+	event.name     = name;
+	event.thread   = getThreadNumber();
+	event.start    = start;
+	event.duration = duration;
+
+	registerWrite();
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	_scopes.push_back(event);
+}
+
+void
+Tracer::count(const char* name, double amount) {
+
+	boost::int64_t time = now();
+
+	registerWrite();
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	double& value = _counters[name];
+	value += amount;
+
+	CounterEvent event;
+	event.name  = name;
+	event.time  = time;
+	event.value = value;
+
+	_counterEvents.push_back(event);
+}
+
+unsigned int
+Tracer::getThreadNumber() {
+
+	if (!threadNumber.get()) {
+
+		static unsigned int nextThreadNumber = 0;
+
+		boost::mutex::scoped_lock lock(_mutex);
+
+		threadNumber.reset(new unsigned int(nextThreadNumber++));
+	}
+
+	return *threadNumber;
+}
+
+void
+Tracer::write() {
+
+	if (!isEnabled())
+		return;
+
+	std::string filename;
+	bool        summary;
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		filename = _traceFile;
+		summary  = _summary;
+	}
+
+	if (!filename.empty())
+		writeTrace(filename);
+
+	if (summary)
+		writeSummary();
+}
+
+void
+Tracer::writeTrace(const std::string& filename) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	std::ofstream out(filename.c_str());
+
+	if (!out) {
+
+		LOG_ERROR(tracerlog) << "can not open " << filename << " for writing" << std::endl;
+		return;
+	}
+
+	LOG_USER(tracerlog)
+			<< "writing " << _scopes.size() << " scopes and " << _counterEvents.size()
+			<< " counter events to " << filename << std::endl;
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+
+	bool first = true;
+
+	foreach (const ScopeEvent& event, _scopes) {
+
+		out << (first ? "" : ",\n")
+		    << "{\"name\":\"" << event.name << "\",\"cat\":\"sopnet\",\"ph\":\"X\",\"pid\":1"
+		    << ",\"tid\":" << event.thread
+		    << ",\"ts\":" << event.start
+		    << ",\"dur\":" << event.duration << "}";
+
+		first = false;
+	}
+
+	foreach (const CounterEvent& event, _counterEvents) {
+
+		out << (first ? "" : ",\n")
+		    << "{\"name\":\"" << event.name << "\",\"ph\":\"C\",\"pid\":1"
+		    << ",\"ts\":" << event.time
+		    << ",\"args\":{\"value\":" << event.value << "}}";
+
+		first = false;
+	}
+
+	out << std::endl << "]}" << std::endl;
+}
+
+void
+Tracer::writeSummary() {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	std::map<std::string, ScopeSummary> summaries;
+
+	foreach (const ScopeEvent& event, _scopes) {
+
+		ScopeSummary& summary = summaries[event.name];
+
+		summary.calls++;
+		summary.total += event.duration;
+		summary.max    = std::max(summary.max, event.duration);
+	}
+
+	// sort by total time, longest first
+	std::vector<std::pair<boost::int64_t, std::string> > order;
+	for (std::map<std::string, ScopeSummary>::const_iterator i = summaries.begin(); i != summaries.end(); i++)
+		order.push_back(std::make_pair(i->second.total, i->first));
+	std::sort(order.rbegin(), order.rend());
+
+	LOG_USER(tracerlog) << "time spent per stage (total, calls, mean, max):" << std::endl;
+
+	for (unsigned int i = 0; i < order.size(); i++) {
+
+		const ScopeSummary& summary = summaries[order[i].second];
+
+		LOG_USER(tracerlog)
+				<< "\t" << order[i].second << ": "
+				<< summary.total*1e-6 << "s, "
+				<< summary.calls << ", "
+				<< summary.total*1e-6/summary.calls << "s, "
+				<< summary.max*1e-6 << "s" << std::endl;
+	}
+
+	if (_counters.empty())
+		return;
+
+	LOG_USER(tracerlog) << "counters:" << std::endl;
+
+	for (std::map<std::string, double>::const_iterator i = _counters.begin(); i != _counters.end(); i++)
+		LOG_USER(tracerlog) << "\t" << i->first << ": " << i->second << std::endl;
+}
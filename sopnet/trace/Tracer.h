@@ -0,0 +1,170 @@
+#ifndef SOPNET_TRACE_TRACER_H__
+#define SOPNET_TRACE_TRACER_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+
+/**
+ * Collects timed scopes and counters of the processing stages, and reports
+ * them as a Chrome trace-event file (to be opened with chrome://tracing or
+ * Perfetto) and as a summary in the log.
+ *
+ * Tracing is enabled by the environment variables SOPNET_TRACE_FILE and
+ * SOPNET_TRACE_SUMMARY, by the program options trace.file and trace.summary
+ * (see configure()), or by a call to enable(). The report is written when the
+ * program exits. If tracing is disabled, a scope or counter costs a single
+ * test of a flag.
+ *
+ * Use the macros TRACE_SCOPE and TRACE_COUNT to instrument code:
+ *
+ *   void SliceGuarantor::extractSlices(...) {
+ *
+ *     TRACE_SCOPE("SliceGuarantor::extractSlices");
+ *     ...
+ *     TRACE_COUNT("slices", slices->size());
+ *   }
+ */
+class Tracer {
+
+public:
+
+	/**
+	 * Check whether tracing is enabled.
+	 */
+	static bool isEnabled() {
+
+		return _enabled;
+	}
+
+	/**
+	 * Enable tracing if the program options trace.file or trace.summary are
+	 * set. Call this after the program options have been parsed.
+	 */
+	static void configure();
+
+	/**
+	 * Enable tracing.
+	 *
+	 * @param traceFile
+	 *              The Chrome trace-event file to write, or an empty string.
+	 * @param summary
+	 *              Whether to log the summary of all stages and counters.
+	 */
+	static void enable(const std::string& traceFile, bool summary);
+
+	/**
+	 * Record a scope with the given name that started at the given time (in
+	 * microseconds since the start of the program) and took the given
+	 * duration (in microseconds).
+	 */
+	static void addScope(const char* name, boost::int64_t start, boost::int64_t duration);
+
+	/**
+	 * Add the given amount to the counter with the given name.
+	 */
+	static void count(const char* name, double amount);
+
+	/**
+	 * Get the current time in microseconds since the start of the program.
+	 */
+	static boost::int64_t now();
+
+	/**
+	 * Write the trace file and the summary of everything recorded so far, if
+	 * enabled. This is done automatically when the program exits.
+	 */
+	static void write();
+
+private:
+
+	struct ScopeEvent {
+
+		const char*    name;
+		unsigned int   thread;
+		boost::int64_t start;
+		boost::int64_t duration;
+	};
+
+	struct CounterEvent {
+
+		const char*    name;
+		boost::int64_t time;
+		double         value;
+	};
+
+	struct ScopeSummary {
+
+		ScopeSummary() : calls(0), total(0), max(0) {}
+
+		unsigned int   calls;
+		boost::int64_t total;
+		boost::int64_t max;
+	};
+
+	static bool enableFromEnvironment();
+
+	static void registerWrite();
+
+	static unsigned int getThreadNumber();
+
+	static void writeTrace(const std::string& filename);
+
+	static void writeSummary();
+
+	static std::vector<ScopeEvent>   _scopes;
+	static std::vector<CounterEvent> _counterEvents;
+
+	static std::map<std::string, double> _counters;
+
+	static boost::mutex _mutex;
+
+	static std::string _traceFile;
+	static bool        _summary;
+
+	static volatile bool _enabled;
+};
+
+/**
+ * Records the time between its construction and destruction as a scope of
+ * the given name. The name has to outlive the program, i.e., it should be a
+ * string literal.
+ */
+class TraceScope {
+
+public:
+
+	TraceScope(const char* name) :
+		_name(name),
+		_start(Tracer::isEnabled() ? Tracer::now() : 0) {}
+
+	~TraceScope() {
+
+		if (Tracer::isEnabled())
+			Tracer::addScope(_name, _start, Tracer::now() - _start);
+	}
+
+private:
+
+	const char*    _name;
+	boost::int64_t _start;
+};
+
+#define TRACE_SCOPE_CONCATENATE_(a, b) a##b
+#define TRACE_SCOPE_CONCATENATE(a, b) TRACE_SCOPE_CONCATENATE_(a, b)
+
+/**
+ * Trace the remainder of the current scope under the given name.
+ */
+#define TRACE_SCOPE(name) TraceScope TRACE_SCOPE_CONCATENATE(traceScope, __LINE__)(name)
+
+/**
+ * Add the given amount to the counter of the given name.
+ */
+#define TRACE_COUNT(name, amount) \
+	do { if (Tracer::isEnabled()) Tracer::count(name, amount); } while (false)
+
+#endif // SOPNET_TRACE_TRACER_H__